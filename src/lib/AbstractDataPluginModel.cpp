@@ -29,6 +29,8 @@
 #include "HttpDownloadManager.h"
 #include "MarbleModel.h"
 #include "MarbleDirs.h"
+#include "RenderProfiler.h"
+#include "ScreenGridIndex.h"
 #include "ViewportParams.h"
 
 #include <cmath>
@@ -62,6 +64,8 @@ public:
     ~AbstractDataPluginModelPrivate();
 
     void updateFavoriteItems();
+
+    void updateHitIndex();
     
     AbstractDataPluginModel *m_parent;
     const QString m_name;
@@ -74,6 +78,7 @@ public:
     QList<AbstractDataPluginItem*> m_itemSet;
     QHash<QString, AbstractDataPluginItem*> m_downloadingItems;
     QList<AbstractDataPluginItem*> m_displayedItems;
+    ScreenGridIndex<AbstractDataPluginItem*> m_hitIndex;
     QTimer m_downloadTimer;
     quint32 m_descriptionFileNumber;
     QHash<QString, QVariant> m_itemSettings;
@@ -147,6 +152,16 @@ AbstractDataPluginModelPrivate::~AbstractDataPluginModelPrivate() {
     m_storagePolicy.clearCache();
 }
 
+void AbstractDataPluginModelPrivate::updateHitIndex()
+{
+    m_hitIndex.clear();
+    foreach( AbstractDataPluginItem *item, m_displayedItems ) {
+        foreach( const QRectF &rect, item->boundingRects() ) {
+            m_hitIndex.insert( rect, item );
+        }
+    }
+}
+
 void AbstractDataPluginModelPrivate::updateFavoriteItems()
 {
     if ( m_favoriteItemsOnly ) {
@@ -274,6 +289,7 @@ const MarbleModel *AbstractDataPluginModel::marbleModel() const
 QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportParams *viewport,
                                                                qint32 number )
 {
+    RenderProfiler::Scope scope( "AbstractDataPluginModel::items" );
     GeoDataLatLonAltBox currentBox = viewport->viewLatLonAltBox();
     QString target = d->m_marbleModel->planetId();
     QList<AbstractDataPluginItem*> list;
@@ -290,6 +306,9 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
         d->m_needsSorting =  false;
     }
 
+    // The items shown so far, for the collision tests and for whichItemAt()
+    d->m_hitIndex.reset( viewport->size() );
+
     QList<AbstractDataPluginItem*>::const_iterator i = candidates.constBegin();
     QList<AbstractDataPluginItem*>::const_iterator end = candidates.constEnd();
 
@@ -319,19 +338,20 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
         // because we zoomed out since then.
         bool const alreadyDisplayed = d->m_displayedItems.contains( *i );
         if( !list.contains( *i ) && ( !alreadyDisplayed || (*i)->addedAngularResolution() >= viewport->angularResolution() ) ) {
+            QList<QRectF> const itemRects = (*i)->boundingRects();
             bool collides = false;
-            int const length = list.length();
-            for ( int j=0; !collides && j<length; ++j ) {
-                foreach( const QRectF &rect, list[j]->boundingRects() ) {
-                    foreach( const QRectF &itemRect, (*i)->boundingRects() ) {
-                        if ( rect.intersects( itemRect ) )
-                            collides = true;
-                    }
+            foreach( const QRectF &itemRect, itemRects ) {
+                if ( d->m_hitIndex.intersects( itemRect ) ) {
+                    collides = true;
+                    break;
                 }
             }
 
             if ( !collides ) {
                 list.append( *i );
+                foreach( const QRectF &itemRect, itemRects ) {
+                    d->m_hitIndex.insert( itemRect, *i );
+                }
                 (*i)->setSettings( d->m_itemSettings );
 
                 // We want to save the angular resolution of the first time the item got added.
@@ -351,14 +371,7 @@ QList<AbstractDataPluginItem*> AbstractDataPluginModel::items( const ViewportPar
 
 QList<AbstractDataPluginItem *> AbstractDataPluginModel::whichItemAt( const QPoint& curpos )
 {
-    QList<AbstractDataPluginItem *> itemsAt;
-    
-    foreach( AbstractDataPluginItem* item, d->m_displayedItems ) {
-        if( item && item->contains( QPointF( curpos ) ) )
-            itemsAt.append( item );
-    }
-    
-    return itemsAt;
+    return d->m_hitIndex.itemsAt( curpos ).toList();
 }
 
 void AbstractDataPluginModel::parseFile( const QByteArray& file )
@@ -651,6 +664,9 @@ void AbstractDataPluginModel::processFinishedJob( const QString& relativeUrlStri
 void AbstractDataPluginModel::removeItem( QObject *item )
 {
     d->m_itemSet.removeAll( (AbstractDataPluginItem *) item );
+    if ( d->m_displayedItems.removeAll( (AbstractDataPluginItem *) item ) > 0 ) {
+        d->updateHitIndex();
+    }
     QHash<QString, AbstractDataPluginItem *>::iterator i;
     for( i = d->m_downloadingItems.begin(); i != d->m_downloadingItems.end(); ++i ) {
         if( (*i) == (AbstractDataPluginItem *) item ) {
@@ -662,6 +678,7 @@ void AbstractDataPluginModel::removeItem( QObject *item )
 void AbstractDataPluginModel::clear()
 {
     d->m_displayedItems.clear();
+    d->m_hitIndex.clear();
     QList<AbstractDataPluginItem*>::iterator iter = d->m_itemSet.begin();
     QList<AbstractDataPluginItem*>::iterator const end = d->m_itemSet.end();
     for (; iter != end; ++iter ) {
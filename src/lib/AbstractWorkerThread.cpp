@@ -14,12 +14,13 @@
 
 // Qt
 #include <QMutex>
+#include <QWaitCondition>
 
 namespace Marble
 {
 
-const int WAIT_ATTEMPTS = 20;
-const int WAIT_TIME = 100;
+// Time in ms a thread without work waits for new work before it exits
+const unsigned long IDLE_TIMEOUT = 2000;
 
 class AbstractWorkerThreadPrivate
 {
@@ -33,12 +34,16 @@ class AbstractWorkerThreadPrivate
 
     ~AbstractWorkerThreadPrivate()
     {
+        m_runningMutex.lock();
         m_end = true;
+        m_workAdded.wakeAll();
+        m_runningMutex.unlock();
         m_parent->wait( 1000 );
     }
 
     bool m_running;
     QMutex m_runningMutex;
+    QWaitCondition m_workAdded;
     bool m_end;
 
     AbstractWorkerThread *m_parent;
@@ -59,38 +64,33 @@ AbstractWorkerThread::~AbstractWorkerThread()
 void AbstractWorkerThread::ensureRunning()
 {
     QMutexLocker locker( &d->m_runningMutex );
-    if ( !d->m_running ) {
-        if ( wait( 2 * WAIT_TIME ) ) {
-            d->m_running = true;
-            start( QThread::IdlePriority );
-        }
+    if ( d->m_running ) {
+        d->m_workAdded.wakeOne();
+    }
+    else {
+        // The thread may still be returning from run() after it gave up
+        // waiting for work, which takes no noticeable time.
+        wait();
+        d->m_running = true;
+        start( QThread::IdlePriority );
     }
 }
 
 void AbstractWorkerThread::run()
 {
-    int waitAttempts = WAIT_ATTEMPTS;
+    QMutexLocker locker( &d->m_runningMutex );
     while( !d->m_end ) {
-        d->m_runningMutex.lock();
-        if ( !workAvailable() ) {
-            waitAttempts--;
-            if ( !waitAttempts || d->m_end ) {
-                d->m_running = false;
-                d->m_runningMutex.unlock();
-                break;
-            }
-            else {
-                d->m_runningMutex.unlock();
-                msleep( WAIT_TIME );
-            }
-        }
-        else {
-            d->m_runningMutex.unlock();
+        if ( workAvailable() ) {
+            locker.unlock();
             work();
-
-            waitAttempts = WAIT_ATTEMPTS;
+            locker.relock();
+        }
+        else if ( !d->m_workAdded.wait( &d->m_runningMutex, IDLE_TIMEOUT )
+                  && !workAvailable() ) {
+            break;
         }
     }
+    d->m_running = false;
 }
 
 }
@@ -28,10 +28,13 @@ class AbstractWorkerThreadPrivate;
  * You should be able to use this class for many different tasks, but you'll have to
  * think about Multi-Threading additionally.
  * The AbstractWorkerThread runs the function work() as long as workAvailable()
- * returns true. If there is no work available for a longer time, the thread will
- * switch itself off. As a result you have to call ensureRunning() every time you
+ * returns true. Without work the thread sleeps until ensureRunning() wakes it up,
+ * and if there is no work available for a longer time, the thread will switch
+ * itself off. As a result you have to call ensureRunning() every time you
  * want something to be worked on. You'll probably want to call this in your
  * addSchedule() function.
+ * workAvailable() is called with an internal mutex held that is also held by
+ * ensureRunning(), so it must not block on anything waiting for either.
  */
 class MARBLE_EXPORT AbstractWorkerThread : public QThread
 {
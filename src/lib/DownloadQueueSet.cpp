@@ -19,17 +19,27 @@
 
 #include "HttpJob.h"
 
+#include <cmath>
+
 namespace Marble
 {
 
 DownloadQueueSet::DownloadQueueSet( QObject * const parent )
-    : QObject( parent )
+    : QObject( parent ),
+      m_jobSerial( 0 ),
+      m_viewLevel( -1 ),
+      m_viewCenterX( 0.0 ),
+      m_viewCenterY( 0.0 )
 {
 }
 
 DownloadQueueSet::DownloadQueueSet( DownloadPolicy const & policy, QObject * const parent )
     : QObject( parent ),
-      m_downloadPolicy( policy )
+      m_downloadPolicy( policy ),
+      m_jobSerial( 0 ),
+      m_viewLevel( -1 ),
+      m_viewCenterX( 0.0 ),
+      m_viewCenterY( 0.0 )
 {
 }
 
@@ -75,7 +85,7 @@ bool DownloadQueueSet::canAcceptJob( const QUrl& sourceUrl,
 
 void DownloadQueueSet::addJob( HttpJob * const job )
 {
-    m_jobs.push( job );
+    m_jobs.insert( job, rank( job, m_jobSerial++ ) );
     mDebug() << "addJob: new job queue size:" << m_jobs.count();
     emit jobAdded();
     emit progressChanged( m_activeJobs.size(), m_jobs.count() );
@@ -87,7 +97,7 @@ void DownloadQueueSet::activateJobs()
     while ( !m_jobs.isEmpty()
             && m_activeJobs.count() < m_downloadPolicy.maximumConnections() )
     {
-        HttpJob * const job = m_jobs.pop();
+        HttpJob * const job = m_jobs.takeFirst();
         activateJob( job );
     }
 }
@@ -106,7 +116,7 @@ void DownloadQueueSet::purgeJobs()
 {
     // purge all waiting jobs
     while( !m_jobs.isEmpty() ) {
-        HttpJob * const job = m_jobs.pop();
+        HttpJob * const job = m_jobs.takeFirst();
         job->deleteLater();
     }
 
@@ -122,6 +132,51 @@ void DownloadQueueSet::purgeJobs()
     emit progressChanged( m_activeJobs.size(), m_jobs.count() );
 }
 
+void DownloadQueueSet::setVisibleTiles( const QStringList &sourceDirs, const QList<TileId> &visibleTiles )
+{
+    m_viewSourceDirs = sourceDirs.toSet();
+    m_visibleTiles.clear();
+    m_viewLevel = -1;
+
+    foreach ( const TileId &id, visibleTiles ) {
+        m_visibleTiles.insert( TileId( 0, id.zoomLevel(), id.x(), id.y() ) );
+        m_viewLevel = qMax( m_viewLevel, id.zoomLevel() );
+    }
+
+    // the view center is the center of the visible tiles of the view level
+    qreal sumX = 0.0;
+    qreal sumY = 0.0;
+    int count = 0;
+    foreach ( const TileId &id, visibleTiles ) {
+        if ( id.zoomLevel() == m_viewLevel ) {
+            sumX += id.x() + 0.5;
+            sumY += id.y() + 0.5;
+            ++count;
+        }
+    }
+    m_viewCenterX = count > 0 ? sumX / count : 0.0;
+    m_viewCenterY = count > 0 ? sumY / count : 0.0;
+
+    int dropped = 0;
+    foreach ( const JobRank &oldRank, m_jobs.ranks() ) {
+        HttpJob * const job = m_jobs.take( oldRank );
+        TileId tileId;
+        if ( isViewTile( job, tileId ) && !m_visibleTiles.contains( tileId ) ) {
+            // the tile has left the view
+            job->deleteLater();
+            ++dropped;
+            emit jobRemoved();
+            continue;
+        }
+        m_jobs.insert( job, rank( job, oldRank.serial ) );
+    }
+
+    if ( dropped > 0 ) {
+        mDebug() << "setVisibleTiles: dropped" << dropped << "jobs, new job queue size:" << m_jobs.count();
+        emit progressChanged( m_activeJobs.size(), m_jobs.count() );
+    }
+}
+
 void DownloadQueueSet::finishJob( HttpJob * job, const QByteArray& data )
 {
     mDebug() << "finishJob: " << job->sourceUrl() << job->destinationFileName();
@@ -242,37 +297,110 @@ bool DownloadQueueSet::jobIsBlackListed( const QUrl& sourceUrl ) const
     return pos != m_jobBlackList.constEnd();
 }
 
+bool DownloadQueueSet::JobRank::operator<( const JobRank &other ) const
+{
+    if ( levelDistance != other.levelDistance ) {
+        return levelDistance < other.levelDistance;
+    }
+    if ( distance != other.distance ) {
+        return distance < other.distance;
+    }
+    return serial > other.serial;
+}
+
+DownloadQueueSet::JobRank DownloadQueueSet::rank( const HttpJob * const job, int serial ) const
+{
+    JobRank result;
+    result.levelDistance = 0;
+    result.distance = 0.0;
+    result.serial = serial;
+
+    TileId tileId;
+    if ( !isViewTile( job, tileId ) ) {
+        return result;
+    }
 
-inline bool DownloadQueueSet::JobStack::contains( const QString& destinationFileName ) const
+    // compare the tile centers in tiles of the view level
+    const qreal scale = pow( 2.0, m_viewLevel - tileId.zoomLevel() );
+    const qreal dx = ( tileId.x() + 0.5 ) * scale - m_viewCenterX;
+    const qreal dy = ( tileId.y() + 0.5 ) * scale - m_viewCenterY;
+
+    result.levelDistance = qAbs( m_viewLevel - tileId.zoomLevel() );
+    result.distance = sqrt( dx * dx + dy * dy );
+
+    return result;
+}
+
+/**
+   Returns whether @p job downloads a tile of the view, that is, whether
+   its id is of the form "sourceDir:zoomLevel:x:y" as created by TileLoader
+   with sourceDir being one of the source dirs of the view. Bulk downloads
+   use the same ids but are never tiles of the view.
+ */
+bool DownloadQueueSet::isViewTile( const HttpJob * const job, TileId &tileId ) const
+{
+    if ( m_viewLevel < 0 || job->downloadUsage() != DownloadBrowse ) {
+        return false;
+    }
+
+    const QStringList components = job->initiatorId().split( ':' );
+    if ( components.size() != 4 || !m_viewSourceDirs.contains( components[ 0 ] ) ) {
+        return false;
+    }
+
+    bool ok = true;
+    const int zoomLevel = components[ 1 ].toInt( &ok );
+    const int x = ok ? components[ 2 ].toInt( &ok ) : 0;
+    const int y = ok ? components[ 3 ].toInt( &ok ) : 0;
+    if ( !ok ) {
+        return false;
+    }
+
+    tileId = TileId( 0, zoomLevel, x, y );
+    return true;
+}
+
+
+inline bool DownloadQueueSet::JobQueue::contains( const QString& destinationFileName ) const
 {
     return m_jobsContent.contains( destinationFileName );
 }
 
-inline int DownloadQueueSet::JobStack::count() const
+inline int DownloadQueueSet::JobQueue::count() const
 {
     return m_jobs.count();
 }
 
-inline bool DownloadQueueSet::JobStack::isEmpty() const
+inline bool DownloadQueueSet::JobQueue::isEmpty() const
 {
     return m_jobs.isEmpty();
 }
 
-inline HttpJob * DownloadQueueSet::JobStack::pop()
+inline HttpJob * DownloadQueueSet::JobQueue::takeFirst()
 {
-    HttpJob * const job = m_jobs.pop();
-    bool const removed = m_jobsContent.remove( job->destinationFileName() );
-    Q_UNUSED( removed ); // for Q_ASSERT in release mode
-    Q_ASSERT( removed );
-    return job;
+    return take( m_jobs.constBegin().key() );
 }
 
-inline void DownloadQueueSet::JobStack::push( HttpJob * const job )
+inline void DownloadQueueSet::JobQueue::insert( HttpJob * const job, const JobRank &rank )
 {
-    m_jobs.push( job );
+    m_jobs.insert( rank, job );
     m_jobsContent.insert( job->destinationFileName() );
 }
 
+inline QList<DownloadQueueSet::JobRank> DownloadQueueSet::JobQueue::ranks() const
+{
+    return m_jobs.keys();
+}
+
+inline HttpJob * DownloadQueueSet::JobQueue::take( const JobRank &rank )
+{
+    HttpJob * const job = m_jobs.take( rank );
+    bool const removed = m_jobsContent.remove( job->destinationFileName() );
+    Q_UNUSED( removed ); // for Q_ASSERT in release mode
+    Q_ASSERT( removed );
+    return job;
+}
+
 
 }
 
@@ -17,13 +17,15 @@
 #define MARBLE_DOWNLOADQUEUESET_H
 
 #include <QList>
+#include <QMap>
 #include <QQueue>
 #include <QObject>
 #include <QSet>
-#include <QStack>
+#include <QStringList>
 #include <QUrl>
 
 #include "DownloadPolicy.h"
+#include "TileId.h"
 
 namespace Marble
 {
@@ -36,6 +38,11 @@ class HttpJob;
    - Job is added to the QueueSet (by calling addJob() )
      the HttpJob is put into the m_jobQueue where it waits for "activation"
      signal jobAdded is emitted
+   - Jobs are ranked
+     Queued jobs are activated in the order of their rank, which
+     prefers tiles of the current view level close to the view center
+     (see setVisibleTiles() ). Jobs which are not tile downloads are
+     activated first, most recently added first.
    - Job is activated
      Job is moved from m_jobQueue to m_activeJobs and signals of the job
      are connected to slots (local or HttpDownloadManager)
@@ -89,6 +96,22 @@ class DownloadQueueSet: public QObject
     void retryJobs();
     void purgeJobs();
 
+    /**
+     * Updates the view the queued tile downloads are ranked for.
+     *
+     * Queued downloads of tiles from the source directories @p sourceDirs
+     * are reordered so that tiles of the zoom level of @p visibleTiles
+     * closest to the center of @p visibleTiles come first. Queued downloads
+     * of tiles which are not in @p visibleTiles are dropped, since the
+     * tiles have left the view. Downloads of other source directories,
+     * bulk downloads, active downloads and downloads waiting for a retry
+     * are kept.
+     *
+     * @param sourceDirs the source directories of the texture layers of the view
+     * @param visibleTiles the tiles on display, the map theme id hash is ignored
+     */
+    void setVisibleTiles( const QStringList &sourceDirs, const QList<TileId> &visibleTiles );
+
  Q_SIGNALS:
     void jobAdded();
     void jobRemoved();
@@ -112,24 +135,49 @@ class DownloadQueueSet: public QObject
     bool jobIsWaitingForRetry( const QString& destinationFileName ) const;
     bool jobIsBlackListed( const QUrl& sourceUrl ) const;
 
+    /**
+     * Position of a job in the queue, the smallest rank is activated first.
+     */
+    struct JobRank
+    {
+        int levelDistance; // to the view level
+        qreal distance;    // to the view center, in tiles of the view level
+        int serial;        // the most recently added job wins a tie
+
+        bool operator<( const JobRank &other ) const;
+    };
+
+    JobRank rank( const HttpJob * const job, int serial ) const;
+    bool isViewTile( const HttpJob * const job, TileId &tileId ) const;
+
     DownloadPolicy m_downloadPolicy;
 
     /** This is the first stage a job enters, from this queue it will get
      *  into the activatedJobs container.
      */
-    class JobStack
+    class JobQueue
     {
     public:
         bool contains( const QString& destinationFileName ) const;
         int count() const;
         bool isEmpty() const;
-        HttpJob * pop();
-        void push( HttpJob * const );
+        HttpJob * takeFirst();
+        void insert( HttpJob * const, const JobRank &rank );
+        QList<JobRank> ranks() const;
+        HttpJob * take( const JobRank &rank );
     private:
-        QStack<HttpJob*> m_jobs;
+        QMap<JobRank, HttpJob*> m_jobs;
         QSet<QString> m_jobsContent;
     };
-    JobStack m_jobs;
+    JobQueue m_jobs;
+    int m_jobSerial;
+
+    /// The view the queued tile downloads are ranked for
+    QSet<QString> m_viewSourceDirs;
+    QSet<TileId> m_visibleTiles;
+    int m_viewLevel;
+    qreal m_viewCenterX;
+    qreal m_viewCenterY;
 
     /// Contains the jobs which are currently being downloaded.
     QList<HttpJob*> m_activeJobs;
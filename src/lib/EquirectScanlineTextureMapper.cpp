@@ -24,7 +24,6 @@
 #include "MarbleDebug.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
-#include "TextureColorizer.h"
 #include "ViewportParams.h"
 
 using namespace Marble;
@@ -69,8 +68,7 @@ EquirectScanlineTextureMapper::EquirectScanlineTextureMapper( StackedTileLoader
 void EquirectScanlineTextureMapper::mapTexture( GeoPainter *painter,
                                                 const ViewportParams *viewport,
                                                 int tileZoomLevel,
-                                                const QRect &dirtyRect,
-                                                TextureColorizer *texColorizer )
+                                                const QRect &dirtyRect )
 {
     if ( m_canvasImage.size() != viewport->size() || m_radius != viewport->radius() ) {
         const QImage::Format optimalFormat = ScanlineTextureMapperContext::optimalCanvasImageFormat( viewport );
@@ -90,10 +88,6 @@ void EquirectScanlineTextureMapper::mapTexture( GeoPainter *painter,
     if ( m_repaintNeeded ) {
         mapTexture( viewport, tileZoomLevel, painter->mapQuality() );
 
-        if ( texColorizer ) {
-            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
-        }
-
         m_repaintNeeded = false;
     }
 
@@ -33,8 +33,7 @@ class EquirectScanlineTextureMapper : public TextureMapperInterface
     virtual void mapTexture( GeoPainter *painter,
                              const ViewportParams *viewport,
                              int tileZoomLevel,
-                             const QRect &dirtyRect,
-                             TextureColorizer *texColorizer );
+                             const QRect &dirtyRect );
 
  private:
     void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
@@ -11,7 +11,6 @@
 #include "FileLoader.h"
 
 #include <QBuffer>
-#include <QDataStream>
 #include <QDateTime>
 #include <QFile>
 #include <QThread>
@@ -32,6 +31,7 @@
 #include "MarbleDebug.h"
 #include "MarbleModel.h"
 #include "ParsingRunnerManager.h"
+#include "PlacemarkCache.h"
 
 namespace Marble
 {
@@ -76,7 +76,6 @@ public:
     }
 
     void saveFile(const QString& filename );
-    void savePlacemarks(QDataStream &out, const GeoDataContainer *container);
 
     void createFilterProperties( GeoDataContainer *container );
     int cityPopIdx( qint64 population ) const;
@@ -238,8 +237,6 @@ bool FileLoader::recenter() const
     return d->m_recenter;
 }
 
-const quint32 MarbleMagicNumber = 0x31415926;
-
 void FileLoaderPrivate::saveFile( const QString& filename )
 {
 
@@ -248,55 +245,7 @@ void FileLoaderPrivate::saveFile( const QString& filename )
    
     mDebug() << "Creating cache at " << filename ;
 
-    QFile file( filename );
-    if ( !file.open( QIODevice::WriteOnly ) ) {
-        mDebug() << Q_FUNC_INFO << "Can't open" << filename << "for writing";
-        return;
-    }
-    QDataStream out( &file );
-
-    // Write a header with a "magic number" and a version
-    // out << (quint32)0xA0B0C0D0;
-    out << (quint32)MarbleMagicNumber;
-    out << (qint32)015;
-
-    out.setVersion( QDataStream::Qt_4_2 );
-
-    savePlacemarks(out, m_document);
-}
-
-void FileLoaderPrivate::savePlacemarks(QDataStream &out, const GeoDataContainer *container)
-{
-
-    qreal lon;
-    qreal lat;
-    qreal alt;
-
-    const QVector<GeoDataPlacemark*> placemarks = container->placemarkList();
-    QVector<GeoDataPlacemark*>::const_iterator it = placemarks.constBegin();
-    QVector<GeoDataPlacemark*>::const_iterator const end = placemarks.constEnd();
-    for (; it != end; ++it ) {
-        out << (*it)->name();
-        (*it)->coordinate( m_clock->dateTime() ).geoCoordinates( lon, lat, alt );
-
-        // Use double to provide a single cache file format across architectures
-        out << (double)(lon) << (double)(lat) << (double)(alt);
-        out << QString( (*it)->role() );
-        out << QString( (*it)->description() );
-        out << QString( (*it)->countryCode() );
-        out << QString( (*it)->state() );
-        out << (double) (*it)->area();
-        out << (qint64) (*it)->population();
-        out << ( qint16 ) ( (*it)->extendedData().value("gmt").value().toInt() );
-        out << ( qint8 ) ( (*it)->extendedData().value("dst").value().toInt() );
-    }
-
-    const QVector<GeoDataFolder*> folders = container->folderList();
-    QVector<GeoDataFolder*>::const_iterator cont = folders.constBegin();
-    QVector<GeoDataFolder*>::const_iterator endcont = folders.constEnd();
-    for (; cont != endcont; ++cont ) {
-            savePlacemarks(out, *cont);
-    }
+    PlacemarkCache::save( filename, m_document, m_clock->dateTime() );
 }
 
 void FileLoaderPrivate::documentParsed( GeoDataDocument* doc, const QString& error )
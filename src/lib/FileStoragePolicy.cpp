@@ -17,17 +17,215 @@
 #include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QWaitCondition>
+
+#ifdef Q_OS_WIN
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
 
 // Marble
+#include "AbstractWorkerThread.h"
 #include "MarbleDebug.h"
 #include "MarbleGlobal.h"
 #include "MarbleDirs.h"
 
+namespace Marble
+{
+
+/**
+ * Writes the files queued by a FileStoragePolicy. Everything that has been
+ * queued while the previous batch was written is taken as the next batch,
+ * and the change of the cache size is reported once per batch.
+ */
+class FileStorageWriter : public AbstractWorkerThread
+{
+ public:
+    explicit FileStorageWriter( FileStoragePolicy *policy );
+
+    void schedule( const QString &fullName, const QByteArray &data );
+
+    bool isScheduled( const QString &fullName ) const;
+
+    void waitForWrites();
+
+    void setSyncWrites( bool sync );
+
+    bool syncWrites() const;
+
+    QString lastErrorMessage() const;
+
+ protected:
+    bool workAvailable();
+    void work();
+
+ private:
+    bool writeFile( const QString &fullName, const QByteArray &data, qint64 &bytes );
+
+    FileStoragePolicy *const m_policy;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_idle;
+    QHash<QString, QByteArray> m_pending;
+    bool m_writing;
+    bool m_syncWrites;
+    QString m_errorMsg;
+
+    // only accessed by the writer thread
+    QSet<QString> m_knownDirectories;
+};
+
+FileStorageWriter::FileStorageWriter( FileStoragePolicy *policy )
+    : AbstractWorkerThread(),
+      m_policy( policy ),
+      m_writing( false ),
+      m_syncWrites( false )
+{
+}
+
+void FileStorageWriter::schedule( const QString &fullName, const QByteArray &data )
+{
+    m_mutex.lock();
+    m_pending.insert( fullName, data );
+    m_mutex.unlock();
+
+    ensureRunning();
+}
+
+bool FileStorageWriter::isScheduled( const QString &fullName ) const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_pending.contains( fullName );
+}
+
+void FileStorageWriter::waitForWrites()
+{
+    QMutexLocker locker( &m_mutex );
+    while ( m_writing || !m_pending.isEmpty() ) {
+        m_idle.wait( &m_mutex );
+    }
+}
+
+void FileStorageWriter::setSyncWrites( bool sync )
+{
+    QMutexLocker locker( &m_mutex );
+    m_syncWrites = sync;
+}
+
+bool FileStorageWriter::syncWrites() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_syncWrites;
+}
+
+QString FileStorageWriter::lastErrorMessage() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_errorMsg;
+}
+
+bool FileStorageWriter::workAvailable()
+{
+    QMutexLocker locker( &m_mutex );
+    return !m_pending.isEmpty();
+}
+
+void FileStorageWriter::work()
+{
+    m_mutex.lock();
+    QHash<QString, QByteArray> batch;
+    batch.swap( m_pending );
+    const bool sync = m_syncWrites;
+    m_writing = true;
+    m_mutex.unlock();
+
+    qint64 bytes = 0;
+    QHash<QString, QByteArray>::const_iterator it = batch.constBegin();
+    QHash<QString, QByteArray>::const_iterator const end = batch.constEnd();
+    for (; it != end; ++it ) {
+        if ( !writeFile( it.key(), it.value(), bytes ) ) {
+            continue;
+        }
+
+        if ( sync ) {
+            // QFile has no way to sync, so reopen the file for the handle
+            QFile file( it.key() );
+            if ( file.open( QIODevice::ReadOnly ) ) {
+#ifdef Q_OS_WIN
+                _commit( file.handle() );
+#else
+                fsync( file.handle() );
+#endif
+            }
+        }
+    }
+
+    if ( bytes != 0 ) {
+        QMetaObject::invokeMethod( m_policy, "reportWrittenBytes", Qt::QueuedConnection,
+                                   Q_ARG( qint64, bytes ) );
+    }
+
+    m_mutex.lock();
+    m_writing = false;
+    if ( m_pending.isEmpty() ) {
+        m_idle.wakeAll();
+    }
+    m_mutex.unlock();
+}
+
+bool FileStorageWriter::writeFile( const QString &fullName, const QByteArray &data, qint64 &bytes )
+{
+    QFileInfo const info( fullName );
+
+    // Create directory if it doesn't exist yet...
+    const QString localFileDirPath = info.absolutePath();
+    if ( !m_knownDirectories.contains( localFileDirPath ) ) {
+        if ( !QDir( localFileDirPath ).exists() )
+            QDir::root().mkpath( localFileDirPath );
+        m_knownDirectories.insert( localFileDirPath );
+    }
+
+    // ... and save the file content
+    const qint64 oldSize = info.exists() ? info.size() : 0;
+    QFile file( fullName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        // the directory may have been removed behind our back
+        QDir::root().mkpath( localFileDirPath );
+    }
+    if ( !file.isOpen() && !file.open( QIODevice::WriteOnly ) ) {
+        const QString errorMsg = QString( "%1: %2" ).arg( fullName ).arg( file.errorString() );
+        qCritical() << "file.open" << errorMsg;
+        QMutexLocker locker( &m_mutex );
+        m_errorMsg = errorMsg;
+        return false;
+    }
+
+    const bool written = file.write( data ) == data.size();
+    bytes += file.size() - oldSize;
+    if ( !written ) {
+        const QString errorMsg = QString( "%1: %2" ).arg( fullName ).arg( file.errorString() );
+        qCritical() << "file.write" << errorMsg;
+        QMutexLocker locker( &m_mutex );
+        m_errorMsg = errorMsg;
+        return false;
+    }
+
+    return true;
+}
+
+}
+
 using namespace Marble;
 
 FileStoragePolicy::FileStoragePolicy( const QString &dataDirectory, QObject *parent )
     : StoragePolicy( parent ),
-      m_dataDirectory( dataDirectory )
+      m_dataDirectory( dataDirectory ),
+      m_writer( new FileStorageWriter( this ) )
 {
     if ( m_dataDirectory.isEmpty() )
         m_dataDirectory = MarbleDirs::localPath() + "/cache/";
@@ -38,12 +236,14 @@ FileStoragePolicy::FileStoragePolicy( const QString &dataDirectory, QObject *par
 
 FileStoragePolicy::~FileStoragePolicy()
 {
+    m_writer->waitForWrites();
+    delete m_writer;
 }
 
 bool FileStoragePolicy::fileExists( const QString &fileName ) const
 {
     const QString fullName( m_dataDirectory + '/' + fileName );
-    return QFile::exists( fullName );
+    return m_writer->isScheduled( fullName ) || QFile::exists( fullName );
 }
 
 bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &data )
@@ -51,40 +251,36 @@ bool FileStoragePolicy::updateFile( const QString &fileName, const QByteArray &d
     QFileInfo const dirInfo( fileName );
     QString const fullName = dirInfo.isAbsolute() ? fileName : m_dataDirectory + '/' + fileName;
 
-    // Create directory if it doesn't exist yet...
-    QFileInfo info( fullName );
-
-    const QDir localFileDir = info.dir();
-    const QString localFileDirPath = localFileDir.absolutePath();
+    m_writer->schedule( fullName, data );
 
-    if ( !QDir( localFileDirPath ).exists() )
-        QDir::root().mkpath( localFileDirPath );
-
-    // ... and save the file content
-    QFile file( fullName );
-    if ( !file.open( QIODevice::WriteOnly ) ) {
-        m_errorMsg = QString( "%1: %2" ).arg( fullName ).arg( file.errorString() );
-        qCritical() << "file.open" << m_errorMsg;
-        return false;
-    }
+    return true;
+}
 
-    quint64 oldSize = file.size();
+void FileStoragePolicy::setSyncWrites( bool sync )
+{
+    m_writer->setSyncWrites( sync );
+}
 
-    if ( !file.write( data ) ) {
-        m_errorMsg = QString( "%1: %2" ).arg( fullName ).arg( file.errorString() );
-        qCritical() << "file.write" << m_errorMsg;
-        emit sizeChanged( file.size() - oldSize );
-        return false;
-    }
+bool FileStoragePolicy::syncWrites() const
+{
+    return m_writer->syncWrites();
+}
 
-    emit sizeChanged( file.size() - oldSize );
-    file.close();
+void FileStoragePolicy::waitForWrites()
+{
+    m_writer->waitForWrites();
+}
 
-    return true;
+void FileStoragePolicy::reportWrittenBytes( qint64 bytes )
+{
+    emit sizeChanged( bytes );
 }
 
 void FileStoragePolicy::clearCache()
 {
+    // don't let queued tiles reappear after the cache has been cleared
+    m_writer->waitForWrites();
+
     if ( m_dataDirectory.isEmpty() || !m_dataDirectory.endsWith(QLatin1String( "data" )) )
     {
         mDebug() << "Error: Refusing to erase files under unknown conditions for safety reasons!";
@@ -139,7 +335,7 @@ void FileStoragePolicy::clearCache()
 
 QString FileStoragePolicy::lastErrorMessage() const
 {
-    return m_errorMsg;
+    return m_writer->lastErrorMessage();
 }
 
 #include "FileStoragePolicy.moc"
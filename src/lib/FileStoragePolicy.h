@@ -12,11 +12,21 @@
 #define MARBLE_FILESTORAGEPOLICY_H
 
 #include "StoragePolicy.h"
+#include "marble_export.h"
 
 namespace Marble
 {
 
-class FileStoragePolicy : public StoragePolicy
+class FileStorageWriter;
+
+/**
+ * Stores downloaded files below a data directory.
+ *
+ * The files are written by a background thread, so updateFile() returns
+ * before the data is on disk. Files which are still waiting to be written
+ * already count as existing.
+ */
+class MARBLE_EXPORT FileStoragePolicy : public StoragePolicy
 {
     Q_OBJECT
     
@@ -39,7 +49,8 @@ class FileStoragePolicy : public StoragePolicy
         bool fileExists( const QString &fileName ) const;
 
         /**
-         * Updates the @p fileName with the given @p data.
+         * Queues the @p fileName to be updated with the given @p data.
+         * Errors while writing are logged and kept as lastErrorMessage().
          */
         bool updateFile( const QString &fileName, const QByteArray &data );
 
@@ -53,11 +64,29 @@ class FileStoragePolicy : public StoragePolicy
          */
         QString lastErrorMessage() const;
 
+        /**
+         * Sets whether written files are synced to the disk before they
+         * are reported as stored. Syncing survives power failures, but
+         * makes every batch of writes wait for the disk. It is off by
+         * default.
+         */
+        void setSyncWrites( bool sync );
+
+        bool syncWrites() const;
+
+        /**
+         * Blocks until all queued files have been written.
+         */
+        void waitForWrites();
+
+    private Q_SLOTS:
+        void reportWrittenBytes( qint64 bytes );
+
     private:
 	Q_DISABLE_COPY( FileStoragePolicy )
 	
         QString m_dataDirectory;
-        QString m_errorMsg;
+        FileStorageWriter *const m_writer;
 };
 
 }
@@ -96,6 +96,13 @@ public Q_SLOTS:
 
     int addDocument( GeoDataDocument *document );
 
+    /**
+      * Appends several documents at once. Views and proxies are notified about
+      * a single inserted range instead of each document on its own.
+      * @return the row of the first document, -1 if @p documents is empty
+      */
+    int addDocuments( const QList<GeoDataDocument *> &documents );
+
     void removeDocument( int index );
 
     void removeDocument( GeoDataDocument* document );
@@ -144,6 +144,20 @@ void HttpDownloadManager::addJob( const QUrl& sourceUrl, const QString& destFile
     }
 }
 
+void HttpDownloadManager::setVisibleTiles( const QStringList &sourceDirs, const QList<TileId> &visibleTiles )
+{
+    QList<QPair<DownloadPolicyKey, DownloadQueueSet *> >::iterator pos = d->m_queueSets.begin();
+    QList<QPair<DownloadPolicyKey, DownloadQueueSet *> >::iterator const end = d->m_queueSets.end();
+    for (; pos != end; ++pos ) {
+        // bulk downloads of a region are not related to the view
+        if ( pos->first.usage() == DownloadBulk ) {
+            continue;
+        }
+        pos->second->setVisibleTiles( sourceDirs, visibleTiles );
+    }
+    d->m_defaultQueueSets[ DownloadBrowse ]->setVisibleTiles( sourceDirs, visibleTiles );
+}
+
 void HttpDownloadManager::finishJob( const QByteArray& data, const QString& destinationFileName,
                                      const QString& id )
 {
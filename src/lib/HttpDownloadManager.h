@@ -17,11 +17,13 @@
 #ifndef MARBLE_HTTPDOWNLOADMANAGER_H
 #define MARBLE_HTTPDOWNLOADMANAGER_H
 
+#include <QList>
 #include <QObject>
 
 #include "MarbleGlobal.h"
 #include "marble_export.h"
 
+class QStringList;
 class QUrl;
 
 namespace Marble
@@ -30,6 +32,7 @@ namespace Marble
 class DownloadPolicy;
 class DownloadQueueSet;
 class StoragePolicy;
+class TileId;
 
 /**
  * @Short This class manages scheduled downloads. 
@@ -74,6 +77,15 @@ class MARBLE_EXPORT HttpDownloadManager : public QObject
     void addJob( const QUrl& sourceUrl, const QString& destFilename, const QString &id,
                  const DownloadUsage usage );
 
+    /**
+     * Ranks the queued tile downloads for the view showing @p visibleTiles
+     * of the texture layers with the source directories @p sourceDirs, and
+     * drops queued downloads of their tiles which have left the view.
+     *
+     * @see DownloadQueueSet::setVisibleTiles()
+     */
+    void setVisibleTiles( const QStringList &sourceDirs, const QList<TileId> &visibleTiles );
+
 
  Q_SIGNALS:
     void downloadComplete( QString, QString );
@@ -23,8 +23,12 @@
 #include "MarbleModel.h"
 #include "PluginManager.h"
 #include "RenderPlugin.h"
+#include "RenderProfiler.h"
 #include "LayerInterface.h"
 
+// Qt
+#include <QVector>
+
 namespace Marble
 {
 
@@ -48,6 +52,18 @@ class LayerManager::Private
 
     void addPlugins();
 
+    /** Marks the layers of the render positions to be collected again before the next frame */
+    void invalidateDispatchTables();
+
+    /** Collects and sorts the layers of each render position */
+    void updateDispatchTables();
+
+    /** Returns false if the zValue() of a layer changed such that the tables are out of order */
+    bool dispatchTablesSorted() const;
+
+    /** The name of @p layer in the render profile */
+    static QString profileName( const LayerInterface *layer );
+
     LayerManager *const q;
 
     QList<RenderPlugin *> m_renderPlugins;
@@ -59,6 +75,13 @@ class LayerManager::Private
     bool m_showBackground;
 
     bool m_showRuntimeTrace;
+
+    /** All render positions in the order they are rendered */
+    const QStringList m_renderPositions;
+
+    /** The visible layers of each render position sorted by their zValue()s */
+    QVector<QVector<LayerInterface *> > m_dispatchTables;
+    bool m_dispatchTablesValid;
 };
 
 LayerManager::Private::Private( const MarbleModel* model, LayerManager *parent )
@@ -66,7 +89,11 @@ LayerManager::Private::Private( const MarbleModel* model, LayerManager *parent )
       m_renderPlugins(),
       m_model( model ),
       m_showBackground( true ),
-      m_showRuntimeTrace( false )
+      m_showRuntimeTrace( false ),
+      m_renderPositions( QStringList() << "STARS" << "BEHIND_TARGET" << "SURFACE" << "HOVERS_ABOVE_SURFACE"
+                                       << "ATMOSPHERE" << "ORBIT" << "ALWAYS_ON_TOP" << "FLOAT_ITEM" << "USER_TOOLS" ),
+      m_dispatchTables( m_renderPositions.size() ),
+      m_dispatchTablesValid( false )
 {
 }
 
@@ -75,11 +102,89 @@ LayerManager::Private::~Private()
     qDeleteAll( m_renderPlugins );
 }
 
+QString LayerManager::Private::profileName( const LayerInterface *layer )
+{
+    if ( const RenderPlugin *renderPlugin = dynamic_cast<const RenderPlugin *>( layer ) ) {
+        return renderPlugin->nameId();
+    }
+
+    if ( const QObject *object = dynamic_cast<const QObject *>( layer ) ) {
+        return object->metaObject()->className();
+    }
+
+    return "Layer";
+}
+
 void LayerManager::Private::updateVisibility( bool visible, const QString &nameId )
 {
+    m_dispatchTablesValid = false;
     emit q->visibilityChanged( nameId, visible );
 }
 
+void LayerManager::Private::invalidateDispatchTables()
+{
+    m_dispatchTablesValid = false;
+}
+
+void LayerManager::Private::updateDispatchTables()
+{
+    for ( int i = 0; i < m_renderPositions.size(); ++i ) {
+        m_dispatchTables[i].clear();
+    }
+
+    // collect all enabled and visible RenderPlugins ...
+    foreach( RenderPlugin *renderPlugin, m_renderPlugins ) {
+        if ( !renderPlugin || !renderPlugin->enabled() || !renderPlugin->visible() ) {
+            continue;
+        }
+
+        const QStringList renderPositions = renderPlugin->renderPosition();
+        for ( int i = 0; i < m_renderPositions.size(); ++i ) {
+            if ( renderPositions.contains( m_renderPositions.at( i ) ) ) {
+                if ( !renderPlugin->isInitialized() ) {
+                    renderPlugin->initialize();
+                    emit q->renderPluginInitialized( renderPlugin );
+                }
+                m_dispatchTables[i].append( renderPlugin );
+            }
+        }
+    }
+
+    // ... and all internal LayerInterfaces
+    foreach( LayerInterface *layer, m_internalLayers ) {
+        if ( !layer ) {
+            continue;
+        }
+
+        const QStringList renderPositions = layer->renderPosition();
+        for ( int i = 0; i < m_renderPositions.size(); ++i ) {
+            if ( renderPositions.contains( m_renderPositions.at( i ) ) ) {
+                m_dispatchTables[i].append( layer );
+            }
+        }
+    }
+
+    // sort them according to their zValue()s
+    for ( int i = 0; i < m_renderPositions.size(); ++i ) {
+        qStableSort( m_dispatchTables[i].begin(), m_dispatchTables[i].end(), zValueLessThan );
+    }
+
+    m_dispatchTablesValid = true;
+}
+
+bool LayerManager::Private::dispatchTablesSorted() const
+{
+    foreach( const QVector<LayerInterface *> &layers, m_dispatchTables ) {
+        for ( int i = 1; i < layers.size(); ++i ) {
+            if ( zValueLessThan( layers.at( i ), layers.at( i - 1 ) ) ) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 
 LayerManager::LayerManager( const MarbleModel* model, QObject *parent )
     : QObject( parent ),
@@ -127,49 +232,27 @@ QList<AbstractDataPluginItem *> LayerManager::whichItemAt( const QPoint& curpos
 void LayerManager::renderLayers( GeoPainter *painter, ViewportParams *viewport )
 {
     const QTime totalTime = QTime::currentTime();
+    RenderProfiler::Scope frameScope( "LayerManager::renderLayers" );
 
-    QStringList renderPositions;
-
-    if ( d->m_showBackground ) {
-        renderPositions << "STARS" << "BEHIND_TARGET";
+    if ( !d->m_dispatchTablesValid || !d->dispatchTablesSorted() ) {
+        d->updateDispatchTables();
     }
 
-    renderPositions << "SURFACE" << "HOVERS_ABOVE_SURFACE" << "ATMOSPHERE"
-                    << "ORBIT" << "ALWAYS_ON_TOP" << "FLOAT_ITEM" << "USER_TOOLS";
-
     QStringList traceList;
-    foreach( const QString& renderPosition, renderPositions ) {
-        QList<LayerInterface*> layers;
-
-        // collect all RenderPlugins of current renderPosition
-        foreach( RenderPlugin *renderPlugin, d->m_renderPlugins ) {
-            if ( renderPlugin && renderPlugin->renderPosition().contains( renderPosition ) ) {
-                if ( renderPlugin->enabled() && renderPlugin->visible() ) {
-                    if ( !renderPlugin->isInitialized() ) {
-                        renderPlugin->initialize();
-                        emit renderPluginInitialized( renderPlugin );
-                    }
-                    layers.push_back( renderPlugin );
-                }
-            }
-        }
 
-        // collect all internal LayerInterfaces of current renderPosition
-        foreach( LayerInterface *layer, d->m_internalLayers ) {
-            if ( layer && layer->renderPosition().contains( renderPosition ) ) {
-                layers.push_back( layer );
-            }
-        }
-
-        // sort them according to their zValue()s
-        qSort( layers.begin(), layers.end(), zValueLessThan );
+    // the first two render positions are the background
+    for ( int i = d->m_showBackground ? 0 : 2; i < d->m_renderPositions.size(); ++i ) {
+        const QString &renderPosition = d->m_renderPositions.at( i );
 
         // render the layers of the current renderPosition
         QTime timer;
-        foreach( LayerInterface *layer, layers ) {
+        foreach( LayerInterface *layer, d->m_dispatchTables.at( i ) ) {
             timer.start();
+            RenderProfiler::Scope layerScope( RenderProfiler::isEnabled() ? Private::profileName( layer ) : QString() );
             layer->render( painter, viewport, renderPosition, 0 );
-            traceList.append( QString("%2 ms %3").arg( timer.elapsed(),3 ).arg( layer->runtimeTrace() ) );
+            if ( d->m_showRuntimeTrace ) {
+                traceList.append( QString("%2 ms %3").arg( timer.elapsed(),3 ).arg( layer->runtimeTrace() ) );
+            }
         }
     }
 
@@ -221,6 +304,10 @@ void LayerManager::Private::addPlugins()
                  q, SIGNAL(repaintNeeded(QRegion)) );
         QObject::connect( renderPlugin, SIGNAL(visibilityChanged(bool,QString)),
                  q, SLOT(updateVisibility(bool,QString)) );
+        QObject::connect( renderPlugin, SIGNAL(enabledChanged(bool)),
+                 q, SLOT(invalidateDispatchTables()) );
+        QObject::connect( renderPlugin, SIGNAL(settingsChanged(QString)),
+                 q, SLOT(invalidateDispatchTables()) );
 
         // get float items ...
         AbstractFloatItem * const floatItem =
@@ -234,6 +321,8 @@ void LayerManager::Private::addPlugins()
         if( dataPlugin )
             m_dataPlugins.append( dataPlugin );
     }
+
+    m_dispatchTablesValid = false;
 }
 
 void LayerManager::setShowBackground( bool show )
@@ -263,11 +352,18 @@ void LayerManager::setVisible( const QString &nameId, bool visible )
 void LayerManager::addLayer(LayerInterface *layer)
 {
     d->m_internalLayers.push_back(layer);
+    d->m_dispatchTablesValid = false;
 }
 
 void LayerManager::removeLayer(LayerInterface *layer)
 {
     d->m_internalLayers.removeAll(layer);
+    d->m_dispatchTablesValid = false;
+}
+
+void LayerManager::invalidateLayers()
+{
+    d->m_dispatchTablesValid = false;
 }
 
 QList<LayerInterface *> LayerManager::internalLayers() const
@@ -83,6 +83,16 @@ class LayerManager : public QObject
 
     QList<LayerInterface *> internalLayers() const;
 
+    /**
+     * @brief Collect the layers of each render position again before the next frame.
+     *
+     * The layers to render are collected once and only collected again when
+     * layers are added or removed, plugins are toggled or change their settings,
+     * or a changed zValue() puts them out of order. Call this if the
+     * renderPosition() of a layer changes otherwise.
+     */
+    void invalidateLayers();
+
  Q_SIGNALS:
     /**
      * @brief Signal that a render item has been initialized
@@ -115,6 +125,8 @@ class LayerManager : public QObject
 
     Q_PRIVATE_SLOT( d, void addPlugins() )
 
+    Q_PRIVATE_SLOT( d, void invalidateDispatchTables() )
+
  private:
     Q_DISABLE_COPY( LayerManager )
 
@@ -14,10 +14,14 @@
 #include "MapThemeManager.h"
 
 // Qt
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
+#include <QHash>
+#include <QImage>
 #include <QScopedPointer>
 #include <QString>
 #include <QStringList>
@@ -36,12 +40,47 @@
 namespace
 {
     static const QString mapDirName = "maps";
-    static const int columnRelativePath = 1;
+    static const QString themeIndexFileName = "mapthemes.idx";
+    static const quint32 themeIndexMagicNumber = 0x4d544958;
+    static const qint32 themeIndexVersion = 1;
 }
 
 namespace Marble
 {
 
+/**
+ * @brief The parts of a map theme that are needed to fill the theme list.
+ *
+ * Entries are kept in a persistent index, so that the .dgml files only
+ * need to be parsed again after they have been modified.
+ */
+struct MapThemeIndexEntry
+{
+    MapThemeIndexEntry() : visible( false ) {}
+
+    QString dgmlPath;
+    QDateTime lastModified;
+    bool visible;
+    QString target;
+    QString name;
+    QString description;
+    QImage icon;
+};
+
+QDataStream &operator<<( QDataStream &stream, const MapThemeIndexEntry &entry )
+{
+    stream << entry.dgmlPath << entry.lastModified << entry.visible
+           << entry.target << entry.name << entry.description << entry.icon;
+    return stream;
+}
+
+QDataStream &operator>>( QDataStream &stream, MapThemeIndexEntry &entry )
+{
+    stream >> entry.dgmlPath >> entry.lastModified >> entry.visible
+           >> entry.target >> entry.name >> entry.description >> entry.icon;
+    return stream;
+}
+
 class MapThemeManager::Private
 {
 public:
@@ -82,7 +121,25 @@ public:
     /**
      * @brief Helper method for updateMapThemeModel().
      */
-    static QList<QStandardItem *> createMapThemeRow( const QString& mapThemeID );
+    QList<QStandardItem *> createMapThemeRow( const QString& mapThemeID );
+
+    /**
+     * @brief Returns the index entry of the given map theme.
+     *
+     * The .dgml file only gets parsed if it is not in the index yet or if it
+     * has been modified since it was indexed. Returns 0 if the map theme
+     * cannot be loaded.
+     */
+    const MapThemeIndexEntry *indexEntry( const QString& mapThemeID );
+
+    /**
+     * @brief Returns the row of the map theme in m_mapThemeModel, or -1.
+     */
+    int mapThemeRow( const QString& mapThemeID ) const;
+
+    static QString themeIndexPath();
+    void loadThemeIndex();
+    void saveThemeIndex();
 
     /**
      * @brief Deletes any directory with its contents.
@@ -96,6 +153,10 @@ public:
     QStandardItemModel m_celestialList;
     QFileSystemWatcher m_fileSystemWatcher;
     bool m_isInitialized;
+    QHash<QString, MapThemeIndexEntry> m_themeIndex;
+    bool m_themeIndexLoaded;
+    bool m_themeIndexDirty;
+    QPixmap m_fallbackIcon;
 
 private:
     /**
@@ -110,7 +171,9 @@ MapThemeManager::Private::Private( MapThemeManager *parent )
       m_mapThemeModel( 0, 3 ),
       m_celestialList(),
       m_fileSystemWatcher(),
-      m_isInitialized( false )
+      m_isInitialized( false ),
+      m_themeIndexLoaded( false ),
+      m_themeIndexDirty( false )
 {
 }
 
@@ -335,44 +398,155 @@ QStandardItemModel *MapThemeManager::celestialBodiesModel()
     return &d->m_celestialList;
 }
 
-QList<QStandardItem *> MapThemeManager::Private::createMapThemeRow( QString const& mapThemeID )
+QString MapThemeManager::Private::themeIndexPath()
 {
-    QList<QStandardItem *> itemList;
+    // Deliberately not inside the watched maps directory, otherwise
+    // saving the index would trigger another update.
+    return MarbleDirs::localPath() + '/' + themeIndexFileName;
+}
 
-    QScopedPointer<GeoSceneDocument> mapTheme( loadMapThemeFile( mapThemeID ) );
-    if ( !mapTheme || !mapTheme->head()->visible() ) {
-        return itemList;
+void MapThemeManager::Private::loadThemeIndex()
+{
+    m_themeIndexLoaded = true;
+
+    QFile file( themeIndexPath() );
+    if ( !file.exists() ) {
+        return;
     }
 
-    QPixmap themeIconPixmap;
-    QString relativePath;
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        mDebug() << "Unable to open map theme index" << file.fileName();
+        return;
+    }
 
-    relativePath = mapDirName + '/'
-        + mapTheme->head()->target() + '/' + mapTheme->head()->theme() + '/'
-        + mapTheme->head()->icon()->pixmap();
-    themeIconPixmap.load( MarbleDirs::path( relativePath ) );
+    QDataStream in( &file );
+    quint32 magicNumber;
+    qint32 version;
+    in >> magicNumber >> version;
+    if ( magicNumber != themeIndexMagicNumber || version != themeIndexVersion ) {
+        mDebug() << "Ignoring outdated map theme index" << file.fileName();
+        return;
+    }
 
-    if ( themeIconPixmap.isNull() ) {
-        relativePath = "svg/application-x-marble-gray.png"; 
-        themeIconPixmap.load( MarbleDirs::path( relativePath ) );
+    in.setVersion( QDataStream::Qt_4_6 );
+    QHash<QString, MapThemeIndexEntry> index;
+    in >> index;
+    if ( in.status() != QDataStream::Ok ) {
+        mDebug() << "Ignoring corrupt map theme index" << file.fileName();
+        return;
     }
-    else {
+
+    m_themeIndex = index;
+}
+
+void MapThemeManager::Private::saveThemeIndex()
+{
+    if ( !m_themeIndexDirty ) {
+        return;
+    }
+
+    QFile file( themeIndexPath() );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << "Unable to write map theme index" << file.fileName();
+        return;
+    }
+
+    QDataStream out( &file );
+    out << themeIndexMagicNumber << themeIndexVersion;
+    out.setVersion( QDataStream::Qt_4_6 );
+    out << m_themeIndex;
+
+    m_themeIndexDirty = false;
+}
+
+const MapThemeIndexEntry *MapThemeManager::Private::indexEntry( const QString& mapThemeID )
+{
+    if ( !m_themeIndexLoaded ) {
+        loadThemeIndex();
+    }
+
+    const QString dgmlPath = MarbleDirs::path( mapDirName + '/' + mapThemeID );
+    const QDateTime lastModified = QFileInfo( dgmlPath ).lastModified();
+
+    QHash<QString, MapThemeIndexEntry>::const_iterator it = m_themeIndex.constFind( mapThemeID );
+    if ( it != m_themeIndex.constEnd()
+         && it->dgmlPath == dgmlPath
+         && it->lastModified == lastModified ) {
+        return &it.value();
+    }
+
+    m_themeIndex.remove( mapThemeID );
+    m_themeIndexDirty = true;
+
+    QScopedPointer<GeoSceneDocument> mapTheme( loadMapThemeFile( mapThemeID ) );
+    if ( !mapTheme ) {
+        return 0;
+    }
+
+    MapThemeIndexEntry entry;
+    entry.dgmlPath = dgmlPath;
+    entry.lastModified = lastModified;
+    entry.visible = mapTheme->head()->visible();
+    entry.target = mapTheme->head()->target();
+    entry.name = mapTheme->head()->name();
+    entry.description = mapTheme->head()->description();
+
+    if ( entry.visible ) {
+        const QString relativePath = mapDirName + '/'
+            + mapTheme->head()->target() + '/' + mapTheme->head()->theme() + '/'
+            + mapTheme->head()->icon()->pixmap();
+        entry.icon.load( MarbleDirs::path( relativePath ) );
+
         // Make sure we don't keep excessively large previews in memory
         // TODO: Scale the icon down to the default icon size in MarbleSelectView.
         //       For now maxIconSize already equals what's expected by the listview.
         QSize maxIconSize( 136, 136 );
-        if ( themeIconPixmap.size() != maxIconSize ) {
+        if ( !entry.icon.isNull() && entry.icon.size() != maxIconSize ) {
             mDebug() << "Smooth scaling theme icon";
-            themeIconPixmap = themeIconPixmap.scaled( maxIconSize,
-                                                      Qt::KeepAspectRatio,
-                                                      Qt::SmoothTransformation );
+            entry.icon = entry.icon.scaled( maxIconSize,
+                                            Qt::KeepAspectRatio,
+                                            Qt::SmoothTransformation );
+        }
+    }
+
+    return &m_themeIndex.insert( mapThemeID, entry ).value();
+}
+
+int MapThemeManager::Private::mapThemeRow( const QString& mapThemeID ) const
+{
+    for ( int row = 0; row < m_mapThemeModel.rowCount(); ++row ) {
+        if ( m_mapThemeModel.item( row )->data( Qt::UserRole + 1 ).toString() == mapThemeID ) {
+            return row;
         }
     }
 
+    return -1;
+}
+
+QList<QStandardItem *> MapThemeManager::Private::createMapThemeRow( QString const& mapThemeID )
+{
+    QList<QStandardItem *> itemList;
+
+    const MapThemeIndexEntry *entry = indexEntry( mapThemeID );
+    if ( !entry || !entry->visible ) {
+        return itemList;
+    }
+
+    QPixmap themeIconPixmap;
+    if ( entry->icon.isNull() ) {
+        if ( m_fallbackIcon.isNull() ) {
+            m_fallbackIcon.load( MarbleDirs::path( "svg/application-x-marble-gray.png" ) );
+        }
+        themeIconPixmap = m_fallbackIcon;
+    }
+    else {
+        themeIconPixmap = QPixmap::fromImage( entry->icon );
+    }
+
     QIcon mapThemeIcon =  QIcon( themeIconPixmap );
 
-    QString name = mapTheme->head()->name();
-    QString description = mapTheme->head()->description();
+    QString name = entry->name;
+    QString description = entry->description;
 
     QStandardItem *item = new QStandardItem( name );
     item->setData( QObject::tr( name.toUtf8() ), Qt::DisplayRole );
@@ -406,6 +580,16 @@ void MapThemeManager::Private::updateMapThemeModel()
         }
     }
 
+    // Forget about themes which have been removed in the meantime
+    foreach ( const QString &mapThemeId, m_themeIndex.keys() ) {
+        if ( !stringlist.contains( mapThemeId ) ) {
+            m_themeIndex.remove( mapThemeId );
+            m_themeIndexDirty = true;
+        }
+    }
+
+    saveThemeIndex();
+
     foreach ( const QString &mapThemeId, stringlist ) {
         QString celestialBodyId = mapThemeId.section( '/', 0, 0 );
         QString celestialBodyName = Planet::name( celestialBodyId );
@@ -438,6 +622,8 @@ void MapThemeManager::Private::directoryChanged( const QString& path )
     mDebug() << "directoryChanged:" << path;
     watchPaths();
 
+    // Unchanged themes are taken from the index, so only new or
+    // modified .dgml files get parsed here
     mDebug() << "Emitting themesChanged()";
     updateMapThemeModel();
     emit q->themesChanged();
@@ -454,19 +640,13 @@ void MapThemeManager::Private::fileChanged( const QString& path )
 
     QString mapThemeId = path.section( '/', -3 );
     mDebug() << "mapThemeId:" << mapThemeId;
-    QList<QStandardItem *> matchingItems = m_mapThemeModel.findItems( mapThemeId,
-                                                                          Qt::MatchFixedString
-                                                                          | Qt::MatchCaseSensitive,
-                                                                          columnRelativePath );
-    mDebug() << "matchingItems:" << matchingItems.size();
-    Q_ASSERT( matchingItems.size() <= 1 );
     int insertAtRow = 0;
 
-    if ( matchingItems.size() == 1 ) {
-        const int row = matchingItems.front()->row();
-	insertAtRow = row;
+    const int row = mapThemeRow( mapThemeId );
+    if ( row >= 0 ) {
+        insertAtRow = row;
         QList<QStandardItem *> toBeDeleted = m_mapThemeModel.takeRow( row );
-	while ( !toBeDeleted.isEmpty() ) {
+        while ( !toBeDeleted.isEmpty() ) {
             delete toBeDeleted.takeFirst();
         }
     }
@@ -478,7 +658,12 @@ void MapThemeManager::Private::fileChanged( const QString& path )
             m_mapThemeModel.insertRow( insertAtRow, newMapThemeRow );
         }
     }
-    
+    else if ( m_themeIndex.remove( mapThemeId ) > 0 ) {
+        m_themeIndexDirty = true;
+    }
+
+    saveThemeIndex();
+
     emit q->themesChanged();
 }
 
@@ -33,6 +33,11 @@ class GeoSceneDocument;
  * This class which is able to check for maps that are locally available.
  * After parsing the data it only stores the name, description and path
  * into a QStandardItemModel.
+ *
+ * The properties shown in the model are kept in a persistent index in the
+ * local Marble directory, so a .dgml file is only parsed again when it has
+ * been modified. The full GeoSceneDocument is loaded by loadMapTheme() once
+ * a theme gets activated.
  * 
  * The MapThemeManager is not owned by the MarbleWidget/Map itself. 
  * Instead it is owned by the widget or application that contains 
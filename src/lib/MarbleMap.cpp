@@ -231,10 +231,14 @@ void MarbleMapPrivate::updateProperty( const QString &name, bool show )
 
     else if ( name == "waterbodies" ) {
         m_veccomposer.setShowWaterBodies( show );
+        // the water bodies are part of the colorized tiles
+        m_textureLayer.reset();
     } else if ( name == "lakes" ) {
         m_veccomposer.setShowLakes( show );
+        m_textureLayer.reset();
     } else if ( name == "ice" ) {
         m_veccomposer.setShowIce( show );
+        m_textureLayer.reset();
     } else if ( name == "coastlines" ) {
         m_veccomposer.setShowCoastLines( show );
     } else if ( name == "rivers" ) {
@@ -59,6 +59,7 @@
 #include "FileManager.h"
 #include "GeoDataTreeModel.h"
 #include "Planet.h"
+#include "PlacemarkSearchIndex.h"
 #include "PluginManager.h"
 #include "StoragePolicy.h"
 #include "SunLocator.h"
@@ -90,6 +91,7 @@ class MarbleModelPrivate
           m_treeModel(),
           m_descendantProxy(),
           m_placemarkProxyModel(),
+          m_placemarkSearchIndex( &m_treeModel ),
           m_placemarkSelectionModel( 0 ),
           m_positionTracking( &m_treeModel ),
           m_trackedPlacemark( 0 ),
@@ -140,6 +142,7 @@ class MarbleModelPrivate
     KDescendantsProxyModel   m_descendantProxy;
     QSortFilterProxyModel    m_placemarkProxyModel;
     QSortFilterProxyModel    m_groundOverlayProxyModel;
+    PlacemarkSearchIndex     m_placemarkSearchIndex;
 
     // Selection handling
     QItemSelectionModel      m_placemarkSelectionModel;
@@ -424,6 +427,11 @@ const QAbstractItemModel *MarbleModel::placemarkModel() const
     return &d->m_placemarkProxyModel;
 }
 
+const PlacemarkSearchIndex *MarbleModel::placemarkSearchIndex() const
+{
+    return &d->m_placemarkSearchIndex;
+}
+
 QAbstractItemModel *MarbleModel::groundOverlayModel()
 {
     return &d->m_groundOverlayProxyModel;
@@ -49,6 +49,7 @@ class AbstractDataPluginItem;
 class GeoDataPlacemark;
 class GeoPainter;
 class MeasureTool;
+class PlacemarkSearchIndex;
 class PositionTracking;
 class HttpDownloadManager;
 class MarbleModelPrivate;
@@ -123,6 +124,11 @@ class MARBLE_EXPORT MarbleModel : public QObject
     QAbstractItemModel *placemarkModel();
     const QAbstractItemModel *placemarkModel() const;
 
+    /**
+     * @brief Return an index for searching placemarks of the placemarkModel() by name
+     */
+    const PlacemarkSearchIndex *placemarkSearchIndex() const;
+
     QItemSelectionModel *placemarkSelectionModel();
 
     /**
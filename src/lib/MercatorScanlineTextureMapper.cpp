@@ -25,7 +25,6 @@
 #include "MarbleDebug.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
-#include "TextureColorizer.h"
 #include "ViewportParams.h"
 #include "MathHelper.h"
 
@@ -70,8 +69,7 @@ MercatorScanlineTextureMapper::MercatorScanlineTextureMapper( StackedTileLoader
 void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
                                                 const ViewportParams *viewport,
                                                 int tileZoomLevel,
-                                                const QRect &dirtyRect,
-                                                TextureColorizer *texColorizer )
+                                                const QRect &dirtyRect )
 {
     if ( m_canvasImage.size() != viewport->size() || m_radius != viewport->radius() ) {
         const QImage::Format optimalFormat = ScanlineTextureMapperContext::optimalCanvasImageFormat( viewport );
@@ -91,10 +89,6 @@ void MercatorScanlineTextureMapper::mapTexture( GeoPainter *painter,
     if ( m_repaintNeeded ) {
         mapTexture( viewport, tileZoomLevel, painter->mapQuality() );
 
-        if ( texColorizer ) {
-            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
-        }
-
         m_repaintNeeded = false;
     }
 
@@ -35,6 +35,7 @@
 #include "StackedTile.h"
 #include "TileLoaderHelper.h"
 #include "Planet.h"
+#include "TextureColorizer.h"
 #include "TextureTile.h"
 #include "TileCreator.h"
 #include "TileCreatorDialog.h"
@@ -69,6 +70,7 @@ public:
     BlendingFactory m_blendingFactory;
     QVector<const GeoSceneTextureTile *> m_textureLayers;
     QList<const GeoDataGroundOverlay *> m_groundOverlays;
+    TextureColorizer *m_textureColorizer;
     int m_maxTileLevel;
     QString m_themeId;
     int m_levelZeroColumns;
@@ -83,6 +85,7 @@ MergedLayerDecorator::Private::Private( TileLoader *tileLoader, const SunLocator
     m_sunLocator( sunLocator ),
     m_blendingFactory( sunLocator ),
     m_textureLayers(),
+    m_textureColorizer( 0 ),
     m_maxTileLevel( 0 ),
     m_themeId(),
     m_levelZeroColumns( 0 ),
@@ -126,6 +129,11 @@ void MergedLayerDecorator::updateGroundOverlays(const QList<const GeoDataGroundO
     d->m_groundOverlays = groundOverlays;
 }
 
+void MergedLayerDecorator::setTextureColorizer( TextureColorizer *colorizer )
+{
+    d->m_textureColorizer = colorizer;
+}
+
 
 int MergedLayerDecorator::textureLayersSize() const
 {
@@ -208,6 +216,10 @@ StackedTile *MergedLayerDecorator::Private::createTile( const QVector<QSharedPoi
         }
     }
 
+    if ( m_textureColorizer ) {
+        m_textureColorizer->colorize( &resultImage, id, m_textureLayers.first() );
+    }
+
     renderGroundOverlays( &resultImage, tiles );
 
     if ( m_showSunShading && !m_showCityLights ) {
@@ -353,6 +365,11 @@ void MergedLayerDecorator::downloadStackedTile( const TileId &id, DownloadUsage
     }
 }
 
+void MergedLayerDecorator::setVisibleTiles( const QList<TileId> &visibleTiles )
+{
+    d->m_tileLoader->setVisibleTiles( d->m_textureLayers, visibleTiles );
+}
+
 void MergedLayerDecorator::setShowSunShading( bool show )
 {
     d->m_showSunShading = show;
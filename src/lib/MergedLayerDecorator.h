@@ -33,6 +33,7 @@ namespace Marble
 
 class SunLocator;
 class StackedTile;
+class TextureColorizer;
 class Tile;
 class TileId;
 class TileLoader;
@@ -46,6 +47,12 @@ class MergedLayerDecorator
     void setTextureLayers( const QVector<const GeoSceneTextureTile *> &textureLayers );
     void updateGroundOverlays( const QList<const GeoDataGroundOverlay *> &groundOverlays );
 
+    /**
+     * Colorizes the merged tiles with @p colorizer, so that the stacked
+     * tiles carry the colorized relief. Pass 0 to disable colorization.
+     */
+    void setTextureColorizer( TextureColorizer *colorizer );
+
     int textureLayersSize() const;
 
     /**
@@ -68,6 +75,12 @@ class MergedLayerDecorator
 
     void downloadStackedTile( const TileId &id, DownloadUsage usage );
 
+    /**
+     * Called when the set of stacked tiles on display changed, so that
+     * downloads can be prioritized for @p visibleTiles.
+     */
+    void setVisibleTiles( const QList<TileId> &visibleTiles );
+
     void setShowSunShading( bool show );
     bool showSunShading() const;
 
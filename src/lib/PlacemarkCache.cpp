@@ -0,0 +1,397 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "PlacemarkCache.h"
+
+#include <QBitArray>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+
+#include <cstring>
+
+#include "GeoDataData.h"
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataFolder.h"
+#include "GeoDataPlacemark.h"
+#include "MarbleDebug.h"
+
+namespace Marble
+{
+
+const quint32 PlacemarkCache::magicNumber = 0x31415926;
+
+// Version 015 was a QDataStream of the placemarks one after another.
+const qint32 PlacemarkCache::version = 016;
+
+/*
+ * Layout after the big endian magic number and version, little endian,
+ * with n placemarks and s strings:
+ *
+ *   quint32 n, quint32 s, quint64 number of UTF-16 units in the string data
+ *   double  coordinates[3 * n]      (lon, lat, alt in radians)
+ *   double  area[n]
+ *   qint64  population[n]
+ *   quint32 name[n], role[n], description[n], countryCode[n], state[n], styleUrl[n]
+ *   qint16  gmt[n]
+ *   qint8   dst[n]
+ *   padding to a multiple of four bytes
+ *   quint32 stringOffsets[s + 1]    (in UTF-16 units)
+ *   quint16 stringData[]
+ */
+namespace
+{
+
+const int headerSize = 24;
+
+enum StringColumn {
+    NameColumn,
+    RoleColumn,
+    DescriptionColumn,
+    CountryCodeColumn,
+    StateColumn,
+    StyleUrlColumn,
+    StringColumnCount
+};
+
+int padding( qint64 size )
+{
+    return ( 4 - size % 4 ) % 4;
+}
+
+class CacheWriter
+{
+ public:
+    explicit CacheWriter( const QDateTime &dateTime ) :
+        m_dateTime( dateTime ),
+        m_stringDataSize( 0 )
+    {
+        m_stringColumns.resize( StringColumnCount );
+    }
+
+    void addPlacemarks( const GeoDataContainer *container );
+
+    void write( QDataStream &out ) const;
+
+ private:
+    quint32 stringIndex( const QString &string );
+
+    const QDateTime m_dateTime;
+    QVector<double> m_coordinates;
+    QVector<double> m_area;
+    QVector<qint64> m_population;
+    QVector<QVector<quint32> > m_stringColumns;
+    QVector<qint16> m_gmt;
+    QVector<qint8> m_dst;
+
+    QHash<QString, quint32> m_stringIndexes;
+    QVector<QString> m_strings;
+    quint64 m_stringDataSize;
+};
+
+quint32 CacheWriter::stringIndex( const QString &string )
+{
+    QHash<QString, quint32>::const_iterator it = m_stringIndexes.constFind( string );
+    if ( it != m_stringIndexes.constEnd() ) {
+        return it.value();
+    }
+
+    const quint32 index = m_strings.size();
+    m_stringIndexes.insert( string, index );
+    m_strings.append( string );
+    m_stringDataSize += string.size();
+
+    return index;
+}
+
+void CacheWriter::addPlacemarks( const GeoDataContainer *container )
+{
+    qreal lon;
+    qreal lat;
+    qreal alt;
+
+    const QVector<GeoDataPlacemark*> placemarks = container->placemarkList();
+    QVector<GeoDataPlacemark*>::const_iterator it = placemarks.constBegin();
+    QVector<GeoDataPlacemark*>::const_iterator const end = placemarks.constEnd();
+    for (; it != end; ++it ) {
+        const GeoDataPlacemark *placemark = *it;
+        placemark->coordinate( m_dateTime ).geoCoordinates( lon, lat, alt );
+
+        m_coordinates << lon << lat << alt;
+        m_area << placemark->area();
+        m_population << placemark->population();
+        m_stringColumns[NameColumn] << stringIndex( placemark->name() );
+        m_stringColumns[RoleColumn] << stringIndex( placemark->role() );
+        m_stringColumns[DescriptionColumn] << stringIndex( placemark->description() );
+        m_stringColumns[CountryCodeColumn] << stringIndex( placemark->countryCode() );
+        m_stringColumns[StateColumn] << stringIndex( placemark->state() );
+        m_stringColumns[StyleUrlColumn] << stringIndex( placemark->styleUrl() );
+        m_gmt << placemark->extendedData().value( "gmt" ).value().toInt();
+        m_dst << placemark->extendedData().value( "dst" ).value().toInt();
+    }
+
+    const QVector<GeoDataFolder*> folders = container->folderList();
+    QVector<GeoDataFolder*>::const_iterator cont = folders.constBegin();
+    QVector<GeoDataFolder*>::const_iterator endcont = folders.constEnd();
+    for (; cont != endcont; ++cont ) {
+        addPlacemarks( *cont );
+    }
+}
+
+void CacheWriter::write( QDataStream &out ) const
+{
+    out.setByteOrder( QDataStream::LittleEndian );
+    out.setFloatingPointPrecision( QDataStream::DoublePrecision );
+
+    out << quint32( m_area.size() ) << quint32( m_strings.size() ) << m_stringDataSize;
+
+    foreach ( double value, m_coordinates ) {
+        out << value;
+    }
+    foreach ( double value, m_area ) {
+        out << value;
+    }
+    foreach ( qint64 value, m_population ) {
+        out << value;
+    }
+    foreach ( const QVector<quint32> &column, m_stringColumns ) {
+        foreach ( quint32 value, column ) {
+            out << value;
+        }
+    }
+    foreach ( qint16 value, m_gmt ) {
+        out << value;
+    }
+    foreach ( qint8 value, m_dst ) {
+        out << value;
+    }
+    for ( int i = 0; i < padding( m_dst.size() * 3 ); ++i ) {
+        out << qint8( 0 );
+    }
+
+    quint32 offset = 0;
+    out << offset;
+    foreach ( const QString &string, m_strings ) {
+        offset += string.size();
+        out << offset;
+    }
+    foreach ( const QString &string, m_strings ) {
+        const ushort *data = string.utf16();
+        for ( int i = 0; i < string.size(); ++i ) {
+            out << quint16( data[i] );
+        }
+    }
+}
+
+/**
+ * Resolves the columns of a memory mapped cache. Strings are decoded when
+ * they are first needed, and each string of the table is decoded once, so
+ * that the placemarks share it.
+ */
+class CacheReader
+{
+ public:
+    CacheReader( const uchar *data, qint64 size );
+
+    bool isValid() const
+    {
+        return m_valid;
+    }
+
+    quint32 placemarkCount() const
+    {
+        return m_count;
+    }
+
+    GeoDataPlacemark *placemark( quint32 index );
+
+ private:
+    static double readDouble( const uchar *data )
+    {
+        const quint64 bits = qFromLittleEndian<quint64>( data );
+        double result;
+        std::memcpy( &result, &bits, sizeof( result ) );
+        return result;
+    }
+
+    quint32 stringIndex( StringColumn column, quint32 index ) const
+    {
+        return qFromLittleEndian<quint32>( m_stringColumns + ( column * m_count + index ) * 4 );
+    }
+
+    const QString &string( quint32 index );
+
+    const uchar *const m_data;
+    quint32 m_count;
+    quint32 m_stringCount;
+    const uchar *m_coordinates;
+    const uchar *m_area;
+    const uchar *m_population;
+    const uchar *m_stringColumns;
+    const uchar *m_gmt;
+    const uchar *m_dst;
+    const uchar *m_stringOffsets;
+    const uchar *m_stringData;
+    bool m_valid;
+
+    QVector<QString> m_strings;
+    QBitArray m_decoded;
+};
+
+CacheReader::CacheReader( const uchar *data, qint64 size ) :
+    m_data( data ),
+    m_count( 0 ),
+    m_stringCount( 0 ),
+    m_valid( false )
+{
+    if ( size < headerSize ) {
+        return;
+    }
+
+    m_count = qFromLittleEndian<quint32>( m_data + 8 );
+    m_stringCount = qFromLittleEndian<quint32>( m_data + 12 );
+    const quint64 stringDataSize = qFromLittleEndian<quint64>( m_data + 16 );
+
+    const qint64 n = m_count;
+    m_coordinates = m_data + headerSize;
+    m_area = m_coordinates + 3 * 8 * n;
+    m_population = m_area + 8 * n;
+    m_stringColumns = m_population + 8 * n;
+    m_gmt = m_stringColumns + StringColumnCount * 4 * n;
+    m_dst = m_gmt + 2 * n;
+    m_stringOffsets = m_dst + n + padding( 3 * n );
+    m_stringData = m_stringOffsets + 4 * ( qint64( m_stringCount ) + 1 );
+
+    const qint64 expectedSize = m_stringData - m_data + 2 * qint64( stringDataSize );
+    if ( expectedSize != size ) {
+        mDebug() << "Bad cache file: expected" << expectedSize << "bytes, got" << size;
+        return;
+    }
+
+    m_strings.resize( m_stringCount );
+    m_decoded.resize( m_stringCount );
+    m_valid = true;
+}
+
+const QString &CacheReader::string( quint32 index )
+{
+    if ( index >= m_stringCount ) {
+        static const QString empty;
+        return empty;
+    }
+
+    if ( !m_decoded.testBit( index ) ) {
+        const quint32 begin = qFromLittleEndian<quint32>( m_stringOffsets + 4 * index );
+        const quint32 end = qFromLittleEndian<quint32>( m_stringOffsets + 4 * ( index + 1 ) );
+        const uchar *const data = m_stringData + 2 * begin;
+        const int length = end - begin;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        m_strings[index] = QString( reinterpret_cast<const QChar *>( data ), length );
+#else
+        QString result( length, Qt::Uninitialized );
+        for ( int i = 0; i < length; ++i ) {
+            result[i] = QChar( qFromLittleEndian<quint16>( data + 2 * i ) );
+        }
+        m_strings[index] = result;
+#endif
+        m_decoded.setBit( index );
+    }
+
+    return m_strings.at( index );
+}
+
+GeoDataPlacemark *CacheReader::placemark( quint32 index )
+{
+    GeoDataPlacemark *mark = new GeoDataPlacemark;
+    mark->setName( string( stringIndex( NameColumn, index ) ) );
+
+    const uchar *const coordinates = m_coordinates + 3 * 8 * index;
+    mark->setCoordinate( readDouble( coordinates ), readDouble( coordinates + 8 ),
+                         readDouble( coordinates + 16 ) );
+
+    mark->setRole( string( stringIndex( RoleColumn, index ) ) );
+    mark->setDescription( string( stringIndex( DescriptionColumn, index ) ) );
+    mark->setCountryCode( string( stringIndex( CountryCodeColumn, index ) ) );
+    mark->setState( string( stringIndex( StateColumn, index ) ) );
+
+    const QString &styleUrl = string( stringIndex( StyleUrlColumn, index ) );
+    if ( !styleUrl.isEmpty() ) {
+        mark->setStyleUrl( styleUrl );
+    }
+
+    mark->setArea( readDouble( m_area + 8 * index ) );
+    mark->setPopulation( qFromLittleEndian<qint64>( m_population + 8 * index ) );
+    mark->extendedData().addValue( GeoDataData( "gmt", int( qFromLittleEndian<qint16>( m_gmt + 2 * index ) ) ) );
+    mark->extendedData().addValue( GeoDataData( "dst", int( qint8( m_dst[index] ) ) ) );
+
+    return mark;
+}
+
+}
+
+bool PlacemarkCache::save( const QString &fileName, const GeoDataContainer *container,
+                           const QDateTime &dateTime )
+{
+    CacheWriter writer( dateTime );
+    writer.addPlacemarks( container );
+
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        mDebug() << Q_FUNC_INFO << "Can't open" << fileName << "for writing";
+        return false;
+    }
+
+    QDataStream out( &file );
+    out << magicNumber << version;
+    writer.write( out );
+
+    return out.status() == QDataStream::Ok;
+}
+
+GeoDataDocument *PlacemarkCache::load( const QString &fileName )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return 0;
+    }
+
+    QDataStream in( &file );
+    quint32 magic;
+    qint32 fileVersion;
+    in >> magic >> fileVersion;
+    if ( magic != magicNumber || fileVersion != version ) {
+        return 0;
+    }
+
+    const uchar *const data = file.map( 0, file.size() );
+    if ( !data ) {
+        mDebug() << "Could not map" << fileName;
+        return 0;
+    }
+
+    CacheReader reader( data, file.size() );
+    if ( !reader.isValid() ) {
+        file.unmap( const_cast<uchar *>( data ) );
+        return 0;
+    }
+
+    GeoDataDocument *document = new GeoDataDocument;
+    const quint32 count = reader.placemarkCount();
+    for ( quint32 i = 0; i < count; ++i ) {
+        document->append( reader.placemark( i ) );
+    }
+
+    file.unmap( const_cast<uchar *>( data ) );
+
+    return document;
+}
+
+}
@@ -0,0 +1,55 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_PLACEMARKCACHE_H
+#define MARBLE_PLACEMARKCACHE_H
+
+#include "marble_export.h"
+
+#include <QDateTime>
+#include <QString>
+
+namespace Marble
+{
+
+class GeoDataContainer;
+class GeoDataDocument;
+
+/**
+ * Reads and writes the binary placemark cache files (*.cache).
+ *
+ * After the magic number and the version, which are stored big endian
+ * like in the older QDataStream based caches, the file holds one column
+ * per placemark property. Coordinates are packed as (lon, lat, alt)
+ * triples, and all strings including the style urls are references into
+ * a string table, so a cache can be memory mapped and read without
+ * decoding each placemark field by field.
+ */
+class MARBLE_EXPORT PlacemarkCache
+{
+ public:
+    /**
+     * Writes the placemarks of @p container and its folders to @p fileName,
+     * using their coordinates at @p dateTime.
+     */
+    static bool save( const QString &fileName, const GeoDataContainer *container,
+                      const QDateTime &dateTime = QDateTime() );
+
+    /**
+     * Reads the placemarks of the cache @p fileName into a new document.
+     * Returns 0 if the file is not a cache of the current version.
+     */
+    static GeoDataDocument *load( const QString &fileName );
+
+    static const quint32 magicNumber;
+    static const qint32 version;
+};
+
+}
+
+#endif
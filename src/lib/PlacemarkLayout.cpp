@@ -32,6 +32,7 @@
 #include "MarbleClock.h"
 #include "MarblePlacemarkModel.h"
 #include "MarbleDirs.h"
+#include "RenderProfiler.h"
 #include "ViewportParams.h"
 #include "TileId.h"
 #include "TileCoordsPyramid.h"
@@ -149,12 +150,14 @@ PlacemarkLayout::PlacemarkLayout( QAbstractItemModel  *placemarkModel,
       m_showCraters( false ),
       m_showMaria( false ),
       m_maxLabelHeight( 0 ),
+      m_labelHeightsStale( false ),
       m_styleResetRequested( true )
 {
     m_placemarkModel.setSourceModel( placemarkModel );
     m_placemarkModel.setDynamicSortFilter( true );
     m_placemarkModel.setSortRole( MarblePlacemarkModel::PopularityIndexRole );
     m_placemarkModel.sort( 0, Qt::AscendingOrder );
+    recountLabelHeights();
 
     connect( m_selectionModel,  SIGNAL( selectionChanged( QItemSelection,
                                                            QItemSelection) ),
@@ -219,9 +222,13 @@ void PlacemarkLayout::requestStyleReset()
 void PlacemarkLayout::styleReset()
 {
     m_paintOrder.clear();
+    m_hitIndex.clear();
     m_labelArea = 0;
     qDeleteAll( m_visiblePlacemarks );
     m_visiblePlacemarks.clear();
+    if ( m_labelHeightsStale || m_labelHeightsFont != GeoDataFeature::defaultFont() ) {
+        recountLabelHeights();
+    }
     m_maxLabelHeight = maxLabelHeight();
     m_styleResetRequested = false;
 }
@@ -232,36 +239,71 @@ QVector<const GeoDataPlacemark*> PlacemarkLayout::whichPlacemarkAt( const QPoint
         styleReset();
     }
 
-    QVector<const GeoDataPlacemark*> ret;
+    return m_hitIndex.itemsAt( curpos );
+}
 
-    foreach( VisiblePlacemark* mark, m_paintOrder ) {
-        if ( mark->labelRect().contains( curpos )
-             || QRect( mark->symbolPosition(), mark->symbolPixmap().size() ).contains( curpos ) ) {
-            ret.append( mark->placemark() );
-        }
+int PlacemarkLayout::maxLabelHeight() const
+{
+    if ( m_labelHeightCounts.isEmpty() ) {
+        return 0;
     }
 
-    return ret;
+    return ( m_labelHeightCounts.constEnd() - 1 ).key();
 }
 
-int PlacemarkLayout::maxLabelHeight() const
+int PlacemarkLayout::labelHeight( const GeoDataPlacemark *placemark )
 {
-    int maxLabelHeight = 0;
+    const QFont labelFont = placemark->style()->labelStyle().font();
+    QMap<QFont, int>::const_iterator it = m_fontHeights.constFind( labelFont );
+    if ( it != m_fontHeights.constEnd() ) {
+        return it.value();
+    }
 
-    for ( int i = 0; i < m_placemarkModel.rowCount(); ++i ) {
-        QModelIndex index = m_placemarkModel.index( i, 0 );
-        const GeoDataPlacemark *placemark = dynamic_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
-        if ( placemark ) {
-            const GeoDataStyle* style = placemark->style();
-            QFont labelFont = style->labelStyle().font();
-            int textHeight = QFontMetrics( labelFont ).height();
-            if ( textHeight > maxLabelHeight )
-                maxLabelHeight = textHeight;
+    const int height = QFontMetrics( labelFont ).height();
+    m_fontHeights.insert( labelFont, height );
+    return height;
+}
+
+void PlacemarkLayout::countLabelHeights( const QModelIndex &parent, int first, int last, int count )
+{
+    for ( int i = first; i <= last; ++i ) {
+        const QModelIndex index = m_placemarkModel.index( i, 0, parent );
+        const GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>(index.data( MarblePlacemarkModel::ObjectPointerRole ) ));
+        if ( !placemark ) {
+            continue;
+        }
+
+        const int height = labelHeight( placemark );
+        QMap<int, int>::iterator it = m_labelHeightCounts.find( height );
+        if ( count > 0 ) {
+            if ( it == m_labelHeightCounts.end() ) {
+                m_labelHeightCounts.insert( height, count );
+            }
+            else {
+                it.value() += count;
+            }
+        }
+        else if ( it != m_labelHeightCounts.end() ) {
+            it.value() += count;
+            if ( it.value() <= 0 ) {
+                m_labelHeightCounts.erase( it );
+            }
+        }
+        else {
+            // the label font changed since the placemark was counted, so the
+            // height it was counted with is left over; the next style reset counts anew
+            m_labelHeightsStale = true;
         }
     }
+}
 
-    //mDebug() <<"Detected maxLabelHeight: " << maxLabelHeight;
-    return maxLabelHeight;
+void PlacemarkLayout::recountLabelHeights()
+{
+    m_labelHeightsFont = GeoDataFeature::defaultFont();
+    m_labelHeightsStale = false;
+    m_fontHeights.clear();
+    m_labelHeightCounts.clear();
+    countLabelHeights( QModelIndex(), 0, m_placemarkModel.rowCount() - 1, 1 );
 }
 
 /// feed an internal QMap of placemarks with TileId as key when model changes
@@ -282,6 +324,7 @@ void PlacemarkLayout::addPlacemarks( QModelIndex parent, int first, int last )
         TileId key = TileId::fromCoordinates( coordinates, zoomLevel );
         m_placemarkCache[key].append( placemark );
     }
+    countLabelHeights( parent, first, last, 1 );
     requestStyleReset();
     emit repaintNeeded();
 }
@@ -303,6 +346,12 @@ void PlacemarkLayout::removePlacemarks( QModelIndex parent, int first, int last
         TileId key = TileId::fromCoordinates( coordinates, zoomLevel );
         m_placemarkCache[key].removeAll( placemark );
     }
+    countLabelHeights( parent, first, last, -1 );
+    m_maxLabelHeight = maxLabelHeight();
+    if ( m_labelHeightsStale ) {
+        // the placemarks are still in the model, count them once they are gone
+        requestStyleReset();
+    }
     emit repaintNeeded();
 }
 
@@ -313,6 +362,7 @@ void PlacemarkLayout::resetCacheData()
     m_placemarkCache.clear();
     requestStyleReset();
     addPlacemarks( m_placemarkModel.index( 0, 0 ), 0, rowCount );
+    recountLabelHeights();
     emit repaintNeeded();
 }
 
@@ -370,6 +420,7 @@ QSet<TileId> PlacemarkLayout::visibleTiles( const ViewportParams *viewport ) con
 
 QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParams *viewport )
 {
+    RenderProfiler::Scope scope( "PlacemarkLayout::generateLayout" );
     m_runtimeTrace.clear();
     if ( m_placemarkModel.rowCount() <= 0 )
         return QVector<VisiblePlacemark *>();
@@ -525,6 +576,12 @@ QVector<VisiblePlacemark *> PlacemarkLayout::generateLayout( const ViewportParam
         }
     }
 
+    m_hitIndex.reset( viewport->size() );
+    foreach( VisiblePlacemark* mark, m_paintOrder ) {
+        m_hitIndex.insert( mark->labelRect(), mark->placemark() );
+        m_hitIndex.insert( QRect( mark->symbolPosition(), mark->symbolPixmap().size() ), mark->placemark() );
+    }
+
     m_runtimeTrace = QString("Placemarks: %1 Drawn: %2").arg( placemarkList.count() ).arg( m_paintOrder.size() );
     return m_paintOrder;
 }
@@ -18,7 +18,9 @@
 #define MARBLE_PLACEMARKLAYOUT_H
 
 
+#include <QFont>
 #include <QHash>
+#include <QMap>
 #include <QModelIndex>
 #include <QRect>
 #include <QSet>
@@ -26,6 +28,7 @@
 #include <QSortFilterProxyModel>
 
 #include "GeoDataFeature.h"
+#include "ScreenGridIndex.h"
 
 class QAbstractItemModel;
 class QItemSelectionModel;
@@ -81,6 +84,12 @@ class PlacemarkLayout : public QObject
 
     QString runtimeTrace() const;
 
+    /**
+     * Returns the maximum height of all possible labels.
+     * The layout checks labels for overlaps in rows of that height.
+     */
+    int maxLabelHeight() const;
+
  public Q_SLOTS:
     // earth
     void setShowPlaces( bool show );
@@ -102,14 +111,14 @@ class PlacemarkLayout : public QObject
     void repaintNeeded();
 
  private:
-    /**
-     * Returns a the maximum height of all possible labels.
-     * WARNING: This is a really slow method as it traverses all placemarks
-     * to check the labelheight.
-     * FIXME: Once a StyleManager that manages all styles has been implemented
-     * just traverse all existing styles.
-     */
-    int maxLabelHeight() const;
+    /** Returns the height of the label font of @p placemark, measured once per font */
+    int labelHeight( const GeoDataPlacemark *placemark );
+
+    /** Counts the label heights of the placemarks in @p first to @p last, or uncounts them if @p count is negative */
+    void countLabelHeights( const QModelIndex &parent, int first, int last, int count );
+
+    /** Counts the label heights of all placemarks anew, e.g. when the default font or a label font changed */
+    void recountLabelHeights();
 
     void styleReset();
 
@@ -136,6 +145,8 @@ class PlacemarkLayout : public QObject
     MarbleClock *const m_clock;
 
     QVector<VisiblePlacemark*> m_paintOrder;
+    /// the label and symbol rects of m_paintOrder for finding the placemarks at a position
+    ScreenGridIndex<const GeoDataPlacemark*> m_hitIndex;
     QString m_runtimeTrace;
     int m_labelArea;
     QHash<const GeoDataPlacemark*, VisiblePlacemark*> m_visiblePlacemarks;
@@ -158,6 +169,12 @@ class PlacemarkLayout : public QObject
     bool m_showMaria;
 
     int     m_maxLabelHeight;
+    /// the number of placemarks per label height
+    QMap<int, int> m_labelHeightCounts;
+    QMap<QFont, int> m_fontHeights;
+    QFont   m_labelHeightsFont;
+    /// a removed placemark had a label height that was not counted
+    bool    m_labelHeightsStale;
     bool    m_styleResetRequested;
 };
 
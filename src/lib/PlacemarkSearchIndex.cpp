@@ -0,0 +1,303 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "PlacemarkSearchIndex.h"
+
+#include "GeoDataContainer.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+#include "GeoDataTypes.h"
+#include "MarbleMath.h"
+
+#include <QPair>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QString>
+#include <QWriteLocker>
+
+#include <algorithm>
+
+namespace Marble
+{
+
+namespace
+{
+
+struct IndexEntry
+{
+    IndexEntry() : placemark( 0 ) {}
+    IndexEntry( const QString &key_, GeoDataPlacemark *placemark_ ) :
+        key( key_ ),
+        placemark( placemark_ )
+    {}
+
+    QString key;
+    GeoDataPlacemark *placemark;
+};
+
+bool operator<( const IndexEntry &one, const IndexEntry &two )
+{
+    return one.key < two.key;
+}
+
+bool operator<( const IndexEntry &entry, const QString &key )
+{
+    return entry.key < key;
+}
+
+/// Removes the entries of @p removed from @p entries, keeping the order of the others
+void removeEntries( QVector<IndexEntry> &entries, const QSet<GeoDataPlacemark*> &removed )
+{
+    QVector<IndexEntry>::Iterator target = entries.begin();
+    QVector<IndexEntry>::Iterator const end = entries.end();
+    for ( QVector<IndexEntry>::Iterator it = target; it != end; ++it ) {
+        if ( !removed.contains( it->placemark ) ) {
+            if ( target != it ) {
+                *target = *it;
+            }
+            ++target;
+        }
+    }
+    entries.erase( target, end );
+}
+
+bool lessDistance( const QPair<qreal, GeoDataPlacemark*> &one, const QPair<qreal, GeoDataPlacemark*> &two )
+{
+    return one.first < two.first;
+}
+
+}
+
+class PlacemarkSearchIndex::Private
+{
+ public:
+    explicit Private( GeoDataTreeModel *treeModel );
+
+    static void collectPlacemarks( GeoDataObject *object, QVector<GeoDataPlacemark*> &placemarks );
+
+    /// Queues @p placemarks for the next merge, m_lock has to be locked for writing
+    void addPlacemarks( const QVector<GeoDataPlacemark*> &placemarks );
+
+    /// Removes @p placemarks from the index, m_lock has to be locked for writing
+    void removePlacemarks( const QVector<GeoDataPlacemark*> &placemarks );
+
+    /// Locks m_lock for reading once all pending entries are merged into m_entries
+    void lockForSearch();
+
+    QVector<GeoDataPlacemark*> search( const QString &key, const GeoDataLatLonAltBox &preferred ) const;
+
+    GeoDataTreeModel *const m_treeModel;
+
+    /// sorted by key, i.e. the case folded placemark name
+    QVector<IndexEntry> m_entries;
+
+    /// entries added since the last search, merged into m_entries in one go
+    QVector<IndexEntry> m_pending;
+
+    mutable QReadWriteLock m_lock;
+};
+
+PlacemarkSearchIndex::Private::Private( GeoDataTreeModel *treeModel ) :
+    m_treeModel( treeModel ),
+    m_entries(),
+    m_pending(),
+    m_lock()
+{
+}
+
+void PlacemarkSearchIndex::Private::collectPlacemarks( GeoDataObject *object, QVector<GeoDataPlacemark*> &placemarks )
+{
+    if ( object->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+        placemarks << static_cast<GeoDataPlacemark*>( object );
+    }
+    else if ( object->nodeType() == GeoDataTypes::GeoDataFolderType
+              || object->nodeType() == GeoDataTypes::GeoDataDocumentType ) {
+        const GeoDataContainer *container = static_cast<const GeoDataContainer*>( object );
+        QVector<GeoDataFeature*>::ConstIterator it = container->constBegin();
+        QVector<GeoDataFeature*>::ConstIterator const end = container->constEnd();
+        for ( ; it != end; ++it ) {
+            collectPlacemarks( *it, placemarks );
+        }
+    }
+}
+
+void PlacemarkSearchIndex::Private::addPlacemarks( const QVector<GeoDataPlacemark*> &placemarks )
+{
+    foreach ( GeoDataPlacemark *placemark, placemarks ) {
+        m_pending << IndexEntry( placemark->name().toCaseFolded(), placemark );
+    }
+}
+
+void PlacemarkSearchIndex::Private::removePlacemarks( const QVector<GeoDataPlacemark*> &placemarks )
+{
+    QSet<GeoDataPlacemark*> removed;
+    removed.reserve( placemarks.size() );
+    foreach ( GeoDataPlacemark *placemark, placemarks ) {
+        removed.insert( placemark );
+    }
+
+    removeEntries( m_entries, removed );
+    removeEntries( m_pending, removed );
+}
+
+void PlacemarkSearchIndex::Private::lockForSearch()
+{
+    forever {
+        m_lock.lockForRead();
+        if ( m_pending.isEmpty() ) {
+            return;
+        }
+        m_lock.unlock();
+
+        QWriteLocker locker( &m_lock );
+        if ( m_pending.isEmpty() ) {
+            continue;
+        }
+
+        std::sort( m_pending.begin(), m_pending.end() );
+        QVector<IndexEntry> merged( m_entries.size() + m_pending.size() );
+        std::merge( m_entries.constBegin(), m_entries.constEnd(),
+                    m_pending.constBegin(), m_pending.constEnd(),
+                    merged.begin() );
+        m_entries = merged;
+        m_pending.clear();
+    }
+}
+
+PlacemarkSearchIndex::PlacemarkSearchIndex( GeoDataTreeModel *treeModel, QObject *parent ) :
+    QObject( parent ),
+    d( new Private( treeModel ) )
+{
+    connect( treeModel, SIGNAL(added(GeoDataObject*)),
+             this, SLOT(addObject(GeoDataObject*)) );
+    connect( treeModel, SIGNAL(removed(GeoDataObject*)),
+             this, SLOT(removeObject(GeoDataObject*)) );
+    connect( treeModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+             this, SLOT(updateObjects(QModelIndex,QModelIndex)) );
+    connect( treeModel, SIGNAL(modelReset()),
+             this, SLOT(rebuild()) );
+
+    rebuild();
+}
+
+PlacemarkSearchIndex::~PlacemarkSearchIndex()
+{
+    delete d;
+}
+
+QVector<GeoDataPlacemark*> PlacemarkSearchIndex::search( const QString &searchTerm, const GeoDataLatLonAltBox &preferred ) const
+{
+    const QString key = searchTerm.toCaseFolded();
+
+    d->lockForSearch();
+    const QVector<GeoDataPlacemark*> result = d->search( key, preferred );
+    d->m_lock.unlock();
+
+    return result;
+}
+
+QVector<GeoDataPlacemark*> PlacemarkSearchIndex::Private::search( const QString &key, const GeoDataLatLonAltBox &preferred ) const
+{
+    QVector<IndexEntry>::ConstIterator it = std::lower_bound( m_entries.constBegin(), m_entries.constEnd(), key );
+    QVector<IndexEntry>::ConstIterator const end = m_entries.constEnd();
+
+    QVector<GeoDataPlacemark*> result;
+
+    if ( preferred.isEmpty() ) {
+        for ( ; it != end && it->key.startsWith( key ); ++it ) {
+            result << new GeoDataPlacemark( *it->placemark );
+        }
+        return result;
+    }
+
+    const GeoDataCoordinates center = preferred.center();
+    QVector< QPair<qreal, GeoDataPlacemark*> > matches;
+    for ( ; it != end && it->key.startsWith( key ); ++it ) {
+        const GeoDataCoordinates coordinate = it->placemark->coordinate();
+        if ( preferred.contains( coordinate ) ) {
+            matches << qMakePair( distanceSphere( center, coordinate ), it->placemark );
+        }
+    }
+
+    std::stable_sort( matches.begin(), matches.end(), lessDistance );
+
+    result.reserve( matches.size() );
+    for ( int i = 0; i < matches.size(); ++i ) {
+        result << new GeoDataPlacemark( *matches[i].second );
+    }
+
+    return result;
+}
+
+int PlacemarkSearchIndex::size() const
+{
+    QReadLocker locker( &d->m_lock );
+    return d->m_entries.size() + d->m_pending.size();
+}
+
+void PlacemarkSearchIndex::addObject( GeoDataObject *object )
+{
+    QVector<GeoDataPlacemark*> placemarks;
+    Private::collectPlacemarks( object, placemarks );
+    if ( placemarks.isEmpty() ) {
+        return;
+    }
+
+    QWriteLocker locker( &d->m_lock );
+    d->addPlacemarks( placemarks );
+}
+
+void PlacemarkSearchIndex::removeObject( GeoDataObject *object )
+{
+    QVector<GeoDataPlacemark*> placemarks;
+    Private::collectPlacemarks( object, placemarks );
+    if ( placemarks.isEmpty() ) {
+        return;
+    }
+
+    QWriteLocker locker( &d->m_lock );
+    d->removePlacemarks( placemarks );
+}
+
+void PlacemarkSearchIndex::updateObjects( const QModelIndex &topLeft, const QModelIndex &bottomRight )
+{
+    // the names of the changed placemarks may have changed
+    QVector<GeoDataPlacemark*> placemarks;
+    const QModelIndex parent = topLeft.parent();
+    for ( int row = topLeft.row(); row <= bottomRight.row(); ++row ) {
+        GeoDataObject *object = static_cast<GeoDataObject*>( d->m_treeModel->index( row, 0, parent ).internalPointer() );
+        if ( object && object->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+            placemarks << static_cast<GeoDataPlacemark*>( object );
+        }
+    }
+    if ( placemarks.isEmpty() ) {
+        return;
+    }
+
+    QWriteLocker locker( &d->m_lock );
+    d->removePlacemarks( placemarks );
+    d->addPlacemarks( placemarks );
+}
+
+void PlacemarkSearchIndex::rebuild()
+{
+    {
+        QWriteLocker locker( &d->m_lock );
+        d->m_entries.clear();
+        d->m_pending.clear();
+    }
+
+    addObject( d->m_treeModel->rootDocument() );
+}
+
+}
+
+#include "PlacemarkSearchIndex.moc"
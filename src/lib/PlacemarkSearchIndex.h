@@ -0,0 +1,79 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_PLACEMARKSEARCHINDEX_H
+#define MARBLE_PLACEMARKSEARCHINDEX_H
+
+#include "marble_export.h"
+
+#include <QObject>
+#include <QVector>
+
+class QModelIndex;
+class QString;
+
+namespace Marble
+{
+
+class GeoDataLatLonAltBox;
+class GeoDataObject;
+class GeoDataPlacemark;
+class GeoDataTreeModel;
+
+/**
+ * @short A prefix index over the names of all placemarks in a GeoDataTreeModel.
+ *
+ * The index keeps the case folded placemark names in a sorted array, so
+ * looking up all placemarks whose name starts with a given term does not
+ * require walking the whole model. It follows the added() and removed()
+ * signals of the tree model, which report whole documents at once, and
+ * re-indexes placemarks reported by dataChanged(). Added placemarks are
+ * collected and merged into the sorted array in a single pass on the
+ * next search.
+ *
+ * Searching is thread-safe and may be done from runner threads.
+ */
+class MARBLE_EXPORT PlacemarkSearchIndex : public QObject
+{
+    Q_OBJECT
+
+ public:
+    explicit PlacemarkSearchIndex( GeoDataTreeModel *treeModel, QObject *parent = 0 );
+    ~PlacemarkSearchIndex();
+
+    /**
+     * @brief Returns copies of all placemarks whose name starts with searchTerm
+     * @param searchTerm the beginning of the name, compared case insensitively
+     * @param preferred if not empty, only placemarks inside this box are returned,
+     *   sorted by their distance to the center of the box
+     *
+     * Ownership of the returned placemarks is passed to the caller.
+     */
+    QVector<GeoDataPlacemark*> search( const QString &searchTerm, const GeoDataLatLonAltBox &preferred ) const;
+
+    /**
+     * @brief Returns the number of indexed placemarks
+     */
+    int size() const;
+
+ private Q_SLOTS:
+    void addObject( GeoDataObject *object );
+    void removeObject( GeoDataObject *object );
+    void updateObjects( const QModelIndex &topLeft, const QModelIndex &bottomRight );
+    void rebuild();
+
+ private:
+    Q_DISABLE_COPY( PlacemarkSearchIndex )
+
+    class Private;
+    Private * const d;
+};
+
+}
+
+#endif
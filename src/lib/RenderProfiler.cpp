@@ -0,0 +1,312 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "RenderProfiler.h"
+
+#include "MarbleDebug.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+
+namespace Marble
+{
+
+namespace
+{
+
+/** The number of events kept for the trace, older ones are overwritten */
+const int maximumEventCount = 1 << 16;
+
+/** The number of recordings per name the histograms are made of */
+const int windowSize = 128;
+
+struct Event
+{
+    int name;
+    qint64 start;
+    qint64 duration;
+    quintptr thread;
+};
+
+class Histogram
+{
+public:
+    Histogram()
+        : m_durations( windowSize, 0 ),
+          m_buckets( RenderProfiler::BucketCount, 0 ),
+          m_next( 0 ),
+          m_size( 0 ),
+          m_count( 0 )
+    {
+    }
+
+    void add( qint64 duration )
+    {
+        if ( m_size == windowSize ) {
+            --m_buckets[bucket( m_durations[m_next] )];
+        } else {
+            ++m_size;
+        }
+
+        m_durations[m_next] = duration;
+        ++m_buckets[bucket( duration )];
+        m_next = ( m_next + 1 ) % windowSize;
+        ++m_count;
+    }
+
+    QVector<int> buckets() const
+    {
+        return m_buckets;
+    }
+
+    qint64 percentile( qreal fraction ) const
+    {
+        if ( m_size == 0 ) {
+            return 0;
+        }
+
+        QVector<qint64> durations = m_durations.mid( 0, m_size );
+        qSort( durations );
+        int const index = qBound( 0, qRound( fraction * ( m_size - 1 ) ), m_size - 1 );
+        return durations[index];
+    }
+
+    int count() const
+    {
+        return m_count;
+    }
+
+private:
+    static int bucket( qint64 duration )
+    {
+        int result = 0;
+        while ( duration > 1 && result < RenderProfiler::BucketCount - 1 ) {
+            duration >>= 1;
+            ++result;
+        }
+        return result;
+    }
+
+    QVector<qint64> m_durations;
+    QVector<int> m_buckets;
+    int m_next;
+    int m_size;
+    int m_count;
+};
+
+class RenderProfilerPrivate
+{
+public:
+    RenderProfilerPrivate()
+        : m_nextEvent( 0 )
+    {
+        m_clock.start();
+        m_events.reserve( maximumEventCount );
+    }
+
+    void clear()
+    {
+        m_names.clear();
+        m_literalIndices.clear();
+        m_nameIndices.clear();
+        m_histograms.clear();
+        m_events.clear();
+        m_nextEvent = 0;
+    }
+
+    int addName( const QString &name )
+    {
+        QHash<QString, int>::const_iterator it = m_nameIndices.constFind( name );
+        if ( it != m_nameIndices.constEnd() ) {
+            return it.value();
+        }
+
+        int const index = m_names.size();
+        m_names.append( name );
+        m_nameIndices.insert( name, index );
+        m_histograms.append( Histogram() );
+        return index;
+    }
+
+    /** The events in the order they were recorded */
+    QVector<Event> events() const
+    {
+        if ( m_events.size() < maximumEventCount ) {
+            return m_events;
+        }
+        return m_events.mid( m_nextEvent ) + m_events.mid( 0, m_nextEvent );
+    }
+
+    QMutex m_mutex;
+    QElapsedTimer m_clock;
+
+    QStringList m_names;
+    QHash<const char *, int> m_literalIndices;
+    QHash<QString, int> m_nameIndices;
+    QVector<Histogram> m_histograms;
+
+    QVector<Event> m_events;
+    int m_nextEvent;
+};
+
+RenderProfilerPrivate *profiler()
+{
+    static RenderProfilerPrivate instance;
+    return &instance;
+}
+
+QString escaped( const QString &name )
+{
+    QString result = name;
+    result.replace( '\\', "\\\\" );
+    result.replace( '"', "\\\"" );
+    return result;
+}
+
+}
+
+bool RenderProfiler::s_enabled = false;
+
+void RenderProfiler::setEnabled( bool enabled )
+{
+    if ( enabled && !s_enabled ) {
+        clear();
+    }
+    s_enabled = enabled;
+}
+
+void RenderProfiler::clear()
+{
+    QMutexLocker locker( &profiler()->m_mutex );
+    profiler()->clear();
+}
+
+QStringList RenderProfiler::names()
+{
+    QMutexLocker locker( &profiler()->m_mutex );
+    return profiler()->m_names;
+}
+
+int RenderProfiler::count( const QString &name )
+{
+    QMutexLocker locker( &profiler()->m_mutex );
+    int const index = profiler()->m_nameIndices.value( name, -1 );
+    return index < 0 ? 0 : profiler()->m_histograms[index].count();
+}
+
+QVector<int> RenderProfiler::histogram( const QString &name )
+{
+    QMutexLocker locker( &profiler()->m_mutex );
+    int const index = profiler()->m_nameIndices.value( name, -1 );
+    return index < 0 ? QVector<int>( BucketCount, 0 ) : profiler()->m_histograms[index].buckets();
+}
+
+qint64 RenderProfiler::percentile( const QString &name, qreal fraction )
+{
+    QMutexLocker locker( &profiler()->m_mutex );
+    int const index = profiler()->m_nameIndices.value( name, -1 );
+    return index < 0 ? 0 : profiler()->m_histograms[index].percentile( fraction );
+}
+
+bool RenderProfiler::exportChromeTrace( const QString &fileName )
+{
+    QStringList names;
+    QVector<Event> events;
+    {
+        QMutexLocker locker( &profiler()->m_mutex );
+        names = profiler()->m_names;
+        events = profiler()->events();
+    }
+
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Cannot write render profile" << fileName << file.errorString();
+        return false;
+    }
+
+    QStringList escapedNames;
+    foreach ( const QString &name, names ) {
+        escapedNames << escaped( name );
+    }
+
+    QHash<quintptr, int> threads;
+
+    QTextStream stream( &file );
+    stream.setCodec( "UTF-8" );
+    stream << "{\"traceEvents\":[";
+    for ( int i = 0; i < events.size(); ++i ) {
+        const Event &event = events.at( i );
+        if ( !threads.contains( event.thread ) ) {
+            threads.insert( event.thread, threads.size() + 1 );
+        }
+
+        stream << ( i == 0 ? "\n" : ",\n" );
+        // timestamps are in microseconds
+        stream << "{\"name\":\"" << escapedNames.at( event.name ) << "\",\"cat\":\"render\",\"ph\":\"X\""
+               << ",\"ts\":" << QString::number( event.start / 1000.0, 'f', 3 )
+               << ",\"dur\":" << QString::number( event.duration / 1000.0, 'f', 3 )
+               << ",\"pid\":1,\"tid\":" << threads.value( event.thread ) << "}";
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    stream.flush();
+
+    return file.error() == QFile::NoError;
+}
+
+int RenderProfiler::nameIndex( const char *name )
+{
+    QMutexLocker locker( &profiler()->m_mutex );
+
+    // string literals are looked up by their address
+    QHash<const char *, int>::const_iterator it = profiler()->m_literalIndices.constFind( name );
+    if ( it != profiler()->m_literalIndices.constEnd() ) {
+        return it.value();
+    }
+
+    int const index = profiler()->addName( QString::fromLatin1( name ) );
+    profiler()->m_literalIndices.insert( name, index );
+    return index;
+}
+
+int RenderProfiler::nameIndex( const QString &name )
+{
+    QMutexLocker locker( &profiler()->m_mutex );
+    return profiler()->addName( name );
+}
+
+qint64 RenderProfiler::now()
+{
+    return profiler()->m_clock.nsecsElapsed();
+}
+
+void RenderProfiler::record( int name, qint64 start, qint64 end )
+{
+    QMutexLocker locker( &profiler()->m_mutex );
+
+    // the profiler may have been cleared in the meantime
+    if ( name >= profiler()->m_names.size() ) {
+        return;
+    }
+
+    Event const event = { name, start, end - start, quintptr( QThread::currentThreadId() ) };
+    if ( profiler()->m_events.size() < maximumEventCount ) {
+        profiler()->m_events.append( event );
+    } else {
+        profiler()->m_events[profiler()->m_nextEvent] = event;
+    }
+    profiler()->m_nextEvent = ( profiler()->m_nextEvent + 1 ) % maximumEventCount;
+
+    profiler()->m_histograms[name].add( ( end - start ) / 1000 );
+}
+
+}
@@ -0,0 +1,122 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_RENDERPROFILER_H
+#define MARBLE_RENDERPROFILER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+/**
+ * @short Records how long the steps of painting a frame take.
+ *
+ * Code that is part of painting the map measures its steps with a Scope:
+ *
+ * @code
+ * RenderProfiler::Scope scope( "GeometryLayer::render" );
+ * @endcode
+ *
+ * A scope costs a single check while the profiler is disabled. While it is
+ * enabled, each scope records an event for the trace and updates a
+ * histogram of the durations of the last frames of its name. The trace
+ * can be exported to the Chrome trace event format and be inspected in
+ * chrome://tracing. Profiling is meant for the thread painting the map.
+ */
+class MARBLE_EXPORT RenderProfiler
+{
+public:
+    class MARBLE_EXPORT Scope
+    {
+    public:
+        /** Measures @p name, which has to be a string literal */
+        explicit Scope( const char *name );
+        explicit Scope( const QString &name );
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY( Scope )
+
+        int m_name;
+        qint64 m_start;
+    };
+
+    /**
+     * The histogram bucket i counts durations from 2^i to 2^(i+1) microseconds.
+     * The first and last buckets also count the shorter and longer ones.
+     */
+    enum { BucketCount = 20 };
+
+    static bool isEnabled();
+
+    /** Toggles recording. Enabling the profiler clears what was recorded before. */
+    static void setEnabled( bool enabled );
+
+    static void clear();
+
+    /** The names of all scopes recorded so far, in the order they first occurred */
+    static QStringList names();
+
+    /** The number of times the scope @p name was recorded */
+    static int count( const QString &name );
+
+    /** Returns the counts of the durations of the last recordings of @p name per bucket */
+    static QVector<int> histogram( const QString &name );
+
+    /**
+     * Returns the duration in microseconds that @p fraction of the last
+     * recordings of @p name did not exceed, e.g. the median for 0.5.
+     */
+    static qint64 percentile( const QString &name, qreal fraction );
+
+    /** Writes the recorded events in the Chrome trace event format to @p fileName */
+    static bool exportChromeTrace( const QString &fileName );
+
+private:
+    friend class Scope;
+
+    static int nameIndex( const char *name );
+    static int nameIndex( const QString &name );
+    static qint64 now();
+    static void record( int name, qint64 start, qint64 end );
+
+    static bool s_enabled;
+};
+
+inline bool RenderProfiler::isEnabled()
+{
+    return s_enabled;
+}
+
+inline RenderProfiler::Scope::Scope( const char *name )
+    : m_name( RenderProfiler::s_enabled ? RenderProfiler::nameIndex( name ) : -1 ),
+      m_start( m_name < 0 ? 0 : RenderProfiler::now() )
+{
+}
+
+inline RenderProfiler::Scope::Scope( const QString &name )
+    : m_name( RenderProfiler::s_enabled ? RenderProfiler::nameIndex( name ) : -1 ),
+      m_start( m_name < 0 ? 0 : RenderProfiler::now() )
+{
+}
+
+inline RenderProfiler::Scope::~Scope()
+{
+    if ( m_name >= 0 ) {
+        RenderProfiler::record( m_name, m_start, RenderProfiler::now() );
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,175 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_SCREENGRIDINDEX_H
+#define MARBLE_SCREENGRIDINDEX_H
+
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QVector>
+
+namespace Marble
+{
+
+/**
+ * A uniform grid over the screen that finds the rectangles at a position.
+ *
+ * Layouts insert the screen rectangles of what they lay out for a frame, and
+ * lookups of the items under the mouse or of rectangles that overlap only
+ * test the rectangles in the touched grid cells. Rectangles reaching beyond
+ * the screen are kept in the border cells, so positions off the screen are
+ * found as well.
+ */
+template<typename T>
+class ScreenGridIndex
+{
+ public:
+    explicit ScreenGridIndex( int cellSize = 64 )
+        : m_cellSize( cellSize ),
+          m_columns( 0 ),
+          m_rows( 0 )
+    {
+    }
+
+    /** Removes all rectangles and resizes the grid to cover @p size */
+    void reset( const QSize &size )
+    {
+        m_entries.resize( 0 );
+
+        const int columns = qMax( 1, ( size.width() + m_cellSize - 1 ) / m_cellSize );
+        const int rows = qMax( 1, ( size.height() + m_cellSize - 1 ) / m_cellSize );
+        if ( columns != m_columns || rows != m_rows ) {
+            m_columns = columns;
+            m_rows = rows;
+            m_cells = QVector<QVector<int> >( columns * rows );
+        }
+        else {
+            for ( int i = 0; i < m_cells.size(); ++i ) {
+                m_cells[i].resize( 0 );
+            }
+        }
+    }
+
+    /** Removes all rectangles */
+    void clear()
+    {
+        reset( QSize( m_columns * m_cellSize, m_rows * m_cellSize ) );
+    }
+
+    bool isEmpty() const
+    {
+        return m_entries.isEmpty();
+    }
+
+    int size() const
+    {
+        return m_entries.size();
+    }
+
+    void insert( const QRectF &rect, const T &value )
+    {
+        if ( m_cells.isEmpty() || !rect.isValid() ) {
+            return;
+        }
+
+        const int index = m_entries.size();
+        const Entry entry = { rect, value };
+        m_entries.append( entry );
+
+        const int left = column( rect.left() );
+        const int right = column( rect.right() );
+        const int top = row( rect.top() );
+        const int bottom = row( rect.bottom() );
+        for ( int y = top; y <= bottom; ++y ) {
+            for ( int x = left; x <= right; ++x ) {
+                m_cells[y * m_columns + x].append( index );
+            }
+        }
+    }
+
+    /**
+     * Returns the values of all rectangles that contain @p point, in the
+     * order they were inserted. A value is only returned once, even if
+     * several of its rectangles contain the point.
+     */
+    QVector<T> itemsAt( const QPointF &point ) const
+    {
+        QVector<T> result;
+        if ( m_cells.isEmpty() ) {
+            return result;
+        }
+
+        const QVector<int> &cell = m_cells.at( row( point.y() ) * m_columns + column( point.x() ) );
+        foreach ( int index, cell ) {
+            const Entry &entry = m_entries.at( index );
+            if ( entry.rect.contains( point ) && !result.contains( entry.value ) ) {
+                result.append( entry.value );
+            }
+        }
+
+        return result;
+    }
+
+    /** Returns true if any of the rectangles intersects @p rect */
+    bool intersects( const QRectF &rect ) const
+    {
+        if ( m_cells.isEmpty() || !rect.isValid() ) {
+            return false;
+        }
+
+        const int left = column( rect.left() );
+        const int right = column( rect.right() );
+        const int top = row( rect.top() );
+        const int bottom = row( rect.bottom() );
+        for ( int y = top; y <= bottom; ++y ) {
+            for ( int x = left; x <= right; ++x ) {
+                foreach ( int index, m_cells.at( y * m_columns + x ) ) {
+                    if ( m_entries.at( index ).rect.intersects( rect ) ) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+ private:
+    struct Entry
+    {
+        QRectF rect;
+        T value;
+    };
+
+    int column( qreal x ) const
+    {
+        if ( x < m_cellSize ) {
+            return 0;
+        }
+        return x < m_columns * m_cellSize ? int( x ) / m_cellSize : m_columns - 1;
+    }
+
+    int row( qreal y ) const
+    {
+        if ( y < m_cellSize ) {
+            return 0;
+        }
+        return y < m_rows * m_cellSize ? int( y ) / m_cellSize : m_rows - 1;
+    }
+
+    int m_cellSize;
+    int m_columns;
+    int m_rows;
+    QVector<Entry> m_entries;
+    QVector<QVector<int> > m_cells;
+};
+
+}
+
+#endif
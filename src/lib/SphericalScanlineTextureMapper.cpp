@@ -25,7 +25,6 @@
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
 #include "StackedTile.h"
-#include "TextureColorizer.h"
 #include "ViewportParams.h"
 #include "MathHelper.h"
 
@@ -71,8 +70,7 @@ SphericalScanlineTextureMapper::SphericalScanlineTextureMapper( StackedTileLoade
 void SphericalScanlineTextureMapper::mapTexture( GeoPainter *painter,
                                                  const ViewportParams *viewport,
                                                  int tileZoomLevel,
-                                                 const QRect &dirtyRect,
-                                                 TextureColorizer *texColorizer )
+                                                 const QRect &dirtyRect )
 {
     if ( m_canvasImage.size() != viewport->size() || m_radius != viewport->radius() ) {
         const QImage::Format optimalFormat = ScanlineTextureMapperContext::optimalCanvasImageFormat( viewport );
@@ -92,10 +90,6 @@ void SphericalScanlineTextureMapper::mapTexture( GeoPainter *painter,
     if ( m_repaintNeeded ) {
         mapTexture( viewport, tileZoomLevel, painter->mapQuality() );
 
-        if ( texColorizer ) {
-            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
-        }
-
         m_repaintNeeded = false;
     }
 
@@ -44,8 +44,7 @@ class SphericalScanlineTextureMapper : public TextureMapperInterface
     virtual void mapTexture( GeoPainter *painter,
                              const ViewportParams *viewport,
                              int tileZoomLevel,
-                             const QRect &dirtyRect,
-                             TextureColorizer *texColorizer );
+                             const QRect &dirtyRect );
 
  private:
     void mapTexture( const ViewportParams *viewport, int tileZoomLevel, MapQuality mapQuality );
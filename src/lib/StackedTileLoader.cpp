@@ -35,6 +35,7 @@
 #include <QCache>
 #include <QHash>
 #include <QReadWriteLock>
+#include <QSet>
 #include <QImage>
 
 
@@ -53,6 +54,7 @@ public:
     MergedLayerDecorator *const m_layerDecorator;
     QHash <TileId, StackedTile*>  m_tilesOnDisplay;
     QCache <TileId, StackedTile>  m_tileCache;
+    QSet <TileId>  m_reportedTiles; // last set of tiles passed to the layer decorator
     QReadWriteLock m_cacheLock;
 };
 
@@ -114,6 +116,14 @@ void StackedTileLoader::cleanupTilehash()
             d->m_tilesOnDisplay.remove( it.key() );
         }
     }
+
+    // Let the downloads of tiles that are still visible overtake the others.
+    const QList<TileId> visibleTiles = d->m_tilesOnDisplay.keys();
+    const QSet<TileId> visibleTileSet = visibleTiles.toSet();
+    if ( visibleTileSet != d->m_reportedTiles ) {
+        d->m_reportedTiles = visibleTileSet;
+        d->m_layerDecorator->setVisibleTiles( visibleTiles );
+    }
 }
 
 const StackedTile* StackedTileLoader::loadTile( TileId const & stackedTileId )
@@ -94,7 +94,9 @@ class StackedTileLoader : public QObject
         /**
          * Cleans up the internal tile hash.
          *
-         * Removes all superfluous tiles from the hash.
+         * Removes all superfluous tiles from the hash. If the remaining
+         * tiles differ from the last call, they are passed on to the
+         * layer decorator so that their downloads get preferred.
          */
         void cleanupTilehash();
 
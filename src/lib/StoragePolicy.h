@@ -16,13 +16,15 @@
 #include <QObject>
 #include <QString>
 
+#include "marble_export.h"
+
 
 class QByteArray;
 
 namespace Marble
 {
 
-class StoragePolicy : public QObject
+class MARBLE_EXPORT StoragePolicy : public QObject
 {
     Q_OBJECT
     
@@ -34,7 +36,8 @@ class StoragePolicy : public QObject
         virtual bool fileExists( const QString &fileName ) const = 0;
 
         /**
-         * Return true if file was written successfully.
+         * Return true if file was written successfully. Policies which
+         * write in the background return true once the data is queued.
          */
         virtual bool updateFile( const QString &fileName, const QByteArray &data ) = 0;
 
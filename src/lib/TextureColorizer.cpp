@@ -22,6 +22,7 @@
 #include <QColor>
 #include <QImage>
 #include <QPainter>
+#include <QRunnable>
 
 #include "MarbleGlobal.h"
 #include "GeoPainter.h"
@@ -34,6 +35,9 @@
 #include "GeoDataTypes.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataDocument.h"
+#include "GeoSceneTiled.h"
+#include "TileId.h"
+#include "TileLoaderHelper.h"
 
 namespace Marble
 {
@@ -67,11 +71,39 @@ private:
     uchar  x4;
 };
 
+class TextureColorizerJob : public QRunnable
+{
+public:
+    TextureColorizerJob( const TextureColorizer *colorizer, uchar *tileBits, int bytesPerLine,
+                         const QImage &coastImage, int yBegin, int yEnd )
+        : m_colorizer( colorizer ),
+          m_tileBits( tileBits ),
+          m_bytesPerLine( bytesPerLine ),
+          m_coastImage( coastImage ),
+          m_yBegin( yBegin ),
+          m_yEnd( yEnd )
+    {}
+
+    virtual void run()
+    {
+        m_colorizer->colorizeRows( m_tileBits, m_bytesPerLine, m_coastImage, m_yBegin, m_yEnd );
+    }
+
+private:
+    const TextureColorizer *const m_colorizer;
+    uchar *const m_tileBits;
+    const int m_bytesPerLine;
+    const QImage &m_coastImage;
+    const int m_yBegin;
+    const int m_yEnd;
+};
+
 
 TextureColorizer::TextureColorizer( const QString &seafile,
                                     const QString &landfile,
                                     VectorComposer *veccomposer )
     : m_veccomposer( veccomposer ),
+      m_showRelief( false ),
       m_landColor(qRgb( 255, 0, 0 ) ),
       m_seaColor( qRgb( 0, 255, 0 ) )
 {
@@ -164,22 +196,10 @@ void TextureColorizer::setShowRelief( bool show )
     m_showRelief = show;
 }
 
-// This function takes two images, both in viewParams:
-//  - The coast image, which has a number of colors where each color
-//    represents a sort of terrain (ex: land/sea)
-//  - The canvas image, which has a gray scale image, often
-//    representing a height field.
-//
-// It then uses the values of the pixels in the coast image to select
-// a color map.  The value of the pixel in the canvas image is used as
-// an index into the selected color map and the resulting color is
-// written back to the canvas image.  This way we can have different
-// color schemes for land and water.
-//
-// In addition to this, a simple form of bump mapping is performed to
-// increase the illusion of height differences (see the variable
-// showRelief).
-// 
+bool TextureColorizer::showRelief() const
+{
+    return m_showRelief;
+}
 
 void TextureColorizer::drawIndividualDocument( GeoPainter *painter, const GeoDataDocument *document )
 {
@@ -227,138 +247,127 @@ void TextureColorizer::drawTextureMap( GeoPainter *painter )
     }
 }
 
-void TextureColorizer::colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality )
+QImage TextureColorizer::coastImage( const QSize &size, const TileId &id, const GeoSceneTiled *textureLayer )
 {
-    if ( m_coastImage.size() != viewport->size() )
-        m_coastImage = QImage( viewport->size(), QImage::Format_RGB32 );
+    const GeoDataLatLonBox tileBox = id.toLatLonBox( textureLayer );
+
+    // Both tile projections map 360 degrees to four times the radius, which
+    // has to be integral. Render at a multiple of the tile size if needed.
+    const int globalWidth = size.width()
+            * TileLoaderHelper::levelToColumn( textureLayer->levelZeroColumns(), id.zoomLevel() );
+    int scale = 1;
+    while ( ( globalWidth * scale ) % 4 != 0
+            || ( size.width() * scale ) % 2 != 0
+            || ( size.height() * scale ) % 2 != 0 ) {
+        scale *= 2;
+    }
 
-    // update coast image
-    m_coastImage.fill( QColor( 0, 0, 255, 0).rgb() );
+    Projection projection = Equirectangular;
+    qreal centerLat = 0.5 * ( tileBox.north() + tileBox.south() );
+    if ( textureLayer->projection() == GeoSceneTiled::Mercator ) {
+        projection = Mercator;
+        centerLat = atan( sinh( 0.5 * ( asinh( tan( tileBox.north() ) )
+                                        + asinh( tan( tileBox.south() ) ) ) ) );
+    }
+
+    const ViewportParams viewport( projection, tileBox.center().longitude(), centerLat,
+                                   globalWidth * scale / 4, size * scale );
 
-    const bool antialiased =    mapQuality == HighQuality
-                             || mapQuality == PrintQuality;
+    QImage result( size, QImage::Format_RGB32 );
+    result.fill( QColor( 0, 0, 255, 0).rgb() );
 
-    GeoPainter painter( &m_coastImage, viewport, mapQuality );
-    painter.setRenderHint( QPainter::Antialiasing, antialiased );
+    // the colorized tiles are cached, so always antialias the coast lines
+    GeoPainter painter( &result, &viewport, HighQuality );
+    painter.setRenderHint( QPainter::Antialiasing, true );
+    painter.scale( 1.0 / scale, 1.0 / scale );
 
     if ( m_landDocuments.isEmpty() ) {
-        m_veccomposer->drawTextureMap( &painter, viewport );
+        m_veccomposer->drawTextureMap( &painter, &viewport );
     } else {
         drawTextureMap( &painter );
     }
 
-    const qint64   radius   = viewport->radius();
-
-    const int  imgheight = origimg->height();
-    const int  imgwidth  = origimg->width();
-    const int  imgrx     = imgwidth / 2;
-    const int  imgry     = imgheight / 2;
-    // This variable is not used anywhere..
-    const int  imgradius = imgrx * imgrx + imgry * imgry;
-
-    int     bump = 8;
-
-    if ( radius * radius > imgradius
-         || viewport->projection() == Equirectangular
-         || viewport->projection() == Mercator )
-    {
-        int yTop = 0;
-        int yBottom = imgheight;
-
-        if( viewport->projection() == Equirectangular
-            || viewport->projection() == Mercator )
-        {
-            // Calculate translation of center point
-            const qreal centerLat = viewport->centerLatitude();
-
-            const float rad2Pixel = (qreal)( 2 * radius ) / M_PI;
-            if ( viewport->projection() == Equirectangular ) {
-                int yCenterOffset = (int)( centerLat * rad2Pixel );
-                yTop = ( imgry - radius + yCenterOffset < 0)? 0 : imgry - radius + yCenterOffset;
-                yBottom = ( imgry + yCenterOffset + radius > imgheight )? imgheight : imgry + yCenterOffset + radius;
-            }
-            else if ( viewport->projection() == Mercator ) {
-                int yCenterOffset = (int)( asinh( tan( centerLat ) ) * rad2Pixel  );
-                yTop = ( imgry - 2 * radius + yCenterOffset < 0 ) ? 0 : imgry - 2 * radius + yCenterOffset;
-                yBottom = ( imgry + 2 * radius + yCenterOffset > imgheight )? imgheight : imgry + 2 * radius + yCenterOffset;
-            }
-        }
+    painter.end();
 
-        const int itEnd = yBottom;
-
-        for (int y = yTop; y < itEnd; ++y) {
-
-            QRgb  *writeData         = (QRgb*)( origimg->scanLine( y ) );
-            const QRgb  *coastData   = (QRgb*)( m_coastImage.scanLine( y ) );
+    return result;
+}
 
-            uchar *readDataStart     = origimg->scanLine( y );
-            const uchar *readDataEnd = readDataStart + imgwidth*4;
+// This function takes two images of the same tile:
+//  - The coast image, which has a number of colors where each color
+//    represents a sort of terrain (ex: land/sea)
+//  - The tile image, which has a gray scale image, often
+//    representing a height field.
+//
+// It then uses the values of the pixels in the coast image to select
+// a color map.  The value of the pixel in the tile image is used as
+// an index into the selected color map and the resulting color is
+// written back to the tile image.  This way we can have different
+// color schemes for land and water.
+//
+// In addition to this, a simple form of bump mapping is performed to
+// increase the illusion of height differences (see the variable
+// showRelief).
+//
 
-            EmbossFifo  emboss;
+void TextureColorizer::colorize( QImage *tileImage, const TileId &id, const GeoSceneTiled *textureLayer )
+{
+    if ( tileImage->depth() != 32 ) {
+        *tileImage = tileImage->convertToFormat( QImage::Format_RGB32 );
+    }
 
-            for ( uchar* readData = readDataStart; 
-                  readData < readDataEnd;
-                  readData += 4, ++writeData, ++coastData )
-            {
+    const QImage coast = coastImage( tileImage->size(), id, textureLayer );
 
-                // Cheap Emboss / Bumpmapping
-                uchar&  grey = *readData; // qBlue(*data);
+    // detach here, the jobs must not do that concurrently
+    uchar *const tileBits = tileImage->bits();
 
-                if ( m_showRelief ) {
-                    emboss << grey;
-                    bump = ( emboss.head() + 8 - grey );
-                    if ( bump  < 0 )  bump = 0;
-                    if ( bump  > 15 ) bump = 15;
-                }
-                setPixel( coastData, writeData, bump, grey );
-            }
-        }
+    // the rows are independent of each other, so emboss them in parallel
+    const int imgheight = tileImage->height();
+    const int bandCount = qBound( 1, m_threadPool.maxThreadCount(), imgheight );
+    for ( int band = 0; band < bandCount; ++band ) {
+        const int yBegin = imgheight * band / bandCount;
+        const int yEnd = imgheight * ( band + 1 ) / bandCount;
+        m_threadPool.start( new TextureColorizerJob( this, tileBits, tileImage->bytesPerLine(),
+                                                     coast, yBegin, yEnd ) );
     }
-    else {
-        int yTop    = ( imgry-radius < 0 ) ? 0 : imgry-radius;
-        const int yBottom = ( yTop == 0 ) ? imgheight : imgry + radius;
 
-        EmbossFifo  emboss;
-
-        for ( int y = yTop; y < yBottom; ++y ) {
-            const int  dy = imgry - y;
-            int  rx = (int)sqrt( (qreal)( radius * radius - dy * dy ) );
-            int  xLeft  = 0; 
-            int  xRight = imgwidth;
+    m_threadPool.waitForDone();
+}
 
-            if ( imgrx-rx > 0 ) {
-                xLeft  = imgrx - rx; 
-                xRight = imgrx + rx;
-            }
+void TextureColorizer::colorizeRows( uchar *tileBits, int bytesPerLine, const QImage &coastImage,
+                                     int yBegin, int yEnd ) const
+{
+    const int imgwidth = coastImage.width();
 
-            QRgb  *writeData         = (QRgb*)( origimg->scanLine( y ) )  + xLeft;
-            const QRgb *coastData    = (QRgb*)( m_coastImage.scanLine( y ) ) + xLeft;
+    int bump = 8;
 
-            uchar *readDataStart     = origimg->scanLine( y ) + xLeft * 4;
-            const uchar *readDataEnd = origimg->scanLine( y ) + xRight * 4;
+    for ( int y = yBegin; y < yEnd; ++y ) {
 
- 
-            for ( uchar* readData = readDataStart;
-                  readData < readDataEnd;
-                  readData += 4, ++writeData, ++coastData )
-            {
-                // Cheap Emboss / Bumpmapping
+        QRgb  *writeData       = (QRgb*)( tileBits + y * bytesPerLine );
+        const QRgb *coastData  = (const QRgb*)( coastImage.constScanLine( y ) );
+        const QRgb *writeEnd   = writeData + imgwidth;
 
-                uchar& grey = *readData; // qBlue(*data);
+        // start with a flat relief instead of darkening the tile borders
+        EmbossFifo  emboss;
+        const uchar firstGrey = qBlue( *writeData );
+        emboss << firstGrey << firstGrey << firstGrey << firstGrey;
 
-                if ( m_showRelief ) {
-                    emboss << grey;
-                    bump = ( emboss.head() + 16 - grey ) >> 1;
-                    if ( bump > 15 ) bump = 15;
-                    if ( bump < 0 )  bump = 0;
-                }
-                setPixel( coastData, writeData, bump, grey );
+        for ( ; writeData < writeEnd; ++writeData, ++coastData )
+        {
+            // Cheap Emboss / Bumpmapping
+            const uchar grey = qBlue( *writeData );
+
+            if ( m_showRelief ) {
+                emboss << grey;
+                bump = ( emboss.head() + 8 - grey );
+                if ( bump  < 0 )  bump = 0;
+                if ( bump  > 15 ) bump = 15;
             }
+            setPixel( coastData, writeData, bump, grey );
         }
     }
 }
 
-void TextureColorizer::setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey )
+void TextureColorizer::setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey ) const
 {
     int alpha = qRed( *coastData );
     if ( alpha == 255 )
@@ -24,12 +24,14 @@
 #include <QImage>
 #include <QPen>
 #include <QBrush>
+#include <QThreadPool>
 
 namespace Marble
 {
 
+class GeoSceneTiled;
+class TileId;
 class VectorComposer;
-class ViewportParams;
 
 class TextureColorizer
 {
@@ -46,19 +48,36 @@ class TextureColorizer
 
     void setShowRelief( bool show );
 
+    bool showRelief() const;
+
     void drawIndividualDocument( GeoPainter *painter, const GeoDataDocument *document );
 
     void drawTextureMap( GeoPainter *painter );
 
-    void colorize( QImage *origimg, const ViewportParams *viewport, MapQuality mapQuality );
+    /**
+     * Colorizes the grey scale @p tileImage of the tile @p id of
+     * @p textureLayer in place. The coast lines covered by the tile select
+     * the land or sea palette, and the rows are embossed in parallel.
+     */
+    void colorize( QImage *tileImage, const TileId &id, const GeoSceneTiled *textureLayer );
+
+    /**
+     * Colorizes the rows @p yBegin up to @p yEnd of the 32 bit tile image
+     * data @p tileBits using the land and sea mask @p coastImage of the
+     * same size.
+     */
+    void colorizeRows( uchar *tileBits, int bytesPerLine, const QImage &coastImage,
+                       int yBegin, int yEnd ) const;
 
-    void setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey );
+    void setPixel( const QRgb *coastData, QRgb *writeData, int bump, uchar grey ) const;
 
  private:
+    QImage coastImage( const QSize &size, const TileId &id, const GeoSceneTiled *textureLayer );
+
     VectorComposer *const m_veccomposer;
     QList<const GeoDataDocument*> m_seaDocuments;
     QList<const GeoDataDocument*> m_landDocuments;
-    QImage m_coastImage;
+    QThreadPool m_threadPool;
     uint texturepalette[16][512];
     bool m_showRelief;
     QRgb      m_landColor;
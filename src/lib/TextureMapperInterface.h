@@ -20,7 +20,6 @@ namespace Marble
 class GeoPainter;
 class StackedTile;
 class StackedTileLoader;
-class TextureColorizer;
 class ViewportParams;
 
 
@@ -33,8 +32,7 @@ public:
     virtual void mapTexture( GeoPainter *painter,
                              const ViewportParams *viewport,
                              int tileZoomLevel,
-                             const QRect &dirtyRect,
-                             TextureColorizer *texColorizer ) = 0;
+                             const QRect &dirtyRect ) = 0;
 
     void setRepaintNeeded();
 
@@ -22,6 +22,10 @@
 #include <QImage>
 #include <QImageReader>
 #include <QPainter>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QTime>
 
 #include "MarbleGlobal.h"
 #include "MarbleDirs.h"
@@ -31,6 +35,63 @@
 namespace Marble
 {
 
+/**
+ * Writes a single tile to disk. Encoding is the expensive part of the tile
+ * creation, so it runs on the thread pool of the TileCreator.
+ */
+class TileWriteJob : public QRunnable
+{
+ public:
+    TileWriteJob( const QImage &tile, const QString &tileName, const QByteArray &format,
+                  int quality, bool verify, QSemaphore *pendingWrites )
+        : m_tile( tile ),
+          m_tileName( tileName ),
+          m_format( format ),
+          m_quality( quality ),
+          m_verify( verify ),
+          m_pendingWrites( pendingWrites )
+    {
+    }
+
+    virtual void run();
+
+ private:
+    const QImage m_tile;
+    const QString m_tileName;
+    const QByteArray m_format;
+    const int m_quality;
+    const bool m_verify;
+    QSemaphore *const m_pendingWrites;
+};
+
+void TileWriteJob::run()
+{
+    bool  ok = m_tile.save( m_tileName, m_format.data(), m_quality );
+    if ( !ok )
+        mDebug() << "Error while writing Tile: " << m_tileName;
+
+    if ( ok && m_verify ) {
+        QImage writtenTile( m_tileName );
+        Q_ASSERT( writtenTile.size() == m_tile.size() );
+        for ( int i=0; i < writtenTile.size().width(); ++i) {
+            for ( int j=0; j < writtenTile.size().height(); ++j) {
+                if ( writtenTile.pixel( i, j ) != m_tile.pixel( i, j ) ) {
+                    unsigned int  pixel = m_tile.pixel( i, j);
+                    unsigned int  writtenPixel = writtenTile.pixel( i, j);
+                    qWarning() << "***** pixel" << i << j << "is off by" << (pixel - writtenPixel) << "pixel" << pixel << "writtenPixel" << writtenPixel;
+                    QByteArray baPixel((char*)&pixel, sizeof(unsigned int));
+                    qWarning() << "pixel" << baPixel.size() << "0x" << baPixel.toHex();
+                    QByteArray baWrittenPixel((char*)&writtenPixel, sizeof(unsigned int));
+                    qWarning() << "writtenPixel" << baWrittenPixel.size() << "0x" << baWrittenPixel.toHex();
+                    Q_ASSERT(false);
+                }
+            }
+        }
+    }
+
+    m_pendingWrites->release();
+}
+
 class TileCreatorPrivate
 {
  public:
@@ -42,7 +103,9 @@ class TileCreatorPrivate
          m_tileFormat( "jpg" ),
          m_resume( false ),
          m_verify( false ),
-         m_source( source )
+         m_source( source ),
+         m_writerPool(),
+         m_pendingWrites( 4 * QThread::idealThreadCount() )
      {
         if ( m_dem == "true" ) {
             m_tileQuality = 70;
@@ -53,9 +116,24 @@ class TileCreatorPrivate
 
     ~TileCreatorPrivate()
     {
+        m_writerPool.waitForDone();
         delete m_source;
     }
 
+    QString tileName( int tileLevel, int n, int m ) const;
+
+    /**
+     * Hands the tile over to the writer pool. Blocks while too many tiles
+     * are waiting to be written, which limits the memory held by the queue.
+     */
+    void writeTile( const QImage &tile, const QString &tileName );
+
+    /**
+     * Creates a tile from its four children, each scaled down by a factor of two.
+     */
+    QImage mergeTiles( const QImage &topLeft, const QImage &topRight,
+                       const QImage &bottomLeft, const QImage &bottomRight ) const;
+
  public:
     QString  m_dem;
     QString  m_targetDir;
@@ -66,24 +144,114 @@ class TileCreatorPrivate
     bool     m_verify;
 
     TileCreatorSource  *m_source;
+
+    QVector<QRgb> m_grayScalePalette;
+    QThreadPool m_writerPool;
+    QSemaphore m_pendingWrites;
 };
 
+QString TileCreatorPrivate::tileName( int tileLevel, int n, int m ) const
+{
+    return m_targetDir + ( QString("%1/%2/%2_%3.%4")
+                           .arg( tileLevel )
+                           .arg( n, tileDigits, 10, QChar('0') )
+                           .arg( m, tileDigits, 10, QChar('0') ) )
+                           .arg( m_tileFormat );
+}
+
+void TileCreatorPrivate::writeTile( const QImage &tile, const QString &tileName )
+{
+    mDebug() << tileName;
+
+    m_pendingWrites.acquire();
+    m_writerPool.start( new TileWriteJob( tile, tileName, m_tileFormat.toLatin1(),
+                                          m_tileQuality, m_verify, &m_pendingWrites ) );
+}
+
+QImage TileCreatorPrivate::mergeTiles( const QImage &topLeft, const QImage &topRight,
+                                       const QImage &bottomLeft, const QImage &bottomRight ) const
+{
+    const QImage *const children[4] = { &topLeft, &topRight, &bottomLeft, &bottomRight };
+    const uint half = c_defaultTileSize / 2;
+
+    QImage tile;
+
+    if ( m_dem == "true" ) {
+        tile = QImage( c_defaultTileSize, c_defaultTileSize, QImage::Format_Indexed8 );
+        tile.setColorTable( m_grayScalePalette );
+
+        for ( int i = 0; i < 4; ++i ) {
+            const QImage child = children[i]->format() == QImage::Format_Indexed8
+                                 ? *children[i]
+                                 : children[i]->convertToFormat( QImage::Format_Indexed8,
+                                                                 m_grayScalePalette,
+                                                                 Qt::ThresholdDither );
+            const uint xOffset = ( i % 2 ) * half;
+            const uint yOffset = ( i / 2 ) * half;
+            const uint width = xOffset ? c_defaultTileSize - half : half;
+            const uint height = yOffset ? c_defaultTileSize - half : half;
+            for ( uint y = 0; y < height; ++y ) {
+                uchar* destLine = tile.scanLine( yOffset + y ) + xOffset;
+                const uchar* srcLine = child.scanLine( 2 * y );
+                for ( uint x = 0; x < width; ++x )
+                    destLine[x] = srcLine[ 2 * x ];
+            }
+        }
+    }
+    else {
+        tile = QImage( c_defaultTileSize, c_defaultTileSize, QImage::Format_ARGB32 );
+
+        for ( int i = 0; i < 4; ++i ) {
+            const QImage child = children[i]->convertToFormat( QImage::Format_ARGB32 );
+            const uint xOffset = ( i % 2 ) * half;
+            const uint yOffset = ( i / 2 ) * half;
+            const uint width = xOffset ? c_defaultTileSize - half : half;
+            const uint height = yOffset ? c_defaultTileSize - half : half;
+            for ( uint y = 0; y < height; ++y ) {
+                QRgb* destLine = (QRgb*) tile.scanLine( yOffset + y ) + xOffset;
+                const QRgb* srcLine = (const QRgb*) child.scanLine( 2 * y );
+                for ( uint x = 0; x < width; ++x )
+                    destLine[x] = srcLine[ 2 * x ];
+            }
+        }
+    }
+
+    return tile;
+}
+
 class TileCreatorSourceImage : public TileCreatorSource
 {
 public:
     TileCreatorSourceImage( const QString &sourcePath )
-        : m_sourceImage( QImage( sourcePath ) ),
+        : m_sourcePath( sourcePath ),
+          m_streaming( false ),
           m_cachedRowNum( -1 )
     {
+        // Read the source image band by band if the image format supports
+        // it, so that huge images don't need to be held in memory at once.
+        // JPEG supports clip rects as well, but decodes the image from the
+        // top for each of them, which makes reading all bands quadratic in
+        // their number. JPEG images are therefore decoded once as a whole.
+        QImageReader reader( sourcePath );
+        m_imageSize = reader.size();
+        const QByteArray format = reader.format().toLower();
+        const bool sequential = format == "jpeg" || format == "jpg";
+        m_streaming = m_imageSize.isValid() && !sequential
+                      && reader.supportsOption( QImageIOHandler::ClipRect );
+
+        if ( !m_streaming ) {
+            m_sourceImage = reader.read();
+            m_imageSize = m_sourceImage.size();
+        }
     }
 
     virtual QSize fullImageSize() const
     {
-        if ( m_sourceImage.size().width() > 21600 || m_sourceImage.height() > 10800 ) {
+        if ( !m_streaming && ( m_imageSize.width() > 21600 || m_imageSize.height() > 10800 ) ) {
             qDebug("Install map too large!");
             return QSize();
         }
-        return m_sourceImage.size();
+        return m_imageSize;
     }
 
     virtual QImage tile(int n, int m, int maxTileLevel)
@@ -91,8 +259,8 @@ public:
         int  mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, maxTileLevel );
         int  nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, maxTileLevel );
 
-        int imageHeight = m_sourceImage.height();
-        int imageWidth = m_sourceImage.width();
+        int imageHeight = m_imageSize.height();
+        int imageWidth = m_imageSize.width();
 
         // If the image size of the image source does not match the expected
         // geometry we need to smooth-scale the image in advance to match
@@ -124,8 +292,14 @@ public:
             QRect   sourceRowRect( 0, (int)( (qreal)( n * imageHeight ) / (qreal)( nmax )),
                                 imageWidth,(int)( (qreal)( imageHeight ) / (qreal)( nmax ) ) );
 
-
-            row = m_sourceImage.copy( sourceRowRect );
+            if ( m_streaming ) {
+                QImageReader reader( m_sourcePath );
+                reader.setClipRect( sourceRowRect );
+                row = reader.read();
+            }
+            else {
+                row = m_sourceImage.copy( sourceRowRect );
+            }
 
             if ( needsScaling ) {
                 // Pick the current row and smooth scale it
@@ -151,6 +325,11 @@ public:
     }
 
 private:
+    const QString m_sourcePath;
+    QSize m_imageSize;
+    bool m_streaming;
+
+    // only used if parts of the image cannot be read efficiently
     QImage m_sourceImage;
 
     QImage m_rowCache;
@@ -212,19 +391,14 @@ void TileCreator::cancelTileCreation()
 
 void TileCreator::run()
 {
-    if ( d->m_resume && d->m_tileFormat == "jpg" && d->m_tileQuality != 100 ) {
-        qWarning() << "Resuming jpegs is only supported with tileQuality 100";
-        return;
-    }
-
     if ( !d->m_targetDir.endsWith('/') )
         d->m_targetDir += '/';
 
     mDebug() << "Installing tiles to: " << d->m_targetDir;
 
-    QVector<QRgb> grayScalePalette;
+    d->m_grayScalePalette.clear();
     for ( int cnt = 0; cnt <= 255; ++cnt ) {
-        grayScalePalette.insert(cnt, qRgb(cnt, cnt, cnt));
+        d->m_grayScalePalette.insert(cnt, qRgb(cnt, cnt, cnt));
     }
 
     QSize fullImageSize = d->m_source->fullImageSize();
@@ -267,6 +441,16 @@ void TileCreator::run()
     while ( tileLevel <= maxTileLevel ) {
         totalTileCount += ( TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel )
                             * TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel ) );
+
+        // Creating directory structure
+        int  nmaxit = TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
+        for ( int n = 0; n < nmaxit; ++n ) {
+            QString dirName( d->m_targetDir
+                             + QString("%1/%2").arg( tileLevel ).arg( n, tileDigits, 10, QChar('0') ) );
+            if ( !QDir( dirName ).exists() )
+                ( QDir::root() ).mkpath( dirName );
+        }
+
         tileLevel++;
     }
 
@@ -275,42 +459,37 @@ void TileCreator::run()
     int  mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, maxTileLevel );
     int  nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, maxTileLevel );
 
-    // Loading each row at highest spatial resolution and cropping tiles
     int      percentCompleted = 0;
     int      createdTilesCount = 0;
-    QString  tileName;
+    QTime    time;
+    time.start();
 
-    // Creating directory structure for the highest level
-    QString  dirName( d->m_targetDir
-                      + QString("%1").arg(maxTileLevel) );
-    if ( !QDir( dirName ).exists() ) 
-        ( QDir::root() ).mkpath( dirName );
+    // The tiles of each level are kept in memory until the row next to them
+    // is complete, so the level above can be built from them without
+    // reading them back from disk. At each level this holds at most
+    // two rows of tiles.
+    QVector< QVector<QImage> > pendingRows( maxTileLevel + 1 );
 
+    // Loading each row at highest spatial resolution and cropping tiles
     for ( int n = 0; n < nmax; ++n ) {
-        QString dirName( d->m_targetDir
-                         + QString("%1/%2").arg(maxTileLevel).arg( n, tileDigits, 10, QChar('0') ) );
-        if ( !QDir( dirName ).exists() ) 
-            ( QDir::root() ).mkpath( dirName );
-    }
 
-    for ( int n = 0; n < nmax; ++n ) {
+        QVector<QImage> row( mmax );
 
         for ( int m = 0; m < mmax; ++m ) {
 
             mDebug() << "** tile" << m << "x" << n;
 
-            if ( d->m_cancelled ) 
+            if ( d->m_cancelled ) {
+                d->m_writerPool.waitForDone();
                 return;
+            }
 
-            tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                       .arg( maxTileLevel )
-                                       .arg( n, tileDigits, 10, QChar('0') )
-                                       .arg( m, tileDigits, 10, QChar('0') ) )
-                                       .arg( d->m_tileFormat );
+            const QString tileName = d->tileName( maxTileLevel, n, m );
 
             if ( QFile::exists( tileName ) && d->m_resume ) {
 
                 //mDebug() << tileName << "exists already";
+                row[m] = QImage( tileName );
 
             } else {
 
@@ -318,260 +497,97 @@ void TileCreator::run()
 
                 if ( tile.isNull() ) {
                     mDebug() << "Read-Error! Null QImage!";
+                    d->m_writerPool.waitForDone();
                     return;
                 }
 
                 if ( d->m_dem == "true" ) {
                     tile = tile.convertToFormat(QImage::Format_Indexed8,
-                                                grayScalePalette,
+                                                d->m_grayScalePalette,
                                                 Qt::ThresholdDither);
                 }
 
-                bool  ok = tile.save( tileName, d->m_tileFormat.toLatin1().data(), d->m_tileFormat == "jpg" ? 100 : d->m_tileQuality );
-                if ( !ok )
-                    mDebug() << "Error while writing Tile: " << tileName;
-
-                mDebug() << tileName << "size" << QFile( tileName ).size();
-
-                if ( d->m_verify ) {
-                    QImage writtenTile(tileName);
-                    Q_ASSERT( writtenTile.size() == tile.size() );
-                    for ( int i=0; i < writtenTile.size().width(); ++i) {
-                        for ( int j=0; j < writtenTile.size().height(); ++j) {
-                            if ( writtenTile.pixel( i, j ) != tile.pixel( i, j ) ) {
-                                unsigned int  pixel = tile.pixel( i, j);
-                                unsigned int  writtenPixel = writtenTile.pixel( i, j);
-                                qWarning() << "***** pixel" << i << j << "is off by" << (pixel - writtenPixel) << "pixel" << pixel << "writtenPixel" << writtenPixel;
-                                QByteArray baPixel((char*)&pixel, sizeof(unsigned int));
-                                qWarning() << "pixel" << baPixel.size() << "0x" << baPixel.toHex();
-                                QByteArray baWrittenPixel((char*)&writtenPixel, sizeof(unsigned int));
-                                qWarning() << "writtenPixel" << baWrittenPixel.size() << "0x" << baWrittenPixel.toHex();
-                                Q_ASSERT(false);
-                            }
-                        }
-                    }
-                }
-
+                d->writeTile( tile, tileName );
+                row[m] = tile;
             }
 
-            percentCompleted =  (int) ( 90 * (qreal)(createdTilesCount) 
-                                        / (qreal)(totalTileCount) );	
+            percentCompleted =  (int) ( 99 * (qreal)(createdTilesCount)
+                                        / (qreal)(totalTileCount) );
             createdTilesCount++;
 
             mDebug() << "percentCompleted" << percentCompleted;
             emit progress( percentCompleted );
         }
-    }
-
-    mDebug() << "tileLevel: " << maxTileLevel << " successfully created.";
-
-    tileLevel = maxTileLevel;
-
-    // Now that we have the tiles at the highest resolution lets build
-    // them together four by four.
 
-    while( tileLevel > 0 ) {
-        tileLevel--;
+        // Now build the tiles of the levels above four by four as soon
+        // as both rows below them are available.
+        int rowLevel = maxTileLevel;
+        int rowNumber = n;
+        while ( rowLevel > 0 && rowNumber % 2 == 1 ) {
+            const QVector<QImage> &upperRow = pendingRows[rowLevel];
+            const int parentLevel = rowLevel - 1;
+            const int parentRowNumber = rowNumber / 2;
+            const int mmaxit = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, parentLevel );
 
-        int  nmaxit =  TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
+            QVector<QImage> parentRow( mmaxit );
 
-        for ( int n = 0; n < nmaxit; ++n ) {
-            QString  dirName( d->m_targetDir
-                              + ( QString("%1/%2")
-                                  .arg(tileLevel)
-                                  .arg( n, tileDigits, 10, QChar('0') ) ) );
-
-            // mDebug() << "dirName: " << dirName;
-            if ( !QDir( dirName ).exists() ) 
-                ( QDir::root() ).mkpath( dirName );
-
-            int   mmaxit = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
             for ( int m = 0; m < mmaxit; ++m ) {
 
-                if ( d->m_cancelled )
+                if ( d->m_cancelled ) {
+                    d->m_writerPool.waitForDone();
                     return;
+                }
 
-                QString newTileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                           .arg( tileLevel )
-                                           .arg( n, tileDigits, 10, QChar('0') )
-                                           .arg( m, tileDigits, 10, QChar('0') ) )
-                                           .arg( d->m_tileFormat );
+                const QString newTileName = d->tileName( parentLevel, parentRowNumber, m );
 
                 if ( QFile::exists( newTileName ) && d->m_resume ) {
                     //mDebug() << newTileName << "exists already";
+                    parentRow[m] = QImage( newTileName );
                 } else {
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_topleft( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m+1, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_topright( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n+1, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_bottomleft( tileName );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n+1, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m+1, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_bottomright( tileName );
-
                     QSize const expectedSize( c_defaultTileSize, c_defaultTileSize );
-                    if ( img_topleft.size() != expectedSize ||
-                         img_topright.size() != expectedSize ||
-                         img_bottomleft.size() != expectedSize ||
-                         img_bottomright.size() != expectedSize ) {
-                        mDebug() << "Tile write failure. Missing write permissions?";
+                    if ( upperRow[2*m].size() != expectedSize ||
+                         upperRow[2*m+1].size() != expectedSize ||
+                         row[2*m].size() != expectedSize ||
+                         row[2*m+1].size() != expectedSize ) {
+                        mDebug() << "Tile read failure. Corrupt tiles from previous run?";
+                        d->m_writerPool.waitForDone();
                         emit progress( 100 );
                         return;
                     }
-                    QImage  tile = img_topleft;
-
-                    if ( d->m_dem == "true" ) {
-
-                        tile.setColorTable( grayScalePalette );
-                        uchar* destLine;
-
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_topleft.scanLine( 2 * y );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2*x ];
-                        }
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_topright.scanLine( 2 * y );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_bottomleft.scanLine( 2 * ( y - c_defaultTileSize / 2 ) );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[ x ] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_bottomright.scanLine( 2 * ( y - c_defaultTileSize/2 ) );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                    }
-                    else {
-
-                        // tile.depth() != 8
-
-                        img_topleft = img_topleft.convertToFormat( QImage::Format_ARGB32 );
-                        img_topright = img_topright.convertToFormat( QImage::Format_ARGB32 );
-                        img_bottomleft = img_bottomleft.convertToFormat( QImage::Format_ARGB32 );
-                        img_bottomright = img_bottomright.convertToFormat( QImage::Format_ARGB32 );
-                        tile = img_topleft;
-
-                        QRgb* destLine;
-
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_topleft.scanLine( 2 * y );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_topright.scanLine( 2 * y );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_bottomleft.scanLine( 2 * ( y-c_defaultTileSize/2 ) );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_bottomright.scanLine( 2 * ( y-c_defaultTileSize / 2 ) );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2*( x-c_defaultTileSize / 2 ) ];
-                        }
-                    }
-
-                    mDebug() << newTileName;
 
-                    // Saving at 100% JPEG quality to have a high-quality
-                    // version to create the remaining needed tiles from.
-                    bool  ok = tile.save( newTileName, d->m_tileFormat.toLatin1().data(), d->m_tileFormat == "jpg" ? 100 : d->m_tileQuality );
-                    if ( ! ok )
-                        mDebug() << "Error while writing Tile: " << newTileName;
+                    const QImage tile = d->mergeTiles( upperRow[2*m], upperRow[2*m+1],
+                                                       row[2*m], row[2*m+1] );
+                    d->writeTile( tile, newTileName );
+                    parentRow[m] = tile;
                 }
 
-                percentCompleted =  (int) ( 90 * (qreal)(createdTilesCount)
-                                            / (qreal)(totalTileCount) );	
+                percentCompleted =  (int) ( 99 * (qreal)(createdTilesCount)
+                                            / (qreal)(totalTileCount) );
                 createdTilesCount++;
-						
+
                 emit progress( percentCompleted );
                 mDebug() << "percentCompleted" << percentCompleted;
             }
-        }
-        mDebug() << "tileLevel: " << tileLevel << " successfully created.";
-    }
-    mDebug() << "Tile creation completed.";
-
-    if ( d->m_tileFormat == "jpg" && d->m_tileQuality != 100 ) {
-
-        // Applying correct lower JPEG compression now that we created all tiles
-        int savedTilesCount = 0;
 
-        tileLevel = 0;
-        while ( tileLevel <= maxTileLevel ) {
-            int nmaxit =  TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
-            for ( int n = 0; n < nmaxit; ++n) {
-                int mmaxit =  TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
-                for ( int m = 0; m < mmaxit; ++m) {
-
-                    if ( d->m_cancelled )
-                        return;
+            pendingRows[rowLevel].clear();
+            row = parentRow;
+            rowLevel = parentLevel;
+            rowNumber = parentRowNumber;
+        }
 
-                    savedTilesCount++;
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel )
-                                            .arg( n, tileDigits, 10, QChar('0') )
-                                            .arg( m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage tile( tileName );
-
-                    bool ok;
-
-                    ok = tile.save( tileName, d->m_tileFormat.toLatin1().data(), d->m_tileQuality );
-
-                    if ( !ok )
-                        mDebug() << "Error while writing Tile: " << tileName;
-                    // Don't exceed 99% as this would cancel the thread unexpectedly
-                    percentCompleted = 90 + (int)( 9 * (qreal)(savedTilesCount)
-                                                / (qreal)(totalTileCount) );
-                    emit progress( percentCompleted );
-                    mDebug() << "percentCompleted" << percentCompleted;
-                    //mDebug() << "Saving Tile #" << savedTilesCount
-                    //         << " of " << totalTileCount
-                    //         << " Percent: " << percentCompleted;
-                }
-            }
-            tileLevel++;
+        if ( rowLevel > 0 ) {
+            pendingRows[rowLevel] = row;
         }
     }
 
+    // Wait for the remaining tiles to be written
+    d->m_writerPool.waitForDone();
+
+    const int elapsed = qMax( 1, time.elapsed() );
+    mDebug() << "Tile creation completed:" << createdTilesCount << "tiles in"
+             << elapsed / 1000.0 << "s," << createdTilesCount * 1000.0 / elapsed << "tiles/s using"
+             << d->m_writerPool.maxThreadCount() << "writer threads";
+
     percentCompleted = 100;
     emit progress( percentCompleted );
 
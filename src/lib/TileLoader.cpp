@@ -46,6 +46,8 @@ TileLoader::TileLoader(HttpDownloadManager * const downloadManager, const Plugin
     qRegisterMetaType<DownloadUsage>( "DownloadUsage" );
     connect( this, SIGNAL(downloadTile(QUrl,QString,QString,DownloadUsage)),
              downloadManager, SLOT(addJob(QUrl,QString,QString,DownloadUsage)));
+    connect( this, SIGNAL(visibleTilesChanged(QStringList,QList<TileId>)),
+             downloadManager, SLOT(setVisibleTiles(QStringList,QList<TileId>)));
     connect( downloadManager, SIGNAL(downloadComplete(QByteArray,QString)),
              SLOT(updateTile(QByteArray,QString)));
 }
@@ -135,6 +137,17 @@ void TileLoader::downloadTile( GeoSceneTiled const *textureLayer, TileId const &
     triggerDownload( textureLayer, tileId, usage );
 }
 
+void TileLoader::setVisibleTiles( QVector<GeoSceneTextureTile const *> const &textureLayers,
+                                  QList<TileId> const &visibleTiles )
+{
+    QStringList sourceDirs;
+    foreach ( GeoSceneTextureTile const *textureLayer, textureLayers ) {
+        sourceDirs << textureLayer->sourceDir();
+    }
+
+    emit visibleTilesChanged( sourceDirs, visibleTiles );
+}
+
 int TileLoader::maximumTileLevel( GeoSceneTiled const & texture )
 {
     // if maximum tile level is configured in the DGML files,
@@ -22,7 +22,9 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QImage>
+#include <QVector>
 
 #include "TileId.h"
 #include "GeoDataContainer.h"
@@ -58,6 +60,14 @@ class TileLoader: public QObject
     GeoDataDocument* loadTileVectorData( GeoSceneVectorTile const *textureLayer, TileId const & tileId, DownloadUsage const usage );
     void downloadTile( GeoSceneTiled const *textureLayer, TileId const &, DownloadUsage const );
 
+    /**
+     * Lets the download manager prefer the downloads of the tiles of
+     * @p textureLayers close to the view center and drop downloads of
+     * tiles that are not in @p visibleTiles anymore.
+     */
+    void setVisibleTiles( QVector<GeoSceneTextureTile const *> const &textureLayers,
+                          QList<TileId> const &visibleTiles );
+
     static int maximumTileLevel( GeoSceneTiled const & texture );
 
     /**
@@ -81,6 +91,8 @@ class TileLoader: public QObject
     void downloadTile( QUrl const & sourceUrl, QString const & destinationFileName,
                        QString const & id, DownloadUsage );
 
+    void visibleTilesChanged( QStringList const & sourceDirs, QList<TileId> const & visibleTiles );
+
     void tileCompleted( TileId const & tileId, QImage const & tileImage );
 
     void tileCompleted( TileId const & tileId, GeoDataDocument * document, QString const & format );
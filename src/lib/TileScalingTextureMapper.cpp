@@ -23,7 +23,6 @@
 #include "GeoPainter.h"
 #include "ScanlineTextureMapperContext.h"
 #include "StackedTileLoader.h"
-#include "TextureColorizer.h"
 #include "TileLoaderHelper.h"
 #include "StackedTile.h"
 #include "MathHelper.h"
@@ -47,13 +46,12 @@ TileScalingTextureMapper::TileScalingTextureMapper( StackedTileLoader *tileLoade
 void TileScalingTextureMapper::mapTexture( GeoPainter *painter,
                                            const ViewportParams *viewport,
                                            int tileZoomLevel,
-                                           const QRect &dirtyRect,
-                                           TextureColorizer *texColorizer )
+                                           const QRect &dirtyRect )
 {
     if ( viewport->radius() <= 0 )
         return;
 
-    if ( texColorizer || m_radius != viewport->radius() ) {
+    if ( m_radius != viewport->radius() ) {
         if ( m_canvasImage.size() != viewport->size() || m_radius != viewport->radius() ) {
             const QImage::Format optimalFormat = ScanlineTextureMapperContext::optimalCanvasImageFormat( viewport );
 
@@ -69,7 +67,7 @@ void TileScalingTextureMapper::mapTexture( GeoPainter *painter,
         }
 
         if ( m_repaintNeeded ) {
-            mapTexture( painter, viewport, tileZoomLevel, texColorizer );
+            mapTexture( painter, viewport, tileZoomLevel );
 
             m_radius = viewport->radius();
             m_repaintNeeded = false;
@@ -77,13 +75,13 @@ void TileScalingTextureMapper::mapTexture( GeoPainter *painter,
 
         painter->drawImage( dirtyRect, m_canvasImage, dirtyRect );
     } else {
-        mapTexture( painter, viewport, tileZoomLevel, texColorizer );
+        mapTexture( painter, viewport, tileZoomLevel );
 
         m_radius = viewport->radius();
     }
 }
 
-void TileScalingTextureMapper::mapTexture( GeoPainter *painter, const ViewportParams *viewport, int tileZoomLevel, TextureColorizer *texColorizer )
+void TileScalingTextureMapper::mapTexture( GeoPainter *painter, const ViewportParams *viewport, int tileZoomLevel )
 {
     const int imageHeight = viewport->height();
     const int imageWidth  = viewport->width();
@@ -118,7 +116,7 @@ void TileScalingTextureMapper::mapTexture( GeoPainter *painter, const ViewportPa
         m_cache.clear();
     }
 
-    if ( texColorizer || m_radius != radius ) {
+    if ( m_radius != radius ) {
         QPainter imagePainter( &m_canvasImage );
         imagePainter.setRenderHint( QPainter::SmoothPixmapTransform, highQuality );
 
@@ -147,10 +145,6 @@ void TileScalingTextureMapper::mapTexture( GeoPainter *painter, const ViewportPa
                 imagePainter.drawImage( rect, part );
             }
         }
-
-        if ( texColorizer ) {
-            texColorizer->colorize( &m_canvasImage, viewport, painter->mapQuality() );
-        }
     } else {
         painter->save();
         painter->setRenderHint( QPainter::SmoothPixmapTransform, highQuality );
@@ -34,8 +34,7 @@ class TileScalingTextureMapper : public QObject, public TextureMapperInterface
     virtual void mapTexture( GeoPainter *painter,
                              const ViewportParams *viewport,
                              int tileZoomLevel,
-                             const QRect &dirtyRect,
-                             TextureColorizer *texColorizer );
+                             const QRect &dirtyRect );
 
  private Q_SLOTS:
     void removePixmap( const TileId &tileId );
@@ -44,8 +43,7 @@ class TileScalingTextureMapper : public QObject, public TextureMapperInterface
  private:
     void mapTexture( GeoPainter *painter,
                      const ViewportParams *viewport,
-                     int tileZoomLevel,
-                     TextureColorizer *texColorizer );
+                     int tileZoomLevel );
 
  private:
     StackedTileLoader *const m_tileLoader;
@@ -22,10 +22,28 @@
 #include "TileLoader.h"
 
 #include <qmath.h>
+#include <QPair>
 #include <QThreadPool>
+#include <QtAlgorithms>
 
 using namespace Marble;
 
+namespace
+{
+
+// parsed tiles kept in memory, including the ones of other zoom levels
+const int maximumCachedTiles = 256;
+
+// tiles are added to the tree model at most that often, in milliseconds
+const int pendingInterval = 100;
+
+bool moreDistant( const QPair<qreal, TileId> &one, const QPair<qreal, TileId> &two )
+{
+    return one.first > two.first;
+}
+
+}
+
 TileRunner::TileRunner( TileLoader *loader, const GeoSceneVectorTile *texture, const TileId &id ) :
     m_loader( loader ),
     m_texture( texture ),
@@ -42,7 +60,8 @@ void TileRunner::run()
 
 VectorTileModel::CacheDocument::CacheDocument( GeoDataDocument *doc, GeoDataTreeModel *model ) :
     m_document( doc ),
-    m_treeModel( model )
+    m_treeModel( model ),
+    m_inTreeModel( false )
 {
     // nothing to do
 }
@@ -50,7 +69,9 @@ VectorTileModel::CacheDocument::CacheDocument( GeoDataDocument *doc, GeoDataTree
 VectorTileModel::CacheDocument::~CacheDocument()
 {
     Q_ASSERT( m_treeModel );
-    m_treeModel->removeDocument( m_document );
+    if ( m_inTreeModel ) {
+        m_treeModel->removeDocument( m_document );
+    }
     delete m_document;
 }
 
@@ -59,8 +80,20 @@ VectorTileModel::VectorTileModel( TileLoader *loader, const GeoSceneVectorTile *
     m_layer( layer ),
     m_treeModel( treeModel ),
     m_threadPool( threadPool ),
-    m_tileZoomLevel( -1 )
+    m_tileZoomLevel( -1 ),
+    m_minTileX( 0 ),
+    m_minTileY( 0 ),
+    m_maxTileX( 0 ),
+    m_maxTileY( 0 )
+{
+    m_pendingTimer.setSingleShot( true );
+    m_pendingTimer.setInterval( pendingInterval );
+    connect( &m_pendingTimer, SIGNAL(timeout()), this, SLOT(addPendingDocuments()) );
+}
+
+VectorTileModel::~VectorTileModel()
 {
+    qDeleteAll( m_documents );
 }
 
 void VectorTileModel::setViewport( const GeoDataLatLonBox &bbox, int radius )
@@ -88,10 +121,10 @@ void VectorTileModel::setViewport( const GeoDataLatLonBox &bbox, int radius )
     if ( tileZoomLevel > m_layer->maximumTileLevel() )
         tileZoomLevel = m_layer->maximumTileLevel();
 
-    // if zoom level has changed, empty vectortile cache
+    // if zoom level has changed, only show the tiles of the new level
     if ( tileZoomLevel != m_tileZoomLevel ) {
         m_tileZoomLevel = tileZoomLevel;
-        m_documents.clear();
+        hideOtherZoomLevels();
     }
 
     const unsigned int maxTileX = ( 1 << tileZoomLevel ) * m_layer->levelZeroColumns();
@@ -119,6 +152,11 @@ void VectorTileModel::setViewport( const GeoDataLatLonBox &bbox, int radius )
                               qMin<unsigned int>( lat2tileY( bbox.south(GeoDataCoordinates::Degree), maxTileY ),
                                     maxTileY ) );
 
+    m_minTileX = minX;
+    m_minTileY = minY;
+    m_maxTileX = maxX;
+    m_maxTileY = maxY;
+
     bool left  = minX < maxTileX;
     bool right = maxX > 0;
     bool up    = minY < maxTileY;
@@ -152,22 +190,106 @@ QString VectorTileModel::name() const
     return m_layer->name();
 }
 
+int VectorTileModel::cachedTileCount() const
+{
+    return m_documents.size();
+}
+
 void VectorTileModel::updateTile( const TileId &id, GeoDataDocument *document )
 {
-    if ( m_tileZoomLevel != id.zoomLevel() ) {
+    if ( !m_runningTiles.remove( id ) ) {
+        // cleared while it was parsed
         delete document;
         return;
     }
 
-    m_treeModel->addDocument( document );
+    delete m_documents.take( id );
     m_documents.insert( id, new CacheDocument( document, m_treeModel ) );
+
+    if ( id.zoomLevel() == m_tileZoomLevel ) {
+        m_pendingTiles << id;
+        if ( !m_pendingTimer.isActive() ) {
+            m_pendingTimer.start();
+        }
+    }
+
+    evictDocuments();
 }
 
 void VectorTileModel::clear()
 {
+    m_pendingTimer.stop();
+    m_pendingTiles.clear();
+    m_runningTiles.clear();
+    qDeleteAll( m_documents );
     m_documents.clear();
 }
 
+void VectorTileModel::addPendingDocuments()
+{
+    QList<GeoDataDocument *> documents;
+    foreach ( const TileId &id, m_pendingTiles ) {
+        CacheDocument *const cached = m_documents.value( id, 0 );
+        if ( cached && !cached->m_inTreeModel && id.zoomLevel() == m_tileZoomLevel ) {
+            cached->m_inTreeModel = true;
+            documents << cached->m_document;
+        }
+    }
+    m_pendingTiles.clear();
+
+    m_treeModel->addDocuments( documents );
+}
+
+void VectorTileModel::hideOtherZoomLevels()
+{
+    QHash<TileId, CacheDocument *>::const_iterator it = m_documents.constBegin();
+    for ( ; it != m_documents.constEnd(); ++it ) {
+        CacheDocument *const cached = it.value();
+        if ( cached->m_inTreeModel && it.key().zoomLevel() != m_tileZoomLevel ) {
+            m_treeModel->removeDocument( cached->m_document );
+            cached->m_inTreeModel = false;
+        }
+    }
+}
+
+qreal VectorTileModel::evictionDistance( const TileId &id ) const
+{
+    // the center of the tile in tiles of the current zoom level
+    const qreal scale = qPow( 2.0, m_tileZoomLevel - id.zoomLevel() );
+    const qreal x = ( id.x() + 0.5 ) * scale;
+    const qreal y = ( id.y() + 0.5 ) * scale;
+
+    const qreal dx = qMax<qreal>( 0.0, qMax( m_minTileX - x, x - ( m_maxTileX + 1 ) ) );
+    const qreal dy = qMax<qreal>( 0.0, qMax( m_minTileY - y, y - ( m_maxTileY + 1 ) ) );
+
+    // zooming by one level is about as likely as panning by a few tiles
+    return qMax( dx, dy ) + 4.0 * qAbs( id.zoomLevel() - m_tileZoomLevel );
+}
+
+void VectorTileModel::evictDocuments()
+{
+    if ( m_documents.size() <= maximumCachedTiles ) {
+        return;
+    }
+
+    QList<QPair<qreal, TileId> > candidates;
+    QHash<TileId, CacheDocument *>::const_iterator it = m_documents.constBegin();
+    for ( ; it != m_documents.constEnd(); ++it ) {
+        const qreal distance = evictionDistance( it.key() );
+        if ( distance > 0.0 ) {
+            // never drop tiles in view
+            candidates << qMakePair( distance, it.key() );
+        }
+    }
+
+    qSort( candidates.begin(), candidates.end(), moreDistant );
+
+    const int count = qMin( m_documents.size() - maximumCachedTiles, candidates.size() );
+    for ( int i = 0; i < count; ++i ) {
+        delete m_documents.take( candidates.at( i ).second );
+    }
+}
+
 void VectorTileModel::setViewport( int tileZoomLevel,
                                    unsigned int minTileX, unsigned int minTileY, unsigned int maxTileX, unsigned int maxTileY )
 {
@@ -176,15 +298,20 @@ void VectorTileModel::setViewport( int tileZoomLevel,
         for ( unsigned int y = minTileY; y <= maxTileY; ++y ) {
            const TileId tileId = TileId( 0, tileZoomLevel, x, y );
 
-           if ( !m_documents.contains( tileId ) ) {
-               GeoDataDocument *const document = new GeoDataDocument;
-
+           CacheDocument *const cached = m_documents.value( tileId, 0 );
+           if ( cached ) {
+               // parsed before, possibly on another zoom level
+               if ( !cached->m_inTreeModel && !m_pendingTiles.contains( tileId ) ) {
+                   m_pendingTiles << tileId;
+                   if ( !m_pendingTimer.isActive() ) {
+                       m_pendingTimer.start();
+                   }
+               }
+           } else if ( !m_runningTiles.contains( tileId ) ) {
+               m_runningTiles.insert( tileId );
                TileRunner *job = new TileRunner( m_loader, m_layer, tileId );
                connect( job, SIGNAL(documentLoaded(TileId,GeoDataDocument*)), this, SLOT(updateTile(TileId,GeoDataDocument*)) );
                m_threadPool->start( job );
-
-               m_treeModel->addDocument( document );
-               m_documents.insert( tileId, new CacheDocument( document, m_treeModel ) );
            }
         }
     }
@@ -15,7 +15,10 @@
 #include <QObject>
 #include <QRunnable>
 
-#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QTimer>
 
 #include "TileId.h"
 
@@ -47,6 +50,18 @@ private:
     const TileId m_id;
 };
 
+/**
+ * Loads the vector tiles of a layer that cover the viewport into the tree model.
+ *
+ * Parsed tiles are kept in memory across zoom levels, so zooming back to an
+ * area that was shown recently only needs to put its tiles back into the tree
+ * model. When the cache grows beyond its size, the tiles furthest away from
+ * the viewport, in zoom levels and in position, are dropped first.
+ *
+ * Tiles are parsed in the thread pool. The parsed documents are collected for
+ * a moment and added to the tree model together, which lets views and layers
+ * update once for several tiles.
+ */
 class VectorTileModel : public QObject
 {
     Q_OBJECT
@@ -54,10 +69,15 @@ class VectorTileModel : public QObject
 public:
     explicit VectorTileModel( TileLoader *loader, const GeoSceneVectorTile *layer, GeoDataTreeModel *treeModel, QThreadPool *threadPool );
 
+    ~VectorTileModel();
+
     void setViewport( const GeoDataLatLonBox &bbox, int radius );
 
     QString name() const;
 
+    /** The number of parsed tiles kept in memory, including tiles of other zoom levels */
+    int cachedTileCount() const;
+
 public Q_SLOTS:
     void updateTile( const TileId &id, GeoDataDocument *document );
 
@@ -66,23 +86,35 @@ public Q_SLOTS:
 Q_SIGNALS:
     void tileCompleted( const TileId &tileId );
 
+private Q_SLOTS:
+    void addPendingDocuments();
+
 private:
     void setViewport( int tileZoomLevel, unsigned int minX, unsigned int minY, unsigned int maxX, unsigned int maxY );
 
     unsigned int lon2tileX( qreal lon, unsigned int maxTileX );
     unsigned int lat2tileY( qreal lat, unsigned int maxTileY );
 
+    /** Removes the documents of other zoom levels from the tree model, keeping them cached */
+    void hideOtherZoomLevels();
+
+    /** How far @p id is from the viewport. Higher values are evicted first. */
+    qreal evictionDistance( const TileId &id ) const;
+
+    void evictDocuments();
+
 private:
     struct CacheDocument
     {
         /** The CacheDocument takes ownership of doc */
         CacheDocument( GeoDataDocument *doc, GeoDataTreeModel *model );
 
-        /** Remove the document from the tree and delete the document */
+        /** Remove the document from the tree if it is there and delete the document */
         ~CacheDocument();
 
         GeoDataDocument *const m_document;
         GeoDataTreeModel *const m_treeModel;
+        bool m_inTreeModel;
 
     private:
         Q_DISABLE_COPY( CacheDocument )
@@ -93,7 +125,21 @@ private:
     GeoDataTreeModel *const m_treeModel;
     QThreadPool *const m_threadPool;
     int m_tileZoomLevel;
-    QCache<TileId, CacheDocument> m_documents;
+
+    // the tiles covering the viewport on m_tileZoomLevel
+    unsigned int m_minTileX;
+    unsigned int m_minTileY;
+    unsigned int m_maxTileX;
+    unsigned int m_maxTileY;
+
+    QHash<TileId, CacheDocument *> m_documents;
+
+    /** Tiles being parsed in the thread pool */
+    QSet<TileId> m_runningTiles;
+
+    /** Parsed tiles of the current zoom level waiting to be added to the tree model */
+    QList<TileId> m_pendingTiles;
+    QTimer m_pendingTimer;
 };
 
 }
@@ -16,6 +16,7 @@
 
 // Qt
 #include <QImage>
+#include <QMutexLocker>
 
 // Marble
 #include "MarbleDebug.h"
@@ -144,14 +145,25 @@ const GeoDataFeature* GeoDataContainer::child( int i ) const
  */
 int GeoDataContainer::childPosition( const GeoDataFeature* object ) const
 {
-    for ( int i=0; i< p()->m_vector.size(); i++ )
-    {
-        if ( p()->m_vector.at( i ) == object )
-        {
-            return i;
+    const QVector<GeoDataFeature*> &vector = p()->m_vector;
+
+    // a linear search is cheaper than maintaining the hash for small containers
+    if ( vector.size() <= 16 ) {
+        return vector.indexOf( const_cast<GeoDataFeature*>( object ) );
+    }
+
+    QMutexLocker locker( &p()->m_childPositionsMutex );
+    QHash<const GeoDataFeature*, int> &positions = p()->m_childPositions;
+    if ( !p()->m_childPositionsComplete ) {
+        positions.clear();
+        positions.reserve( vector.size() );
+        for ( int i = 0; i < vector.size(); ++i ) {
+            positions.insert( vector.at( i ), i );
         }
+        p()->m_childPositionsComplete = true;
     }
-    return -1;
+
+    return positions.value( object, -1 );
 }
 
 
@@ -160,6 +172,7 @@ void GeoDataContainer::insert( GeoDataFeature *other, int index )
     detach();
     other->setParent(this);
     p()->m_vector.insert( index, other );
+    p()->updateChildPositions( index );
 }
 
 void GeoDataContainer::append( GeoDataFeature *other )
@@ -167,13 +180,16 @@ void GeoDataContainer::append( GeoDataFeature *other )
     detach();
     other->setParent(this);
     p()->m_vector.append( other );
+    p()->updateChildPositions( p()->m_vector.size() - 1 );
 }
 
 
 void GeoDataContainer::remove( int index )
 {
     detach();
+    p()->m_childPositions.remove( p()->m_vector.at( index ) );
     p()->m_vector.remove( index );
+    p()->updateChildPositions( index );
 }
 
 int GeoDataContainer::size() const
@@ -219,15 +235,19 @@ void GeoDataContainer::clear()
     GeoDataContainer::detach();
     qDeleteAll(p()->m_vector);
     p()->m_vector.clear();
+    p()->invalidateChildPositions();
 }
 
 QVector<GeoDataFeature*>::Iterator GeoDataContainer::begin()
 {
+    // the children may be replaced through the iterator
+    p()->invalidateChildPositions();
     return p()->m_vector.begin();
 }
 
 QVector<GeoDataFeature*>::Iterator GeoDataContainer::end()
 {
+    p()->invalidateChildPositions();
     return p()->m_vector.end();
 }
 
@@ -265,6 +285,7 @@ void GeoDataContainer::unpack( QDataStream& stream )
     int count;
     stream >> count;
 
+    p()->invalidateChildPositions();
     for ( int i = 0; i < count; ++i ) {
         int featureId;
         stream >> featureId;
@@ -99,7 +99,9 @@ class GEODATA_EXPORT GeoDataContainer : public GeoDataFeature
     const GeoDataFeature* child( int ) const;
 
     /**
-     * @brief returns the position of an item in the list
+     * @brief returns the position of an item in the list, or -1 if it is not a child
+     *
+     * The positions are looked up in a cache that is built on the first call.
      */
     int childPosition( const GeoDataFeature *child) const;
     
@@ -15,6 +15,9 @@
 
 #include "GeoDataTypes.h"
 
+#include <QHash>
+#include <QMutex>
+
 namespace Marble
 {
 
@@ -22,6 +25,7 @@ class GeoDataContainerPrivate : public GeoDataFeaturePrivate
 {
   public:
     GeoDataContainerPrivate()
+        : m_childPositionsComplete( false )
     {
     }
     
@@ -34,6 +38,7 @@ class GeoDataContainerPrivate : public GeoDataFeaturePrivate
     {
         GeoDataFeaturePrivate::operator=( other );
         qDeleteAll( m_vector );
+        invalidateChildPositions();
         foreach( GeoDataFeature *feature, other.m_vector )
         {
             m_vector.append( new GeoDataFeature( *feature ) );
@@ -58,6 +63,36 @@ class GeoDataContainerPrivate : public GeoDataFeaturePrivate
     }
 
     QVector<GeoDataFeature*> m_vector;
+
+    /**
+     * Updates the cached positions of the features from @p first on, after
+     * m_vector has been changed at @p first.
+     */
+    void updateChildPositions( int first )
+    {
+        if ( !m_childPositionsComplete ) {
+            return;
+        }
+        for ( int i = first; i < m_vector.size(); ++i ) {
+            m_childPositions[ m_vector.at( i ) ] = i;
+        }
+    }
+
+    void invalidateChildPositions()
+    {
+        m_childPositions.clear();
+        m_childPositionsComplete = false;
+    }
+
+    /**
+     * Positions of the features in m_vector, built on demand by childPosition().
+     * Once built, modifications keep it complete, and modifications it cannot
+     * follow (like handing out mutable iterators) invalidate it. The mutex
+     * guards the build, since childPosition() may be called concurrently.
+     */
+    QHash<const GeoDataFeature*, int> m_childPositions;
+    bool m_childPositionsComplete;
+    QMutex m_childPositionsMutex;
 };
 
 } // namespace Marble
@@ -136,6 +136,12 @@ int GeoDataLineString::size() const
     return p()->m_vector.size();
 }
 
+void GeoDataLineString::reserve( int size )
+{
+    GeoDataGeometry::detach();
+    p()->m_vector.reserve( size );
+}
+
 GeoDataCoordinates& GeoDataLineString::at( int pos )
 {
     GeoDataGeometry::detach();
@@ -217,6 +217,12 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
     int size() const;
 
 
+/*!
+    \brief Allocates memory for at least @p size nodes, e.g. before appending many nodes.
+*/
+    void reserve( int size );
+
+
 /*!
     \brief Returns a reference to the coordinates of a node at a given position.
     This method detaches the returned coordinate object from the line string.
@@ -19,6 +19,8 @@
 
 #include "MarbleDebug.h"
 
+#include <QMutexLocker>
+
 
 namespace Marble
 {
@@ -129,12 +131,15 @@ const GeoDataGeometry& GeoDataMultiGeometry::first() const
 QVector<GeoDataGeometry*>::Iterator GeoDataMultiGeometry::begin()
 {
     detach();
+    // the children may be replaced through the iterator
+    p()->invalidateChildPositions();
     return p()->m_vector.begin();
 }
 
 QVector<GeoDataGeometry*>::Iterator GeoDataMultiGeometry::end()
 {
     detach();
+    p()->invalidateChildPositions();
     return p()->m_vector.end();
 }
 
@@ -166,14 +171,25 @@ const GeoDataGeometry* GeoDataMultiGeometry::child( int i ) const
  */
 int GeoDataMultiGeometry::childPosition( GeoDataGeometry *object)
 {
-    for ( int i=0; i< p()->m_vector.size(); i++ )
-    {
-        if ( p()->m_vector.at( i ) == object )
-        {
-            return i;
+    const QVector<GeoDataGeometry*> &vector = p()->m_vector;
+
+    // a linear search is cheaper than maintaining the hash for small geometries
+    if ( vector.size() <= 16 ) {
+        return vector.indexOf( object );
+    }
+
+    QMutexLocker locker( &p()->m_childPositionsMutex );
+    QHash<const GeoDataGeometry*, int> &positions = p()->m_childPositions;
+    if ( !p()->m_childPositionsComplete ) {
+        positions.clear();
+        positions.reserve( vector.size() );
+        for ( int i = 0; i < vector.size(); ++i ) {
+            positions.insert( vector.at( i ), i );
         }
+        p()->m_childPositionsComplete = true;
     }
-    return -1;
+
+    return positions.value( object, -1 );
 }
 
 /**
@@ -184,6 +200,7 @@ void GeoDataMultiGeometry::append( GeoDataGeometry *other )
     detach();
     other->setParent( this );
     p()->m_vector.append( other );
+    p()->updateChildPositions( p()->m_vector.size() - 1 );
 }
 
 
@@ -193,6 +210,7 @@ GeoDataMultiGeometry& GeoDataMultiGeometry::operator << ( const GeoDataGeometry&
     GeoDataGeometry *g = new GeoDataGeometry( value );
     g->setParent( this );
     p()->m_vector.append( g );
+    p()->updateChildPositions( p()->m_vector.size() - 1 );
     return *this;
 }
 
@@ -201,6 +219,7 @@ void GeoDataMultiGeometry::clear()
     detach();
     qDeleteAll(p()->m_vector);
     p()->m_vector.clear();
+    p()->invalidateChildPositions();
 }
 
 void GeoDataMultiGeometry::pack( QDataStream& stream ) const
@@ -228,6 +247,7 @@ void GeoDataMultiGeometry::unpack( QDataStream& stream )
     
     stream >> size;
     
+    p()->invalidateChildPositions();
     for( int i = 0; i < size; i++ ) {
         int geometryId;
         stream >> geometryId;
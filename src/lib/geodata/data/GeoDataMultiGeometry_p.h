@@ -15,6 +15,9 @@
 
 #include "GeoDataTypes.h"
 
+#include <QHash>
+#include <QMutex>
+
 namespace Marble
 {
 
@@ -22,6 +25,7 @@ class GeoDataMultiGeometryPrivate : public GeoDataGeometryPrivate
 {
   public:
     GeoDataMultiGeometryPrivate()
+        : m_childPositionsComplete( false )
     {
     }
 
@@ -34,6 +38,7 @@ class GeoDataMultiGeometryPrivate : public GeoDataGeometryPrivate
     {
         GeoDataGeometryPrivate::operator=( other );
         qDeleteAll( m_vector );
+        invalidateChildPositions();
         foreach( GeoDataGeometry *geometry, other.m_vector ) {
             m_vector.append( new GeoDataGeometry( *geometry ) );
         }
@@ -56,6 +61,36 @@ class GeoDataMultiGeometryPrivate : public GeoDataGeometryPrivate
         return GeoDataMultiGeometryId;
     }
     QVector<GeoDataGeometry*>  m_vector;
+
+    /**
+     * Updates the cached positions of the geometries from @p first on, after
+     * m_vector has been changed at @p first.
+     */
+    void updateChildPositions( int first )
+    {
+        if ( !m_childPositionsComplete ) {
+            return;
+        }
+        for ( int i = first; i < m_vector.size(); ++i ) {
+            m_childPositions[ m_vector.at( i ) ] = i;
+        }
+    }
+
+    void invalidateChildPositions()
+    {
+        m_childPositions.clear();
+        m_childPositionsComplete = false;
+    }
+
+    /**
+     * Positions of the geometries in m_vector, built on demand by childPosition().
+     * Once built, modifications keep it complete, and modifications it cannot
+     * follow (like handing out mutable iterators) invalidate it. The mutex
+     * guards the build, since childPosition() may be called concurrently.
+     */
+    QHash<const GeoDataGeometry*, int> m_childPositions;
+    bool m_childPositionsComplete;
+    QMutex m_childPositionsMutex;
 };
 
 } // namespace Marble
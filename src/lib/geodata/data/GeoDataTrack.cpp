@@ -17,8 +17,7 @@
 
 #include "GeoDataLineString.h"
 
-#include <QMap>
-#include <QLinkedList>
+#include <QVector>
 #include "GeoDataExtendedData.h"
 
 namespace Marble {
@@ -29,6 +28,7 @@ public:
     GeoDataTrackPrivate()
         : m_lineString( new GeoDataLineString() ),
           m_lineStringNeedsUpdate( false ),
+          m_whenSorted( true ),
           m_interpolate( false )
     {
     }
@@ -38,20 +38,107 @@ public:
         while ( m_when.size() < m_coordinates.size() ) {
             //fill coordinates without time information with null QDateTime
             m_when.append( QDateTime() );
+            m_whenSorted = false;
         }
     }
 
+    void appendWhen( const QDateTime &when )
+    {
+        if ( !when.isValid() || ( !m_when.isEmpty() && when < m_when.last() ) ) {
+            m_whenSorted = false;
+        }
+        m_when.append( when );
+    }
+
+    GeoDataCoordinates unsortedCoordinatesAt( const QDateTime &when, bool interpolate ) const;
+
+    // m_lineString always mirrors the first m_lineString->size() coordinates
+    // unless m_lineStringNeedsUpdate is set; points appended since are
+    // added to it by lineString() without rebuilding it.
     GeoDataLineString *m_lineString;
     bool m_lineStringNeedsUpdate;
 
-    QList<QDateTime> m_when;
-    QList<GeoDataCoordinates> m_coordinates;
+    // in document order; m_whenSorted is set while all times are valid
+    // and ascending, which allows for binary searches
+    QVector<QDateTime> m_when;
+    QVector<GeoDataCoordinates> m_coordinates;
+    bool m_whenSorted;
 
     GeoDataExtendedData m_extendedData;
 
     bool m_interpolate;
 };
 
+static GeoDataCoordinates interpolateCoordinates( const QDateTime &previousWhen, const GeoDataCoordinates &previousCoord,
+                                                  const QDateTime &nextWhen, const GeoDataCoordinates &nextCoord,
+                                                  const QDateTime &when )
+{
+#if QT_VERSION < 0x040700	
+    int interval = 1000 * previousWhen.secsTo( nextWhen );
+    int position = 1000 * previousWhen.secsTo( when );
+#else	
+    int interval = previousWhen.msecsTo( nextWhen );
+    int position = previousWhen.msecsTo( when );
+#endif	
+    qreal t = (qreal)position / (qreal)interval;
+
+    Quaternion interpolated;
+    interpolated.slerp( previousCoord.quaternion(), nextCoord.quaternion(), t );
+    qreal lon, lat;
+    interpolated.getSpherical( lon, lat );
+
+    qreal alt = previousCoord.altitude() + ( nextCoord.altitude() - previousCoord.altitude() ) * t;
+
+    return GeoDataCoordinates( lon, lat, alt );
+}
+
+GeoDataCoordinates GeoDataTrackPrivate::unsortedCoordinatesAt( const QDateTime &when, bool interpolate ) const
+{
+    const int count = qMin( m_when.size(), m_coordinates.size() );
+
+    const int index = m_when.indexOf( when );
+    if ( index >= 0 && index < count ) {
+        //exact match found
+        return m_coordinates.at( index );
+    }
+
+    if ( !interpolate ) {
+        return GeoDataCoordinates();
+    }
+
+    // the latest point before and the earliest point after "when", later
+    // points taking precedence over earlier ones of the same time
+    int previous = -1;
+    int next = -1;
+    for ( int i = 0; i < count; ++i ) {
+        const QDateTime &pointWhen = m_when.at( i );
+        if ( !pointWhen.isValid() ) {
+            continue;
+        }
+        if ( pointWhen > when ) {
+            if ( next < 0 || !( m_when.at( next ) < pointWhen ) ) {
+                next = i;
+            }
+        }
+        else if ( previous < 0 || !( pointWhen < m_when.at( previous ) ) ) {
+            previous = i;
+        }
+    }
+
+    if ( previous < 0 ) {
+        mDebug() << "No tracked point before " << when;
+        return GeoDataCoordinates();
+    }
+
+    if ( next < 0 ) {
+        mDebug() << "No tracked point after " << when;
+        return GeoDataCoordinates();
+    }
+
+    return interpolateCoordinates( m_when.at( previous ), m_coordinates.at( previous ),
+                                   m_when.at( next ), m_coordinates.at( next ), when );
+}
+
 GeoDataTrack::GeoDataTrack()
     : d( new GeoDataTrackPrivate() )
 {
@@ -99,12 +186,12 @@ QDateTime GeoDataTrack::lastWhen() const
 
 QList<GeoDataCoordinates> GeoDataTrack::coordinatesList() const
 {
-    return d->m_coordinates;
+    return d->m_coordinates.toList();
 }
 
 QList<QDateTime> GeoDataTrack::whenList() const
 {
-    return d->m_when;
+    return d->m_when.toList();
 }
 
 GeoDataCoordinates GeoDataTrack::coordinatesAt( const QDateTime &when ) const
@@ -113,58 +200,40 @@ GeoDataCoordinates GeoDataTrack::coordinatesAt( const QDateTime &when ) const
         return GeoDataCoordinates();
     }
 
-    if ( d->m_when.contains( when ) ) {
+    if ( !d->m_whenSorted ) {
+        return d->unsortedCoordinatesAt( when, interpolate() );
+    }
+
+    const int count = qMin( d->m_when.size(), d->m_coordinates.size() );
+    QVector<QDateTime>::const_iterator begin = d->m_when.constBegin();
+    QVector<QDateTime>::const_iterator end = begin + count;
+    QVector<QDateTime>::const_iterator nextEntry = qLowerBound( begin, end, when );
+
+    if ( nextEntry != end && *nextEntry == when ) {
         //exact match found
-        int index = d->m_when.indexOf( when );
-        if ( index < d->m_coordinates.size() ) {
-            return d->m_coordinates.at( index );
-        }
+        return d->m_coordinates.at( nextEntry - begin );
     }
 
     if ( !interpolate() ) {
         return GeoDataCoordinates();
     }
 
-    typedef QMap<QDateTime, GeoDataCoordinates> PointMap;
-    PointMap pointMap;
-    for ( int i = 0; i < qMin( d->m_when.size(), d->m_coordinates.size() ); ++i) {
-        if ( d->m_when.at( i ).isValid() ) {
-            pointMap[ d->m_when.at( i ) ] = d->m_coordinates.at( i );
-        }
-    }
-
-    QMap<QDateTime, GeoDataCoordinates>::const_iterator nextEntry = const_cast<const PointMap&>(pointMap).upperBound( when );
-
     // No tracked point happened before "when"
-    if ( nextEntry == pointMap.constBegin() ) {
+    if ( nextEntry == begin ) {
         mDebug() << "No tracked point before " << when;
         return GeoDataCoordinates();
     }
 
-    QMap<QDateTime, GeoDataCoordinates>::const_iterator previousEntry = nextEntry - 1;
-    GeoDataCoordinates previousCoord = previousEntry.value();
-
-    QDateTime previousWhen = previousEntry.key();
-    QDateTime nextWhen = nextEntry.key();
-    GeoDataCoordinates nextCoord = nextEntry.value();
-
-#if QT_VERSION < 0x040700	
-    int interval = 1000 * previousWhen.secsTo( nextWhen );
-    int position = 1000 * previousWhen.secsTo( when );
-#else	
-    int interval = previousWhen.msecsTo( nextWhen );
-    int position = previousWhen.msecsTo( when );
-#endif	
-    qreal t = (qreal)position / (qreal)interval;
-
-    Quaternion interpolated;
-    interpolated.slerp( previousCoord.quaternion(), nextCoord.quaternion(), t );
-    qreal lon, lat;
-    interpolated.getSpherical( lon, lat );
-
-    qreal alt = previousCoord.altitude() + ( nextCoord.altitude() - previousCoord.altitude() ) * t;
+    // No tracked point happened after "when"
+    if ( nextEntry == end ) {
+        mDebug() << "No tracked point after " << when;
+        return GeoDataCoordinates();
+    }
 
-    return GeoDataCoordinates( lon, lat, alt );
+    const int previous = nextEntry - 1 - begin;
+    const int next = nextEntry - begin;
+    return interpolateCoordinates( d->m_when.at( previous ), d->m_coordinates.at( previous ),
+                                   d->m_when.at( next ), d->m_coordinates.at( next ), when );
 }
 
 GeoDataCoordinates GeoDataTrack::coordinatesAt( int index ) const
@@ -175,44 +244,57 @@ GeoDataCoordinates GeoDataTrack::coordinatesAt( int index ) const
 void GeoDataTrack::addPoint( const QDateTime &when, const GeoDataCoordinates &coord )
 {
     d->equalizeWhenSize();
+
+    if ( d->m_when.isEmpty() || ( d->m_whenSorted && !( when < d->m_when.last() ) ) ) {
+        // common case when recording a track: no need to search or to
+        // rebuild the line string
+        d->appendWhen( when );
+        d->m_coordinates.append( coord );
+        return;
+    }
+
     d->m_lineStringNeedsUpdate = true;
-    int i=0;
-    while ( i < d->m_when.size() ) {
-        if ( d->m_when.at( i ) > when ) {
-            break;
+    int i = 0;
+    if ( d->m_whenSorted ) {
+        i = qUpperBound( d->m_when.constBegin(), d->m_when.constEnd(), when ) - d->m_when.constBegin();
+        d->m_whenSorted = when.isValid();
+    }
+    else {
+        while ( i < d->m_when.size() && !( d->m_when.at( i ) > when ) ) {
+            ++i;
         }
-        ++i;
     }
-    d->m_when.insert(i, when );
-    d->m_coordinates.insert(i, coord );
+    d->m_when.insert( i, when );
+    d->m_coordinates.insert( i, coord );
 }
 
 void GeoDataTrack::appendCoordinates( const GeoDataCoordinates &coord )
 {
     d->equalizeWhenSize();
-    d->m_lineStringNeedsUpdate = true;
     d->m_coordinates.append( coord );
 }
 
 void GeoDataTrack::appendAltitude( qreal altitude )
 {
-    d->m_lineStringNeedsUpdate = true;
     Q_ASSERT( !d->m_coordinates.isEmpty() );
     if ( d->m_coordinates.isEmpty() ) return;
-    GeoDataCoordinates coordinates = d->m_coordinates.takeLast();
-    coordinates.setAltitude( altitude );
-    d->m_coordinates.append( coordinates );
+    if ( d->m_lineString->size() == d->m_coordinates.size() ) {
+        // the line string already contains the changed point
+        d->m_lineStringNeedsUpdate = true;
+    }
+    d->m_coordinates.last().setAltitude( altitude );
 }
 
 void GeoDataTrack::appendWhen( const QDateTime &when )
 {
-    d->m_when.append( when );
+    d->appendWhen( when );
 }
 
 void GeoDataTrack::clear()
 {
     d->m_when.clear();
     d->m_coordinates.clear();
+    d->m_whenSorted = true;
     d->m_lineStringNeedsUpdate = true;
 }
 
@@ -224,9 +306,19 @@ void GeoDataTrack::removeBefore( const QDateTime &when )
     }
     d->equalizeWhenSize();
 
-    while ( !d->m_when.isEmpty() && d->m_when.first() < when ) {
-        d->m_when.takeFirst();
-        d->m_coordinates.takeFirst();
+    int count = 0;
+    if ( d->m_whenSorted ) {
+        count = qLowerBound( d->m_when.constBegin(), d->m_when.constEnd(), when ) - d->m_when.constBegin();
+    }
+    else {
+        while ( count < d->m_when.size() && d->m_when.at( count ) < when ) {
+            ++count;
+        }
+    }
+    if ( count > 0 ) {
+        d->m_when.remove( 0, count );
+        d->m_coordinates.remove( 0, count );
+        d->m_lineStringNeedsUpdate = true;
     }
 }
 
@@ -237,10 +329,19 @@ void GeoDataTrack::removeAfter( const QDateTime &when )
         return;
     }
     d->equalizeWhenSize();
-    while ( !d->m_when.isEmpty() && d->m_when.last() > when ) {
-        d->m_when.takeLast();
-        d->m_coordinates.takeLast();
-
+    int size = d->m_when.size();
+    if ( d->m_whenSorted ) {
+        size = qUpperBound( d->m_when.constBegin(), d->m_when.constEnd(), when ) - d->m_when.constBegin();
+    }
+    else {
+        while ( size > 0 && d->m_when.at( size - 1 ) > when ) {
+            --size;
+        }
+    }
+    if ( size < d->m_when.size() ) {
+        d->m_when.resize( size );
+        d->m_coordinates.resize( size );
+        d->m_lineStringNeedsUpdate = true;
     }
 }
 
@@ -249,11 +350,12 @@ const GeoDataLineString *GeoDataTrack::lineString() const
     if ( d->m_lineStringNeedsUpdate ) {
         delete d->m_lineString;
         d->m_lineString = new GeoDataLineString();
-        foreach ( const GeoDataCoordinates &coordinates, coordinatesList() ) {
-            d->m_lineString->append( coordinates );
-        }
         d->m_lineStringNeedsUpdate = false;
     }
+    // append the points added since the last call
+    for ( int i = d->m_lineString->size(); i < d->m_coordinates.size(); ++i ) {
+        d->m_lineString->append( d->m_coordinates.at( i ) );
+    }
     return d->m_lineString;
 }
 
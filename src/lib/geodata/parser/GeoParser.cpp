@@ -139,14 +139,18 @@ void GeoParser::parseDocument()
     }
 
     bool processChildren = true;
-    QualifiedName qName( name().toString(), namespaceUri().toString() );
 
     if( tokenType() == QXmlStreamReader::Invalid )
         raiseWarning( QString( "%1: %2" ).arg( error() ).arg( errorString() ) );
 
-    GeoStackItem stackItem( qName, 0 );
+    // Known elements share the interned name of their tag, only unknown ones need a copy
+    const int parentIndex = m_nodeStack.isEmpty() ? -1 : m_nodeStack.top().m_tagIndex;
+    const int index = tagIndex( parentIndex );
+    GeoStackItem stackItem( index < 0 ? QualifiedName( name().toString(), namespaceUri().toString() )
+                                      : GeoTagHandler::tagName( index ), 0 );
+    stackItem.m_tagIndex = index;
 
-    if ( const GeoTagHandler* handler = GeoTagHandler::recognizes( qName )) {
+    if ( const GeoTagHandler* handler = index < 0 ? 0 : GeoTagHandler::tagHandler( index ) ) {
         stackItem.assignNode( handler->parse( *this ));
         processChildren = !isEndElement();
     }
@@ -190,6 +194,38 @@ void GeoParser::parseDocument()
 #endif
 }
 
+int GeoParser::tagIndex( int parentIndex )
+{
+    const QStringRef tagName = name();
+    const QStringRef tagNamespace = namespaceUri();
+
+    // Elements usually have few different children, e.g. <nd> and <tag> in OSM ways
+    const int slot = parentIndex + 1;
+    if ( slot < m_childTags.size() ) {
+        const QVector<int> &children = m_childTags.at( slot );
+        for ( int i = 0; i < children.size(); ++i ) {
+            const QualifiedName &qName = GeoTagHandler::tagName( children.at( i ) );
+            if ( tagName == qName.first && tagNamespace == qName.second ) {
+                return children.at( i );
+            }
+        }
+    }
+
+    const int index = GeoTagHandler::tagIndex( tagName, tagNamespace );
+    if ( index >= 0 ) {
+        if ( slot >= m_childTags.size() ) {
+            m_childTags.resize( GeoTagHandler::tagCount() + 1 );
+        }
+        QVector<int> &children = m_childTags[slot];
+        // keep the linear search short for containers of many different elements
+        if ( children.size() < 16 ) {
+            children.append( index );
+        }
+    }
+
+    return index;
+}
+
 void GeoParser::raiseWarning( const QString& warning )
 {
     // TODO: Maybe introduce a strict parsing mode where we feed the warning to
@@ -24,6 +24,7 @@
 
 #include <QPair>
 #include <QStack>
+#include <QVector>
 #include <QXmlStreamReader>
 
 #include "geodata_export.h"
@@ -91,7 +92,18 @@ protected:
 
 private:
     void parseDocument();
+
+    /**
+     * The tag index of the current element, see GeoTagHandler::tagIndex().
+     * Children that appeared in the same parent context before are matched
+     * first, which avoids hashing the element name for most elements.
+     */
+    int tagIndex( int parentIndex );
+
     QStack<GeoStackItem> m_nodeStack;
+
+    // the tag indices of the children seen per parent tag index + 1
+    QVector<QVector<int> > m_childTags;
 };
 
 class GeoStackItem
@@ -99,13 +111,15 @@ class GeoStackItem
  public:
     GeoStackItem()
         : m_qualifiedName(),
-          m_node( 0 )
+          m_node( 0 ),
+          m_tagIndex( -1 )
     {
     }
 
     GeoStackItem( const GeoParser::QualifiedName& qualifiedName, GeoNode* node )
         : m_qualifiedName( qualifiedName ),
-          m_node( node )
+          m_node( node ),
+          m_tagIndex( -1 )
     {
     }
 
@@ -137,6 +151,7 @@ private:
     void assignNode( GeoNode* node ) { m_node = node; }
     GeoParser::QualifiedName m_qualifiedName;
     GeoNode* m_node;
+    int m_tagIndex;
 };
 
 }
@@ -33,7 +33,7 @@ namespace Marble
 // Set to a value greater than 0, to dump tag handlers as they get registered
 #define DUMP_TAG_HANDLER_REGISTRATION 0
 
-GeoTagHandler::TagHash* GeoTagHandler::s_tagHandlerHash = 0;
+GeoTagHandler::TagTable* GeoTagHandler::s_tagTable = 0;
 
 GeoTagHandler::GeoTagHandler()
 {
@@ -43,45 +43,96 @@ GeoTagHandler::~GeoTagHandler()
 {
 }
 
-GeoTagHandler::TagHash* GeoTagHandler::tagHandlerHash()
+GeoTagHandler::TagTable* GeoTagHandler::tagTable()
 {
-    if (!s_tagHandlerHash)
-        s_tagHandlerHash = new TagHash();
+    if (!s_tagTable)
+        s_tagTable = new TagTable();
 
-    Q_ASSERT(s_tagHandlerHash);
-    return s_tagHandlerHash;
+    Q_ASSERT(s_tagTable);
+    return s_tagTable;
 }
 
-void GeoTagHandler::registerHandler(const GeoParser::QualifiedName& qName, const GeoTagHandler* handler)
+uint GeoTagHandler::tagHash(const QStringRef& name, const QStringRef& nameSpace)
 {
-    TagHash* hash = tagHandlerHash();
+    // FNV-1a over the characters of both strings, hashing the references directly
+    uint hash = 2166136261u;
+    const QChar* data = name.unicode();
+    for (int i = 0; i < name.size(); ++i) {
+        hash = (hash ^ data[i].unicode()) * 16777619u;
+    }
+    hash = (hash ^ ':') * 16777619u;
+    data = nameSpace.unicode();
+    for (int i = 0; i < nameSpace.size(); ++i) {
+        hash = (hash ^ data[i].unicode()) * 16777619u;
+    }
+    return hash;
+}
 
-    Q_ASSERT(!hash->contains(qName));
-    hash->insert(qName, handler);
-    Q_ASSERT(hash->contains(qName));
+int GeoTagHandler::tagIndex(const QStringRef& name, const QStringRef& nameSpace)
+{
+    const TagTable* table = tagTable();
 
-#if DUMP_TAG_HANDLER_REGISTRATION > 0
-    mDebug() << "[GeoTagHandler] -> Recognizing" << qName.first << "tag with namespace" << qName.second;
-#endif
+    const uint hash = tagHash(name, nameSpace);
+    QMultiHash<uint, int>::const_iterator it = table->indices.constFind(hash);
+    for (; it != table->indices.constEnd() && it.key() == hash; ++it) {
+        const GeoParser::QualifiedName& tag = table->tags.at(it.value()).name;
+        if (name == tag.first && nameSpace == tag.second)
+            return it.value();
+    }
+
+    return -1;
 }
 
-void GeoTagHandler::unregisterHandler(const GeoParser::QualifiedName& qName)
+int GeoTagHandler::tagIndex(const GeoParser::QualifiedName& qName)
+{
+    return tagIndex(QStringRef(&qName.first), QStringRef(&qName.second));
+}
+
+int GeoTagHandler::tagCount()
+{
+    return tagTable()->tags.size();
+}
+
+const GeoParser::QualifiedName& GeoTagHandler::tagName(int index)
 {
-    TagHash* hash = tagHandlerHash();
+    return tagTable()->tags.at(index).name;
+}
 
-    Q_ASSERT(hash->contains(qName));
-    hash->remove(qName);
-    Q_ASSERT(!hash->contains(qName));
+const GeoTagHandler* GeoTagHandler::tagHandler(int index)
+{
+    return tagTable()->tags.at(index).handler;
 }
 
-const GeoTagHandler* GeoTagHandler::recognizes(const GeoParser::QualifiedName& qName)
+void GeoTagHandler::registerHandler(const GeoParser::QualifiedName& qName, const GeoTagHandler* handler)
 {
-    TagHash* hash = tagHandlerHash();
+    TagTable* table = tagTable();
+
+    // indices stay valid when handlers are unregistered, the tag is reused
+    int index = tagIndex(qName);
+    if (index < 0) {
+        Tag tag;
+        tag.name = qName;
+        tag.handler = 0;
+        index = table->tags.size();
+        table->tags.append(tag);
+        table->indices.insert(tagHash(QStringRef(&qName.first), QStringRef(&qName.second)), index);
+    }
+
+    Q_ASSERT(!table->tags.at(index).handler);
+    table->tags[index].handler = handler;
+
+#if DUMP_TAG_HANDLER_REGISTRATION > 0
+    mDebug() << "[GeoTagHandler] -> Recognizing" << qName.first << "tag with namespace" << qName.second;
+#endif
+}
 
-    if (!hash->contains(qName))
-        return 0;
+void GeoTagHandler::unregisterHandler(const GeoParser::QualifiedName& qName)
+{
+    const int index = tagIndex(qName);
 
-    return (*hash)[qName];
+    Q_ASSERT(index >= 0 && tagHandler(index));
+    if (index >= 0)
+        tagTable()->tags[index].handler = 0;
 }
 
 }
@@ -23,6 +23,8 @@
 #define MARBLE_GEOTAGHANDLER_H
 
 #include <QHash>
+#include <QStringRef>
+#include <QVector>
 #include "marble_export.h"
 #include "GeoParser.h"
 
@@ -61,13 +63,37 @@ private: // Only our registrar is allowed to register tag handlers.
 
 private: // Only our parser is allowed to access tag handlers.
     friend class GeoParser;
-    static const GeoTagHandler* recognizes(const GeoParser::QualifiedName&);
+
+    /**
+     * Every registered qualified name is interned once and identified by its
+     * index in the tag table afterwards. Looking up the index of an element
+     * name read by the parser does not allocate any memory.
+     * @return the index of the tag, -1 if no handler was ever registered for it
+     */
+    static int tagIndex(const QStringRef& name, const QStringRef& nameSpace);
+    static int tagCount();
+    static const GeoParser::QualifiedName& tagName(int index);
+    static const GeoTagHandler* tagHandler(int index);
 
 private:
-    typedef QHash<GeoParser::QualifiedName, const GeoTagHandler*> TagHash;
+    struct Tag
+    {
+        GeoParser::QualifiedName name;
+        const GeoTagHandler* handler;
+    };
+
+    struct TagTable
+    {
+        QVector<Tag> tags;
+        // tag indices by a hash of the tag name and namespace
+        QMultiHash<uint, int> indices;
+    };
+
+    static uint tagHash(const QStringRef& name, const QStringRef& nameSpace);
+    static int tagIndex(const GeoParser::QualifiedName&);
 
-    static TagHash* tagHandlerHash();
-    static TagHash* s_tagHandlerHash;
+    static TagTable* tagTable();
+    static TagTable* s_tagTable;
 };
 
 // Helper structure
@@ -41,6 +41,7 @@
 #include "TileId.h"
 #include "MarbleGraphicsItem.h"
 #include "MarblePlacemarkModel.h"
+#include "RenderProfiler.h"
 
 // Qt
 #include <qmath.h>
@@ -243,14 +244,21 @@ bool GeometryLayer::render( GeoPainter *painter, ViewportParams *viewport,
     painter->save();
 
     int maxZoomLevel = qMin<int>( qMax<int>( qLn( viewport->radius() *4 / 256 ) / qLn( 2.0 ), 1), GeometryLayerPrivate::maximumZoomLevel() );
-    QList<GeoGraphicsItem*> items = d->m_scene.items( viewport->viewLatLonAltBox(), maxZoomLevel );
+    QList<GeoGraphicsItem*> items;
+    {
+        RenderProfiler::Scope scope( "GeometryLayer::items" );
+        items = d->m_scene.items( viewport->viewLatLonAltBox(), maxZoomLevel );
+    }
 
     int painted = 0;
-    foreach( GeoGraphicsItem* item, items )
     {
-        if ( item->latLonAltBox().intersects( viewport->viewLatLonAltBox() ) ) {
-            item->paint( painter, viewport );
-            ++painted;
+        RenderProfiler::Scope scope( "GeometryLayer::paint" );
+        foreach( GeoGraphicsItem* item, items )
+        {
+            if ( item->latLonAltBox().intersects( viewport->viewLatLonAltBox() ) ) {
+                item->paint( painter, viewport );
+                ++painted;
+            }
         }
     }
 
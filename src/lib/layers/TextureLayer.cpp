@@ -29,6 +29,7 @@
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
 #include "MarblePlacemarkModel.h"
+#include "RenderProfiler.h"
 #include "StackedTile.h"
 #include "StackedTileLoader.h"
 #include "SunLocator.h"
@@ -53,6 +54,7 @@ public:
              TextureLayer *parent );
 
     void requestDelayedRepaint();
+    void updateCoastlines();
     void updateTextureLayers();
     void updateTile( const TileId &tileId, const QImage &tileImage );
 
@@ -134,6 +136,16 @@ void TextureLayer::Private::requestDelayedRepaint()
     }
 }
 
+void TextureLayer::Private::updateCoastlines()
+{
+    // the coast lines are part of the colorized tiles
+    if ( m_texcolorizer ) {
+        m_tileLoader.clear();
+    }
+
+    requestDelayedRepaint();
+}
+
 void TextureLayer::Private::updateTextureLayers()
 {
     QVector<GeoSceneTextureTile const *> result;
@@ -249,7 +261,7 @@ TextureLayer::TextureLayer( HttpDownloadManager *downloadManager,
              this, SIGNAL(repaintNeeded()) );
 
     connect( d->m_veccomposer, SIGNAL(datasetLoaded()),
-             this, SLOT(requestDelayedRepaint()) );
+             this, SLOT(updateCoastlines()) );
 }
 
 TextureLayer::~TextureLayer()
@@ -337,7 +349,10 @@ bool TextureLayer::render( GeoPainter *painter, ViewportParams *viewport,
     }
 
     const QRect dirtyRect = QRect( QPoint( 0, 0), viewport->size() );
-    d->m_texmapper->mapTexture( painter, viewport, d->m_tileZoomLevel, dirtyRect, d->m_texcolorizer );
+    {
+        RenderProfiler::Scope scope( "TextureLayer::mapTexture" );
+        d->m_texmapper->mapTexture( painter, viewport, d->m_tileZoomLevel, dirtyRect );
+    }
     d->m_runtimeTrace = QString("Texture Cache: %1 ").arg(d->m_tileLoader.tileCount());
     return true;
 }
@@ -349,8 +364,9 @@ QString TextureLayer::runtimeTrace() const
 
 void TextureLayer::setShowRelief( bool show )
 {
-    if ( d->m_texcolorizer ) {
+    if ( d->m_texcolorizer && d->m_texcolorizer->showRelief() != show ) {
         d->m_texcolorizer->setShowRelief( show );
+        reset();
     }
 }
 
@@ -451,11 +467,13 @@ void TextureLayer::downloadStackedTile( const TileId &stackedTileId )
 
 void TextureLayer::setMapTheme( const QVector<const GeoSceneTextureTile *> &textures, const GeoSceneGroup *textureLayerSettings, const QString &seaFile, const QString &landFile )
 {
+    d->m_layerDecorator.setTextureColorizer( 0 );
     delete d->m_texcolorizer;
     d->m_texcolorizer = 0;
 
     if ( QFileInfo( seaFile ).isReadable() || QFileInfo( landFile ).isReadable() ) {
         d->m_texcolorizer = new TextureColorizer( seaFile, landFile, d->m_veccomposer );
+        d->m_layerDecorator.setTextureColorizer( d->m_texcolorizer );
     }
 
     d->m_textures = textures;
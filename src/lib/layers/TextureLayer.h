@@ -114,6 +114,7 @@ public Q_SLOTS:
 
  private:
     Q_PRIVATE_SLOT( d, void requestDelayedRepaint() )
+    Q_PRIVATE_SLOT( d, void updateCoastlines() )
     Q_PRIVATE_SLOT( d, void updateTextureLayers() )
     Q_PRIVATE_SLOT( d, void updateTile( const TileId &tileId, const QImage &tileImage ) )
     Q_PRIVATE_SLOT( d, void addGroundOverlays( QModelIndex parent, int first, int last ) )
@@ -32,6 +32,7 @@
 #include <QBrush>
 #include <QColorDialog>
 #include <QDebug>
+#include <QPicture>
 
 
 
@@ -40,6 +41,7 @@ namespace Marble
 
 GraticulePlugin::GraticulePlugin()
     : RenderPlugin( 0 ),
+      m_hasPicture( false ),
       ui_configWidget( 0 ),
       m_configDialog( 0 )
 {
@@ -53,6 +55,7 @@ GraticulePlugin::GraticulePlugin( const MarbleModel *marbleModel )
       m_showPrimaryLabels( true ),
       m_showSecondaryLabels( true ),
       m_isInitialized( false ),
+      m_hasPicture( false ),
       ui_configWidget( 0 ),
       m_configDialog( 0 )
 {
@@ -279,17 +282,78 @@ bool GraticulePlugin::render( GeoPainter *painter, ViewportParams *viewport,
     gridFont.setPointSize( defaultFontSize );    
     gridFont.setBold( true );
 
-    painter->save();
+    // Printers get the grid painted at their own resolution
+    if ( painter->mapQuality() == PrintQuality ) {
+        painter->save();
 
-    painter->setFont( gridFont );
+        painter->setFont( gridFont );
 
-    renderGrid( painter, viewport, m_equatorCirclePen, m_tropicsCirclePen, m_gridCirclePen );
+        renderGrid( painter, viewport, m_equatorCirclePen, m_tropicsCirclePen, m_gridCirclePen );
 
-    painter->restore();
+        painter->restore();
+
+        return true;
+    }
+
+    // Building, tessellating and projecting the lines and placing their
+    // labels only needs to be done when the view changes. Otherwise the
+    // grid recorded for the previous frame is painted again.
+    const GridView view = gridView( painter, viewport );
+    if ( !m_hasPicture || !( view == m_pictureView ) ) {
+        m_picture = QPicture();
+        m_picture.setBoundingRect( QRect( QPoint( 0, 0 ), viewport->size() ) );
+
+        GeoPainter picturePainter( &m_picture, viewport, painter->mapQuality() );
+        picturePainter.setFont( gridFont );
+        renderGrid( &picturePainter, viewport, m_equatorCirclePen, m_tropicsCirclePen, m_gridCirclePen );
+        picturePainter.end();
+
+        m_pictureView = view;
+        m_hasPicture = true;
+    }
+
+    painter->drawPicture( QPointF( 0, 0 ), m_picture );
 
     return true;
 }
 
+bool GraticulePlugin::GridView::operator==( const GridView &other ) const
+{
+    return projection == other.projection
+        && centerLongitude == other.centerLongitude
+        && centerLatitude == other.centerLatitude
+        && radius == other.radius
+        && size == other.size
+        && mapQuality == other.mapQuality
+        && notation == other.notation
+        && planetId == other.planetId
+        && equatorCirclePen == other.equatorCirclePen
+        && tropicsCirclePen == other.tropicsCirclePen
+        && gridCirclePen == other.gridCirclePen
+        && showPrimaryLabels == other.showPrimaryLabels
+        && showSecondaryLabels == other.showSecondaryLabels;
+}
+
+GraticulePlugin::GridView GraticulePlugin::gridView( const GeoPainter *painter, const ViewportParams *viewport ) const
+{
+    GridView view;
+    view.projection = viewport->projection();
+    view.centerLongitude = viewport->centerLongitude();
+    view.centerLatitude = viewport->centerLatitude();
+    view.radius = viewport->radius();
+    view.size = viewport->size();
+    view.mapQuality = painter->mapQuality();
+    view.notation = m_currentNotation;
+    view.planetId = marbleModel()->planet()->id();
+    view.equatorCirclePen = m_equatorCirclePen;
+    view.tropicsCirclePen = m_tropicsCirclePen;
+    view.gridCirclePen = m_gridCirclePen;
+    view.showPrimaryLabels = m_showPrimaryLabels;
+    view.showSecondaryLabels = m_showSecondaryLabels;
+
+    return view;
+}
+
 qreal GraticulePlugin::zValue() const
 {
     return 1.0;
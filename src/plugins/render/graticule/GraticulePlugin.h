@@ -23,6 +23,7 @@
 #include <QIcon>
 #include <QColorDialog>
 #include <QAbstractButton>
+#include <QPicture>
 
 
 #include "DialogConfigurationInterface.h"
@@ -32,6 +33,7 @@
 
 #include "GeoDataCoordinates.h"
 #include "GeoDataLatLonAltBox.h"
+#include "MarbleGlobal.h"
 
 
 namespace Ui 
@@ -211,6 +213,30 @@ class GraticulePlugin : public RenderPlugin, public DialogConfigurationInterface
      */
     void initLineMaps( GeoDataCoordinates::Notation notation );
 
+    /**
+     * @brief The view and the settings that decide how the grid is painted.
+     */
+    struct GridView
+    {
+        Projection projection;
+        qreal centerLongitude;
+        qreal centerLatitude;
+        int radius;
+        QSize size;
+        MapQuality mapQuality;
+        GeoDataCoordinates::Notation notation;
+        QString planetId;
+        QPen equatorCirclePen;
+        QPen tropicsCirclePen;
+        QPen gridCirclePen;
+        bool showPrimaryLabels;
+        bool showSecondaryLabels;
+
+        bool operator==( const GridView &other ) const;
+    };
+
+    GridView gridView( const GeoPainter *painter, const ViewportParams *viewport ) const;
+
     GeoDataCoordinates::Notation m_currentNotation;
 
     // Maps the zoom factor to the amount of lines per 360 deg
@@ -225,6 +251,11 @@ class GraticulePlugin : public RenderPlugin, public DialogConfigurationInterface
 
     bool m_isInitialized;
 
+    // The grid as painted for m_pictureView, replayed while the view does not change
+    QPicture m_picture;
+    GridView m_pictureView;
+    bool m_hasPicture;
+
     QIcon m_icon;
 
     Ui::GraticuleConfigWidget *ui_configWidget;
@@ -21,18 +21,133 @@
 #include "sgp4/sgp4io.h"
 #include "mex/planetarySats.h"
 
+#include <QRunnable>
+
 #include <locale.h>
 
 namespace Marble {
 
+class SatellitesPropagationJob : public QRunnable
+{
+public:
+    SatellitesPropagationJob( SatellitesModel *model,
+                              const QVector<SatellitesTLEItem *> &items,
+                              const QDateTime &dateTime,
+                              int generation )
+        : m_model( model ),
+          m_items( items ),
+          m_dateTime( dateTime ),
+          m_generation( generation )
+    {
+    }
+
+    void run()
+    {
+        foreach( SatellitesTLEItem *item, m_items ) {
+            item->propagate( m_dateTime );
+        }
+
+        QMetaObject::invokeMethod( m_model, "finishPropagation", Qt::QueuedConnection,
+                                   Q_ARG( int, m_generation ) );
+    }
+
+private:
+    SatellitesModel *const m_model;
+    const QVector<SatellitesTLEItem *> m_items;
+    const QDateTime m_dateTime;
+    const int m_generation;
+};
+
 SatellitesModel::SatellitesModel( GeoDataTreeModel *treeModel,
                                   const MarbleClock *clock )
     : TrackerPluginModel( treeModel ),
       m_clock( clock ),
-      m_currentColorIndex( 0 )
+      m_currentColorIndex( 0 ),
+      m_pendingJobs( 0 ),
+      m_generation( 0 ),
+      m_updatePending( false )
 {
     setupColors();
-    connect(m_clock, SIGNAL(timeChanged()), this, SLOT(update()));
+    connect(m_clock, SIGNAL(timeChanged()), this, SLOT(updateOrbits()));
+}
+
+SatellitesModel::~SatellitesModel()
+{
+    // the jobs access the items, which are deleted by TrackerPluginModel
+    m_propagationPool.waitForDone();
+}
+
+void SatellitesModel::clear()
+{
+    m_propagationPool.waitForDone();
+    m_propagatingItems.clear();
+    m_pendingJobs = 0;
+    m_updatePending = false;
+    // ignore the notifications of the jobs that are still queued
+    ++m_generation;
+
+    TrackerPluginModel::clear();
+}
+
+void SatellitesModel::updateOrbits()
+{
+    if ( m_pendingJobs > 0 ) {
+        // catch up once the running propagation is finished
+        m_updatePending = true;
+        return;
+    }
+    m_updatePending = false;
+
+    QVector<SatellitesTLEItem *> tleItems;
+    foreach( TrackerPluginItem *item, items() ) {
+        SatellitesTLEItem *tleItem = qobject_cast<SatellitesTLEItem*>( item );
+        if ( tleItem == 0 ) {
+            // there are only few of them, no need for a thread
+            item->update();
+        } else if ( tleItem->isEnabled() ) {
+            tleItems.append( tleItem );
+        }
+    }
+
+    if ( tleItems.isEmpty() ) {
+        return;
+    }
+
+    // a few jobs per thread balance the load between orbits of
+    // different cost
+    const int jobCount = qMin( tleItems.size(), 4 * qMax( 1, m_propagationPool.maxThreadCount() ) );
+    const int itemsPerJob = ( tleItems.size() + jobCount - 1 ) / jobCount;
+    const QDateTime dateTime = m_clock->dateTime();
+
+    m_propagatingItems = tleItems;
+    for ( int i = 0; i < tleItems.size(); i += itemsPerJob ) {
+        ++m_pendingJobs;
+        m_propagationPool.start( new SatellitesPropagationJob( this, tleItems.mid( i, itemsPerJob ),
+                                                               dateTime, m_generation ) );
+    }
+}
+
+void SatellitesModel::finishPropagation( int generation )
+{
+    if ( generation != m_generation ) {
+        return;
+    }
+
+    --m_pendingJobs;
+    if ( m_pendingJobs > 0 ) {
+        return;
+    }
+
+    foreach( SatellitesTLEItem *item, m_propagatingItems ) {
+        item->updateTrack();
+    }
+    m_propagatingItems.clear();
+
+    emit orbitsUpdated();
+
+    if ( m_updatePending ) {
+        updateOrbits();
+    }
 }
 
 void SatellitesModel::setupColors()
@@ -95,10 +210,6 @@ void SatellitesModel::updateVisibility()
             bool enabled = ( ( oItem->relatedBody().toLower() == m_lcPlanet ) &&
                              ( m_enabledIds.contains( oItem->id() ) ) );
             oItem->setEnabled( enabled );
-
-            if( enabled ) {
-                oItem->update();
-            }
         }
 
         SatellitesTLEItem *eItem = qobject_cast<SatellitesTLEItem*>(obj);
@@ -106,14 +217,13 @@ void SatellitesModel::updateVisibility()
             // TLE satellites are always earth satellites
             bool enabled = ( m_lcPlanet == "earth" );
             eItem->setEnabled( enabled );
-
-            if( enabled ) {
-                eItem->update();
-            }
         }
     }
 
     endUpdateItems();
+
+    // also updates the newly enabled satellites
+    updateOrbits();
 }
 
 void SatellitesModel::parseFile( const QString &id,
@@ -13,6 +13,7 @@
 
 #include <QVariant>
 #include <QStringList>
+#include <QThreadPool>
 #include <QVector>
 
 #include "TrackerPluginModel.h"
@@ -20,6 +21,7 @@
 namespace Marble {
 
 class MarbleClock;
+class SatellitesTLEItem;
 
 /**
  * The model for satellites.
@@ -31,12 +33,35 @@ public:
     SatellitesModel( GeoDataTreeModel *treeModel,
                      const MarbleClock *clock );
 
+    ~SatellitesModel();
+
+    /**
+     * Remove all satellites. Orbit propagations still running are
+     * waited for and their results are dropped.
+     */
+    void clear();
+
     void loadSettings( const QHash<QString, QVariant> &settings );
     void setPlanet( const QString &lcPlanet );
     void updateVisibility();
 
     void parseFile( const QString &id, const QByteArray &file );
 
+public Q_SLOTS:
+    /**
+     * Update the tracks of all enabled satellites to the current time of
+     * the clock. The orbits of TLE satellites are propagated in a thread
+     * pool and their tracks are updated once all of them are done.
+     */
+    void updateOrbits();
+
+Q_SIGNALS:
+    /**
+     * Emitted when the tracks of the TLE satellites have been updated
+     * after a propagation.
+     */
+    void orbitsUpdated();
+
 protected:
     /**
      * Parse the Marble Satellite Catalog @p id with content @p data.
@@ -49,6 +74,9 @@ protected:
      */
     void parseTLE( const QString &id, const QByteArray &data );
 
+private Q_SLOTS:
+    void finishPropagation( int generation );
+
 private:
     void setupColors();
     QColor nextColor();
@@ -59,6 +87,12 @@ private:
     QString m_lcPlanet;
     QVector<QColor> m_colorList;
     int m_currentColorIndex;
+
+    QThreadPool m_propagationPool;
+    QVector<SatellitesTLEItem *> m_propagatingItems;
+    int m_pendingJobs;
+    int m_generation;
+    bool m_updatePending;
 };
 
 } // namespace Marble
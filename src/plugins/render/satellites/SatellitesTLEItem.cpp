@@ -44,17 +44,25 @@ SatellitesTLEItem::SatellitesTLEItem( const QString &name,
       m_showOrbit( false ),
       m_satrec( satrec ),
       m_track( new GeoDataTrack() ),
-      m_clock( clock )
+      m_clock( clock ),
+      m_firstSample( 0 )
 {
     double tumin, mu, xke, j2, j3, j4, j3oj2;
     double radiusearthkm;
     getgravconst( wgs84, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2 );
     m_earthSemiMajorAxis = radiusearthkm;
 
+    m_epoch = timeAtEpoch().toTime_t();
+    // time interval between each point in the track
+    m_step = period() / 100.0;
+
     setDescription();
 
     placemark()->setVisualCategory( GeoDataFeature::Satellite );
     placemark()->setZoomLevel( 0 );
+    // the position is looked up by the current time of the clock, which
+    // may already have advanced while the orbit is being propagated
+    m_track->setInterpolate( true );
     placemark()->setGeometry( m_track );
 
     GeoDataStyle *style = new GeoDataStyle( *placemark()->style() );
@@ -91,25 +99,74 @@ void SatellitesTLEItem::update()
         return;
     }
 
-    QDateTime startTime = m_clock->dateTime().addSecs( - 2 * 60 );
+    propagate( m_clock->dateTime() );
+    updateTrack();
+}
 
-    QDateTime endTime = startTime.addSecs( period() );
+void SatellitesTLEItem::propagate( const QDateTime &dateTime )
+{
+    const double startTime = (double)dateTime.toTime_t() - 2 * 60;
+    const double endTime = startTime + period();
+
+    const qint64 first = (qint64)ceil( startTime / m_step );
+    const qint64 last = (qint64)floor( endTime / m_step );
+
+    const qint64 cachedLast = m_firstSample + m_orbit.size() - 1;
+    if ( m_orbit.isEmpty() || first > cachedLast || last < m_firstSample ) {
+        // the cached part of the orbit is of no use anymore
+        m_orbit.clear();
+        m_firstSample = first;
+    } else {
+        if ( first > m_firstSample ) {
+            m_orbit.remove( 0, first - m_firstSample );
+        } else if ( first < m_firstSample ) {
+            // the clock went backwards
+            QVector<GeoDataCoordinates> orbit;
+            orbit.reserve( m_firstSample - first + m_orbit.size() );
+            for ( qint64 sample = first; sample < m_firstSample; ++sample ) {
+                orbit.append( positionAt( sampleTime( sample ) ) );
+            }
+            orbit += m_orbit;
+            m_orbit = orbit;
+        }
+        m_firstSample = first;
 
-    m_track->removeBefore( startTime );
-    m_track->removeAfter( endTime );
+        if ( last < m_firstSample + m_orbit.size() - 1 ) {
+            m_orbit.resize( last - m_firstSample + 1 );
+        }
+    }
 
-    addPointAt( m_clock->dateTime() );
+    for ( qint64 sample = m_firstSample + m_orbit.size(); sample <= last; ++sample ) {
+        m_orbit.append( positionAt( sampleTime( sample ) ) );
+    }
 
-    // time interval between each point in the track, in seconds
-    double step = period() / 100.0;
+    m_currentTime = dateTime;
+    m_currentPosition = positionAt( dateTime.toTime_t() );
+}
 
-    for ( double i = startTime.toTime_t(); i < endTime.toTime_t(); i += step ) {
-        // No need to add points in this interval
-        if ( i >= m_track->firstWhen().toTime_t() ) {
-            i = m_track->lastWhen().toTime_t() + step;
+void SatellitesTLEItem::updateTrack()
+{
+    m_track->clear();
+
+    // the points are added in chronological order, so that the track
+    // only needs to append them
+    bool currentAdded = !m_currentPosition.isValid();
+    for ( int i = 0; i < m_orbit.size(); ++i ) {
+        const QDateTime when = QDateTime::fromTime_t( sampleTime( m_firstSample + i ) );
+        if ( !currentAdded && !( when < m_currentTime ) ) {
+            m_track->addPoint( m_currentTime, m_currentPosition );
+            currentAdded = true;
+            if ( when == m_currentTime ) {
+                continue;
+            }
+        }
+        if ( m_orbit.at( i ).isValid() ) {
+            m_track->addPoint( when, m_orbit.at( i ) );
         }
+    }
 
-        addPointAt( QDateTime::fromTime_t( i ) );
+    if ( !currentAdded ) {
+        m_track->addPoint( m_currentTime, m_currentPosition );
     }
 }
 
@@ -123,22 +180,23 @@ void SatellitesTLEItem::setOrbitColor(const QColor &color)
     placemark()->style()->lineStyle().setColor(color);
 }
 
-void SatellitesTLEItem::addPointAt( const QDateTime &dateTime )
+GeoDataCoordinates SatellitesTLEItem::positionAt( double time )
 {
     // in minutes
-    double timeSinceEpoch = (double)( dateTime.toTime_t() -
-        timeAtEpoch().toTime_t() ) / 60.0;
+    double timeSinceEpoch = ( time - m_epoch ) / 60.0;
 
     double r[3], v[3];
     sgp4( wgs84, m_satrec, timeSinceEpoch, r, v );
-
-    GeoDataCoordinates coordinates = fromTEME(
-        r[0], r[1], r[2], gmst( timeSinceEpoch ) );
     if ( m_satrec.error != 0 ) {
-        return;
+        return GeoDataCoordinates();
     }
 
-    m_track->addPoint( dateTime, coordinates);
+    return fromTEME( r[0], r[1], r[2], gmst( timeSinceEpoch ) );
+}
+
+uint SatellitesTLEItem::sampleTime( qint64 sample ) const
+{
+    return (uint)floor( sample * m_step );
 }
 
 QDateTime SatellitesTLEItem::timeAtEpoch()
@@ -18,6 +18,9 @@
 
 #include "sgp4/sgp4unit.h"
 
+#include <QDateTime>
+#include <QVector>
+
 class QColor;
 
 namespace Marble {
@@ -40,6 +43,24 @@ public:
 
     void update();
 
+    /**
+     * Compute the orbit from two minutes before @p dateTime until one
+     * period later, and the position at @p dateTime. Samples computed by
+     * earlier calls are reused, only the part of the orbit that is not
+     * cached yet is propagated.
+     *
+     * This does not touch the placemark, so it may run in a worker thread
+     * as long as no other method of this item is called at the same time.
+     * @see updateTrack()
+     */
+    void propagate( const QDateTime &dateTime );
+
+    /**
+     * Fill the track of the placemark with the result of the last call
+     * to propagate().
+     */
+    void updateTrack();
+
     QString name();
 
     void showOrbit( bool show );
@@ -55,13 +76,31 @@ private:
 
     const MarbleClock *m_clock;
 
+    double m_epoch; // in seconds since 1970-01-01T00:00:00Z
+    double m_step;  // time between two orbit samples, in seconds
+
+    // m_orbit[i] is the position at sampleTime( m_firstSample + i )
+    QVector<GeoDataCoordinates> m_orbit;
+    qint64 m_firstSample;
+
+    QDateTime m_currentTime;
+    GeoDataCoordinates m_currentPosition;
+
     void setDescription();
 
     /**
-     * Add a point in the GeoDataTrack geometry of the placemark with time
-     * dateTime and coordinates of the satellite determined from m_satrec.
+     * @return The coordinates of the satellite determined from m_satrec
+     * at @p time in seconds since 1970-01-01T00:00:00Z, or invalid
+     * coordinates if the propagation failed.
+     */
+    GeoDataCoordinates positionAt( double time );
+
+    /**
+     * @return The time of orbit sample @p sample in seconds since
+     * 1970-01-01T00:00:00Z. Samples are aligned to multiples of m_step
+     * so that they remain valid while the clock advances.
      */
-    void addPointAt( const QDateTime &dateTime );
+    uint sampleTime( qint64 sample ) const;
 
     /**
      * Create a GeoDataCoordinates object from the cartesian coordinates
@@ -0,0 +1,164 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "SatellitesModel.h"
+#include "TrackerPluginItem.h"
+
+#include "GeoDataPlacemark.h"
+#include "GeoDataTrack.h"
+#include "GeoDataTreeModel.h"
+#include "MarbleClock.h"
+
+#include <QEventLoop>
+#include <QTimer>
+#include <QtTest>
+
+namespace Marble
+{
+
+class SatellitesModelTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void propagation();
+    void benchmarkFullPropagation();
+    void benchmarkIncrementalPropagation();
+
+ private:
+    /**
+     * A catalogue of @p count TLE sets derived from the ISS, with
+     * different ascending nodes, mean anomalies and mean motions.
+     */
+    static QByteArray tleCatalog( int count );
+
+    bool waitForOrbits( SatellitesModel *model );
+
+    QByteArray m_catalog;
+};
+
+QByteArray SatellitesModelTest::tleCatalog( int count )
+{
+    QByteArray data;
+    for ( int i = 0; i < count; ++i ) {
+        QString line0 = QString( "SAT %1" ).arg( i );
+        QString line1;
+        line1.sprintf( "1 %05dU 98067A   13118.52623843  .00013327  00000-0  22941-3 0  1528",
+                       10000 + i );
+        QString line2;
+        line2.sprintf( "2 %05d  51.6480 %8.4f 0009474  23.3497 %8.4f %11.8f%05d0",
+                       10000 + i, ( i * 7 ) % 360 + 0.5, ( i * 37 ) % 360 + 0.5,
+                       14.0 + ( i % 200 ) / 100.0, i );
+        data += line0.toLatin1() + '\n' + line1.toLatin1() + '\n' + line2.toLatin1() + '\n';
+    }
+    return data;
+}
+
+bool SatellitesModelTest::waitForOrbits( SatellitesModel *model )
+{
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot( true );
+    connect( model, SIGNAL(orbitsUpdated()), &loop, SLOT(quit()) );
+    connect( &timeout, SIGNAL(timeout()), &loop, SLOT(quit()) );
+    timeout.start( 60000 );
+    loop.exec();
+
+    return timeout.isActive();
+}
+
+void SatellitesModelTest::initTestCase()
+{
+    m_catalog = tleCatalog( 10000 );
+}
+
+void SatellitesModelTest::propagation()
+{
+    GeoDataTreeModel treeModel;
+    MarbleClock clock;
+    // only the test advances the clock
+    clock.setUpdateInterval( 24 * 3600 );
+    clock.setDateTime( QDateTime( QDate( 2013, 4, 29 ), QTime( 12, 0, 0 ), Qt::UTC ) );
+
+    SatellitesModel model( &treeModel, &clock );
+    model.parseFile( "tle", tleCatalog( 100 ) );
+    QCOMPARE( model.items().size(), 100 );
+
+    model.setPlanet( "earth" );
+    QVERIFY( waitForOrbits( &model ) );
+
+    foreach( TrackerPluginItem *item, model.items() ) {
+        const GeoDataTrack *track = static_cast<const GeoDataTrack *>( item->placemark()->geometry() );
+        // one sample every hundredth of the period, plus the current position
+        QVERIFY( track->size() >= 100 );
+        QVERIFY( track->size() <= 102 );
+        QVERIFY( track->coordinatesAt( clock.dateTime() ).isValid() );
+    }
+
+    // advancing the clock moves the window over the orbit
+    const QDateTime later = clock.dateTime().addSecs( 10 * 60 );
+    clock.setDateTime( later );
+    QVERIFY( waitForOrbits( &model ) );
+
+    foreach( TrackerPluginItem *item, model.items() ) {
+        const GeoDataTrack *track = static_cast<const GeoDataTrack *>( item->placemark()->geometry() );
+        QVERIFY( track->size() >= 100 );
+        QVERIFY( track->size() <= 102 );
+        QVERIFY( track->firstWhen() >= later.addSecs( -2 * 60 ) );
+        QVERIFY( track->coordinatesAt( clock.dateTime() ).isValid() );
+    }
+}
+
+void SatellitesModelTest::benchmarkFullPropagation()
+{
+    GeoDataTreeModel treeModel;
+    MarbleClock clock;
+    clock.setUpdateInterval( 24 * 3600 );
+    QDateTime dateTime( QDate( 2013, 4, 29 ), QTime( 12, 0, 0 ), Qt::UTC );
+    clock.setDateTime( dateTime );
+
+    SatellitesModel model( &treeModel, &clock );
+    model.parseFile( "tle", m_catalog );
+    model.setPlanet( "earth" );
+    QVERIFY( waitForOrbits( &model ) );
+
+    QBENCHMARK {
+        // a day later none of the cached orbits can be reused
+        dateTime = dateTime.addDays( 1 );
+        clock.setDateTime( dateTime );
+        QVERIFY( waitForOrbits( &model ) );
+    }
+}
+
+void SatellitesModelTest::benchmarkIncrementalPropagation()
+{
+    GeoDataTreeModel treeModel;
+    MarbleClock clock;
+    clock.setUpdateInterval( 24 * 3600 );
+    QDateTime dateTime( QDate( 2013, 4, 29 ), QTime( 12, 0, 0 ), Qt::UTC );
+    clock.setDateTime( dateTime );
+
+    SatellitesModel model( &treeModel, &clock );
+    model.parseFile( "tle", m_catalog );
+    model.setPlanet( "earth" );
+    QVERIFY( waitForOrbits( &model ) );
+
+    QBENCHMARK {
+        // the usual clock tick only needs the samples at the end of the window
+        dateTime = dateTime.addSecs( 60 );
+        clock.setDateTime( dateTime );
+        QVERIFY( waitForOrbits( &model ) );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::SatellitesModelTest )
+
+#include "SatellitesModelTest.moc"
@@ -43,7 +43,9 @@ void BBCItemGetter::setSchedule( const GeoDataLatLonAltBox& box,
 
 void BBCItemGetter::setStationList( const QList<BBCStation>& items )
 {
+    m_scheduleMutex.lock();
     m_items = items;
+    m_scheduleMutex.unlock();
     ensureRunning();
 }
 
@@ -61,28 +63,26 @@ BBCStation BBCItemGetter::station( const QString &id )
 
 bool BBCItemGetter::workAvailable()
 {
-    return !m_scheduledBox.isNull()
+    // Without stations the schedule is kept until setStationList() is called
+    QMutexLocker locker( &m_scheduleMutex );
+    return !m_items.isEmpty()
+           && !m_scheduledBox.isNull()
            && m_scheduledNumber;
-
 }
 
 void BBCItemGetter::work()
 {
-    if ( m_items.isEmpty() ) {
-        sleep( 1 );
-        return;
-    }
-
     m_scheduleMutex.lock();
     GeoDataLatLonAltBox box = m_scheduledBox;
     qint32 number = m_scheduledNumber;
     m_scheduledBox = GeoDataLatLonAltBox();
     m_scheduledNumber = 0;
+    const QList<BBCStation> items = m_items;
     m_scheduleMutex.unlock();
 
     qint32 fetched = 0;
-    QList<BBCStation>::ConstIterator it = m_items.constBegin();
-    QList<BBCStation>::ConstIterator end = m_items.constEnd();
+    QList<BBCStation>::ConstIterator it = items.constBegin();
+    QList<BBCStation>::ConstIterator end = items.constEnd();
 
     while ( fetched < number && it != end ) {
         if ( box.contains( it->coordinate() ) ) {
@@ -12,14 +12,13 @@
 #include "GeoDataDocument.h"
 #include "GeoDataExtendedData.h"
 #include "GeoDataPlacemark.h"
+#include "PlacemarkCache.h"
 
 #include <QFile>
 
 namespace Marble
 {
 
-const quint32 MarbleMagicNumber = 0x31415926;
-
 CacheRunner::CacheRunner(QObject *parent) :
     ParsingRunner(parent)
 {
@@ -38,13 +37,23 @@ void CacheRunner::parseFile( const QString &fileName, DocumentRole role = Unknow
         return;
     }
 
+    // Caches of the current version are memory mapped
+    GeoDataDocument *cachedDocument = PlacemarkCache::load( fileName );
+    if ( cachedDocument ) {
+        cachedDocument->setDocumentRole( role );
+        cachedDocument->setFileName( fileName );
+        emit parsingFinished( cachedDocument );
+        return;
+    }
+
+    // Older caches are a stream of placemarks
     file.open( QIODevice::ReadOnly );
     QDataStream in( &file );
 
     // Read and check the header
     quint32 magic;
     in >> magic;
-    if ( magic != MarbleMagicNumber ) {
+    if ( magic != PlacemarkCache::magicNumber ) {
         emit parsingFinished( 0 );
         return;
     }
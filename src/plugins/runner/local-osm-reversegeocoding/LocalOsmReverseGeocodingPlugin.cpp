@@ -0,0 +1,68 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "LocalOsmReverseGeocodingPlugin.h"
+#include "LocalOsmReverseGeocodingRunner.h"
+
+namespace Marble
+{
+
+LocalOsmReverseGeocodingPlugin::LocalOsmReverseGeocodingPlugin( QObject *parent ) :
+    ReverseGeocodingRunnerPlugin( parent ),
+    m_databaseFiles()
+{
+    setSupportedCelestialBodies( QStringList() << "earth" );
+    setCanWorkOffline( true );
+}
+
+QString LocalOsmReverseGeocodingPlugin::name() const
+{
+    return tr( "Local OSM Reverse Geocoding" );
+}
+
+QString LocalOsmReverseGeocodingPlugin::guiString() const
+{
+    return tr( "Offline OpenStreetMap Reverse Geocoding" );
+}
+
+QString LocalOsmReverseGeocodingPlugin::nameId() const
+{
+    return "local-osm-reverse";
+}
+
+QString LocalOsmReverseGeocodingPlugin::version() const
+{
+    return "1.0";
+}
+
+QString LocalOsmReverseGeocodingPlugin::description() const
+{
+    return tr( "Looks up the closest address in offline maps." );
+}
+
+QString LocalOsmReverseGeocodingPlugin::copyrightYears() const
+{
+    return "2026";
+}
+
+QList<PluginAuthor> LocalOsmReverseGeocodingPlugin::pluginAuthors() const
+{
+    return QList<PluginAuthor>()
+            << PluginAuthor( "The Marble Team", "marble-devel@kde.org" );
+}
+
+ReverseGeocodingRunner* LocalOsmReverseGeocodingPlugin::newRunner() const
+{
+    return new LocalOsmReverseGeocodingRunner( m_databaseFiles.files() );
+}
+
+}
+
+Q_EXPORT_PLUGIN2( LocalOsmReverseGeocodingPlugin, Marble::LocalOsmReverseGeocodingPlugin )
+
+#include "LocalOsmReverseGeocodingPlugin.moc"
@@ -0,0 +1,49 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_LOCALOSMREVERSEGEOCODINGPLUGIN_H
+#define MARBLE_LOCALOSMREVERSEGEOCODINGPLUGIN_H
+
+#include "ReverseGeocodingRunnerPlugin.h"
+#include "OsmDatabaseFiles.h"
+
+namespace Marble
+{
+
+class LocalOsmReverseGeocodingPlugin : public ReverseGeocodingRunnerPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.LocalOsmReverseGeocodingPlugin" )
+    Q_INTERFACES( Marble::ReverseGeocodingRunnerPlugin )
+
+public:
+    explicit LocalOsmReverseGeocodingPlugin( QObject *parent = 0 );
+
+    QString name() const;
+
+    QString guiString() const;
+
+    QString nameId() const;
+
+    QString version() const;
+
+    QString description() const;
+
+    QString copyrightYears() const;
+
+    QList<PluginAuthor> pluginAuthors() const;
+
+    virtual ReverseGeocodingRunner* newRunner() const;
+
+private:
+    OsmDatabaseFiles m_databaseFiles;
+};
+
+}
+
+#endif
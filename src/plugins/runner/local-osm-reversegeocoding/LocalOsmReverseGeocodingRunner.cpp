@@ -0,0 +1,56 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "LocalOsmReverseGeocodingRunner.h"
+
+#include "GeoDataData.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataPlacemark.h"
+
+namespace Marble
+{
+
+LocalOsmReverseGeocodingRunner::LocalOsmReverseGeocodingRunner( const QStringList &databaseFiles, QObject *parent ) :
+    ReverseGeocodingRunner( parent ),
+    m_database( databaseFiles )
+{
+}
+
+LocalOsmReverseGeocodingRunner::~LocalOsmReverseGeocodingRunner()
+{
+}
+
+void LocalOsmReverseGeocodingRunner::reverseGeocoding( const GeoDataCoordinates &coordinates )
+{
+    GeoDataPlacemark placemark;
+    placemark.setCoordinate( coordinates );
+
+    // streets are stored as single points, so allow for some distance to them
+    OsmPlacemark nearest;
+    if ( m_database.findNearest( coordinates, 500.0, nearest ) ) {
+        QString address = nearest.name();
+        GeoDataExtendedData extendedData;
+        extendedData.addValue( GeoDataData( "road", nearest.name() ) );
+        if ( !nearest.houseNumber().isEmpty() ) {
+            address += ' ' + nearest.houseNumber();
+            extendedData.addValue( GeoDataData( "house_number", nearest.houseNumber() ) );
+        }
+        if ( !nearest.additionalInformation().isEmpty() ) {
+            address += ", " + nearest.additionalInformation();
+            extendedData.addValue( GeoDataData( "city", nearest.additionalInformation() ) );
+        }
+        placemark.setAddress( address );
+        placemark.setExtendedData( extendedData );
+    }
+
+    emit reverseGeocodingFinished( coordinates, placemark );
+}
+
+} // namespace Marble
+
+#include "LocalOsmReverseGeocodingRunner.moc"
@@ -0,0 +1,36 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_LOCALOSMREVERSEGEOCODINGRUNNER_H
+#define MARBLE_LOCALOSMREVERSEGEOCODINGRUNNER_H
+
+#include "ReverseGeocodingRunner.h"
+
+#include "OsmDatabase.h"
+
+namespace Marble
+{
+
+class LocalOsmReverseGeocodingRunner : public ReverseGeocodingRunner
+{
+    Q_OBJECT
+public:
+    explicit LocalOsmReverseGeocodingRunner( const QStringList &databaseFiles, QObject *parent = 0 );
+
+    ~LocalOsmReverseGeocodingRunner();
+
+    // Overriding MarbleAbstractRunner
+    virtual void reverseGeocoding( const GeoDataCoordinates &coordinates );
+
+private:
+    OsmDatabase m_database;
+};
+
+}
+
+#endif
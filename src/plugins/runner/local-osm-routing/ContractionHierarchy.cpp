@@ -0,0 +1,388 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ContractionHierarchy.h"
+
+#include "MarbleDebug.h"
+#include "MarbleGlobal.h"
+
+#include <QHash>
+#include <QPair>
+#include <QtEndian>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace Marble
+{
+
+const quint32 ContractionHierarchy::magicNumber = 0x4d434831;
+const quint32 ContractionHierarchy::version = 1;
+const qreal ContractionHierarchy::cellSize = 0.01;
+const quint32 ContractionHierarchy::noNode = 0xffffffff;
+
+namespace
+{
+
+// magic, version, node, edge and cell count
+const int headerSize = 20;
+
+const int cellEntrySize = 8;
+const int coordinateSize = 8;
+const int edgeSize = 12;
+
+struct Label
+{
+    quint32 distance;
+    int parent;
+    quint32 edge;
+};
+
+typedef QPair<quint32, int> HeapEntry;
+typedef std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > Heap;
+
+const int lonCells = 36000;
+const int latCells = 18000;
+
+int lonCell( qreal lon )
+{
+    return qBound( 0, int( ( lon + 180.0 ) / ContractionHierarchy::cellSize ), lonCells - 1 );
+}
+
+int latCell( qreal lat )
+{
+    return qBound( 0, int( ( lat + 90.0 ) / ContractionHierarchy::cellSize ), latCells - 1 );
+}
+
+}
+
+ContractionHierarchy::ContractionHierarchy() :
+    m_data( 0 ),
+    m_nodeCount( 0 ),
+    m_edgeCount( 0 ),
+    m_cellCount( 0 ),
+    m_cells( 0 ),
+    m_firstEdges( 0 ),
+    m_coordinates( 0 ),
+    m_edges( 0 )
+{
+}
+
+ContractionHierarchy::~ContractionHierarchy()
+{
+    if ( m_data ) {
+        m_file.unmap( const_cast<uchar *>( m_data ) );
+    }
+}
+
+bool ContractionHierarchy::load( const QString &fileName )
+{
+    Q_ASSERT( !m_data );
+
+    m_file.setFileName( fileName );
+    if ( !m_file.open( QIODevice::ReadOnly ) || m_file.size() < headerSize ) {
+        m_file.close();
+        return false;
+    }
+
+    const uchar *const data = m_file.map( 0, m_file.size() );
+    if ( !data ) {
+        mDebug() << "Cannot map routing graph" << fileName;
+        m_file.close();
+        return false;
+    }
+
+    if ( qFromLittleEndian<quint32>( data ) != magicNumber
+         || qFromLittleEndian<quint32>( data + 4 ) != version ) {
+        mDebug() << "Unsupported routing graph" << fileName;
+        m_file.unmap( const_cast<uchar *>( data ) );
+        m_file.close();
+        return false;
+    }
+
+    const quint32 nodeCount = qFromLittleEndian<quint32>( data + 8 );
+    const quint32 edgeCount = qFromLittleEndian<quint32>( data + 12 );
+    const quint32 cellCount = qFromLittleEndian<quint32>( data + 16 );
+
+    const qint64 size = headerSize
+            + qint64( cellCount + 1 ) * cellEntrySize
+            + qint64( nodeCount + 1 ) * 4
+            + qint64( nodeCount ) * coordinateSize
+            + qint64( edgeCount ) * edgeSize;
+    if ( m_file.size() != size ) {
+        mDebug() << "Truncated routing graph" << fileName;
+        m_file.unmap( const_cast<uchar *>( data ) );
+        m_file.close();
+        return false;
+    }
+
+    m_data = data;
+    m_nodeCount = nodeCount;
+    m_edgeCount = edgeCount;
+    m_cellCount = cellCount;
+    m_cells = m_data + headerSize;
+    m_firstEdges = m_cells + ( m_cellCount + 1 ) * cellEntrySize;
+    m_coordinates = m_firstEdges + ( m_nodeCount + 1 ) * 4;
+    m_edges = m_coordinates + m_nodeCount * coordinateSize;
+
+    return true;
+}
+
+int ContractionHierarchy::nodeCount() const
+{
+    return m_nodeCount;
+}
+
+GeoDataCoordinates ContractionHierarchy::coordinates( int node ) const
+{
+    Q_ASSERT( node >= 0 && quint32( node ) < m_nodeCount );
+    const qint32 lon = qFromLittleEndian<qint32>( m_coordinates + node * coordinateSize );
+    const qint32 lat = qFromLittleEndian<qint32>( m_coordinates + node * coordinateSize + 4 );
+    return GeoDataCoordinates( lon * 1e-7, lat * 1e-7, 0.0, GeoDataCoordinates::Degree );
+}
+
+quint32 ContractionHierarchy::cellKey( qreal lon, qreal lat )
+{
+    return quint32( lonCell( lon ) ) * latCells + latCell( lat );
+}
+
+int ContractionHierarchy::nearestNode( const GeoDataCoordinates &coordinates, qreal maximumDistance ) const
+{
+    if ( !m_data ) {
+        return -1;
+    }
+
+    const qreal lon = coordinates.longitude( GeoDataCoordinates::Degree );
+    const qreal lat = coordinates.latitude( GeoDataCoordinates::Degree );
+    // degrees of longitude get shorter towards the poles
+    const qreal lonScale = qMax<qreal>( cos( coordinates.latitude() ), 0.01 );
+
+    const int centerLon = lonCell( lon );
+    const int centerLat = latCell( lat );
+
+    // distances in degrees of latitude
+    qreal bestDistance = maximumDistance / EARTH_RADIUS * RAD2DEG;
+    const int maximumRing = int( bestDistance / ( cellSize * lonScale ) ) + 1;
+    int bestNode = -1;
+
+    for ( int ring = 0; ring <= maximumRing; ++ring ) {
+        // all cells of this ring are at least that far away
+        if ( ( ring - 1 ) * cellSize * lonScale > bestDistance ) {
+            break;
+        }
+
+        for ( int i = centerLon - ring; i <= centerLon + ring; ++i ) {
+            // inner columns of the ring only have their top and bottom cell in it
+            const bool border = i == centerLon - ring || i == centerLon + ring;
+            const int step = border ? 1 : 2 * ring;
+            for ( int j = centerLat - ring; j <= centerLat + ring; j += step ) {
+                if ( i < 0 || i >= lonCells || j < 0 || j >= latCells ) {
+                    continue;
+                }
+
+                quint32 begin, end;
+                if ( !cellNodes( quint32( i ) * latCells + j, begin, end ) ) {
+                    continue;
+                }
+
+                for ( quint32 node = begin; node < end; ++node ) {
+                    const qreal nodeLon = qFromLittleEndian<qint32>( m_coordinates + node * coordinateSize ) * 1e-7;
+                    const qreal nodeLat = qFromLittleEndian<qint32>( m_coordinates + node * coordinateSize + 4 ) * 1e-7;
+                    const qreal distance = sqrt( ( nodeLat - lat ) * ( nodeLat - lat )
+                                                 + ( nodeLon - lon ) * ( nodeLon - lon ) * lonScale * lonScale );
+                    if ( distance <= bestDistance ) {
+                        bestDistance = distance;
+                        bestNode = node;
+                    }
+                }
+            }
+        }
+    }
+
+    return bestNode;
+}
+
+qint64 ContractionHierarchy::route( int source, int target, QVector<int> *path ) const
+{
+    if ( !m_data || source < 0 || target < 0 || quint32( source ) >= m_nodeCount || quint32( target ) >= m_nodeCount ) {
+        return -1;
+    }
+
+    // index 0 searches forward from the source, index 1 backward from the target
+    QHash<int, Label> labels[2];
+    Heap heaps[2];
+    const EdgeFlag flags[2] = { Forward, Backward };
+
+    const Label sourceLabel = { 0, -1, 0 };
+    labels[0].insert( source, sourceLabel );
+    heaps[0].push( HeapEntry( 0, source ) );
+    labels[1].insert( target, sourceLabel );
+    heaps[1].push( HeapEntry( 0, target ) );
+
+    quint32 best = 0xffffffff;
+    int meeting = -1;
+
+    forever {
+        // continue the direction with the closer node, as long as it can still improve the route
+        int direction = -1;
+        if ( !heaps[0].empty() && heaps[0].top().first < best ) {
+            direction = 0;
+        }
+        if ( !heaps[1].empty() && heaps[1].top().first < best
+             && ( direction < 0 || heaps[1].top().first < heaps[0].top().first ) ) {
+            direction = 1;
+        }
+        if ( direction < 0 ) {
+            break;
+        }
+
+        const HeapEntry entry = heaps[direction].top();
+        heaps[direction].pop();
+        const quint32 distance = entry.first;
+        const int node = entry.second;
+        if ( distance > labels[direction].value( node ).distance ) {
+            // already settled with a shorter distance
+            continue;
+        }
+
+        QHash<int, Label>::const_iterator other = labels[1 - direction].constFind( node );
+        if ( other != labels[1 - direction].constEnd() && distance + other.value().distance < best ) {
+            best = distance + other.value().distance;
+            meeting = node;
+        }
+
+        const quint32 end = firstEdge( node + 1 );
+        for ( quint32 edge = firstEdge( node ); edge < end; ++edge ) {
+            if ( !( edgeFlags( edge ) & flags[direction] ) ) {
+                continue;
+            }
+
+            const int next = edgeTarget( edge );
+            const quint32 nextDistance = distance + edgeWeight( edge );
+            QHash<int, Label>::iterator label = labels[direction].find( next );
+            if ( label == labels[direction].end() ) {
+                const Label nextLabel = { nextDistance, node, edge };
+                labels[direction].insert( next, nextLabel );
+                heaps[direction].push( HeapEntry( nextDistance, next ) );
+            } else if ( nextDistance < label.value().distance ) {
+                label.value().distance = nextDistance;
+                label.value().parent = node;
+                label.value().edge = edge;
+                heaps[direction].push( HeapEntry( nextDistance, next ) );
+            }
+        }
+    }
+
+    if ( meeting < 0 ) {
+        return -1;
+    }
+
+    if ( path ) {
+        path->clear();
+        path->append( source );
+
+        // the forward search tree leads from the source up to the meeting node
+        QVector<int> upwards;
+        for ( int node = meeting; node != source; node = labels[0].value( node ).parent ) {
+            upwards.append( node );
+        }
+        for ( int i = upwards.size() - 1; i >= 0; --i ) {
+            const Label &label = labels[0].value( upwards.at( i ) );
+            unpack( label.parent, upwards.at( i ), label.edge, path );
+        }
+
+        // the backward search tree leads from the meeting node down to the target
+        for ( int node = meeting; node != target; ) {
+            const Label label = labels[1].value( node );
+            unpack( node, label.parent, label.edge, path );
+            node = label.parent;
+        }
+    }
+
+    return best;
+}
+
+quint32 ContractionHierarchy::firstEdge( int node ) const
+{
+    return qFromLittleEndian<quint32>( m_firstEdges + 4 * node );
+}
+
+quint32 ContractionHierarchy::edgeTarget( quint32 edge ) const
+{
+    return qFromLittleEndian<quint32>( m_edges + edge * edgeSize );
+}
+
+quint32 ContractionHierarchy::edgeWeight( quint32 edge ) const
+{
+    return qFromLittleEndian<quint32>( m_edges + edge * edgeSize + 4 ) >> 2;
+}
+
+quint32 ContractionHierarchy::edgeFlags( quint32 edge ) const
+{
+    return qFromLittleEndian<quint32>( m_edges + edge * edgeSize + 4 ) & 0x3;
+}
+
+quint32 ContractionHierarchy::edgeMiddle( quint32 edge ) const
+{
+    return qFromLittleEndian<quint32>( m_edges + edge * edgeSize + 8 );
+}
+
+quint32 ContractionHierarchy::findEdge( int node, int target, EdgeFlag flag ) const
+{
+    quint32 result = noNode;
+    const quint32 end = firstEdge( node + 1 );
+    for ( quint32 edge = firstEdge( node ); edge < end; ++edge ) {
+        if ( edgeTarget( edge ) == quint32( target ) && ( edgeFlags( edge ) & flag ) ) {
+            if ( result == noNode || edgeWeight( edge ) < edgeWeight( result ) ) {
+                result = edge;
+            }
+        }
+    }
+
+    Q_ASSERT( result != noNode );
+    return result;
+}
+
+void ContractionHierarchy::unpack( int from, int to, quint32 edge, QVector<int> *path ) const
+{
+    const quint32 middle = edgeMiddle( edge );
+    if ( middle == noNode ) {
+        path->append( to );
+        return;
+    }
+
+    // the bypassed node was contracted before both ends, so it stores both halves
+    unpack( from, middle, findEdge( middle, from, Backward ), path );
+    unpack( middle, to, findEdge( middle, to, Forward ), path );
+}
+
+bool ContractionHierarchy::cellNodes( quint32 key, quint32 &begin, quint32 &end ) const
+{
+    // binary search in the sorted cell table, the last entry is a sentinel
+    quint32 low = 0;
+    quint32 high = m_cellCount;
+    while ( low < high ) {
+        const quint32 middle = low + ( high - low ) / 2;
+        if ( qFromLittleEndian<quint32>( m_cells + middle * cellEntrySize ) < key ) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if ( low >= m_cellCount || qFromLittleEndian<quint32>( m_cells + low * cellEntrySize ) != key ) {
+        return false;
+    }
+
+    begin = qFromLittleEndian<quint32>( m_cells + low * cellEntrySize + 4 );
+    end = qFromLittleEndian<quint32>( m_cells + ( low + 1 ) * cellEntrySize + 4 );
+    return true;
+}
+
+}
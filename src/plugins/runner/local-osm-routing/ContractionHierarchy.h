@@ -0,0 +1,108 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CONTRACTIONHIERARCHY_H
+#define MARBLE_CONTRACTIONHIERARCHY_H
+
+#include "GeoDataCoordinates.h"
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+namespace Marble
+{
+
+/**
+ * A road network preprocessed into a contraction hierarchy, as written by
+ * ContractionHierarchyBuilder. The graph file is memory mapped.
+ *
+ * Each node only stores the edges to nodes that were contracted after it,
+ * so a bidirectional Dijkstra search from source and target only ever
+ * walks upwards in the hierarchy and settles a few hundred nodes even on
+ * country sized networks. Shortcut edges remember the node they bypass,
+ * which allows to unpack them into the original road nodes.
+ *
+ * Nodes are numbered by grid cells of cellSize degrees, and the file holds
+ * the node range of each cell for looking up the nodes close to a position.
+ */
+class ContractionHierarchy
+{
+ public:
+    ContractionHierarchy();
+
+    ~ContractionHierarchy();
+
+    /** Maps the graph file @p fileName. Returns false if it is no valid graph. */
+    bool load( const QString &fileName );
+
+    int nodeCount() const;
+
+    GeoDataCoordinates coordinates( int node ) const;
+
+    /**
+     * Returns the node closest to @p coordinates, or -1 if there is
+     * none within @p maximumDistance meters.
+     */
+    int nearestNode( const GeoDataCoordinates &coordinates, qreal maximumDistance ) const;
+
+    /**
+     * Returns the travel time in tenths of a second of the fastest route
+     * from @p source to @p target, or -1 if there is none. If @p path is
+     * given, it receives the nodes along the route, including both ends.
+     */
+    qint64 route( int source, int target, QVector<int> *path = 0 ) const;
+
+    static quint32 cellKey( qreal lon, qreal lat );
+
+    static const quint32 magicNumber;
+    static const quint32 version;
+    static const qreal cellSize;
+
+    /** Edge flags: the edge leads from its node to its target, or from its target to its node */
+    enum EdgeFlag {
+        Forward = 0x1,
+        Backward = 0x2
+    };
+
+    static const quint32 noNode;
+
+ private:
+    Q_DISABLE_COPY( ContractionHierarchy )
+
+    quint32 firstEdge( int node ) const;
+    quint32 edgeTarget( quint32 edge ) const;
+    quint32 edgeWeight( quint32 edge ) const;
+    quint32 edgeFlags( quint32 edge ) const;
+    quint32 edgeMiddle( quint32 edge ) const;
+
+    /** The edge of @p node to @p target with @p flag */
+    quint32 findEdge( int node, int target, EdgeFlag flag ) const;
+
+    /** Appends the nodes after @p from of the edge from @p from to @p to to @p path */
+    void unpack( int from, int to, quint32 edge, QVector<int> *path ) const;
+
+    /** The range of nodes in the cell @p key */
+    bool cellNodes( quint32 key, quint32 &begin, quint32 &end ) const;
+
+    QFile m_file;
+    const uchar *m_data;
+
+    quint32 m_nodeCount;
+    quint32 m_edgeCount;
+    quint32 m_cellCount;
+
+    const uchar *m_cells;
+    const uchar *m_firstEdges;
+    const uchar *m_coordinates;
+    const uchar *m_edges;
+};
+
+}
+
+#endif
@@ -0,0 +1,382 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ContractionHierarchyBuilder.h"
+
+#include "ContractionHierarchy.h"
+#include "MarbleMath.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QPair>
+#include <QtAlgorithms>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace Marble
+{
+
+namespace
+{
+
+const quint32 infinity = 0xffffffff;
+
+// Witness searches give up after settling that many nodes. Shortcuts
+// might be superfluous then, but the hierarchy stays correct.
+const int maximumSettledNodes = 500;
+
+// weights share their field with the edge flags in the graph file
+const quint32 maximumEdgeWeight = 0x3fffffff;
+
+}
+
+ContractionHierarchyBuilder::ContractionHierarchyBuilder() :
+    m_shortcutCount( 0 )
+{
+}
+
+int ContractionHierarchyBuilder::addNode( qreal lon, qreal lat )
+{
+    Node node;
+    node.lon = qRound( lon * 1e7 );
+    node.lat = qRound( lat * 1e7 );
+    node.deletedNeighbors = 0;
+    node.contracted = false;
+    m_nodes.append( node );
+
+    return m_nodes.size() - 1;
+}
+
+void ContractionHierarchyBuilder::addEdge( int from, int to, qreal speed, bool forward, bool backward )
+{
+    Q_ASSERT( from >= 0 && from < m_nodes.size() );
+    Q_ASSERT( to >= 0 && to < m_nodes.size() );
+    if ( from == to || speed <= 0.0 ) {
+        return;
+    }
+
+    const Node &a = m_nodes.at( from );
+    const Node &b = m_nodes.at( to );
+    const quint32 weight = travelTime( a.lon * 1e-7, a.lat * 1e-7, b.lon * 1e-7, b.lat * 1e-7, speed );
+    if ( forward ) {
+        addArc( from, to, weight, ContractionHierarchy::noNode );
+    }
+    if ( backward ) {
+        addArc( to, from, weight, ContractionHierarchy::noNode );
+    }
+}
+
+quint32 ContractionHierarchyBuilder::travelTime( qreal lon1, qreal lat1, qreal lon2, qreal lat2, qreal speed )
+{
+    const qreal distance = EARTH_RADIUS * distanceSphere( lon1 * DEG2RAD, lat1 * DEG2RAD, lon2 * DEG2RAD, lat2 * DEG2RAD );
+    return qMax<quint32>( 1, qRound( 10.0 * distance / ( speed / 3.6 ) ) );
+}
+
+void ContractionHierarchyBuilder::addArc( quint32 from, quint32 to, quint32 weight, quint32 middle )
+{
+    weight = qMin( weight, maximumEdgeWeight );
+
+    QVector<Edge> &out = m_nodes[from].out;
+    for ( int i = 0; i < out.size(); ++i ) {
+        if ( out.at( i ).node == to ) {
+            if ( weight < out.at( i ).weight ) {
+                out[i].weight = weight;
+                out[i].middle = middle;
+                QVector<Edge> &in = m_nodes[to].in;
+                for ( int j = 0; j < in.size(); ++j ) {
+                    if ( in.at( j ).node == from ) {
+                        in[j].weight = weight;
+                        in[j].middle = middle;
+                    }
+                }
+            }
+            return;
+        }
+    }
+
+    const Edge outEdge = { to, weight, middle };
+    out.append( outEdge );
+    const Edge inEdge = { from, weight, middle };
+    m_nodes[to].in.append( inEdge );
+}
+
+void ContractionHierarchyBuilder::witnessSearch( quint32 source, quint32 excluded, quint32 maximumWeight )
+{
+    foreach ( quint32 node, m_touched ) {
+        m_distances[node] = infinity;
+    }
+    m_touched.clear();
+
+    typedef QPair<quint32, quint32> HeapEntry;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap;
+    m_distances[source] = 0;
+    m_touched.append( source );
+    heap.push( HeapEntry( 0, source ) );
+
+    int settled = 0;
+    while ( !heap.empty() ) {
+        const HeapEntry entry = heap.top();
+        heap.pop();
+        if ( entry.first > m_distances.at( entry.second ) ) {
+            continue;
+        }
+        if ( entry.first > maximumWeight || ++settled > maximumSettledNodes ) {
+            break;
+        }
+
+        foreach ( const Edge &edge, m_nodes.at( entry.second ).out ) {
+            if ( edge.node == excluded ) {
+                continue;
+            }
+            const quint32 distance = entry.first + edge.weight;
+            if ( distance < m_distances.at( edge.node ) ) {
+                if ( m_distances.at( edge.node ) == infinity ) {
+                    m_touched.append( edge.node );
+                }
+                m_distances[edge.node] = distance;
+                heap.push( HeapEntry( distance, edge.node ) );
+            }
+        }
+    }
+}
+
+int ContractionHierarchyBuilder::contractNode( quint32 node, bool simulate )
+{
+    int shortcuts = 0;
+
+    // copies, as adding shortcuts may modify the edge lists of the node
+    const QVector<Edge> in = m_nodes.at( node ).in;
+    const QVector<Edge> out = m_nodes.at( node ).out;
+
+    foreach ( const Edge &inEdge, in ) {
+        quint32 maximumWeight = 0;
+        foreach ( const Edge &outEdge, out ) {
+            if ( outEdge.node != inEdge.node ) {
+                maximumWeight = qMax( maximumWeight, inEdge.weight + outEdge.weight );
+            }
+        }
+        if ( maximumWeight == 0 ) {
+            continue;
+        }
+
+        witnessSearch( inEdge.node, node, maximumWeight );
+
+        foreach ( const Edge &outEdge, out ) {
+            if ( outEdge.node == inEdge.node ) {
+                continue;
+            }
+
+            const quint32 weight = inEdge.weight + outEdge.weight;
+            if ( m_distances.at( outEdge.node ) <= weight ) {
+                // there is a witness path that is at least as fast
+                continue;
+            }
+
+            ++shortcuts;
+            if ( !simulate ) {
+                addArc( inEdge.node, outEdge.node, weight, node );
+            }
+        }
+    }
+
+    return shortcuts;
+}
+
+int ContractionHierarchyBuilder::priority( quint32 node )
+{
+    const Node &n = m_nodes.at( node );
+    const int edgeDifference = contractNode( node, true ) - n.in.size() - n.out.size();
+    return edgeDifference + n.deletedNeighbors;
+}
+
+void ContractionHierarchyBuilder::addUpwardEdge( quint32 node, const Edge &edge, quint32 flag )
+{
+    QVector<UpwardEdge> &edges = m_upwardEdges[node];
+    for ( int i = 0; i < edges.size(); ++i ) {
+        if ( edges.at( i ).target == edge.node && edges.at( i ).weight == edge.weight && edges.at( i ).middle == edge.middle ) {
+            edges[i].flags |= flag;
+            return;
+        }
+    }
+
+    const UpwardEdge upwardEdge = { edge.node, edge.weight, edge.middle, flag };
+    edges.append( upwardEdge );
+}
+
+void ContractionHierarchyBuilder::contract()
+{
+    const int nodeCount = m_nodes.size();
+    m_distances.fill( infinity, nodeCount );
+    m_touched.clear();
+    m_upwardEdges.clear();
+    m_upwardEdges.resize( nodeCount );
+    m_shortcutCount = 0;
+
+    // the heap may contain outdated priorities of a node, only the current one counts
+    typedef QPair<int, quint32> HeapEntry;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap;
+    QVector<int> priorities( nodeCount );
+    for ( int i = 0; i < nodeCount; ++i ) {
+        priorities[i] = priority( i );
+        heap.push( HeapEntry( priorities.at( i ), i ) );
+    }
+
+    int contracted = 0;
+    while ( !heap.empty() ) {
+        const HeapEntry entry = heap.top();
+        heap.pop();
+        const quint32 node = entry.second;
+        if ( m_nodes.at( node ).contracted || entry.first != priorities.at( node ) ) {
+            continue;
+        }
+
+        // lazy update: the priority may have grown since the neighbors changed
+        const int current = priority( node );
+        if ( !heap.empty() && current > heap.top().first ) {
+            priorities[node] = current;
+            heap.push( HeapEntry( current, node ) );
+            continue;
+        }
+
+        m_shortcutCount += contractNode( node, false );
+
+        // the remaining edges lead to nodes that are contracted later
+        Node &n = m_nodes[node];
+        foreach ( const Edge &edge, n.out ) {
+            addUpwardEdge( node, edge, ContractionHierarchy::Forward );
+        }
+        foreach ( const Edge &edge, n.in ) {
+            addUpwardEdge( node, edge, ContractionHierarchy::Backward );
+        }
+
+        QVector<quint32> neighbors;
+        foreach ( const Edge &edge, n.out ) {
+            QVector<Edge> &in = m_nodes[edge.node].in;
+            for ( int i = in.size() - 1; i >= 0; --i ) {
+                if ( in.at( i ).node == node ) {
+                    in.remove( i );
+                }
+            }
+            if ( !neighbors.contains( edge.node ) ) {
+                neighbors.append( edge.node );
+            }
+        }
+        foreach ( const Edge &edge, n.in ) {
+            QVector<Edge> &out = m_nodes[edge.node].out;
+            for ( int i = out.size() - 1; i >= 0; --i ) {
+                if ( out.at( i ).node == node ) {
+                    out.remove( i );
+                }
+            }
+            if ( !neighbors.contains( edge.node ) ) {
+                neighbors.append( edge.node );
+            }
+        }
+
+        n.contracted = true;
+        n.out.clear();
+        n.in.clear();
+        n.out.squeeze();
+        n.in.squeeze();
+
+        foreach ( quint32 neighbor, neighbors ) {
+            ++m_nodes[neighbor].deletedNeighbors;
+            priorities[neighbor] = priority( neighbor );
+            heap.push( HeapEntry( priorities.at( neighbor ), neighbor ) );
+        }
+
+        if ( ++contracted % 100000 == 0 ) {
+            qDebug() << "Contracted" << contracted << "of" << nodeCount << "nodes," << m_shortcutCount << "shortcuts";
+        }
+    }
+
+    m_distances.clear();
+    m_touched.clear();
+}
+
+bool ContractionHierarchyBuilder::save( const QString &fileName ) const
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) ) {
+        qCritical() << "Cannot write routing graph" << fileName;
+        return false;
+    }
+
+    // order the nodes by grid cells, which allows to find the nodes close to a position
+    const int nodeCount = m_nodes.size();
+    QVector<QPair<quint32, quint32> > order( nodeCount );
+    for ( int i = 0; i < nodeCount; ++i ) {
+        const Node &node = m_nodes.at( i );
+        order[i] = qMakePair( ContractionHierarchy::cellKey( node.lon * 1e-7, node.lat * 1e-7 ), quint32( i ) );
+    }
+    qSort( order );
+
+    QVector<quint32> index( nodeCount );
+    for ( int i = 0; i < nodeCount; ++i ) {
+        index[order.at( i ).second] = i;
+    }
+
+    QVector<QPair<quint32, quint32> > cells;
+    for ( int i = 0; i < nodeCount; ++i ) {
+        if ( cells.isEmpty() || cells.last().first != order.at( i ).first ) {
+            cells.append( qMakePair( order.at( i ).first, quint32( i ) ) );
+        }
+    }
+
+    quint32 edgeCount = 0;
+    foreach ( const QVector<UpwardEdge> &edges, m_upwardEdges ) {
+        edgeCount += edges.size();
+    }
+
+    QDataStream stream( &file );
+    stream.setByteOrder( QDataStream::LittleEndian );
+    stream << ContractionHierarchy::magicNumber << ContractionHierarchy::version;
+    stream << quint32( nodeCount ) << edgeCount << quint32( cells.size() );
+
+    for ( int i = 0; i < cells.size(); ++i ) {
+        stream << cells.at( i ).first << cells.at( i ).second;
+    }
+    stream << ContractionHierarchy::noNode << quint32( nodeCount );
+
+    quint32 firstEdge = 0;
+    for ( int i = 0; i < nodeCount; ++i ) {
+        stream << firstEdge;
+        firstEdge += m_upwardEdges.at( order.at( i ).second ).size();
+    }
+    stream << firstEdge;
+
+    for ( int i = 0; i < nodeCount; ++i ) {
+        const Node &node = m_nodes.at( order.at( i ).second );
+        stream << node.lon << node.lat;
+    }
+
+    for ( int i = 0; i < nodeCount; ++i ) {
+        foreach ( const UpwardEdge &edge, m_upwardEdges.at( order.at( i ).second ) ) {
+            stream << index.at( edge.target );
+            stream << quint32( ( edge.weight << 2 ) | edge.flags );
+            stream << ( edge.middle == ContractionHierarchy::noNode ? edge.middle : index.at( edge.middle ) );
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+int ContractionHierarchyBuilder::nodeCount() const
+{
+    return m_nodes.size();
+}
+
+int ContractionHierarchyBuilder::shortcutCount() const
+{
+    return m_shortcutCount;
+}
+
+}
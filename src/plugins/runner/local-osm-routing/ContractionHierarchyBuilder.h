@@ -0,0 +1,101 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CONTRACTIONHIERARCHYBUILDER_H
+#define MARBLE_CONTRACTIONHIERARCHYBUILDER_H
+
+#include <QString>
+#include <QVector>
+
+namespace Marble
+{
+
+/**
+ * Preprocesses a road network into the graph files read by ContractionHierarchy.
+ *
+ * Nodes are contracted one by one in the order of their edge difference,
+ * the number of shortcuts their removal needs minus the number of their
+ * edges. A shortcut is only added if a local witness search finds no other
+ * path between the two neighbors that is as fast.
+ */
+class ContractionHierarchyBuilder
+{
+ public:
+    ContractionHierarchyBuilder();
+
+    /** Adds a junction or shape point of a road and returns its index */
+    int addNode( qreal lon, qreal lat );
+
+    /**
+     * Adds a road segment between two nodes that is driven at @p speed km/h,
+     * from @p from to @p to if @p forward and in the opposite direction if @p backward.
+     */
+    void addEdge( int from, int to, qreal speed, bool forward, bool backward );
+
+    /** Contracts all nodes. Call this once after adding all nodes and edges. */
+    void contract();
+
+    bool save( const QString &fileName ) const;
+
+    int nodeCount() const;
+
+    int shortcutCount() const;
+
+    /** The travel time in tenths of a second between two points at @p speed km/h */
+    static quint32 travelTime( qreal lon1, qreal lat1, qreal lon2, qreal lat2, qreal speed );
+
+ private:
+    struct Edge
+    {
+        quint32 node;
+        quint32 weight;
+        quint32 middle;
+    };
+
+    struct Node
+    {
+        qint32 lon;
+        qint32 lat;
+        QVector<Edge> out;
+        QVector<Edge> in;
+        int deletedNeighbors;
+        bool contracted;
+    };
+
+    struct UpwardEdge
+    {
+        quint32 target;
+        quint32 weight;
+        quint32 middle;
+        quint32 flags;
+    };
+
+    /** Adds an edge, or lowers the weight of an existing one */
+    void addArc( quint32 from, quint32 to, quint32 weight, quint32 middle );
+
+    /** Sets the distances of the nodes close to @p source, avoiding @p excluded */
+    void witnessSearch( quint32 source, quint32 excluded, quint32 maximumWeight );
+
+    /** Returns the number of shortcuts needed to contract @p node, and adds them unless @p simulate */
+    int contractNode( quint32 node, bool simulate );
+
+    int priority( quint32 node );
+
+    void addUpwardEdge( quint32 node, const Edge &edge, quint32 flag );
+
+    QVector<Node> m_nodes;
+    QVector<QVector<UpwardEdge> > m_upwardEdges;
+    int m_shortcutCount;
+
+    QVector<quint32> m_distances;
+    QVector<quint32> m_touched;
+};
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "LocalOsmRoutingPlugin.h"
+#include "LocalOsmRoutingRunner.h"
+#include "MarbleDirs.h"
+
+#include <QDir>
+
+namespace Marble
+{
+
+LocalOsmRoutingPlugin::LocalOsmRoutingPlugin( QObject *parent ) :
+    RoutingRunnerPlugin( parent )
+{
+    setSupportedCelestialBodies( QStringList() << "earth" );
+    setCanWorkOffline( true );
+}
+
+QString LocalOsmRoutingPlugin::name() const
+{
+    return tr( "Local OSM Routing" );
+}
+
+QString LocalOsmRoutingPlugin::guiString() const
+{
+    return tr( "Offline OpenStreetMap Routing" );
+}
+
+QString LocalOsmRoutingPlugin::nameId() const
+{
+    return "local-osm-routing";
+}
+
+QString LocalOsmRoutingPlugin::version() const
+{
+    return "1.0";
+}
+
+QString LocalOsmRoutingPlugin::description() const
+{
+    return tr( "Offline route retrieval using preprocessed OpenStreetMap road networks" );
+}
+
+QString LocalOsmRoutingPlugin::copyrightYears() const
+{
+    return "2026";
+}
+
+QList<PluginAuthor> LocalOsmRoutingPlugin::pluginAuthors() const
+{
+    return QList<PluginAuthor>()
+            << PluginAuthor( "The Marble Team", "marble-devel@kde.org" );
+}
+
+RoutingRunner *LocalOsmRoutingPlugin::newRunner() const
+{
+    return new LocalOsmRoutingRunner( graphFiles() );
+}
+
+bool LocalOsmRoutingPlugin::canWork() const
+{
+    return !graphFiles().isEmpty();
+}
+
+bool LocalOsmRoutingPlugin::supportsTemplate( RoutingProfilesModel::ProfileTemplate profileTemplate ) const
+{
+    // the graphs only contain car travel times
+    return profileTemplate == RoutingProfilesModel::CarFastestTemplate;
+}
+
+QStringList LocalOsmRoutingPlugin::graphFiles()
+{
+    QStringList result;
+    QStringList const baseDirs = QStringList() << MarbleDirs::localPath() << MarbleDirs::systemPath();
+    foreach ( const QString &baseDir, baseDirs ) {
+        QDir directory( baseDir + "/maps/earth/local-osm-routing/" );
+        QStringList const files = directory.entryList( QStringList() << "*.ch", QDir::Files );
+        foreach ( const QString &file, files ) {
+            result << directory.filePath( file );
+        }
+    }
+
+    return result;
+}
+
+}
+
+Q_EXPORT_PLUGIN2( LocalOsmRoutingPlugin, Marble::LocalOsmRoutingPlugin )
+
+#include "LocalOsmRoutingPlugin.moc"
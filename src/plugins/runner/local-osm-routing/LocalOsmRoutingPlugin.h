@@ -0,0 +1,55 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_LOCALOSMROUTINGPLUGIN_H
+#define MARBLE_LOCALOSMROUTINGPLUGIN_H
+
+#include "RoutingRunnerPlugin.h"
+
+#include <QStringList>
+
+namespace Marble
+{
+
+class LocalOsmRoutingPlugin : public RoutingRunnerPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA( IID "org.kde.edu.marble.LocalOsmRoutingPlugin" )
+    Q_INTERFACES( Marble::RoutingRunnerPlugin )
+
+public:
+    explicit LocalOsmRoutingPlugin( QObject *parent = 0 );
+
+    QString name() const;
+
+    QString guiString() const;
+
+    QString nameId() const;
+
+    QString version() const;
+
+    QString description() const;
+
+    QString copyrightYears() const;
+
+    QList<PluginAuthor> pluginAuthors() const;
+
+    virtual RoutingRunner *newRunner() const;
+
+    virtual bool supportsTemplate(RoutingProfilesModel::ProfileTemplate profileTemplate) const;
+
+    virtual bool canWork() const;
+
+private:
+    /** The routing graphs created by osm-addresses --routing */
+    static QStringList graphFiles();
+};
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "LocalOsmRoutingRunner.h"
+
+#include "ContractionHierarchy.h"
+
+#include "MarbleDebug.h"
+#include "MarbleGlobal.h"
+#include "routing/RouteRequest.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+
+#include <QTime>
+
+namespace Marble
+{
+
+LocalOsmRoutingRunner::LocalOsmRoutingRunner( const QStringList &graphFiles, QObject *parent ) :
+    RoutingRunner( parent ),
+    m_graphFiles( graphFiles )
+{
+    // nothing to do
+}
+
+LocalOsmRoutingRunner::~LocalOsmRoutingRunner()
+{
+    // nothing to do
+}
+
+void LocalOsmRoutingRunner::retrieveRoute( const RouteRequest *request )
+{
+    if ( request->size() < 2 ) {
+        emit routeCalculated( 0 );
+        return;
+    }
+
+    QTime timer;
+    timer.start();
+
+    // graphs usually cover a single country, use the first one that connects all waypoints
+    foreach ( const QString &fileName, m_graphFiles ) {
+        ContractionHierarchy graph;
+        if ( !graph.load( fileName ) ) {
+            continue;
+        }
+
+        GeoDataLineString *geometry = new GeoDataLineString;
+        qint64 duration = 0;
+        if ( retrieveRoute( graph, request, geometry, duration ) ) {
+            mDebug() << "Route of" << duration / 10 << "s found in" << fileName << "after" << timer.elapsed() << "ms";
+            emit routeCalculated( createDocument( geometry ) );
+            return;
+        }
+        delete geometry;
+    }
+
+    emit routeCalculated( 0 );
+}
+
+bool LocalOsmRoutingRunner::retrieveRoute( const ContractionHierarchy &graph, const RouteRequest *request,
+                                           GeoDataLineString *geometry, qint64 &duration )
+{
+    // waypoints further away from any road are probably not covered by the graph
+    qreal const lookupRadius = 1000.0;
+
+    int source = graph.nearestNode( request->at( 0 ), lookupRadius );
+    if ( source < 0 ) {
+        return false;
+    }
+    geometry->append( graph.coordinates( source ) );
+
+    for ( int i = 1; i < request->size(); ++i ) {
+        int const target = graph.nearestNode( request->at( i ), lookupRadius );
+        if ( target < 0 ) {
+            return false;
+        }
+
+        QVector<int> path;
+        qint64 const time = graph.route( source, target, &path );
+        if ( time < 0 ) {
+            return false;
+        }
+        duration += time;
+
+        // the first node of the path is the last one of the previous leg
+        for ( int j = 1; j < path.size(); ++j ) {
+            geometry->append( graph.coordinates( path[j] ) );
+        }
+        source = target;
+    }
+
+    return true;
+}
+
+GeoDataDocument *LocalOsmRoutingRunner::createDocument( GeoDataLineString *geometry )
+{
+    if ( !geometry || geometry->isEmpty() ) {
+        return 0;
+    }
+
+    GeoDataDocument* result = new GeoDataDocument;
+    GeoDataPlacemark* routePlacemark = new GeoDataPlacemark;
+    routePlacemark->setName( "Route" );
+    routePlacemark->setGeometry( geometry );
+    result->append( routePlacemark );
+
+    QString name = "%1 %2 (Local OSM)";
+    QString unit = QLatin1String( "m" );
+    qreal length = geometry->length( EARTH_RADIUS );
+    if ( length >= 1000 ) {
+        length /= 1000.0;
+        unit = "km";
+    }
+
+    result->setName( name.arg( length, 0, 'f', 1 ).arg( unit ) );
+    return result;
+}
+
+} // namespace Marble
+
+#include "LocalOsmRoutingRunner.moc"
@@ -0,0 +1,45 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_LOCALOSMROUTINGRUNNER_H
+#define MARBLE_LOCALOSMROUTINGRUNNER_H
+
+#include "RoutingRunner.h"
+
+#include <QStringList>
+
+namespace Marble
+{
+
+class ContractionHierarchy;
+class GeoDataLineString;
+
+class LocalOsmRoutingRunner : public RoutingRunner
+{
+    Q_OBJECT
+public:
+    explicit LocalOsmRoutingRunner( const QStringList &graphFiles, QObject *parent = 0 );
+
+    ~LocalOsmRoutingRunner();
+
+    // Overriding MarbleAbstractRunner
+    virtual void retrieveRoute( const RouteRequest *request );
+
+private:
+    /** Appends the route through all waypoints of @p request to @p geometry, false if there is none */
+    static bool retrieveRoute( const ContractionHierarchy &graph, const RouteRequest *request,
+                               GeoDataLineString *geometry, qint64 &duration );
+
+    static GeoDataDocument *createDocument( GeoDataLineString *geometry );
+
+    QStringList m_graphFiles;
+};
+
+}
+
+#endif
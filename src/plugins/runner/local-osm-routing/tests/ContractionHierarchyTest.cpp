@@ -0,0 +1,333 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ContractionHierarchy.h"
+#include "ContractionHierarchyBuilder.h"
+
+#include <QDir>
+#include <QFile>
+#include <QtTest>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace Marble
+{
+
+class ContractionHierarchyTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void rejectsOtherFiles();
+    void nearestNode();
+    void shortestPaths();
+    void unreachable();
+
+    void benchmarkPreprocessing_data();
+    void benchmarkPreprocessing();
+    void benchmarkQuery();
+
+ private:
+    struct Arc
+    {
+        int target;
+        quint32 weight;
+    };
+
+    /**
+     * A grid of streets with an arterial road every ten rows and columns.
+     * Every seventh column is a one-way street heading north.
+     */
+    static void createGrid( int size, ContractionHierarchyBuilder &builder,
+                            QVector<QVector<Arc> > *arcs = 0 );
+
+    /** The plain Dijkstra travel time, the reference for the hierarchy */
+    static qint64 dijkstra( const QVector<QVector<Arc> > &arcs, int source, int target );
+
+    /** The grid node at the position of @p node of @p graph */
+    static int gridNode( const ContractionHierarchy &graph, int node, int size );
+
+    static QString graphFileName( const QString &name );
+
+    QVector<QVector<Arc> > m_arcs;
+    QString m_smallGraph;
+    QString m_largeGraph;
+};
+
+static const int smallGridSize = 60;
+static const int largeGridSize = 300;
+
+void ContractionHierarchyTest::createGrid( int size, ContractionHierarchyBuilder &builder,
+                                           QVector<QVector<Arc> > *arcs )
+{
+    for ( int j = 0; j < size; ++j ) {
+        for ( int i = 0; i < size; ++i ) {
+            builder.addNode( 10.0 + i * 0.001, 50.0 + j * 0.001 );
+        }
+    }
+
+    if ( arcs ) {
+        arcs->clear();
+        arcs->resize( size * size );
+    }
+
+    for ( int j = 0; j < size; ++j ) {
+        for ( int i = 0; i < size; ++i ) {
+            const int node = j * size + i;
+            const qreal lon = 10.0 + i * 0.001;
+            const qreal lat = 50.0 + j * 0.001;
+
+            if ( i + 1 < size ) {
+                const qreal speed = j % 10 == 0 ? 80.0 : 30.0;
+                builder.addEdge( node, node + 1, speed, true, true );
+                if ( arcs ) {
+                    const quint32 weight = ContractionHierarchyBuilder::travelTime( lon, lat, lon + 0.001, lat, speed );
+                    Arc forward = { node + 1, weight };
+                    Arc backward = { node, weight };
+                    (*arcs)[node].append( forward );
+                    (*arcs)[node + 1].append( backward );
+                }
+            }
+
+            if ( j + 1 < size ) {
+                const qreal speed = i % 10 == 0 ? 80.0 : 30.0;
+                const bool oneway = i % 7 == 3;
+                builder.addEdge( node, node + size, speed, true, !oneway );
+                if ( arcs ) {
+                    const quint32 weight = ContractionHierarchyBuilder::travelTime( lon, lat, lon, lat + 0.001, speed );
+                    Arc forward = { node + size, weight };
+                    (*arcs)[node].append( forward );
+                    if ( !oneway ) {
+                        Arc backward = { node, weight };
+                        (*arcs)[node + size].append( backward );
+                    }
+                }
+            }
+        }
+    }
+}
+
+qint64 ContractionHierarchyTest::dijkstra( const QVector<QVector<Arc> > &arcs, int source, int target )
+{
+    typedef QPair<quint32, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+    QVector<quint32> distances( arcs.size(), 0xffffffff );
+    distances[source] = 0;
+    queue.push( Entry( 0, source ) );
+
+    while ( !queue.empty() ) {
+        const Entry entry = queue.top();
+        queue.pop();
+        if ( entry.second == target ) {
+            return entry.first;
+        }
+        if ( entry.first > distances[entry.second] ) {
+            continue;
+        }
+
+        foreach ( const Arc &arc, arcs[entry.second] ) {
+            const quint32 distance = entry.first + arc.weight;
+            if ( distance < distances[arc.target] ) {
+                distances[arc.target] = distance;
+                queue.push( Entry( distance, arc.target ) );
+            }
+        }
+    }
+
+    return -1;
+}
+
+int ContractionHierarchyTest::gridNode( const ContractionHierarchy &graph, int node, int size )
+{
+    const GeoDataCoordinates coordinates = graph.coordinates( node );
+    const int i = qRound( ( coordinates.longitude( GeoDataCoordinates::Degree ) - 10.0 ) / 0.001 );
+    const int j = qRound( ( coordinates.latitude( GeoDataCoordinates::Degree ) - 50.0 ) / 0.001 );
+    return j * size + i;
+}
+
+QString ContractionHierarchyTest::graphFileName( const QString &name )
+{
+    return QDir::tempPath() + QString( "/marble-%1-%2.ch" )
+            .arg( name ).arg( QCoreApplication::applicationPid() );
+}
+
+void ContractionHierarchyTest::initTestCase()
+{
+    ContractionHierarchyBuilder small;
+    createGrid( smallGridSize, small, &m_arcs );
+    small.contract();
+    m_smallGraph = graphFileName( "small" );
+    QVERIFY( small.save( m_smallGraph ) );
+
+    ContractionHierarchyBuilder large;
+    createGrid( largeGridSize, large );
+    large.contract();
+    m_largeGraph = graphFileName( "large" );
+    QVERIFY( large.save( m_largeGraph ) );
+}
+
+void ContractionHierarchyTest::cleanupTestCase()
+{
+    QFile::remove( m_smallGraph );
+    QFile::remove( m_largeGraph );
+}
+
+void ContractionHierarchyTest::rejectsOtherFiles()
+{
+    ContractionHierarchy graph;
+    QVERIFY( !graph.load( graphFileName( "doesNotExist" ) ) );
+
+    // a truncated graph
+    const QString fileName = graphFileName( "truncated" );
+    QFile::remove( fileName );
+    QVERIFY( QFile::copy( m_smallGraph, fileName ) );
+    QFile file( fileName );
+    QVERIFY( file.resize( file.size() / 2 ) );
+    QVERIFY( !graph.load( fileName ) );
+    QFile::remove( fileName );
+}
+
+void ContractionHierarchyTest::nearestNode()
+{
+    ContractionHierarchy graph;
+    QVERIFY( graph.load( m_smallGraph ) );
+    QCOMPARE( graph.nodeCount(), smallGridSize * smallGridSize );
+
+    // close to the grid node (12, 34)
+    const GeoDataCoordinates position( 10.01203, 50.03398, 0, GeoDataCoordinates::Degree );
+    const int node = graph.nearestNode( position, 100.0 );
+    QVERIFY( node >= 0 );
+    QCOMPARE( gridNode( graph, node, smallGridSize ), 34 * smallGridSize + 12 );
+
+    // far away from any road
+    QCOMPARE( graph.nearestNode( GeoDataCoordinates( 11.0, 51.0, 0, GeoDataCoordinates::Degree ), 1000.0 ), -1 );
+}
+
+void ContractionHierarchyTest::shortestPaths()
+{
+    ContractionHierarchy graph;
+    QVERIFY( graph.load( m_smallGraph ) );
+
+    QVector<int> fileNodes( graph.nodeCount() );
+    for ( int node = 0; node < graph.nodeCount(); ++node ) {
+        fileNodes[gridNode( graph, node, smallGridSize )] = node;
+    }
+
+    qsrand( 42 );
+    for ( int k = 0; k < 200; ++k ) {
+        const int source = qrand() % m_arcs.size();
+        const int target = qrand() % m_arcs.size();
+
+        QVector<int> path;
+        const qint64 expected = dijkstra( m_arcs, source, target );
+        const qint64 time = graph.route( fileNodes[source], fileNodes[target], &path );
+        QCOMPARE( time, expected );
+
+        // the unpacked path follows the roads and takes just as long
+        QVERIFY( !path.isEmpty() );
+        QCOMPARE( gridNode( graph, path.first(), smallGridSize ), source );
+        QCOMPARE( gridNode( graph, path.last(), smallGridSize ), target );
+        qint64 sum = 0;
+        for ( int i = 1; i < path.size(); ++i ) {
+            const int from = gridNode( graph, path[i-1], smallGridSize );
+            const int to = gridNode( graph, path[i], smallGridSize );
+            bool found = false;
+            foreach ( const Arc &arc, m_arcs[from] ) {
+                if ( arc.target == to ) {
+                    sum += arc.weight;
+                    found = true;
+                    break;
+                }
+            }
+            QVERIFY( found );
+        }
+        QCOMPARE( sum, time );
+    }
+}
+
+void ContractionHierarchyTest::unreachable()
+{
+    ContractionHierarchyBuilder builder;
+    const int a = builder.addNode( 10.0, 50.0 );
+    const int b = builder.addNode( 10.001, 50.0 );
+    const int c = builder.addNode( 12.0, 52.0 );
+    builder.addEdge( a, b, 50.0, true, false );
+    builder.addNode( 12.001, 52.0 );
+    builder.addEdge( c, c + 1, 50.0, true, true );
+    builder.contract();
+
+    const QString fileName = graphFileName( "unreachable" );
+    QVERIFY( builder.save( fileName ) );
+
+    ContractionHierarchy graph;
+    QVERIFY( graph.load( fileName ) );
+    const int first = graph.nearestNode( GeoDataCoordinates( 10.0, 50.0, 0, GeoDataCoordinates::Degree ), 10.0 );
+    const int second = graph.nearestNode( GeoDataCoordinates( 10.001, 50.0, 0, GeoDataCoordinates::Degree ), 10.0 );
+    const int third = graph.nearestNode( GeoDataCoordinates( 12.0, 52.0, 0, GeoDataCoordinates::Degree ), 10.0 );
+    QVERIFY( first >= 0 && second >= 0 && third >= 0 );
+
+    QVERIFY( graph.route( first, second ) > 0 );
+    QCOMPARE( graph.route( second, first ), qint64( -1 ) );
+    QCOMPARE( graph.route( first, third ), qint64( -1 ) );
+    QCOMPARE( graph.route( first, first ), qint64( 0 ) );
+
+    QFile::remove( fileName );
+}
+
+void ContractionHierarchyTest::benchmarkPreprocessing_data()
+{
+    QTest::addColumn<int>( "size" );
+
+    QTest::newRow( "100x100" ) << 100;
+    QTest::newRow( "300x300" ) << 300;
+}
+
+void ContractionHierarchyTest::benchmarkPreprocessing()
+{
+    QFETCH( int, size );
+
+    const QString fileName = graphFileName( "preprocessing" );
+    QBENCHMARK {
+        ContractionHierarchyBuilder builder;
+        createGrid( size, builder );
+        builder.contract();
+        QVERIFY( builder.save( fileName ) );
+        qDebug() << builder.nodeCount() << "nodes," << builder.shortcutCount() << "shortcuts,"
+                 << QFileInfo( fileName ).size() << "bytes";
+    }
+    QFile::remove( fileName );
+}
+
+void ContractionHierarchyTest::benchmarkQuery()
+{
+    ContractionHierarchy graph;
+    QVERIFY( graph.load( m_largeGraph ) );
+
+    // from the south west to the north east corner
+    const int source = graph.nearestNode( GeoDataCoordinates( 10.0, 50.0, 0, GeoDataCoordinates::Degree ), 10.0 );
+    const int target = graph.nearestNode( GeoDataCoordinates( 10.0 + ( largeGridSize - 1 ) * 0.001,
+                                                              50.0 + ( largeGridSize - 1 ) * 0.001,
+                                                              0, GeoDataCoordinates::Degree ), 10.0 );
+    QVERIFY( source >= 0 && target >= 0 );
+
+    QBENCHMARK {
+        QVector<int> path;
+        QVERIFY( graph.route( source, target, &path ) > 0 );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ContractionHierarchyTest )
+
+#include "ContractionHierarchyTest.moc"
@@ -11,9 +11,6 @@
 
 #include "LocalOsmSearchPlugin.h"
 #include "LocalOsmSearchRunner.h"
-#include "MarbleDirs.h"
-
-#include <QDirIterator>
 
 namespace Marble
 {
@@ -24,20 +21,6 @@ LocalOsmSearchPlugin::LocalOsmSearchPlugin( QObject *parent ) :
 {
     setSupportedCelestialBodies( QStringList() << "earth" );
     setCanWorkOffline( true );
-
-    QString const path = MarbleDirs::localPath() + "/maps/earth/placemarks/";
-    QFileInfo pathInfo( path );
-    if ( !pathInfo.exists() ) {
-        QDir("/").mkpath( pathInfo.absolutePath() );
-        pathInfo.refresh();
-    }
-    if ( pathInfo.exists() ) {
-        m_watcher.addPath( path );
-    }
-    connect( &m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(updateDirectory(QString)) );
-    connect( &m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(updateFile(QString)) );
-
-    updateDatabase();
 }
 
 QString LocalOsmSearchPlugin::name() const
@@ -78,46 +61,7 @@ QList<PluginAuthor> LocalOsmSearchPlugin::pluginAuthors() const
 
 SearchRunner* LocalOsmSearchPlugin::newRunner() const
 {
-    return new LocalOsmSearchRunner( m_databaseFiles );
-}
-
-void LocalOsmSearchPlugin::addDatabaseDirectory( const QString &path )
-{
-    QDir directory( path );
-    QStringList const nameFilters = QStringList() << "*.sqlite";
-    QStringList const files( directory.entryList( nameFilters, QDir::Files ) );
-    foreach( const QString &file, files ) {
-        m_databaseFiles << directory.filePath( file );
-    }
-}
-
-void LocalOsmSearchPlugin::updateDirectory( const QString & )
-{
-    updateDatabase();
-}
-
-void LocalOsmSearchPlugin::updateFile( const QString &file )
-{
-    if ( file.endsWith( QLatin1String( ".sqlite" ) ) ) {
-        updateDatabase();
-    }
-}
-
-void LocalOsmSearchPlugin::updateDatabase()
-{
-    m_databaseFiles.clear();
-    QStringList const baseDirs = QStringList() << MarbleDirs::systemPath() << MarbleDirs::localPath();
-    foreach ( const QString &baseDir, baseDirs ) {
-        QString base = baseDir + "/maps/earth/placemarks/";
-        addDatabaseDirectory( base );
-        QDir::Filters filters = QDir::AllDirs | QDir::Readable | QDir::NoDotAndDotDot;
-        QDirIterator::IteratorFlags flags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
-        QDirIterator iter( base, filters, flags );
-        while ( iter.hasNext() ) {
-            iter.next();
-            addDatabaseDirectory( iter.filePath() );
-        }
-    }
+    return new LocalOsmSearchRunner( m_databaseFiles.files() );
 }
 
 }
@@ -15,8 +15,7 @@
 
 #include "SearchRunnerPlugin.h"
 #include "OsmDatabase.h"
-
-#include <QFileSystemWatcher>
+#include "OsmDatabaseFiles.h"
 
 namespace Marble
 {
@@ -46,18 +45,8 @@ public:
 
     virtual SearchRunner* newRunner() const;
 
-private Q_SLOTS:
-    void updateDirectory( const QString &directory );
-
-    void updateFile( const QString &directory );
-
 private:
-    void addDatabaseDirectory( const QString &path );
-
-    void updateDatabase();
-
-    QStringList m_databaseFiles;
-    QFileSystemWatcher m_watcher;
+    OsmDatabaseFiles m_databaseFiles;
 };
 
 }
@@ -93,16 +93,26 @@ QVector<OsmPlacemark> OsmDatabase::find( const DatabaseQuery &userQuery )
             qWarning() << "Failed to connect to database" << databaseFile;
         }
 
+        const bool indexed = hasSearchIndexes( database );
+
         QString regionRestriction;
         if ( !userQuery.region().isEmpty() ) {
             QTime regionTimer;
             regionTimer.start();
             // Nested set model to support region hierarchies, see http://en.wikipedia.org/wiki/Nested_set_model
-            const QString regionsQueryString = "SELECT lft, rgt FROM regions WHERE name LIKE '%" + userQuery.region() + "%';";
-            QSqlQuery regionsQuery( regionsQueryString, database );
-            if ( regionsQuery.lastError().isValid() ) {
-                qWarning() << regionsQuery.lastError() << "in" << databaseFile << "with query" << regionsQuery.lastQuery();
+            QString regionsQueryString;
+            QVariantList regionsBindValues;
+            const QString regionTerm = prefixQuery( userQuery.region() );
+            if ( indexed && !regionTerm.isEmpty() ) {
+                regionsQueryString = "SELECT lft, rgt FROM regions WHERE id IN"
+                        " (SELECT docid FROM regionsFts WHERE regionsFts MATCH ?);";
+                regionsBindValues << regionTerm;
+            } else {
+                regionsQueryString = "SELECT lft, rgt FROM regions WHERE name LIKE '%" + userQuery.region() + "%';";
             }
+            QSqlQuery regionsQuery( database );
+            regionsQuery.setForwardOnly( true );
+            execQuery( regionsQuery, regionsQueryString, regionsBindValues );
             regionRestriction = " AND (";
             int regionCount = 0;
             while ( regionsQuery.next() ) {
@@ -123,15 +133,25 @@ QVector<OsmPlacemark> OsmDatabase::find( const DatabaseQuery &userQuery )
             }
         }
 
+        // category searches around a position look up growing boxes in the R-tree, see below
+        const bool nearbySearch = indexed && userQuery.queryType() == DatabaseQuery::CategorySearch
+                && userQuery.position().isValid() && userQuery.region().isEmpty();
+
         QString queryString;
+        QVariantList bindValues;
 
         queryString = " SELECT regions.name,"
                 " places.name, places.number,"
-                " places.category, places.lon, places.lat"
-                " FROM regions, places";
+                " places.category, places.lon, places.lat";
+        if ( nearbySearch ) {
+            queryString += " FROM placemarksRtree, places, regions"
+                    " WHERE places.id = placemarksRtree.id AND";
+        } else {
+            queryString += " FROM regions, places WHERE";
+        }
 
         if ( userQuery.queryType() == DatabaseQuery::CategorySearch ) {
-            queryString += " WHERE regions.id = places.region";
+            queryString += " regions.id = places.region";
             if( userQuery.category() == OsmPlacemark::UnknownCategory ) {
                 // search for all pois which are not street nor address
                 queryString += " AND places.category <> 0 AND places.category <> 6";
@@ -141,6 +161,10 @@ QVector<OsmPlacemark> OsmDatabase::find( const DatabaseQuery &userQuery )
                 queryString = queryString.arg( (qint32) userQuery.category() );
             }
             if ( userQuery.position().isValid() && userQuery.region().isEmpty() ) {
+                if ( nearbySearch ) {
+                    queryString += " AND placemarksRtree.minLon >= ? AND placemarksRtree.maxLon <= ?"
+                            " AND placemarksRtree.minLat >= ? AND placemarksRtree.maxLat <= ?";
+                }
                 // sort by distance
                 queryString += " ORDER BY ((places.lat-%1)*(places.lat-%1)+(places.lon-%2)*(places.lon-%2))";
                 GeoDataCoordinates position = userQuery.position();
@@ -149,18 +173,29 @@ QVector<OsmPlacemark> OsmDatabase::find( const DatabaseQuery &userQuery )
             } else {
                 queryString += regionRestriction;
             }
-        } else if ( userQuery.queryType() == DatabaseQuery::BroadSearch ) {
-            queryString += " WHERE regions.id = places.region"
-                    " AND places.name " + wildcardQuery( userQuery.searchTerm() );
         } else {
-            queryString += " WHERE regions.id = places.region"
-                    "   AND places.name " + wildcardQuery( userQuery.street() );
-            if ( !userQuery.houseNumber().isEmpty() ) {
-                queryString += " AND places.number " + wildcardQuery( userQuery.houseNumber() );
+            const QString name = userQuery.queryType() == DatabaseQuery::BroadSearch ? userQuery.searchTerm() : userQuery.street();
+            const QString nameTerm = prefixQuery( name );
+            queryString += " regions.id = places.region";
+            if ( indexed && !nameTerm.isEmpty() ) {
+                queryString += " AND places.nameId IN (SELECT docid FROM namesFts WHERE namesFts MATCH ?)";
+                bindValues << nameTerm;
             } else {
-                queryString += " AND places.number IS NULL";
+                queryString += " AND places.name " + wildcardQuery( name );
+            }
+            if ( userQuery.queryType() == DatabaseQuery::AddressSearch ) {
+                if ( !userQuery.houseNumber().isEmpty() ) {
+                    queryString += " AND places.number " + wildcardQuery( userQuery.houseNumber() );
+                } else {
+                    queryString += " AND places.number IS NULL";
+                }
+                queryString += regionRestriction;
+            }
+            if ( indexed && !nameTerm.isEmpty() ) {
+                // exact matches first, then the shortest names starting with the term
+                queryString += " ORDER BY lower(places.name) <> lower(?), length(places.name)";
+                bindValues << name;
             }
-            queryString += regionRestriction;
         }
 
         queryString += " LIMIT 50;";
@@ -171,32 +206,49 @@ QVector<OsmPlacemark> OsmDatabase::find( const DatabaseQuery &userQuery )
         query.setForwardOnly( true );
         QTime queryTimer;
         queryTimer.start();
-        if ( !query.exec( queryString ) ) {
-            qWarning() << query.lastError() << "in" << databaseFile << "with query" << query.lastQuery();
-            continue;
-        }
 
-        int resultCount = 0;
-        while ( query.next() ) {
-            OsmPlacemark placemark;
-            if ( userQuery.resultFormat() == DatabaseQuery::DistanceFormat ) {
-                GeoDataCoordinates coordinates( query.value(4).toFloat(), query.value(5).toFloat(), 0.0, GeoDataCoordinates::Degree );
-                placemark.setAdditionalInformation( formatDistance( coordinates, userQuery.position() ) );
-            } else {
-                placemark.setAdditionalInformation( query.value( 0 ).toString() );
+        QVector<OsmPlacemark> placemarks;
+        if ( nearbySearch ) {
+            // Query growing boxes around the position until they contain 50 results,
+            // and the circle through the farthest of them lies inside the box. Then
+            // no placemark outside of the box can be closer than the results.
+            const qreal lon = userQuery.position().longitude( GeoDataCoordinates::Degree );
+            const qreal lat = userQuery.position().latitude( GeoDataCoordinates::Degree );
+            qreal radius = 0.05;
+            forever {
+                bindValues.clear();
+                bindValues << lon - radius << lon + radius << lat - radius << lat + radius;
+                placemarks.clear();
+                if ( !execQuery( query, queryString, bindValues ) ) {
+                    break;
+                }
+                readPlacemarks( query, userQuery, placemarks );
+
+                if ( placemarks.size() < 50 ) {
+                    if ( radius >= 360.0 ) {
+                        // the box covers the whole database
+                        break;
+                    }
+                    radius *= 4;
+                    continue;
+                }
+
+                const OsmPlacemark &farthest = placemarks.last();
+                const qreal distance = sqrt( ( farthest.longitude() - lon ) * ( farthest.longitude() - lon )
+                                           + ( farthest.latitude() - lat ) * ( farthest.latitude() - lat ) );
+                if ( distance <= radius ) {
+                    break;
+                }
+                radius = distance;
             }
-            placemark.setName( query.value(1).toString() );
-            placemark.setHouseNumber( query.value(2).toString() );
-            placemark.setCategory( (OsmPlacemark::OsmCategory) query.value(3).toInt() );
-            placemark.setLongitude( query.value(4).toFloat() );
-            placemark.setLatitude( query.value(5).toFloat() );
-
-            result.push_back( placemark );
-            resultCount++;
+        } else if ( execQuery( query, queryString, bindValues ) ) {
+            readPlacemarks( query, userQuery, placemarks );
         }
 
+        result << placemarks;
+
         mDebug() << Q_FUNC_INFO << "query in" << databaseFile << "with query" << queryString
-                 << "took" << queryTimer.elapsed() << "ms for" << resultCount << "results";
+                 << "took" << queryTimer.elapsed() << "ms for" << placemarks.size() << "results";
     }
 
     mDebug() << "Offline OSM search query took" << timer.elapsed() << "ms for" << result.count() << "results.";
@@ -219,6 +271,146 @@ QVector<OsmPlacemark> OsmDatabase::find( const DatabaseQuery &userQuery )
     return result;
 }
 
+bool OsmDatabase::findNearest( const GeoDataCoordinates &coordinates, qreal maximumDistance, OsmPlacemark &placemark )
+{
+    if ( m_databaseFiles.isEmpty() ) {
+        return false;
+    }
+
+    QSqlDatabase database = QSqlDatabase::addDatabase( "QSQLITE", QString( "marble/local-osm-search-%1" ).arg( reinterpret_cast<size_t>( this ) ) );
+
+    const qreal lon = coordinates.longitude( GeoDataCoordinates::Degree );
+    const qreal lat = coordinates.latitude( GeoDataCoordinates::Degree );
+    // degrees of longitude get shorter towards the poles
+    const qreal lonScale = qMax<qreal>( cos( coordinates.latitude() ), 0.01 );
+
+    // streets and addresses, ordered by their distance in degrees of latitude
+    const QString queryString = QString( " SELECT regions.name,"
+            " places.name, places.number,"
+            " places.category, places.lon, places.lat"
+            " FROM placemarksRtree, places, regions"
+            " WHERE places.id = placemarksRtree.id AND regions.id = places.region"
+            " AND places.category IN (%1, %2)"
+            " AND placemarksRtree.minLon >= ? AND placemarksRtree.maxLon <= ?"
+            " AND placemarksRtree.minLat >= ? AND placemarksRtree.maxLat <= ?"
+            " ORDER BY ((places.lat-%3)*(places.lat-%3)+(places.lon-%4)*(places.lon-%4)*%5)"
+            " LIMIT 1;" )
+            .arg( (qint32) OsmPlacemark::UnknownCategory ).arg( (qint32) OsmPlacemark::Address )
+            .arg( lat, 0, 'f', 8 ).arg( lon, 0, 'f', 8 ).arg( lonScale * lonScale, 0, 'f', 8 );
+
+    QTime timer;
+    timer.start();
+    qreal searchRadius = maximumDistance / EARTH_RADIUS * RAD2DEG;
+    bool found = false;
+    foreach( const QString &databaseFile, m_databaseFiles ) {
+        database.setDatabaseName( databaseFile );
+        if ( !database.open() ) {
+            qWarning() << "Failed to connect to database" << databaseFile;
+            continue;
+        }
+
+        if ( !hasSearchIndexes( database ) ) {
+            continue;
+        }
+
+        QSqlQuery query( database );
+        query.setForwardOnly( true );
+
+        // Start with a box of about 200 meters and grow it up to the search radius until
+        // the closest placemark in the box is also closer than any placemark outside of it.
+        qreal radius = qMin<qreal>( 0.002, searchRadius );
+        forever {
+            QVariantList bindValues;
+            bindValues << lon - radius / lonScale << lon + radius / lonScale << lat - radius << lat + radius;
+            if ( !execQuery( query, queryString, bindValues ) ) {
+                break;
+            }
+
+            qreal distance = 4 * radius;
+            if ( query.next() ) {
+                const qreal placemarkLon = query.value( 4 ).toFloat();
+                const qreal placemarkLat = query.value( 5 ).toFloat();
+                distance = sqrt( ( placemarkLat - lat ) * ( placemarkLat - lat )
+                                 + ( placemarkLon - lon ) * ( placemarkLon - lon ) * lonScale * lonScale );
+                if ( distance <= radius ) {
+                    placemark = OsmPlacemark();
+                    placemark.setAdditionalInformation( query.value( 0 ).toString() );
+                    placemark.setName( query.value( 1 ).toString() );
+                    placemark.setHouseNumber( query.value( 2 ).toString() );
+                    placemark.setCategory( (OsmPlacemark::OsmCategory) query.value( 3 ).toInt() );
+                    placemark.setLongitude( placemarkLon );
+                    placemark.setLatitude( placemarkLat );
+                    // other databases only need to be searched for closer placemarks
+                    searchRadius = distance;
+                    found = true;
+                    break;
+                }
+            }
+
+            if ( radius >= searchRadius ) {
+                break;
+            }
+            radius = qMin( distance, searchRadius );
+        }
+    }
+
+    mDebug() << "Offline OSM reverse geocoding took" << timer.elapsed() << "ms," << ( found ? "found" : "no" ) << "placemark";
+
+    return found;
+}
+
+bool OsmDatabase::hasSearchIndexes( const QSqlDatabase &database )
+{
+    const QString databaseFile = database.databaseName();
+    if ( !m_searchIndexes.contains( databaseFile ) ) {
+        QSqlQuery query( "SELECT count(*) FROM sqlite_master"
+                         " WHERE name IN ('namesFts', 'regionsFts', 'placemarksRtree');", database );
+        const bool indexed = query.next() && query.value( 0 ).toInt() == 3;
+        if ( !indexed ) {
+            mDebug() << "No search indexes in" << databaseFile << ", searches will be slow."
+                     << "Please recreate it with a recent osm-addresses.";
+        }
+        m_searchIndexes[databaseFile] = indexed;
+    }
+
+    return m_searchIndexes.value( databaseFile );
+}
+
+bool OsmDatabase::execQuery( QSqlQuery &query, const QString &queryString, const QVariantList &bindValues ) const
+{
+    query.prepare( queryString );
+    foreach( const QVariant &value, bindValues ) {
+        query.addBindValue( value );
+    }
+
+    if ( !query.exec() ) {
+        qWarning() << query.lastError() << "with query" << query.lastQuery();
+        return false;
+    }
+
+    return true;
+}
+
+void OsmDatabase::readPlacemarks( QSqlQuery &query, const DatabaseQuery &userQuery, QVector<OsmPlacemark> &placemarks ) const
+{
+    while ( query.next() ) {
+        OsmPlacemark placemark;
+        if ( userQuery.resultFormat() == DatabaseQuery::DistanceFormat ) {
+            GeoDataCoordinates coordinates( query.value(4).toFloat(), query.value(5).toFloat(), 0.0, GeoDataCoordinates::Degree );
+            placemark.setAdditionalInformation( formatDistance( coordinates, userQuery.position() ) );
+        } else {
+            placemark.setAdditionalInformation( query.value( 0 ).toString() );
+        }
+        placemark.setName( query.value(1).toString() );
+        placemark.setHouseNumber( query.value(2).toString() );
+        placemark.setCategory( (OsmPlacemark::OsmCategory) query.value(3).toInt() );
+        placemark.setLongitude( query.value(4).toFloat() );
+        placemark.setLatitude( query.value(5).toFloat() );
+
+        placemarks.push_back( placemark );
+    }
+}
+
 void OsmDatabase::unique( QVector<OsmPlacemark> &placemarks ) const
 {
     for ( int i=1; i<placemarks.size(); ++i ) {
@@ -300,4 +492,19 @@ QString OsmDatabase::wildcardQuery( const QString &term ) const
     }
 }
 
+QString OsmDatabase::prefixQuery( const QString &term ) const
+{
+    if ( term.contains( '*' ) ) {
+        // explicit wildcards may stand anywhere in a name, which the index cannot match
+        return QString();
+    }
+
+    QStringList words = term.split( QRegExp( "[^\\w]+" ), QString::SkipEmptyParts );
+    for ( int i = 0; i < words.size(); ++i ) {
+        words[i] += '*';
+    }
+
+    return words.join( " " );
+}
+
 }
@@ -14,8 +14,13 @@
 
 #include "OsmPlacemark.h"
 
+#include <QHash>
 #include <QString>
 #include <QStringList>
+#include <QVariant>
+
+class QSqlDatabase;
+class QSqlQuery;
 
 namespace Marble {
 
@@ -32,13 +37,35 @@ public:
     /** Search the database for matching regions and placemarks */
     QVector<OsmPlacemark> find( const DatabaseQuery &userQuery );
 
+    /**
+      * Look up the street or address closest to @p coordinates, at most @p maximumDistance
+      * meters away. Only databases with search indexes are used, so that a lookup takes
+      * bounded time. Returns false if there is no such placemark.
+      */
+    bool findNearest( const GeoDataCoordinates &coordinates, qreal maximumDistance, OsmPlacemark &placemark );
+
 private:
     QString wildcardQuery( const QString &term ) const;
 
+    /**
+      * Returns the term as a full text query matching names whose words start with its words,
+      * or an empty string for terms with explicit wildcards, which need a LIKE query instead
+      */
+    QString prefixQuery( const QString &term ) const;
+
+    /** Whether the database has the full text and R-tree indexes written by osm-addresses */
+    bool hasSearchIndexes( const QSqlDatabase &database );
+
+    bool execQuery( QSqlQuery &query, const QString &queryString, const QVariantList &bindValues ) const;
+
+    void readPlacemarks( QSqlQuery &query, const DatabaseQuery &userQuery, QVector<OsmPlacemark> &placemarks ) const;
+
     void unique( QVector<OsmPlacemark> &placemarks ) const;
 
     QStringList m_databaseFiles;
 
+    QHash<QString, bool> m_searchIndexes;
+
     QString formatDistance( const GeoDataCoordinates &a, const GeoDataCoordinates &b ) const;
 
     qreal bearing( const GeoDataCoordinates &a, const GeoDataCoordinates &b ) const;
@@ -0,0 +1,85 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "OsmDatabaseFiles.h"
+
+#include "MarbleDirs.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+
+namespace Marble
+{
+
+OsmDatabaseFiles::OsmDatabaseFiles( QObject *parent ) :
+    QObject( parent ),
+    m_databaseFiles()
+{
+    QString const path = MarbleDirs::localPath() + "/maps/earth/placemarks/";
+    QFileInfo pathInfo( path );
+    if ( !pathInfo.exists() ) {
+        QDir("/").mkpath( pathInfo.absolutePath() );
+        pathInfo.refresh();
+    }
+    if ( pathInfo.exists() ) {
+        m_watcher.addPath( path );
+    }
+    connect( &m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(updateDirectory(QString)) );
+    connect( &m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(updateFile(QString)) );
+
+    updateDatabase();
+}
+
+QStringList OsmDatabaseFiles::files() const
+{
+    return m_databaseFiles;
+}
+
+void OsmDatabaseFiles::addDatabaseDirectory( const QString &path )
+{
+    QDir directory( path );
+    QStringList const nameFilters = QStringList() << "*.sqlite";
+    QStringList const files( directory.entryList( nameFilters, QDir::Files ) );
+    foreach( const QString &file, files ) {
+        m_databaseFiles << directory.filePath( file );
+    }
+}
+
+void OsmDatabaseFiles::updateDirectory( const QString & )
+{
+    updateDatabase();
+}
+
+void OsmDatabaseFiles::updateFile( const QString &file )
+{
+    if ( file.endsWith( QLatin1String( ".sqlite" ) ) ) {
+        updateDatabase();
+    }
+}
+
+void OsmDatabaseFiles::updateDatabase()
+{
+    m_databaseFiles.clear();
+    QStringList const baseDirs = QStringList() << MarbleDirs::systemPath() << MarbleDirs::localPath();
+    foreach ( const QString &baseDir, baseDirs ) {
+        QString base = baseDir + "/maps/earth/placemarks/";
+        addDatabaseDirectory( base );
+        QDir::Filters filters = QDir::AllDirs | QDir::Readable | QDir::NoDotAndDotDot;
+        QDirIterator::IteratorFlags flags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
+        QDirIterator iter( base, filters, flags );
+        while ( iter.hasNext() ) {
+            iter.next();
+            addDatabaseDirectory( iter.filePath() );
+        }
+    }
+}
+
+}
+
+#include "OsmDatabaseFiles.moc"
@@ -0,0 +1,49 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_OSMDATABASEFILES_H
+#define MARBLE_OSMDATABASEFILES_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QStringList>
+
+namespace Marble
+{
+
+/**
+ * The databases written by osm-addresses, found in the placemarks directories
+ * of the system and the local data path. The list is updated when databases
+ * are added to or removed from the local directory.
+ */
+class OsmDatabaseFiles : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OsmDatabaseFiles( QObject *parent = 0 );
+
+    QStringList files() const;
+
+private Q_SLOTS:
+    void updateDirectory( const QString &directory );
+
+    void updateFile( const QString &file );
+
+private:
+    void addDatabaseDirectory( const QString &path );
+
+    void updateDatabase();
+
+    QStringList m_databaseFiles;
+    QFileSystemWatcher m_watcher;
+};
+
+}
+
+#endif
@@ -0,0 +1,410 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "DatabaseQuery.h"
+#include "GeoDataLatLonAltBox.h"
+#include "MarbleGlobal.h"
+#include "OsmDatabase.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtTest>
+
+namespace Marble
+{
+
+class OsmDatabaseTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void prefixSearch();
+    void regionSearch();
+    void nearbySearch();
+    void nearestAddress();
+
+    void benchmarkPrefixSearch_data();
+    void benchmarkPrefixSearch();
+
+    void benchmarkNearbySearch_data();
+    void benchmarkNearbySearch();
+
+    void benchmarkNearestAddress();
+
+ private:
+    /**
+     * Writes a database of @p placemarkCount placemarks with the tables of osm-addresses.
+     * Only databases with @p searchIndexes get the full text and R-tree indexes.
+     */
+    static void createDatabase( const QString &fileName, int placemarkCount, bool searchIndexes );
+
+    /** The resident memory of the process in kilobytes, or -1 if unknown */
+    static qint64 residentMemory();
+
+    static QString streetName( int i );
+
+    static bool execQuery( QSqlQuery &query, const QString &queryString );
+
+    static QString databaseFileName( const QString &name );
+
+    QString m_plainDatabase;
+    QString m_indexedDatabase;
+    QString m_largeDatabase;
+};
+
+QString OsmDatabaseTest::streetName( int i )
+{
+    static const char *const syllables[] = {
+        "Haupt", "Bahnhof", "Linden", "Kirch", "Schul", "Berg", "Wald", "Garten",
+        "Mühlen", "Ring", "Eichen", "Rosen", "Feld", "Wiesen", "Burg", "Sonnen" };
+    static const char *const suffixes[] = { "straße", "weg", "platz", "allee", "gasse" };
+
+    return QString::fromUtf8( syllables[i % 16] )
+            + QString::fromUtf8( syllables[( i / 16 ) % 16] ).toLower()
+            + QString::fromUtf8( syllables[( i / 256 ) % 16] ).toLower()
+            + QString::fromUtf8( suffixes[( i / 4096 ) % 5] );
+}
+
+QString OsmDatabaseTest::databaseFileName( const QString &name )
+{
+    return QDir::tempPath() + QString( "/marble-%1-%2.sqlite" )
+            .arg( name ).arg( QCoreApplication::applicationPid() );
+}
+
+bool OsmDatabaseTest::execQuery( QSqlQuery &query, const QString &queryString )
+{
+    if ( !query.exec( queryString ) ) {
+        qWarning() << query.lastError() << "with query" << queryString;
+        return false;
+    }
+
+    return true;
+}
+
+qint64 OsmDatabaseTest::residentMemory()
+{
+    QFile file( "/proc/self/statm" );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return -1;
+    }
+
+    const QList<QByteArray> pages = file.readAll().split( ' ' );
+    return pages.size() > 1 ? pages.at( 1 ).toLongLong() * 4 : -1;
+}
+
+void OsmDatabaseTest::createDatabase( const QString &fileName, int placemarkCount, bool searchIndexes )
+{
+    QFile::remove( fileName );
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase( "QSQLITE", "OsmDatabaseTest" );
+        database.setDatabaseName( fileName );
+        QVERIFY( database.open() );
+
+        QSqlQuery query( database );
+        QVERIFY( execQuery( query, "CREATE TABLE placemarks ( id INTEGER PRIMARY KEY, regionId INTEGER,"
+                                   " nameId INTEGER, number VARCHAR(8), category INTEGER, lon FLOAT(8), lat FLOAT(8) )" ) );
+        QVERIFY( execQuery( query, "CREATE TABLE names ( id INTEGER PRIMARY KEY, name VARCHAR(50) )" ) );
+        QVERIFY( execQuery( query, "CREATE TABLE regions ( id INTEGER PRIMARY KEY, parent INTEGER NOT NULL,"
+                                   " lft INTEGER NOT NULL, rgt INTEGER NOT NULL, name VARCHAR(50), lon FLOAT(8), lat FLOAT(8) )" ) );
+        QVERIFY( execQuery( query, "CREATE VIEW places AS SELECT placemarks.id AS id, placemarks.regionId AS region,"
+                                   " placemarks.nameId AS nameId, names.name AS name, placemarks.number AS number,"
+                                   " placemarks.category AS category, placemarks.lon AS lon, placemarks.lat AS lat"
+                                   " FROM names INNER JOIN placemarks ON names.id=placemarks.nameId" ) );
+
+        QVERIFY( database.transaction() );
+
+        // a flat hierarchy of 400 regions below the country
+        const int regionCount = 400;
+        query.prepare( "INSERT INTO regions (id, parent, lft, rgt, name, lon, lat) VALUES (?, ?, ?, ?, ?, ?, ?)" );
+        for ( int i = 0; i <= regionCount; ++i ) {
+            query.addBindValue( i );
+            query.addBindValue( 0 );
+            query.addBindValue( i == 0 ? 0 : 2 * i - 1 );
+            query.addBindValue( i == 0 ? 2 * regionCount + 1 : 2 * i );
+            query.addBindValue( i == 0 ? QString( "Country" ) : QString( "%1 Town" ).arg( streetName( 7 * i ) ) );
+            query.addBindValue( 10.0 );
+            query.addBindValue( 51.0 );
+            QVERIFY( query.exec() );
+        }
+
+        const int nameCount = 5 * 4096;
+        query.prepare( "INSERT INTO names (id, name) VALUES (?, ?)" );
+        for ( int i = 0; i < nameCount; ++i ) {
+            query.addBindValue( i );
+            query.addBindValue( streetName( i ) );
+            QVERIFY( query.exec() );
+        }
+
+        // a country sized area, 6-15 degrees east and 47-55 degrees north
+        quint32 random = 42;
+        query.prepare( "INSERT INTO placemarks (id, regionId, nameId, number, category, lon, lat) VALUES (?, ?, ?, ?, ?, ?, ?)" );
+        for ( int i = 0; i < placemarkCount; ++i ) {
+            random = random * 1103515245 + 12345;
+            const qreal lon = 6.0 + 9.0 * ( random >> 8 ) / qreal( 1 << 24 );
+            random = random * 1103515245 + 12345;
+            const qreal lat = 47.0 + 8.0 * ( random >> 8 ) / qreal( 1 << 24 );
+            const bool isAddress = i % 10 != 0;
+            query.addBindValue( 1 + i % regionCount );
+            query.addBindValue( ( i / 10 ) % nameCount );
+            query.addBindValue( isAddress ? QVariant( QString::number( 1 + i % 120 ) ) : QVariant( QVariant::String ) );
+            query.addBindValue( isAddress ? int( OsmPlacemark::Address ) : 1 + ( i / 10 ) % 40 );
+            query.addBindValue( lon );
+            query.addBindValue( lat );
+            QVERIFY( query.exec() );
+        }
+
+        QVERIFY( database.commit() );
+
+        QVERIFY( execQuery( query, "CREATE INDEX namesIndex ON names(name)" ) );
+        QVERIFY( execQuery( query, "CREATE INDEX placemarksIndex ON placemarks(regionId,nameId,category)" ) );
+        QVERIFY( execQuery( query, "CREATE INDEX regionsIndex ON regions(name,parent,lft,rgt)" ) );
+
+        if ( searchIndexes ) {
+            QVERIFY( execQuery( query, "CREATE VIRTUAL TABLE namesFts USING fts3(name)" ) );
+            QVERIFY( execQuery( query, "CREATE VIRTUAL TABLE regionsFts USING fts3(name)" ) );
+            QVERIFY( execQuery( query, "CREATE VIRTUAL TABLE placemarksRtree USING rtree(id, minLon, maxLon, minLat, maxLat)" ) );
+            QVERIFY( execQuery( query, "INSERT INTO namesFts (docid, name) SELECT id, name FROM names" ) );
+            QVERIFY( execQuery( query, "INSERT INTO regionsFts (docid, name) SELECT id, name FROM regions" ) );
+            QVERIFY( execQuery( query, "INSERT INTO placemarksRtree SELECT id, lon, lon, lat, lat FROM placemarks" ) );
+        }
+
+        database.close();
+    }
+
+    QSqlDatabase::removeDatabase( "OsmDatabaseTest" );
+}
+
+void OsmDatabaseTest::initTestCase()
+{
+    // enough placemarks for every name and for 50 results of each search
+    m_plainDatabase = databaseFileName( "plain" );
+    createDatabase( m_plainDatabase, 200000, false );
+
+    m_indexedDatabase = databaseFileName( "indexed" );
+    createDatabase( m_indexedDatabase, 200000, true );
+}
+
+void OsmDatabaseTest::cleanupTestCase()
+{
+    QFile::remove( m_plainDatabase );
+    QFile::remove( m_indexedDatabase );
+    if ( !m_largeDatabase.isEmpty() ) {
+        QFile::remove( m_largeDatabase );
+    }
+}
+
+void OsmDatabaseTest::prefixSearch()
+{
+    OsmDatabase database( QStringList() << m_indexedDatabase );
+
+    const QVector<OsmPlacemark> exact = database.find( DatabaseQuery( 0, "Lindenbergwaldweg", GeoDataLatLonAltBox() ) );
+    QVERIFY( !exact.isEmpty() );
+    foreach ( const OsmPlacemark &placemark, exact ) {
+        QCOMPARE( placemark.name(), QString( "Lindenbergwaldweg" ) );
+    }
+
+    // the full text index matches names starting with the term, regardless of case
+    const QVector<OsmPlacemark> prefix = database.find( DatabaseQuery( 0, "lindenberg", GeoDataLatLonAltBox() ) );
+    QCOMPARE( prefix.size(), 50 );
+    foreach ( const OsmPlacemark &placemark, prefix ) {
+        QVERIFY( placemark.name().startsWith( "Lindenberg" ) );
+    }
+
+    // wildcard searches give the same names as in databases without the index
+    OsmDatabase plainDatabase( QStringList() << m_plainDatabase );
+    const QVector<OsmPlacemark> plain = plainDatabase.find( DatabaseQuery( 0, "Lindenberg*", GeoDataLatLonAltBox() ) );
+    QCOMPARE( plain.size(), 50 );
+    foreach ( const OsmPlacemark &placemark, plain ) {
+        QVERIFY( placemark.name().startsWith( "Lindenberg" ) );
+    }
+
+    // explicit wildcards keep matching inside names in indexed databases, too
+    foreach ( const QString &term, QStringList() << "*waldweg" << "Lindenberg*weg" ) {
+        const QVector<OsmPlacemark> indexed = database.find( DatabaseQuery( 0, term, GeoDataLatLonAltBox() ) );
+        QVERIFY( !indexed.isEmpty() );
+        QCOMPARE( indexed.size(), plainDatabase.find( DatabaseQuery( 0, term, GeoDataLatLonAltBox() ) ).size() );
+        foreach ( const OsmPlacemark &placemark, indexed ) {
+            QVERIFY( placemark.name().endsWith( "weg" ) );
+        }
+    }
+}
+
+void OsmDatabaseTest::regionSearch()
+{
+    OsmDatabase database( QStringList() << m_indexedDatabase );
+
+    // the second placemark lies in the second region
+    const QString region = streetName( 14 );
+    const DatabaseQuery query( 0, QString( "%1 2, %2" ).arg( streetName( 0 ) ).arg( region ), GeoDataLatLonAltBox() );
+    QCOMPARE( query.queryType(), DatabaseQuery::AddressSearch );
+
+    const QVector<OsmPlacemark> result = database.find( query );
+    QVERIFY( !result.isEmpty() );
+    foreach ( const OsmPlacemark &placemark, result ) {
+        QCOMPARE( placemark.name(), streetName( 0 ) );
+        QCOMPARE( placemark.houseNumber(), QString( "2" ) );
+        QVERIFY( placemark.additionalInformation().startsWith( region ) );
+    }
+
+    OsmDatabase plainDatabase( QStringList() << m_plainDatabase );
+    QCOMPARE( plainDatabase.find( query ).size(), result.size() );
+}
+
+void OsmDatabaseTest::nearbySearch()
+{
+    const GeoDataLatLonAltBox preferred( GeoDataLatLonBox( 51.5, 51.4, 10.1, 10.0, GeoDataCoordinates::Degree ), 0, 0 );
+    const DatabaseQuery query( 0, "restaurant", preferred );
+    QCOMPARE( query.queryType(), DatabaseQuery::CategorySearch );
+
+    OsmDatabase plainDatabase( QStringList() << m_plainDatabase );
+    OsmDatabase indexedDatabase( QStringList() << m_indexedDatabase );
+    const QVector<OsmPlacemark> plain = plainDatabase.find( query );
+    const QVector<OsmPlacemark> indexed = indexedDatabase.find( query );
+
+    // the growing boxes in the R-tree must find the same closest placemarks as a full scan
+    QCOMPARE( indexed.size(), 50 );
+    QCOMPARE( indexed.size(), plain.size() );
+    for ( int i = 0; i < indexed.size(); ++i ) {
+        QCOMPARE( indexed[i].category(), OsmPlacemark::FoodRestaurant );
+        QCOMPARE( indexed[i].longitude(), plain[i].longitude() );
+        QCOMPARE( indexed[i].latitude(), plain[i].latitude() );
+    }
+}
+
+void OsmDatabaseTest::nearestAddress()
+{
+    OsmDatabase database( QStringList() << m_indexedDatabase );
+
+    const qreal lon = 10.05;
+    const qreal lat = 51.45;
+    const GeoDataCoordinates coordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+    OsmPlacemark nearest;
+    QVERIFY( database.findNearest( coordinates, 5000.0, nearest ) );
+    QCOMPARE( nearest.category(), OsmPlacemark::Address );
+    QVERIFY( !nearest.houseNumber().isEmpty() );
+    QVERIFY( !nearest.additionalInformation().isEmpty() );
+
+    // the R-tree lookup must find the same address as a full scan
+    {
+        const qreal lonScale = cos( lat * DEG2RAD );
+        QSqlDatabase scan = QSqlDatabase::addDatabase( "QSQLITE", "OsmDatabaseTest" );
+        scan.setDatabaseName( m_indexedDatabase );
+        QVERIFY( scan.open() );
+        QSqlQuery query( scan );
+        QVERIFY( execQuery( query, QString( "SELECT lon, lat FROM placemarks WHERE category IN (0, 6)"
+                                            " ORDER BY ((lat-%1)*(lat-%1)+(lon-%2)*(lon-%2)*%3) LIMIT 1" )
+                                   .arg( lat, 0, 'f', 8 ).arg( lon, 0, 'f', 8 ).arg( lonScale * lonScale, 0, 'f', 8 ) ) );
+        QVERIFY( query.next() );
+        QCOMPARE( nearest.longitude(), query.value( 0 ).toFloat() );
+        QCOMPARE( nearest.latitude(), query.value( 1 ).toFloat() );
+        scan.close();
+    }
+    QSqlDatabase::removeDatabase( "OsmDatabaseTest" );
+
+    // nothing within the maximum distance
+    const GeoDataCoordinates ocean( 0.0, 0.0, 0.0, GeoDataCoordinates::Degree );
+    QVERIFY( !database.findNearest( ocean, 5000.0, nearest ) );
+
+    // databases without the R-tree are not scanned
+    OsmDatabase plainDatabase( QStringList() << m_plainDatabase );
+    QVERIFY( !plainDatabase.findNearest( coordinates, 5000.0, nearest ) );
+}
+
+void OsmDatabaseTest::benchmarkPrefixSearch_data()
+{
+    QTest::addColumn<QString>( "databaseFile" );
+    QTest::addColumn<QString>( "term" );
+
+    QTest::newRow( "like" ) << m_plainDatabase << QString( "Lindenberg*" );
+    QTest::newRow( "fts" ) << m_indexedDatabase << QString( "Lindenberg" );
+}
+
+void OsmDatabaseTest::benchmarkPrefixSearch()
+{
+    QFETCH( QString, databaseFile );
+    QFETCH( QString, term );
+
+    OsmDatabase database( QStringList() << databaseFile );
+    const DatabaseQuery query( 0, term, GeoDataLatLonAltBox() );
+
+    QBENCHMARK {
+        QCOMPARE( database.find( query ).size(), 50 );
+    }
+}
+
+void OsmDatabaseTest::benchmarkNearbySearch_data()
+{
+    QTest::addColumn<QString>( "databaseFile" );
+
+    QTest::newRow( "full scan" ) << m_plainDatabase;
+    QTest::newRow( "rtree" ) << m_indexedDatabase;
+}
+
+void OsmDatabaseTest::benchmarkNearbySearch()
+{
+    QFETCH( QString, databaseFile );
+
+    OsmDatabase database( QStringList() << databaseFile );
+    const GeoDataLatLonAltBox preferred( GeoDataLatLonBox( 51.5, 51.4, 10.1, 10.0, GeoDataCoordinates::Degree ), 0, 0 );
+    const DatabaseQuery query( 0, "restaurant", preferred );
+
+    QBENCHMARK {
+        QCOMPARE( database.find( query ).size(), 50 );
+    }
+}
+
+void OsmDatabaseTest::benchmarkNearestAddress()
+{
+    // writing the database takes several minutes, so it is only done on request
+    if ( qgetenv( "MARBLE_OSM_LARGE_BENCHMARK" ).isEmpty() ) {
+#if QT_VERSION < 0x050000
+        QSKIP( "Set MARBLE_OSM_LARGE_BENCHMARK to benchmark a database of ten million placemarks", SkipSingle );
+#else
+        QSKIP( "Set MARBLE_OSM_LARGE_BENCHMARK to benchmark a database of ten million placemarks" );
+#endif
+    }
+
+    if ( m_largeDatabase.isEmpty() ) {
+        m_largeDatabase = databaseFileName( "large" );
+        createDatabase( m_largeDatabase, 10000000, true );
+    }
+
+    OsmDatabase database( QStringList() << m_largeDatabase );
+    const qint64 memoryBefore = residentMemory();
+
+    // different places for each lookup, so that not all of them hit SQLite's page cache
+    quint32 random = 7;
+    QBENCHMARK {
+        random = random * 1103515245 + 12345;
+        const qreal lon = 6.5 + 8.0 * ( random >> 8 ) / qreal( 1 << 24 );
+        random = random * 1103515245 + 12345;
+        const qreal lat = 47.5 + 7.0 * ( random >> 8 ) / qreal( 1 << 24 );
+
+        OsmPlacemark nearest;
+        QVERIFY( database.findNearest( GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree ), 500.0, nearest ) );
+    }
+
+    if ( memoryBefore >= 0 ) {
+        // lookups go through the rtree, the placemarks must not be loaded into memory
+        const qint64 growth = residentMemory() - memoryBefore;
+        QVERIFY2( growth < 64 * 1024, qPrintable( QString( "resident memory grew by %1 kB" ).arg( growth ) ) );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::OsmDatabaseTest )
+
+#include "OsmDatabaseTest.moc"
@@ -40,6 +40,11 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentRun>
+#include <QtEndian>
 
 namespace Marble
 {
@@ -47,69 +52,109 @@ namespace Marble
 // Polygon header flags, representing the type of polygon
 enum polygonFlagType { LINESTRING = 0, LINEARRING = 1, OUTERBOUNDARY = 2, INNERBOUNDARY = 3, MULTIGEOMETRY = 4 };
 
-
-Pn2Runner::Pn2Runner(QObject *parent) :
-    ParsingRunner(parent)
+namespace
 {
-}
 
-Pn2Runner::~Pn2Runner()
-{
-}
+// Size of the file header, the polygon header, an absolute and a relative node in bytes
+const int fileHeaderSize = 5;
+const int polygonHeaderSize = 9;
+const int absoluteNodeSize = 6;
+const int relativeNodeSize = 2;
 
-bool Pn2Runner::errorCheckLat( qint16 lat ) 
-{
-    if ( lat >= -10800 && lat <= +10800 )
-        return false;
-    else
-        return true;
-}
+// Files with less nodes are decoded in the runner thread only
+const int minimumParallelNodes = 100000;
 
-bool Pn2Runner::errorCheckLon( qint16 lon )
+struct Pn2Polygon
 {
-    if ( lon >= -21600 && lon <= +21600 )
-        return false;
-    else
-        return true;
+    quint8 flag;
+    quint32 nrAbsoluteNodes;
+    int nodeCount;
+    const uchar *nodes;
+    GeoDataLineString *lineString;
+    bool error;
+};
+
+qint16 readInt16( const uchar *data )
+{
+    return qFromBigEndian<qint16>( data );
 }
 
-bool Pn2Runner::importPolygon( QDataStream &stream, GeoDataLineString* linestring, quint32 nrAbsoluteNodes ) 
+/**
+ * Decodes the absolute and relative nodes of @p polygon into a line string
+ * or linear ring that has room for all of them.
+ */
+void importPolygon( Pn2Polygon &polygon )
 {
-    qint16 lat, lon, nrRelativeNodes;
-    qint8 relativeLat, relativeLon;
+    GeoDataLineString *linestring = polygon.flag == LINESTRING ? new GeoDataLineString : new GeoDataLinearRing;
+    linestring->reserve( polygon.nodeCount );
     bool error = false;
 
+    const uchar *node = polygon.nodes;
+    for ( quint32 absoluteNode = 1; absoluteNode <= polygon.nrAbsoluteNodes; absoluteNode++ ) {
+        const qint16 lat = readInt16( node );
+        const qint16 lon = readInt16( node + 2 );
+        const qint16 nrRelativeNodes = readInt16( node + 4 );
+        node += absoluteNodeSize;
 
-    for ( quint32 absoluteNode = 1; absoluteNode <= nrAbsoluteNodes; absoluteNode++ ) {
-        stream >> lat >> lon >> nrRelativeNodes;
-
-        error = error | errorCheckLat( lat ) | errorCheckLon( lon );
+        error = error | Pn2Runner::errorCheckLat( lat ) | Pn2Runner::errorCheckLon( lon );
 
         qreal degLat = ( 1.0 * lat / 120.0 );
         qreal degLon = ( 1.0 * lon / 120.0 );
 
-        GeoDataCoordinates *coord = new GeoDataCoordinates( degLon / 180 * M_PI, degLat / 180 * M_PI );
-        linestring->append( *coord );
+        linestring->append( GeoDataCoordinates( degLon / 180 * M_PI, degLat / 180 * M_PI ) );
 
         for ( qint16 relativeNode = 1; relativeNode <= nrRelativeNodes; ++relativeNode ) {
-            stream >> relativeLat >> relativeLon;
-
-            qint16 currLat = relativeLat + lat; 
-            qint16 currLon = relativeLon + lon;
+            qint16 currLat = qint8( node[0] ) + lat;
+            qint16 currLon = qint8( node[1] ) + lon;
+            node += relativeNodeSize;
 
-
-            error = error | errorCheckLat( currLat ) | errorCheckLon( currLon );
+            error = error | Pn2Runner::errorCheckLat( currLat ) | Pn2Runner::errorCheckLon( currLon );
 
             qreal currDegLat = ( 1.0 * currLat / 120.0 );
             qreal currDegLon = ( 1.0 * currLon / 120.0 );
 
+            linestring->append( GeoDataCoordinates( currDegLon / 180 * M_PI, currDegLat / 180 * M_PI ) );
+        }
+    }
+
+    polygon.lineString = linestring;
+    polygon.error = error;
+}
 
-            GeoDataCoordinates *currCoord = new GeoDataCoordinates( currDegLon / 180 * M_PI, currDegLat / 180 * M_PI );
-            linestring->append( *currCoord );
+void importPolygons( Pn2Polygon *begin, Pn2Polygon *end )
+{
+    for ( Pn2Polygon *polygon = begin; polygon != end; ++polygon ) {
+        if ( polygon->flag <= INNERBOUNDARY ) {
+            importPolygon( *polygon );
         }
     }
+}
+
+}
+
+Pn2Runner::Pn2Runner(QObject *parent) :
+    ParsingRunner(parent)
+{
+}
 
-    return error;
+Pn2Runner::~Pn2Runner()
+{
+}
+
+bool Pn2Runner::errorCheckLat( qint16 lat ) 
+{
+    if ( lat >= -10800 && lat <= +10800 )
+        return false;
+    else
+        return true;
+}
+
+bool Pn2Runner::errorCheckLon( qint16 lon )
+{
+    if ( lon >= -21600 && lon <= +21600 )
+        return false;
+    else
+        return true;
 }
 
 void Pn2Runner::parseFile( const QString &fileName, DocumentRole role = UnknownDocument )
@@ -127,27 +172,114 @@ void Pn2Runner::parseFile( const QString &fileName, DocumentRole role = UnknownD
         return;
     }
 
-    file.open( QIODevice::ReadOnly );
-    QDataStream stream( &file );  // read the data serialized from the file
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        emit parsingFinished( 0, file.errorString() );
+        return;
+    }
+
+    // The nodes are decoded straight from the mapped file
+    QByteArray buffer;
+    qint64 size = file.size();
+    const uchar *data = file.map( 0, size );
+    if ( !data ) {
+        buffer = file.readAll();
+        size = buffer.size();
+        data = reinterpret_cast<const uchar *>( buffer.constData() );
+    }
+    const uchar *const end = data + size;
 
     GeoDataDocument *document = new GeoDataDocument();
     document->setDocumentRole( role );
 
-    quint8 fileHeaderVersion;
-    quint32 fileHeaderPolygons;
+    const quint32 fileHeaderPolygons = size >= fileHeaderSize ? qFromBigEndian<quint32>( data + 1 ) : 0;
+
+    // Find the node runs of all polygons first, as only their relative node
+    // counts tell where the next polygon starts
+    QVector<Pn2Polygon> polygons;
+    qint64 totalNodes = 0;
+    const uchar *pos = data + fileHeaderSize;
+    for ( quint32 currentPoly = 1; ( currentPoly <= fileHeaderPolygons ) && ( end - pos >= polygonHeaderSize ); currentPoly++ ) {
+        Pn2Polygon polygon;
+        polygon.nrAbsoluteNodes = qFromBigEndian<quint32>( pos + 4 );
+        polygon.flag = pos[8];
+        polygon.nodeCount = 0;
+        polygon.lineString = 0;
+        polygon.error = false;
+        pos += polygonHeaderSize;
+        polygon.nodes = pos;
+
+        // a multigeometry header is followed by the headers of its elements
+        if ( polygon.flag <= INNERBOUNDARY ) {
+            for ( quint32 absoluteNode = 1; absoluteNode <= polygon.nrAbsoluteNodes; absoluteNode++ ) {
+                if ( end - pos < absoluteNodeSize ) {
+                    pos = end + 1;
+                    break;
+                }
+                const int nrRelativeNodes = qMax<int>( 0, readInt16( pos + 4 ) );
+                pos += absoluteNodeSize;
+                if ( end - pos < nrRelativeNodes * relativeNodeSize ) {
+                    pos = end + 1;
+                    break;
+                }
+                pos += nrRelativeNodes * relativeNodeSize;
+                polygon.nodeCount += 1 + nrRelativeNodes;
+            }
 
-    stream >> fileHeaderVersion >> fileHeaderPolygons;
+            if ( pos > end ) {
+                mDebug() << "Truncated polygon" << ( currentPoly - 1 ) << "in" << fileName;
+                break;
+            }
+        }
+
+        totalNodes += polygon.nodeCount;
+        polygons.append( polygon );
+    }
+
+    // Decode runs of polygons with about the same number of nodes in parallel
+    Pn2Polygon *const first = polygons.data();
+    const int threadCount = QThread::idealThreadCount();
+    if ( totalNodes < minimumParallelNodes || threadCount < 2 ) {
+        importPolygons( first, first + polygons.size() );
+    }
+    else {
+        const qint64 nodesPerRun = totalNodes / threadCount + 1;
+        QList<QFuture<void> > runs;
+        int begin = 0;
+        qint64 nodes = 0;
+        for ( int i = 0; i < polygons.size(); ++i ) {
+            nodes += polygons[i].nodeCount;
+            if ( nodes >= nodesPerRun || i == polygons.size() - 1 ) {
+                runs << QtConcurrent::run( &importPolygons, first + begin, first + i + 1 );
+                begin = i + 1;
+                nodes = 0;
+            }
+        }
+        foreach ( QFuture<void> future, runs ) {
+            future.waitForFinished();
+        }
+    }
 
     bool error = false;
+    foreach ( const Pn2Polygon &polygon, polygons ) {
+        error = error | polygon.error;
+    }
+
+    if ( error ) {
+        foreach ( const Pn2Polygon &polygon, polygons ) {
+            delete polygon.lineString;
+        }
+        delete document;
+        document = 0;
+        emit parsingFinished( 0, "Errors occurred while parsing the .pn2 file!" );
+        return;
+    }
 
-    quint32 ID, nrAbsoluteNodes;
     quint8 flag, prevFlag = -1;
 
     GeoDataPolygon *polygon = new GeoDataPolygon;
 
-    for ( quint32 currentPoly = 1; ( currentPoly <= fileHeaderPolygons ) && ( !error ) && ( !stream.atEnd() ); currentPoly++ ) {
-
-        stream >> ID >> nrAbsoluteNodes >> flag;
+    foreach ( const Pn2Polygon &current, polygons ) {
+        flag = current.flag;
 
         if ( flag != INNERBOUNDARY && ( prevFlag == INNERBOUNDARY || prevFlag == OUTERBOUNDARY ) ) {
 
@@ -157,17 +289,13 @@ void Pn2Runner::parseFile( const QString &fileName, DocumentRole role = UnknownD
         }
 
         if ( flag == LINESTRING ) {
-            GeoDataLineString *linestring = new GeoDataLineString;
-            error = error | importPolygon( stream, linestring, nrAbsoluteNodes );
-
             GeoDataPlacemark *placemark = new GeoDataPlacemark;
-            placemark->setGeometry( linestring );
+            placemark->setGeometry( current.lineString );
             document->append( placemark );
         }
 
         if ( ( flag == LINEARRING ) || ( flag == OUTERBOUNDARY ) || ( flag == INNERBOUNDARY ) ) {
-            GeoDataLinearRing* linearring = new GeoDataLinearRing;
-            error = error | importPolygon( stream, linearring, nrAbsoluteNodes );
+            GeoDataLinearRing* linearring = static_cast<GeoDataLinearRing*>( current.lineString );
 
             if ( flag == LINEARRING ) {
                 GeoDataPlacemark *placemark = new GeoDataPlacemark;
@@ -178,15 +306,15 @@ void Pn2Runner::parseFile( const QString &fileName, DocumentRole role = UnknownD
             if ( flag == OUTERBOUNDARY ) {
                 polygon = new GeoDataPolygon;
                 polygon->setOuterBoundary( *linearring );
+                delete linearring;
             }
 
             if ( flag == INNERBOUNDARY ) {
                 polygon->appendInnerBoundary( *linearring );
+                delete linearring;
             }
         }
 
-        
-
         if ( flag == MULTIGEOMETRY ) {
             // not implemented yet, for now elements inside a multigeometry are separated as individual geometries
         }
@@ -200,12 +328,6 @@ void Pn2Runner::parseFile( const QString &fileName, DocumentRole role = UnknownD
         document->append( placemark );
     }
 
-    if ( error ) {
-        delete document;
-        document = 0;
-        emit parsingFinished( 0, "Errors occurred while parsing the .pn2 file!" );
-        return;
-    }
     document->setFileName( fileName );
 
     emit parsingFinished( document );
@@ -15,17 +15,14 @@
 namespace Marble
 {
 
-class GeoDataLineString;
-
 class Pn2Runner : public ParsingRunner
 {
     Q_OBJECT
 public:
     explicit Pn2Runner(QObject *parent = 0);
     ~Pn2Runner();
-    bool errorCheckLat( qint16 lat );
-    bool errorCheckLon( qint16 lon );
-    bool importPolygon( QDataStream &stream, GeoDataLineString* linestring, quint32 nrAbsoluteNodes );
+    static bool errorCheckLat( qint16 lat );
+    static bool errorCheckLon( qint16 lon );
     virtual void parseFile( const QString &fileName, DocumentRole role );
 
 signals:
@@ -23,6 +23,7 @@
 #include "MarbleDebug.h"
 #include "MarbleTest.h"
 #include "MarbleLocale.h"
+#include "RenderProfiler.h"
 
 #ifdef STATIC_BUILD
  #include <QtPlugin>
@@ -94,6 +95,7 @@ int main(int argc, char *argv[])
     QString mapThemeId;
     QString coordinatesString;
     QString distanceString;
+    QString renderProfileFile;
     MarbleGlobal::Profiles profiles = MarbleGlobal::detectProfiles();
 
     QStringList args = QApplication::arguments();
@@ -113,6 +115,7 @@ int main(int argc, char *argv[])
         qWarning() << "  --debug-info ............... write (more) debugging information to the console";
         qWarning() << "  --fps ...................... Show the paint performance (paint rate) in the top left corner";
         qWarning() << "  --runtimeTrace.............. Show the time spent and other debug info of each layer";
+        qWarning() << "  --render-profile=<file> .... Write the time spent painting each layer to <file> in the Chrome trace format on exit";
         qWarning() << "  --tile-id................... Write the identifier of texture tiles on top of them";
         qWarning() << "  --timedemo ................. Measure the paint performance while moving the map and quit";
         qWarning();
@@ -169,6 +172,11 @@ int main(int argc, char *argv[])
         {
             mapThemeId = arg.mid(6);
         }
+        else if ( arg.startsWith( QLatin1String( "--render-profile=" ), Qt::CaseInsensitive ) )
+        {
+            renderProfileFile = arg.mid(17);
+            RenderProfiler::setEnabled( true );
+        }
         else if ( arg.compare( QLatin1String( "--map" ), Qt::CaseInsensitive ) == 0 ) {
             ++i;
             // TODO: misses an error check if there is a value at all
@@ -233,5 +241,11 @@ int main(int argc, char *argv[])
             window->addGeoDataFile( arg );
     }
 
-    return app.exec();
+    const int result = app.exec();
+
+    if ( !renderProfileFile.isEmpty() ) {
+        RenderProfiler::exportChromeTrace( renderProfileFile );
+    }
+
+    return result;
 }
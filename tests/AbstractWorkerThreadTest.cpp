@@ -0,0 +1,116 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "AbstractWorkerThread.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QtTest>
+
+namespace Marble
+{
+
+class TestWorkerThread : public AbstractWorkerThread
+{
+ public:
+    TestWorkerThread() :
+        AbstractWorkerThread(),
+        m_scheduled( 0 )
+    {}
+
+    void schedule()
+    {
+        m_mutex.lock();
+        ++m_scheduled;
+        m_mutex.unlock();
+        ensureRunning();
+    }
+
+    QSemaphore m_done;
+
+ protected:
+    bool workAvailable()
+    {
+        QMutexLocker locker( &m_mutex );
+        return m_scheduled > 0;
+    }
+
+    void work()
+    {
+        m_mutex.lock();
+        --m_scheduled;
+        m_mutex.unlock();
+        m_done.release();
+    }
+
+ private:
+    QMutex m_mutex;
+    int m_scheduled;
+};
+
+class AbstractWorkerThreadTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void workIsDone();
+    void restartAfterIdle();
+    void scheduleLatency();
+};
+
+void AbstractWorkerThreadTest::workIsDone()
+{
+    TestWorkerThread worker;
+
+    for ( int i = 0; i < 100; ++i ) {
+        worker.schedule();
+    }
+
+    QVERIFY( worker.m_done.tryAcquire( 100, 5000 ) );
+}
+
+void AbstractWorkerThreadTest::restartAfterIdle()
+{
+    TestWorkerThread worker;
+
+    worker.schedule();
+    QVERIFY( worker.m_done.tryAcquire( 1, 5000 ) );
+
+    // the thread switches itself off after some time without work
+    QVERIFY( worker.wait( 10000 ) );
+
+    worker.schedule();
+    QVERIFY( worker.m_done.tryAcquire( 1, 5000 ) );
+}
+
+void AbstractWorkerThreadTest::scheduleLatency()
+{
+    TestWorkerThread worker;
+
+    // make sure the thread is up and waiting for work
+    worker.schedule();
+    QVERIFY( worker.m_done.tryAcquire( 1, 5000 ) );
+
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        worker.schedule();
+        worker.m_done.acquire();
+    }
+
+    // waking the thread must not depend on a polling interval
+    QVERIFY( timer.elapsed() < 5000 );
+}
+
+}
+
+QTEST_MAIN( Marble::AbstractWorkerThreadTest )
+
+#include "AbstractWorkerThreadTest.moc"
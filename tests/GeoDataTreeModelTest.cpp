@@ -0,0 +1,217 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest>
+
+#include "GeoDataFolder.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+#include "kdescendantsproxymodel.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class GeoDataTreeModelTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void childPosition();
+    void parentAndIndex();
+    void addDocuments();
+    void benchmarkDescendants();
+    void benchmarkAddDocument();
+    void benchmarkAddDocuments();
+
+ private:
+    static QString largeKml( int placemarks );
+};
+
+QString GeoDataTreeModelTest::largeKml( int placemarks )
+{
+    QString kml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document><Folder>";
+    for ( int i = 0; i < placemarks; ++i ) {
+        kml += QString( "<Placemark><name>%1</name><Point><coordinates>%2,%3</coordinates></Point></Placemark>" )
+               .arg( i ).arg( ( i % 360 ) - 180 ).arg( ( i % 180 ) - 90 );
+    }
+    kml += "</Folder></Document></kml>";
+    return kml;
+}
+
+void GeoDataTreeModelTest::childPosition()
+{
+    GeoDataFolder folder;
+    QVector<GeoDataPlacemark*> placemarks;
+    for ( int i = 0; i < 100; ++i ) {
+        placemarks << new GeoDataPlacemark( QString::number( i ) );
+        folder.append( placemarks.last() );
+    }
+
+    for ( int i = 0; i < 100; ++i ) {
+        QCOMPARE( folder.childPosition( placemarks.at( i ) ), i );
+    }
+
+    GeoDataPlacemark *first = new GeoDataPlacemark( "first" );
+    folder.insert( first, 0 );
+    QCOMPARE( folder.childPosition( first ), 0 );
+    QCOMPARE( folder.childPosition( placemarks.at( 50 ) ), 51 );
+
+    folder.remove( 0 );
+    QCOMPARE( folder.childPosition( first ), -1 );
+    delete first;
+    QCOMPARE( folder.childPosition( placemarks.at( 50 ) ), 50 );
+
+    GeoDataPlacemark *last = new GeoDataPlacemark( "last" );
+    folder.append( last );
+    QCOMPARE( folder.childPosition( last ), 100 );
+    QCOMPARE( folder.childPosition( placemarks.at( 99 ) ), 99 );
+
+    // removals in the middle shift the following positions
+    folder.remove( 50 );
+    QCOMPARE( folder.childPosition( placemarks.at( 50 ) ), -1 );
+    delete placemarks.at( 50 );
+    QCOMPARE( folder.childPosition( placemarks.at( 49 ) ), 49 );
+    QCOMPARE( folder.childPosition( placemarks.at( 51 ) ), 50 );
+    QCOMPARE( folder.childPosition( last ), 99 );
+
+    GeoDataPlacemark *middle = new GeoDataPlacemark( "middle" );
+    folder.insert( middle, 20 );
+    QCOMPARE( folder.childPosition( middle ), 20 );
+    QCOMPARE( folder.childPosition( placemarks.at( 20 ) ), 21 );
+    QCOMPARE( folder.childPosition( last ), 100 );
+
+    // children replaced through an iterator are found as well
+    GeoDataPlacemark *replacement = new GeoDataPlacemark( "replacement" );
+    *( folder.begin() + 20 ) = replacement;
+    QCOMPARE( folder.childPosition( replacement ), 20 );
+    QCOMPARE( folder.childPosition( middle ), -1 );
+    delete middle;
+}
+
+void GeoDataTreeModelTest::parentAndIndex()
+{
+    GeoDataTreeModel model;
+    GeoDataDocument *document = parseKml( largeKml( 1000 ) );
+    QVERIFY( document );
+    model.addDocument( document );
+
+    const QModelIndex documentIndex = model.index( 0, 0 );
+    const QModelIndex folderIndex = model.index( 0, 0, documentIndex );
+    QCOMPARE( model.rowCount( folderIndex ), 1000 );
+
+    for ( int row = 0; row < 1000; row += 97 ) {
+        const QModelIndex placemarkIndex = model.index( row, 0, folderIndex );
+        QVERIFY( model.parent( placemarkIndex ) == folderIndex );
+
+        GeoDataObject *object = static_cast<GeoDataObject*>( placemarkIndex.internalPointer() );
+        QVERIFY( model.index( object ) == placemarkIndex );
+    }
+
+    model.removeDocument( document );
+    delete document;
+}
+
+void GeoDataTreeModelTest::addDocuments()
+{
+    GeoDataTreeModel model;
+    GeoDataDocument *first = new GeoDataDocument;
+    model.addDocument( first );
+
+    QList<GeoDataDocument *> documents;
+    for ( int i = 0; i < 10; ++i ) {
+        documents << new GeoDataDocument;
+    }
+
+    QSignalSpy inserted( &model, SIGNAL(rowsInserted(QModelIndex,int,int)) );
+    QCOMPARE( model.addDocuments( documents ), 1 );
+    QCOMPARE( model.addDocuments( QList<GeoDataDocument *>() ), -1 );
+
+    QCOMPARE( inserted.count(), 1 );
+    QCOMPARE( inserted.at( 0 ).at( 1 ).toInt(), 1 );
+    QCOMPARE( inserted.at( 0 ).at( 2 ).toInt(), 10 );
+    QCOMPARE( model.rowCount(), 11 );
+
+    for ( int i = 0; i < documents.size(); ++i ) {
+        QVERIFY( model.index( documents.at( i ) ) == model.index( i + 1, 0 ) );
+    }
+
+    model.removeDocument( first );
+    delete first;
+    foreach ( GeoDataDocument *document, documents ) {
+        model.removeDocument( document );
+        delete document;
+    }
+}
+
+void GeoDataTreeModelTest::benchmarkDescendants()
+{
+    GeoDataTreeModel model;
+    GeoDataDocument *document = parseKml( largeKml( 100000 ) );
+    QVERIFY( document );
+    model.addDocument( document );
+
+    QBENCHMARK {
+        KDescendantsProxyModel descendants;
+        descendants.setSourceModel( &model );
+        // document, folder and placemarks
+        QCOMPARE( descendants.rowCount(), 100002 );
+        for ( int row = 0; row < descendants.rowCount(); ++row ) {
+            descendants.mapToSource( descendants.index( row, 0 ) );
+        }
+    }
+
+    model.removeDocument( document );
+    delete document;
+}
+
+void GeoDataTreeModelTest::benchmarkAddDocument()
+{
+    // like vector tiles, many small documents
+    GeoDataTreeModel model;
+    KDescendantsProxyModel descendants;
+    descendants.setSourceModel( &model );
+
+    QBENCHMARK {
+        QList<GeoDataDocument *> documents;
+        for ( int i = 0; i < 200; ++i ) {
+            documents << parseKml( largeKml( 10 ) );
+            model.addDocument( documents.last() );
+        }
+        foreach ( GeoDataDocument *document, documents ) {
+            model.removeDocument( document );
+            delete document;
+        }
+    }
+}
+
+void GeoDataTreeModelTest::benchmarkAddDocuments()
+{
+    GeoDataTreeModel model;
+    KDescendantsProxyModel descendants;
+    descendants.setSourceModel( &model );
+
+    QBENCHMARK {
+        QList<GeoDataDocument *> documents;
+        for ( int i = 0; i < 200; ++i ) {
+            documents << parseKml( largeKml( 10 ) );
+        }
+        model.addDocuments( documents );
+        foreach ( GeoDataDocument *document, documents ) {
+            model.removeDocument( document );
+            delete document;
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::GeoDataTreeModelTest )
+
+#include "GeoDataTreeModelTest.moc"
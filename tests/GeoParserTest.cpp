@@ -0,0 +1,141 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
+#include "GeoDataTrack.h"
+#include "TestUtils.h"
+
+namespace Marble
+{
+
+class GeoParserTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void parentContexts();
+    void namespaces();
+    void benchmarkParse();
+
+ private:
+    static QString largeKml( int placemarks );
+};
+
+QString GeoParserTest::largeKml( int placemarks )
+{
+    QString kml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>";
+    for ( int i = 0; i < placemarks; ++i ) {
+        kml += QString( "<Placemark><name>%1</name><description>Place %1</description>"
+                        "<Point><coordinates>%2,%3</coordinates></Point></Placemark>" )
+               .arg( i ).arg( ( i % 360 ) - 180 ).arg( ( i % 180 ) - 90 );
+    }
+    kml += "</Document></kml>";
+    return kml;
+}
+
+void GeoParserTest::parentContexts()
+{
+    // the same elements below different parents, and below unknown elements
+    const QString content(
+"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+"<Document>"
+"  <name>document</name>"
+"  <Placemark><name>first</name><Point><coordinates>1,2</coordinates></Point></Placemark>"
+"  <Folder>"
+"    <name>folder</name>"
+"    <Placemark><name>second</name><Point><coordinates>3,4</coordinates></Point></Placemark>"
+"    <Unknown><name>ignored</name></Unknown>"
+"    <Placemark><name>third</name><Point><coordinates>5,6</coordinates></Point></Placemark>"
+"  </Folder>"
+"  <Placemark><name>fourth</name><Point><coordinates>7,8</coordinates></Point></Placemark>"
+"</Document>"
+"</kml>" );
+
+    // twice, as the second document is parsed with the child tags seen before
+    for ( int i = 0; i < 2; ++i ) {
+        GeoDataDocument *document = parseKml( content );
+        QCOMPARE( document->name(), QString( "document" ) );
+        QCOMPARE( document->placemarkList().size(), 2 );
+        QCOMPARE( document->placemarkList().at( 0 )->name(), QString( "first" ) );
+        QCOMPARE( document->placemarkList().at( 1 )->name(), QString( "fourth" ) );
+
+        QCOMPARE( document->folderList().size(), 1 );
+        const GeoDataFolder *folder = document->folderList().at( 0 );
+        QCOMPARE( folder->name(), QString( "folder" ) );
+        QCOMPARE( folder->placemarkList().size(), 2 );
+        QCOMPARE( folder->placemarkList().at( 0 )->name(), QString( "second" ) );
+        QCOMPARE( folder->placemarkList().at( 1 )->name(), QString( "third" ) );
+        QCOMPARE( folder->placemarkList().at( 1 )->coordinate(), GeoDataCoordinates( 5, 6, 0, GeoDataCoordinates::Degree ) );
+
+        delete document;
+    }
+}
+
+void GeoParserTest::namespaces()
+{
+    // <coord> only exists in the gx namespace, <coordinates> only in the kml one
+    const QString content(
+"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<kml xmlns=\"http://www.opengis.net/kml/2.2\""
+" xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+"<Document>"
+"  <Placemark>"
+"    <gx:Track>"
+"      <when>2010-05-28T02:02:09Z</when>"
+"      <when>2010-05-28T02:02:35Z</when>"
+"      <gx:coord>-122.207881 37.371915 156.000000</gx:coord>"
+"      <gx:coord>-122.205712 37.373288 152.000000</gx:coord>"
+"      <coord>0 0 0</coord>"
+"    </gx:Track>"
+"  </Placemark>"
+"  <Placemark>"
+"    <LineString><coordinates>1,2 3,4 5,6</coordinates></LineString>"
+"  </Placemark>"
+"</Document>"
+"</kml>" );
+
+    GeoDataDocument *document = parseKml( content );
+    QCOMPARE( document->placemarkList().size(), 2 );
+
+    const GeoDataPlacemark *first = document->placemarkList().at( 0 );
+    QCOMPARE( first->geometry()->geometryId(), GeoDataTrackId );
+    QCOMPARE( static_cast<const GeoDataTrack*>( first->geometry() )->size(), 2 );
+
+    const GeoDataPlacemark *second = document->placemarkList().at( 1 );
+    QCOMPARE( second->geometry()->geometryId(), GeoDataLineStringId );
+    QCOMPARE( static_cast<const GeoDataLineString*>( second->geometry() )->size(), 3 );
+
+    delete document;
+}
+
+void GeoParserTest::benchmarkParse()
+{
+    const int placemarks = 50000;
+    const QString content = largeKml( placemarks );
+
+    // kml, Document and five elements per placemark
+    qDebug() << 2 + 5 * placemarks << "elements," << content.size() / 1024 << "kB";
+
+    QBENCHMARK {
+        GeoDataDocument *document = parseKml( content );
+        QCOMPARE( document->placemarkList().size(), placemarks );
+        delete document;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::GeoParserTest )
+
+#include "GeoParserTest.moc"
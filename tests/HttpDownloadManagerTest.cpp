@@ -0,0 +1,500 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "FileStoragePolicy.h"
+#include "HttpDownloadManager.h"
+#include "TileId.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtTest>
+
+namespace Marble
+{
+
+/**
+ * Answers every request after a fixed latency, like a remote tile server.
+ */
+class DelayedHttpServer : public QTcpServer
+{
+    Q_OBJECT
+
+ public:
+    explicit DelayedHttpServer( int latency ) :
+        QTcpServer(),
+        m_latency( latency )
+    {
+        connect( this, SIGNAL(newConnection()), SLOT(acceptConnection()) );
+    }
+
+    QUrl url( const QString &path ) const
+    {
+        return QUrl( QString( "http://127.0.0.1:%1/%2" ).arg( serverPort() ).arg( path ) );
+    }
+
+    QSet<QString> requestedPaths() const
+    {
+        return m_requestedPaths;
+    }
+
+ private Q_SLOTS:
+    void acceptConnection()
+    {
+        while ( hasPendingConnections() ) {
+            QTcpSocket *socket = nextPendingConnection();
+            connect( socket, SIGNAL(readyRead()), SLOT(readRequests()) );
+            connect( socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()) );
+        }
+    }
+
+    void readRequests()
+    {
+        QTcpSocket *socket = qobject_cast<QTcpSocket *>( sender() );
+        QByteArray &buffer = m_buffers[ socket ];
+        buffer += socket->readAll();
+
+        int end = buffer.indexOf( "\r\n\r\n" );
+        while ( end >= 0 ) {
+            const QByteArray request = buffer.left( end );
+            buffer.remove( 0, end + 4 );
+
+            const QString path = QString::fromLatin1( request.split( ' ' ).value( 1 ) ).mid( 1 );
+            m_requestedPaths.insert( path );
+            m_replies.append( qMakePair( QPointer<QTcpSocket>( socket ), path ) );
+            QTimer::singleShot( m_latency, this, SLOT(sendReply()) );
+
+            end = buffer.indexOf( "\r\n\r\n" );
+        }
+    }
+
+    void sendReply()
+    {
+        // all replies have the same latency, so they are due in request order
+        const QPair<QPointer<QTcpSocket>, QString> reply = m_replies.takeFirst();
+        if ( reply.first.isNull() ) {
+            return;
+        }
+
+        const QByteArray body = reply.second.toLatin1();
+        reply.first->write( "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: " );
+        reply.first->write( QByteArray::number( body.size() ) + "\r\n\r\n" + body );
+    }
+
+ private:
+    const int m_latency;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    QList<QPair<QPointer<QTcpSocket>, QString> > m_replies;
+    QSet<QString> m_requestedPaths;
+};
+
+/**
+ * Writes every file right away, as the file storage used to do.
+ */
+class SynchronousStoragePolicy : public StoragePolicy
+{
+ public:
+    explicit SynchronousStoragePolicy( const QString &dataDirectory ) :
+        StoragePolicy(),
+        m_dataDirectory( dataDirectory )
+    {}
+
+    bool fileExists( const QString &fileName ) const
+    {
+        return QFile::exists( m_dataDirectory + '/' + fileName );
+    }
+
+    bool updateFile( const QString &fileName, const QByteArray &data )
+    {
+        const QString fullName = m_dataDirectory + '/' + fileName;
+        QDir::root().mkpath( QFileInfo( fullName ).absolutePath() );
+        QFile file( fullName );
+        return file.open( QIODevice::WriteOnly ) && file.write( data ) == data.size();
+    }
+
+    void clearCache() {}
+
+    QString lastErrorMessage() const
+    {
+        return QString();
+    }
+
+ private:
+    const QString m_dataDirectory;
+};
+
+/**
+ * Measures the longest time the event loop did not get to a timer, which
+ * is how long a frame could have been delayed.
+ */
+class FrameTimer : public QObject
+{
+    Q_OBJECT
+
+ public:
+    FrameTimer() :
+        QObject(),
+        m_maximumGap( 0 )
+    {
+        connect( &m_timer, SIGNAL(timeout()), SLOT(tick()) );
+        m_timer.start( 1 );
+        m_elapsed.start();
+    }
+
+    qint64 maximumGap() const
+    {
+        return m_maximumGap;
+    }
+
+ private Q_SLOTS:
+    void tick()
+    {
+        m_maximumGap = qMax( m_maximumGap, m_elapsed.restart() );
+    }
+
+ private:
+    QTimer m_timer;
+    QElapsedTimer m_elapsed;
+    qint64 m_maximumGap;
+};
+
+class HttpDownloadManagerTest : public QObject
+{
+    Q_OBJECT
+
+ public Q_SLOTS:
+    void recordCompletion( const QByteArray &data, const QString &id );
+    void recordSizeChange( qint64 bytes );
+
+ private Q_SLOTS:
+    void prefersViewCenter();
+    void dropsInvisibleTiles();
+    void keepsBulkDownloads();
+    void benchmarkPan();
+    void storesBurst();
+    void burstJitter();
+
+ private:
+    /**
+     * Queues the downloads of a @p size x @p size view of level 8 tiles
+     * centered at @p centerX, @p centerY in raster order and reports the
+     * view to @p manager.
+     */
+    void showView( HttpDownloadManager *manager, DelayedHttpServer *server,
+                   int centerX, int centerY, int size );
+
+    bool waitForTile( const QString &id );
+
+    /**
+     * Downloads a burst of @p count tiles into @p storagePolicy and returns
+     * the longest time the event loop was blocked meanwhile.
+     */
+    qint64 downloadBurst( StoragePolicy *storagePolicy, DelayedHttpServer *server, int count );
+
+    static QString tileId( int x, int y );
+
+    static QString tileFileName( int x, int y );
+
+    static QString createDataDirectory( const QString &name );
+
+    static void removeDataDirectory( const QString &path );
+
+    QStringList m_completed;
+    qint64 m_sizeChange;
+};
+
+QString HttpDownloadManagerTest::tileId( int x, int y )
+{
+    return QString( "test:8:%1:%2" ).arg( x ).arg( y );
+}
+
+QString HttpDownloadManagerTest::tileFileName( int x, int y )
+{
+    return QString( "maps/earth/test/8/%1/%2.png" ).arg( y ).arg( x );
+}
+
+QString HttpDownloadManagerTest::createDataDirectory( const QString &name )
+{
+    const QString path = QDir::tempPath() + QString( "/marble-%1-%2" )
+                         .arg( name ).arg( QCoreApplication::applicationPid() );
+    removeDataDirectory( path );
+    QDir::root().mkpath( path );
+    return path;
+}
+
+void HttpDownloadManagerTest::removeDataDirectory( const QString &path )
+{
+    QDirIterator files( path, QDir::Files, QDirIterator::Subdirectories );
+    while ( files.hasNext() ) {
+        QFile::remove( files.next() );
+    }
+
+    // remove the deepest directories first
+    QStringList directories;
+    QDirIterator it( path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories );
+    while ( it.hasNext() ) {
+        directories.prepend( it.next() );
+    }
+    foreach ( const QString &directory, directories ) {
+        QDir::root().rmdir( directory );
+    }
+    QDir::root().rmdir( path );
+}
+
+void HttpDownloadManagerTest::recordCompletion( const QByteArray &data, const QString &id )
+{
+    Q_UNUSED( data );
+    m_completed.append( id );
+}
+
+void HttpDownloadManagerTest::recordSizeChange( qint64 bytes )
+{
+    m_sizeChange += bytes;
+}
+
+void HttpDownloadManagerTest::showView( HttpDownloadManager *manager, DelayedHttpServer *server,
+                                        int centerX, int centerY, int size )
+{
+    QList<TileId> visibleTiles;
+    for ( int y = centerY - size / 2; y <= centerY + size / 2; ++y ) {
+        for ( int x = centerX - size / 2; x <= centerX + size / 2; ++x ) {
+            const QString id = tileId( x, y );
+            manager->addJob( server->url( id ), id, id, DownloadBrowse );
+            visibleTiles << TileId( 0, 8, x, y );
+        }
+    }
+    manager->setVisibleTiles( QStringList() << "test", visibleTiles );
+}
+
+bool HttpDownloadManagerTest::waitForTile( const QString &id )
+{
+    QElapsedTimer timer;
+    timer.start();
+    while ( !m_completed.contains( id ) && timer.elapsed() < 30000 ) {
+        QTest::qWait( 1 );
+    }
+
+    return m_completed.contains( id );
+}
+
+void HttpDownloadManagerTest::prefersViewCenter()
+{
+    DelayedHttpServer server( 20 );
+    QVERIFY( server.listen( QHostAddress::LocalHost ) );
+
+    HttpDownloadManager manager( 0 );
+    connect( &manager, SIGNAL(downloadComplete(QByteArray,QString)),
+             this, SLOT(recordCompletion(QByteArray,QString)) );
+    m_completed.clear();
+
+    // keep all connections busy, so that the tiles have to wait in the queue
+    for ( int i = 0; i < 20; ++i ) {
+        const QString id = QString( "other%1" ).arg( i );
+        manager.addJob( server.url( id ), id, id, DownloadBrowse );
+    }
+
+    showView( &manager, &server, 100, 100, 11 );
+    QVERIFY( waitForTile( tileId( 100, 100 ) ) );
+
+    // the center tile has been queued in the middle of the view, but it is
+    // among the first tiles to be activated
+    QStringList completedTiles = m_completed.filter( "test:" );
+    QVERIFY( completedTiles.indexOf( tileId( 100, 100 ) ) < 6 );
+
+    QVERIFY( waitForTile( tileId( 95, 95 ) ) );
+    completedTiles = m_completed.filter( "test:" );
+    QVERIFY( completedTiles.indexOf( tileId( 100, 100 ) ) < completedTiles.indexOf( tileId( 95, 95 ) ) );
+}
+
+void HttpDownloadManagerTest::dropsInvisibleTiles()
+{
+    DelayedHttpServer server( 20 );
+    QVERIFY( server.listen( QHostAddress::LocalHost ) );
+
+    HttpDownloadManager manager( 0 );
+    connect( &manager, SIGNAL(downloadComplete(QByteArray,QString)),
+             this, SLOT(recordCompletion(QByteArray,QString)) );
+    m_completed.clear();
+
+    for ( int i = 0; i < 20; ++i ) {
+        const QString id = QString( "other%1" ).arg( i );
+        manager.addJob( server.url( id ), id, id, DownloadBrowse );
+    }
+
+    showView( &manager, &server, 100, 100, 11 );
+    // pan far away before any of the tiles could be downloaded
+    showView( &manager, &server, 200, 100, 11 );
+
+    QVERIFY( waitForTile( tileId( 200, 100 ) ) );
+    QVERIFY( waitForTile( tileId( 195, 95 ) ) );
+    QTest::qWait( 200 );
+
+    // none of the tiles of the first view has been requested
+    foreach ( const QString &path, server.requestedPaths() ) {
+        if ( path.startsWith( "test:" ) ) {
+            QVERIFY2( path.split( ':' ).value( 2 ).toInt() >= 195, qPrintable( path ) );
+        }
+    }
+
+    // jobs which are not tile downloads of the view are not dropped
+    for ( int i = 0; i < 20; ++i ) {
+        QVERIFY( m_completed.contains( QString( "other%1" ).arg( i ) ) );
+    }
+}
+
+void HttpDownloadManagerTest::keepsBulkDownloads()
+{
+    DelayedHttpServer server( 20 );
+    QVERIFY( server.listen( QHostAddress::LocalHost ) );
+
+    HttpDownloadManager manager( 0 );
+    connect( &manager, SIGNAL(downloadComplete(QByteArray,QString)),
+             this, SLOT(recordCompletion(QByteArray,QString)) );
+    m_completed.clear();
+
+    // a region download queues tiles with the same ids as the view does
+    for ( int x = 95; x <= 105; ++x ) {
+        const QString id = tileId( x, 100 );
+        manager.addJob( server.url( id ), id, id, DownloadBulk );
+    }
+
+    // the view is elsewhere while the bulk jobs are still queued
+    showView( &manager, &server, 200, 100, 3 );
+
+    for ( int x = 95; x <= 105; ++x ) {
+        QVERIFY2( waitForTile( tileId( x, 100 ) ), qPrintable( tileId( x, 100 ) ) );
+    }
+}
+
+void HttpDownloadManagerTest::benchmarkPan()
+{
+    DelayedHttpServer server( 20 );
+    QVERIFY( server.listen( QHostAddress::LocalHost ) );
+
+    QBENCHMARK {
+        HttpDownloadManager manager( 0 );
+        connect( &manager, SIGNAL(downloadComplete(QByteArray,QString)),
+                 this, SLOT(recordCompletion(QByteArray,QString)) );
+        m_completed.clear();
+
+        // pan east in steps of four tiles, waiting for the center tile of
+        // each view to be complete before moving on
+        for ( int step = 0; step < 10; ++step ) {
+            const int centerX = 1000 + 4 * step;
+            showView( &manager, &server, centerX, 100, 15 );
+            QVERIFY( waitForTile( tileId( centerX, 100 ) ) );
+        }
+    }
+}
+
+qint64 HttpDownloadManagerTest::downloadBurst( StoragePolicy *storagePolicy,
+                                              DelayedHttpServer *server, int count )
+{
+    HttpDownloadManager manager( storagePolicy );
+    connect( &manager, SIGNAL(downloadComplete(QByteArray,QString)),
+             this, SLOT(recordCompletion(QByteArray,QString)) );
+    m_completed.clear();
+
+    FrameTimer frameTimer;
+    for ( int i = 0; i < count; ++i ) {
+        const QString id = tileId( i % 64, i / 64 );
+        manager.addJob( server->url( id ), tileFileName( i % 64, i / 64 ), id, DownloadBrowse );
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    while ( m_completed.size() < count && timer.elapsed() < 60000 ) {
+        QTest::qWait( 1 );
+    }
+
+    return frameTimer.maximumGap();
+}
+
+void HttpDownloadManagerTest::storesBurst()
+{
+    DelayedHttpServer server( 0 );
+    QVERIFY( server.listen( QHostAddress::LocalHost ) );
+
+    const QString dataDirectory = createDataDirectory( "storesBurst" );
+    FileStoragePolicy storagePolicy( dataDirectory );
+    connect( &storagePolicy, SIGNAL(sizeChanged(qint64)), SLOT(recordSizeChange(qint64)) );
+    m_sizeChange = 0;
+
+    const int count = 500;
+    downloadBurst( &storagePolicy, &server, count );
+    QCOMPARE( m_completed.size(), count );
+
+    // the tiles which are not on disk yet count as stored already
+    for ( int i = 0; i < count; ++i ) {
+        QVERIFY( storagePolicy.fileExists( tileFileName( i % 64, i / 64 ) ) );
+    }
+
+    storagePolicy.waitForWrites();
+    QTest::qWait( 10 );
+
+    qint64 storedBytes = 0;
+    for ( int i = 0; i < count; ++i ) {
+        QFile file( dataDirectory + '/' + tileFileName( i % 64, i / 64 ) );
+        QVERIFY( file.open( QIODevice::ReadOnly ) );
+        QCOMPARE( QString::fromLatin1( file.readAll() ), tileId( i % 64, i / 64 ) );
+        storedBytes += file.size();
+    }
+
+    // the size is reported without rescanning the directory
+    QCOMPARE( m_sizeChange, storedBytes );
+
+    // overwriting files only reports the difference
+    m_sizeChange = 0;
+    storagePolicy.updateFile( tileFileName( 0, 0 ), "a" );
+    storagePolicy.waitForWrites();
+    QTest::qWait( 10 );
+    QCOMPARE( m_sizeChange, qint64( 1 - tileId( 0, 0 ).size() ) );
+
+    removeDataDirectory( dataDirectory );
+}
+
+void HttpDownloadManagerTest::burstJitter()
+{
+    DelayedHttpServer server( 0 );
+    QVERIFY( server.listen( QHostAddress::LocalHost ) );
+
+    const int count = 2000;
+
+    const QString synchronousDirectory = createDataDirectory( "synchronousBurst" );
+    SynchronousStoragePolicy synchronousPolicy( synchronousDirectory );
+    const qint64 synchronousGap = downloadBurst( &synchronousPolicy, &server, count );
+    QCOMPARE( m_completed.size(), count );
+    removeDataDirectory( synchronousDirectory );
+
+    const QString dataDirectory = createDataDirectory( "backgroundBurst" );
+    qint64 backgroundGap = 0;
+    {
+        FileStoragePolicy storagePolicy( dataDirectory );
+        backgroundGap = downloadBurst( &storagePolicy, &server, count );
+        QCOMPARE( m_completed.size(), count );
+    }
+    removeDataDirectory( dataDirectory );
+
+    // writing the tiles must not stall the event loop as writing them synchronously does
+    QVERIFY2( backgroundGap < synchronousGap,
+              qPrintable( QString( "longest frame delay with synchronous writes: %1 ms, with background writes: %2 ms" )
+                          .arg( synchronousGap ).arg( backgroundGap ) ) );
+}
+
+}
+
+QTEST_MAIN( Marble::HttpDownloadManagerTest )
+
+#include "HttpDownloadManagerTest.moc"
@@ -0,0 +1,217 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "GeoPainter.h"
+#include "LayerInterface.h"
+#include "LayerManager.h"
+#include "MarbleModel.h"
+#include "RenderPlugin.h"
+#include "ViewportParams.h"
+
+#include <QImage>
+#include <QtTest>
+
+namespace Marble
+{
+
+class TestLayer : public LayerInterface
+{
+ public:
+    TestLayer( const QString &name, const QStringList &renderPosition, qreal zValue, QStringList *log )
+        : m_name( name ),
+          m_renderPosition( renderPosition ),
+          m_zValue( zValue ),
+          m_log( log )
+    {
+    }
+
+    virtual QStringList renderPosition() const { return m_renderPosition; }
+
+    virtual bool render( GeoPainter *, ViewportParams *, const QString &renderPos, GeoSceneLayer * )
+    {
+        if ( m_log ) {
+            m_log->append( m_name + ' ' + renderPos );
+        }
+        return true;
+    }
+
+    virtual qreal zValue() const { return m_zValue; }
+
+    void setZValue( qreal zValue ) { m_zValue = zValue; }
+
+ private:
+    const QString m_name;
+    const QStringList m_renderPosition;
+    qreal m_zValue;
+    QStringList *const m_log;
+};
+
+class LayerManagerTest : public QObject
+{
+    Q_OBJECT
+
+ public:
+    LayerManagerTest();
+
+ private Q_SLOTS:
+    void initTestCase();
+
+    void renderOrder();
+    void showBackground();
+    void changeZValue();
+    void addAndRemove();
+
+    void benchmarkRenderLayers();
+
+ private:
+    void renderLayers( LayerManager *manager );
+
+    MarbleModel m_model;
+    ViewportParams m_viewport;
+    QImage m_image;
+};
+
+LayerManagerTest::LayerManagerTest()
+    : m_model(),
+      m_viewport(),
+      m_image( 10, 10, QImage::Format_ARGB32_Premultiplied )
+{
+}
+
+void LayerManagerTest::initTestCase()
+{
+    m_viewport.setSize( m_image.size() );
+}
+
+void LayerManagerTest::renderLayers( LayerManager *manager )
+{
+    // only test layers are rendered
+    foreach ( RenderPlugin *plugin, manager->renderPlugins() ) {
+        plugin->setEnabled( false );
+    }
+
+    GeoPainter painter( &m_image, &m_viewport, NormalQuality );
+    manager->renderLayers( &painter, &m_viewport );
+}
+
+void LayerManagerTest::renderOrder()
+{
+    QStringList log;
+    TestLayer top( "top", QStringList() << "SURFACE", 10, &log );
+    TestLayer bottom( "bottom", QStringList() << "SURFACE", -10, &log );
+    TestLayer both( "both", QStringList() << "STARS" << "ALWAYS_ON_TOP", 0, &log );
+    TestLayer none( "none", QStringList() << "NONE", 0, &log );
+
+    LayerManager manager( &m_model );
+    manager.addLayer( &top );
+    manager.addLayer( &both );
+    manager.addLayer( &none );
+    manager.addLayer( &bottom );
+
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "both STARS" << "bottom SURFACE" << "top SURFACE" << "both ALWAYS_ON_TOP" );
+
+    // the same order in the next frame
+    log.clear();
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "both STARS" << "bottom SURFACE" << "top SURFACE" << "both ALWAYS_ON_TOP" );
+}
+
+void LayerManagerTest::showBackground()
+{
+    QStringList log;
+    TestLayer stars( "stars", QStringList() << "STARS", 0, &log );
+    TestLayer surface( "surface", QStringList() << "SURFACE", 0, &log );
+
+    LayerManager manager( &m_model );
+    manager.addLayer( &stars );
+    manager.addLayer( &surface );
+
+    manager.setShowBackground( false );
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "surface SURFACE" );
+
+    log.clear();
+    manager.setShowBackground( true );
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "stars STARS" << "surface SURFACE" );
+}
+
+void LayerManagerTest::changeZValue()
+{
+    QStringList log;
+    TestLayer first( "first", QStringList() << "SURFACE", 1, &log );
+    TestLayer second( "second", QStringList() << "SURFACE", 2, &log );
+
+    LayerManager manager( &m_model );
+    manager.addLayer( &first );
+    manager.addLayer( &second );
+
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "first SURFACE" << "second SURFACE" );
+
+    log.clear();
+    first.setZValue( 3 );
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "second SURFACE" << "first SURFACE" );
+}
+
+void LayerManagerTest::addAndRemove()
+{
+    QStringList log;
+    TestLayer first( "first", QStringList() << "SURFACE", 0, &log );
+    TestLayer second( "second", QStringList() << "ORBIT", 0, &log );
+
+    LayerManager manager( &m_model );
+    manager.addLayer( &first );
+
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "first SURFACE" );
+
+    log.clear();
+    manager.addLayer( &second );
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "first SURFACE" << "second ORBIT" );
+
+    log.clear();
+    manager.removeLayer( &first );
+    renderLayers( &manager );
+    QCOMPARE( log, QStringList() << "second ORBIT" );
+}
+
+void LayerManagerTest::benchmarkRenderLayers()
+{
+    QStringList const renderPositions = QStringList() << "STARS" << "BEHIND_TARGET" << "SURFACE"
+                                                      << "HOVERS_ABOVE_SURFACE" << "ATMOSPHERE" << "ORBIT"
+                                                      << "ALWAYS_ON_TOP" << "FLOAT_ITEM" << "USER_TOOLS";
+
+    LayerManager manager( &m_model );
+    QList<TestLayer *> layers;
+    for ( int i = 0; i < 50; ++i ) {
+        layers << new TestLayer( QString::number( i ), QStringList() << renderPositions.at( i % renderPositions.size() ),
+                                 i % 7, 0 );
+        manager.addLayer( layers.last() );
+    }
+
+    foreach ( RenderPlugin *plugin, manager.renderPlugins() ) {
+        plugin->setEnabled( false );
+    }
+
+    GeoPainter painter( &m_image, &m_viewport, NormalQuality );
+    QBENCHMARK {
+        manager.renderLayers( &painter, &m_viewport );
+    }
+
+    qDeleteAll( layers );
+}
+
+}
+
+QTEST_MAIN( Marble::LayerManagerTest )
+
+#include "LayerManagerTest.moc"
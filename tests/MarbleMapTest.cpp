@@ -65,6 +65,9 @@ class MarbleMapTest : public QObject
     void paint_data();
     void paint();
 
+    void benchmarkPanAtlas_data();
+    void benchmarkPanAtlas();
+
  private:
     MarbleModel m_model;
 };
@@ -593,6 +596,48 @@ void MarbleMapTest::paint()
     QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
 }
 
+void MarbleMapTest::benchmarkPanAtlas_data()
+{
+    QTest::addColumn<int>( "projection" );
+
+    addRow() << (int)Spherical;
+    addRow() << (int)Equirectangular;
+    addRow() << (int)Mercator;
+}
+
+void MarbleMapTest::benchmarkPanAtlas()
+{
+    QFETCH( int, projection );
+
+    MarbleMap map;
+
+    map.setMapThemeId( "earth/srtm/srtm.dgml" );
+    map.setSize( 1920, 1080 );
+    map.setProjection( (Projection)projection );
+    map.setRadius( 1500 );
+    map.setShowRelief( true );
+
+    QImage paintDevice( map.size(), QImage::Format_ARGB32_Premultiplied );
+
+    // colorize the tiles of the initial view
+    {
+        GeoPainter painter( &paintDevice, map.viewport(), map.mapQuality() );
+        map.paint( painter, QRect() );
+    }
+
+    // pan in small steps, which reuses most of the colorized tiles
+    qreal lon = 0.0;
+    QBENCHMARK {
+        lon += 0.5;
+        map.centerOn( lon, 10.0 );
+
+        GeoPainter painter( &paintDevice, map.viewport(), map.mapQuality() );
+        map.paint( painter, QRect() );
+    }
+
+    QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
+}
+
 }
 
 QTEST_MAIN( Marble::MarbleMapTest )
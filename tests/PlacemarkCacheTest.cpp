@@ -0,0 +1,251 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "PlacemarkCache.h"
+
+#include "GeoDataData.h"
+#include "GeoDataDocument.h"
+#include "GeoDataExtendedData.h"
+#include "GeoDataFolder.h"
+#include "GeoDataPlacemark.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QtTest>
+
+namespace Marble
+{
+
+class PlacemarkCacheTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void saveAndLoad();
+    void sharesStrings();
+    void rejectsOtherFiles();
+
+    void benchmarkLoad();
+    void benchmarkLoadStream();
+
+ private:
+    static GeoDataPlacemark *createPlacemark( int i );
+
+    static QString cacheFileName( const QString &name );
+
+    QString m_largeCache;
+    QString m_largeStream;
+};
+
+GeoDataPlacemark *PlacemarkCacheTest::createPlacemark( int i )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    placemark->setName( QString( "Place %1" ).arg( i ) );
+    placemark->setCoordinate( 0.001 * ( i % 3000 ), 0.0005 * ( i % 2000 ), i % 100 );
+    placemark->setRole( i % 2 ? "PPL" : "PPLA" );
+    placemark->setCountryCode( i % 3 ? "DE" : "FR" );
+    placemark->setState( "" );
+    placemark->setArea( 0.5 * i );
+    placemark->setPopulation( 1000 * i );
+    placemark->extendedData().addValue( GeoDataData( "gmt", i % 24 ) );
+    placemark->extendedData().addValue( GeoDataData( "dst", i % 2 ) );
+
+    return placemark;
+}
+
+QString PlacemarkCacheTest::cacheFileName( const QString &name )
+{
+    return QDir::tempPath() + QString( "/marble-%1-%2.cache" )
+            .arg( name ).arg( QCoreApplication::applicationPid() );
+}
+
+void PlacemarkCacheTest::initTestCase()
+{
+    const int count = 500000;
+
+    GeoDataDocument document;
+    for ( int i = 0; i < count; ++i ) {
+        document.append( createPlacemark( i ) );
+    }
+
+    m_largeCache = cacheFileName( "large" );
+    QVERIFY( PlacemarkCache::save( m_largeCache, &document ) );
+
+    // the same placemarks as a stream of fields, like older caches
+    m_largeStream = cacheFileName( "stream" );
+    QFile file( m_largeStream );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    QDataStream out( &file );
+    out.setVersion( QDataStream::Qt_4_2 );
+    foreach ( const GeoDataPlacemark *placemark, document.placemarkList() ) {
+        qreal lon, lat, alt;
+        placemark->coordinate().geoCoordinates( lon, lat, alt );
+        out << placemark->name() << (double)lon << (double)lat << (double)alt;
+        out << placemark->role() << placemark->description() << placemark->countryCode()
+            << placemark->state() << (double)placemark->area() << (qint64)placemark->population();
+        out << (qint16)placemark->extendedData().value( "gmt" ).value().toInt();
+        out << (qint8)placemark->extendedData().value( "dst" ).value().toInt();
+    }
+}
+
+void PlacemarkCacheTest::cleanupTestCase()
+{
+    QFile::remove( m_largeCache );
+    QFile::remove( m_largeStream );
+}
+
+void PlacemarkCacheTest::saveAndLoad()
+{
+    GeoDataDocument document;
+    document.append( createPlacemark( 1 ) );
+
+    GeoDataFolder *folder = new GeoDataFolder;
+    GeoDataPlacemark *placemark = createPlacemark( 2 );
+    placemark->setDescription( QString::fromUtf8( "Kraków" ) );
+    placemark->setStyleUrl( "#city" );
+    folder->append( placemark );
+    document.append( folder );
+
+    const QString fileName = cacheFileName( "saveAndLoad" );
+    QVERIFY( PlacemarkCache::save( fileName, &document ) );
+
+    GeoDataDocument *const loaded = PlacemarkCache::load( fileName );
+    QFile::remove( fileName );
+    QVERIFY( loaded );
+
+    // the placemarks of folders are flattened into the document
+    QCOMPARE( loaded->placemarkList().size(), 2 );
+
+    const GeoDataPlacemark *first = loaded->placemarkList().at( 0 );
+    QCOMPARE( first->name(), QString( "Place 1" ) );
+    QCOMPARE( first->role(), QString( "PPL" ) );
+    QCOMPARE( first->countryCode(), QString( "DE" ) );
+    QCOMPARE( first->area(), qreal( 0.5 ) );
+    QCOMPARE( first->population(), qint64( 1000 ) );
+    QCOMPARE( first->coordinate(), GeoDataCoordinates( 0.001, 0.0005, 1 ) );
+    QCOMPARE( first->extendedData().value( "gmt" ).value().toInt(), 1 );
+    QCOMPARE( first->extendedData().value( "dst" ).value().toInt(), 1 );
+    QVERIFY( first->styleUrl().isEmpty() );
+
+    const GeoDataPlacemark *second = loaded->placemarkList().at( 1 );
+    QCOMPARE( second->name(), QString( "Place 2" ) );
+    QCOMPARE( second->role(), QString( "PPLA" ) );
+    QCOMPARE( second->description(), QString::fromUtf8( "Kraków" ) );
+    QCOMPARE( second->styleUrl(), QString( "#city" ) );
+    QCOMPARE( second->extendedData().value( "gmt" ).value().toInt(), 2 );
+    QCOMPARE( second->extendedData().value( "dst" ).value().toInt(), 0 );
+
+    delete loaded;
+}
+
+void PlacemarkCacheTest::sharesStrings()
+{
+    GeoDataDocument document;
+    for ( int i = 0; i < 10; ++i ) {
+        document.append( createPlacemark( i ) );
+    }
+
+    const QString fileName = cacheFileName( "sharesStrings" );
+    QVERIFY( PlacemarkCache::save( fileName, &document ) );
+
+    // ten names, two roles, two country codes and the empty string
+    QFile file( fileName );
+    QVERIFY( file.open( QIODevice::ReadOnly ) );
+    QDataStream in( &file );
+    quint32 magic;
+    qint32 version;
+    quint32 count;
+    quint32 stringCount;
+    in >> magic >> version;
+    in.setByteOrder( QDataStream::LittleEndian );
+    in >> count >> stringCount;
+    QCOMPARE( count, quint32( 10 ) );
+    QCOMPARE( stringCount, quint32( 15 ) );
+    file.close();
+
+    QFile::remove( fileName );
+}
+
+void PlacemarkCacheTest::rejectsOtherFiles()
+{
+    QCOMPARE( PlacemarkCache::load( m_largeStream ), (GeoDataDocument *)0 );
+    QCOMPARE( PlacemarkCache::load( cacheFileName( "doesNotExist" ) ), (GeoDataDocument *)0 );
+
+    // a truncated cache
+    const QString fileName = cacheFileName( "truncated" );
+    QFile::remove( fileName );
+    QVERIFY( QFile::copy( m_largeCache, fileName ) );
+    QFile file( fileName );
+    QVERIFY( file.resize( file.size() / 2 ) );
+    QCOMPARE( PlacemarkCache::load( fileName ), (GeoDataDocument *)0 );
+    QFile::remove( fileName );
+}
+
+void PlacemarkCacheTest::benchmarkLoad()
+{
+    QBENCHMARK {
+        GeoDataDocument *document = PlacemarkCache::load( m_largeCache );
+        QVERIFY( document );
+        QCOMPARE( document->size(), 500000 );
+        delete document;
+    }
+}
+
+void PlacemarkCacheTest::benchmarkLoadStream()
+{
+    QBENCHMARK {
+        QFile file( m_largeStream );
+        QVERIFY( file.open( QIODevice::ReadOnly ) );
+        QDataStream in( &file );
+        in.setVersion( QDataStream::Qt_4_2 );
+
+        GeoDataDocument *document = new GeoDataDocument;
+        double lon, lat, alt, area;
+        QString tmpstr;
+        qint64 tmpint64;
+        qint16 tmpint16;
+        qint8 tmpint8;
+        while ( !in.atEnd() ) {
+            GeoDataPlacemark *mark = new GeoDataPlacemark;
+            in >> tmpstr;
+            mark->setName( tmpstr );
+            in >> lon >> lat >> alt;
+            mark->setCoordinate( lon, lat, alt );
+            in >> tmpstr;
+            mark->setRole( tmpstr );
+            in >> tmpstr;
+            mark->setDescription( tmpstr );
+            in >> tmpstr;
+            mark->setCountryCode( tmpstr );
+            in >> tmpstr;
+            mark->setState( tmpstr );
+            in >> area;
+            mark->setArea( area );
+            in >> tmpint64;
+            mark->setPopulation( tmpint64 );
+            in >> tmpint16;
+            mark->extendedData().addValue( GeoDataData( "gmt", int( tmpint16 ) ) );
+            in >> tmpint8;
+            mark->extendedData().addValue( GeoDataData( "dst", int( tmpint8 ) ) );
+            document->append( mark );
+        }
+
+        QCOMPARE( document->size(), 500000 );
+        delete document;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::PlacemarkCacheTest )
+
+#include "PlacemarkCacheTest.moc"
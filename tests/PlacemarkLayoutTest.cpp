@@ -0,0 +1,181 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "PlacemarkLayout.h"
+
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "MarbleClock.h"
+#include "MarbleGlobal.h"
+#include "MarblePlacemarkModel.h"
+#include "ViewportParams.h"
+
+#include <QAbstractListModel>
+#include <QFontMetrics>
+#include <QItemSelectionModel>
+#include <QtTest>
+
+namespace Marble
+{
+
+class PlacemarkListModel : public QAbstractListModel
+{
+ public:
+    ~PlacemarkListModel()
+    {
+        qDeleteAll( m_placemarks );
+    }
+
+    virtual int rowCount( const QModelIndex &parent = QModelIndex() ) const
+    {
+        return parent.isValid() ? 0 : m_placemarks.size();
+    }
+
+    virtual QVariant data( const QModelIndex &index, int role ) const
+    {
+        if ( !index.isValid() || index.row() >= m_placemarks.size() ) {
+            return QVariant();
+        }
+
+        if ( role == MarblePlacemarkModel::ObjectPointerRole ) {
+            return qVariantFromValue( static_cast<GeoDataObject *>( m_placemarks.at( index.row() ) ) );
+        }
+        else if ( role == MarblePlacemarkModel::PopularityIndexRole ) {
+            return m_placemarks.at( index.row() )->zoomLevel();
+        }
+
+        return QVariant();
+    }
+
+    void append( const QVector<GeoDataPlacemark *> &placemarks )
+    {
+        beginInsertRows( QModelIndex(), m_placemarks.size(), m_placemarks.size() + placemarks.size() - 1 );
+        m_placemarks += placemarks;
+        endInsertRows();
+    }
+
+    void removeLast( int count )
+    {
+        beginRemoveRows( QModelIndex(), m_placemarks.size() - count, m_placemarks.size() - 1 );
+        for ( int i = 0; i < count; ++i ) {
+            delete m_placemarks.last();
+            m_placemarks.pop_back();
+        }
+        endRemoveRows();
+    }
+
+ private:
+    QVector<GeoDataPlacemark *> m_placemarks;
+};
+
+class PlacemarkLayoutTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void insertAndRemove();
+
+    void benchmarkStyleReset();
+
+ private:
+    /// @p count cities spread around lon 0, lat 0
+    static QVector<GeoDataPlacemark *> cities( int count );
+};
+
+QVector<GeoDataPlacemark *> PlacemarkLayoutTest::cities( int count )
+{
+    QVector<GeoDataPlacemark *> placemarks;
+    for ( int i = 0; i < count; ++i ) {
+        GeoDataPlacemark *placemark = new GeoDataPlacemark( QString( "City %1" ).arg( i ) );
+        placemark->setCoordinate( -40.0 + 0.37 * ( i % 217 ), -30.0 + 0.29 * ( ( i / 217 ) % 207 ), 0, GeoDataCoordinates::Degree );
+        placemark->setVisualCategory( GeoDataFeature::LargeCity );
+        placemark->setZoomLevel( 1 + i % 4 );
+        placemarks << placemark;
+    }
+
+    return placemarks;
+}
+
+void PlacemarkLayoutTest::insertAndRemove()
+{
+    PlacemarkListModel model;
+    QItemSelectionModel selectionModel( &model );
+    MarbleClock clock;
+    PlacemarkLayout layout( &model, &selectionModel, &clock );
+    layout.setShowCities( true );
+
+    ViewportParams viewport( Spherical, 0, 0, 1000, QSize( 800, 600 ) );
+    QVERIFY( layout.generateLayout( &viewport ).isEmpty() );
+
+    // the label heights of inserted placemarks are counted
+    model.append( cities( 200 ) );
+    QVERIFY( !layout.generateLayout( &viewport ).isEmpty() );
+    const int cityHeight = layout.maxLabelHeight();
+    QVERIFY( cityHeight > 0 );
+
+    // a larger label font makes the rows of the layout higher until the placemark is removed
+    QVector<GeoDataPlacemark *> capital = cities( 1 );
+    GeoDataStyle capitalStyle( *capital.first()->style() );
+    QFont capitalFont = capitalStyle.labelStyle().font();
+    capitalFont.setPointSize( 30 );
+    capitalStyle.labelStyle().setFont( capitalFont );
+    capital.first()->setStyle( &capitalStyle );
+    const int capitalHeight = QFontMetrics( capitalFont ).height();
+    QVERIFY( capitalHeight > cityHeight );
+
+    model.append( capital );
+    QVERIFY( !layout.generateLayout( &viewport ).isEmpty() );
+    QCOMPARE( layout.maxLabelHeight(), capitalHeight );
+
+    model.removeLast( 1 );
+    QVERIFY( !layout.generateLayout( &viewport ).isEmpty() );
+    QCOMPARE( layout.maxLabelHeight(), cityHeight );
+
+    // the heights are counted anew if the label font changed before the placemark is removed
+    capital = cities( 1 );
+    capital.first()->setStyle( &capitalStyle );
+    model.append( capital );
+    QVERIFY( !layout.generateLayout( &viewport ).isEmpty() );
+    QCOMPARE( layout.maxLabelHeight(), capitalHeight );
+
+    capitalFont.setPointSize( 20 );
+    capitalStyle.labelStyle().setFont( capitalFont );
+    QVERIFY( QFontMetrics( capitalFont ).height() != capitalHeight );
+    QVERIFY( QFontMetrics( capitalFont ).height() != cityHeight );
+    model.removeLast( 1 );
+    QVERIFY( !layout.generateLayout( &viewport ).isEmpty() );
+    QCOMPARE( layout.maxLabelHeight(), cityHeight );
+
+    model.removeLast( 150 );
+    QVERIFY( !layout.generateLayout( &viewport ).isEmpty() );
+
+    model.removeLast( 50 );
+    QVERIFY( layout.generateLayout( &viewport ).isEmpty() );
+    QVERIFY( layout.whichPlacemarkAt( QPoint( 400, 300 ) ).isEmpty() );
+}
+
+void PlacemarkLayoutTest::benchmarkStyleReset()
+{
+    PlacemarkListModel model;
+    QItemSelectionModel selectionModel( &model );
+    MarbleClock clock;
+    PlacemarkLayout layout( &model, &selectionModel, &clock );
+    model.append( cities( 500000 ) );
+
+    // a style reset happens on every change of the selection or the map theme
+    QBENCHMARK {
+        layout.requestStyleReset();
+        layout.whichPlacemarkAt( QPoint( 0, 0 ) );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::PlacemarkLayoutTest )
+
+#include "PlacemarkLayoutTest.moc"
@@ -0,0 +1,206 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest>
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+#include "PlacemarkSearchIndex.h"
+
+namespace Marble
+{
+
+class PlacemarkSearchIndexTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void addAndRemove();
+    void caseInsensitive();
+    void preferredBox();
+    void rename();
+    void benchmarkSearch();
+    void benchmarkAddDocuments();
+
+ private:
+    static GeoDataPlacemark *placemark( const QString &name, qreal lon = 0.0, qreal lat = 0.0 );
+    static QStringList names( const QVector<GeoDataPlacemark*> &placemarks );
+};
+
+GeoDataPlacemark *PlacemarkSearchIndexTest::placemark( const QString &name, qreal lon, qreal lat )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark( name );
+    placemark->setCoordinate( lon, lat, 0.0, GeoDataCoordinates::Degree );
+    return placemark;
+}
+
+QStringList PlacemarkSearchIndexTest::names( const QVector<GeoDataPlacemark*> &placemarks )
+{
+    QStringList result;
+    foreach ( const GeoDataPlacemark *placemark, placemarks ) {
+        result << placemark->name();
+    }
+    qDeleteAll( placemarks );
+    return result;
+}
+
+void PlacemarkSearchIndexTest::addAndRemove()
+{
+    GeoDataTreeModel model;
+    PlacemarkSearchIndex index( &model );
+
+    QCOMPARE( index.size(), 0 );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    GeoDataFolder *folder = new GeoDataFolder;
+    folder->append( placemark( "Berlin" ) );
+    folder->append( placemark( "Bern" ) );
+    document->append( folder );
+    document->append( placemark( "Paris" ) );
+
+    model.addDocument( document );
+    QCOMPARE( index.size(), 3 );
+    QCOMPARE( names( index.search( "Ber", GeoDataLatLonAltBox() ) ), QStringList() << "Berlin" << "Bern" );
+    QCOMPARE( names( index.search( "Berl", GeoDataLatLonAltBox() ) ), QStringList() << "Berlin" );
+    QCOMPARE( names( index.search( "Rome", GeoDataLatLonAltBox() ) ), QStringList() );
+
+    GeoDataPlacemark *rome = placemark( "Rome" );
+    model.addFeature( folder, rome );
+    QCOMPARE( index.size(), 4 );
+    QCOMPARE( names( index.search( "Rome", GeoDataLatLonAltBox() ) ), QStringList() << "Rome" );
+
+    model.removeFeature( folder );
+    QCOMPARE( index.size(), 1 );
+    QCOMPARE( names( index.search( "Ber", GeoDataLatLonAltBox() ) ), QStringList() );
+    delete folder;
+
+    model.removeDocument( document );
+    QCOMPARE( index.size(), 0 );
+    delete document;
+}
+
+void PlacemarkSearchIndexTest::caseInsensitive()
+{
+    GeoDataTreeModel model;
+    PlacemarkSearchIndex index( &model );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    document->append( placemark( QString::fromUtf8( "München" ) ) );
+    document->append( placemark( "MANNHEIM" ) );
+    model.addDocument( document );
+
+    QCOMPARE( names( index.search( "m", GeoDataLatLonAltBox() ) ).size(), 2 );
+    QCOMPARE( names( index.search( QString::fromUtf8( "MÜN" ), GeoDataLatLonAltBox() ) ), QStringList() << QString::fromUtf8( "München" ) );
+    QCOMPARE( names( index.search( "mannheim", GeoDataLatLonAltBox() ) ), QStringList() << "MANNHEIM" );
+
+    model.removeDocument( document );
+    delete document;
+}
+
+void PlacemarkSearchIndexTest::preferredBox()
+{
+    GeoDataTreeModel model;
+    PlacemarkSearchIndex index( &model );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    document->append( placemark( "Springfield A", 9.0, 9.0 ) );
+    document->append( placemark( "Springfield B", 1.0, 1.0 ) );
+    document->append( placemark( "Springfield C", 50.0, 50.0 ) );
+    document->append( placemark( "Springfield D", -5.0, 5.0 ) );
+    model.addDocument( document );
+
+    const GeoDataLatLonAltBox box( GeoDataLatLonBox( 10.0, -10.0, 10.0, -10.0, GeoDataCoordinates::Degree ), 0.0, 0.0 );
+    QCOMPARE( names( index.search( "spring", box ) ), QStringList() << "Springfield B" << "Springfield D" << "Springfield A" );
+
+    model.removeDocument( document );
+    delete document;
+}
+
+void PlacemarkSearchIndexTest::rename()
+{
+    GeoDataTreeModel model;
+    PlacemarkSearchIndex index( &model );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    GeoDataPlacemark *berlin = placemark( "Berlin" );
+    document->append( berlin );
+    document->append( placemark( "Paris" ) );
+    model.addDocument( document );
+    QCOMPARE( names( index.search( "Ber", GeoDataLatLonAltBox() ) ), QStringList() << "Berlin" );
+
+    // a placemark renamed in place is re-indexed on dataChanged()
+    berlin->setName( "Potsdam" );
+    const QModelIndex berlinIndex = model.index( berlin );
+    QVERIFY( QMetaObject::invokeMethod( &model, "dataChanged", Q_ARG( QModelIndex, berlinIndex ), Q_ARG( QModelIndex, berlinIndex ) ) );
+    QCOMPARE( index.size(), 2 );
+    QCOMPARE( names( index.search( "Ber", GeoDataLatLonAltBox() ) ), QStringList() );
+    QCOMPARE( names( index.search( "Pots", GeoDataLatLonAltBox() ) ), QStringList() << "Potsdam" );
+
+    // and so is one renamed through the model
+    QVERIFY( model.setData( model.index( berlin ), "Brandenburg", Qt::EditRole ) );
+    QCOMPARE( index.size(), 2 );
+    QCOMPARE( names( index.search( "Pots", GeoDataLatLonAltBox() ) ), QStringList() );
+    QCOMPARE( names( index.search( "Bran", GeoDataLatLonAltBox() ) ), QStringList() << "Brandenburg" );
+
+    model.removeDocument( document );
+    QCOMPARE( index.size(), 0 );
+    delete document;
+}
+
+void PlacemarkSearchIndexTest::benchmarkSearch()
+{
+    GeoDataTreeModel model;
+    PlacemarkSearchIndex index( &model );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    for ( int i = 0; i < 200000; ++i ) {
+        document->append( placemark( QString( "Place %1" ).arg( i ) ) );
+    }
+    model.addDocument( document );
+    QCOMPARE( index.size(), 200000 );
+
+    QVector<GeoDataPlacemark*> result;
+    QBENCHMARK {
+        qDeleteAll( result );
+        result = index.search( "place 19999", GeoDataLatLonAltBox() );
+    }
+    QCOMPARE( result.size(), 11 );
+    qDeleteAll( result );
+
+    model.removeDocument( document );
+    delete document;
+}
+
+}
+
+void PlacemarkSearchIndexTest::benchmarkAddDocuments()
+{
+    // many small documents, like the results of several runners
+    QBENCHMARK {
+        GeoDataTreeModel model;
+        PlacemarkSearchIndex index( &model );
+
+        // the documents are deleted along with the model
+        for ( int i = 0; i < 1000; ++i ) {
+            GeoDataDocument *document = new GeoDataDocument;
+            for ( int j = 0; j < 100; ++j ) {
+                document->append( placemark( QString( "Place %1 %2" ).arg( i ).arg( j ) ) );
+            }
+            model.addDocument( document );
+        }
+
+        QCOMPARE( names( index.search( "place 999 9", GeoDataLatLonAltBox() ) ).size(), 11 );
+    }
+}
+
+QTEST_MAIN( Marble::PlacemarkSearchIndexTest )
+
+#include "PlacemarkSearchIndexTest.moc"
@@ -0,0 +1,179 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataLinearRing.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPolygon.h"
+#include "MarbleDirs.h"
+#include "ParsingRunnerManager.h"
+#include "PluginManager.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QtTest>
+
+namespace Marble
+{
+
+class Pn2RunnerTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void parseGeometries();
+    void rejectInvalidCoordinates();
+
+    void benchmarkParse();
+
+ private:
+    static QString pn2FileName( const QString &name );
+
+    /// Writes a polygon header and one absolute node followed by @p relative nodes
+    static void writePolygon( QDataStream &out, quint32 id, quint8 flag, qint16 lat, qint16 lon, int relative );
+
+    PluginManager m_pluginManager;
+    QString m_largeFile;
+};
+
+QString Pn2RunnerTest::pn2FileName( const QString &name )
+{
+    return QDir::tempPath() + QString( "/marble-%1-%2.pn2" )
+            .arg( name ).arg( QCoreApplication::applicationPid() );
+}
+
+void Pn2RunnerTest::writePolygon( QDataStream &out, quint32 id, quint8 flag, qint16 lat, qint16 lon, int relative )
+{
+    out << id << quint32( 1 ) << flag;
+    out << lat << lon << qint16( relative );
+    for ( int i = 0; i < relative; ++i ) {
+        out << qint8( i % 60 ) << qint8( -( i % 50 ) );
+    }
+}
+
+void Pn2RunnerTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    // coast lines and borders with about two million nodes, like the
+    // data of the vector themes at a higher resolution
+    const int polygonCount = 2000;
+    const int absoluteNodes = 50;
+    const int relativeNodes = 20;
+
+    m_largeFile = pn2FileName( "large" );
+    QFile file( m_largeFile );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    QDataStream out( &file );
+    out << quint8( 1 ) << quint32( polygonCount );
+    for ( int i = 0; i < polygonCount; ++i ) {
+        const quint8 flag = i % 2 ? 1 : 0;
+        out << quint32( i ) << quint32( absoluteNodes ) << flag;
+        for ( int j = 0; j < absoluteNodes; ++j ) {
+            out << qint16( ( i * 7 + j ) % 20000 - 10000 ) << qint16( ( i * 13 + j * 3 ) % 40000 - 20000 );
+            out << qint16( relativeNodes );
+            for ( int k = 0; k < relativeNodes; ++k ) {
+                out << qint8( k ) << qint8( -k );
+            }
+        }
+    }
+}
+
+void Pn2RunnerTest::cleanupTestCase()
+{
+    QFile::remove( m_largeFile );
+}
+
+void Pn2RunnerTest::parseGeometries()
+{
+    const QString fileName = pn2FileName( "geometries" );
+    QFile file( fileName );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    QDataStream out( &file );
+    out << quint8( 1 ) << quint32( 4 );
+
+    // a line string with two absolute nodes
+    out << quint32( 1 ) << quint32( 2 ) << quint8( 0 );
+    out << qint16( 120 ) << qint16( 240 ) << qint16( 2 );
+    out << qint8( 1 ) << qint8( 1 ) << qint8( -1 ) << qint8( 2 );
+    out << qint16( -120 ) << qint16( -240 ) << qint16( 0 );
+
+    // a polygon with a hole, and a linear ring
+    writePolygon( out, 2, 2, 600, 600, 3 );
+    writePolygon( out, 3, 3, 610, 610, 2 );
+    writePolygon( out, 4, 1, -600, 1200, 2 );
+    file.close();
+
+    ParsingRunnerManager manager( &m_pluginManager );
+    GeoDataDocument *document = manager.openFile( fileName );
+    QFile::remove( fileName );
+    QVERIFY( document );
+    QCOMPARE( document->placemarkList().size(), 3 );
+
+    const GeoDataLineString *lineString = dynamic_cast<const GeoDataLineString *>( document->placemarkList().at( 0 )->geometry() );
+    QVERIFY( lineString );
+    QCOMPARE( lineString->size(), 4 );
+    QCOMPARE( lineString->at( 0 ).longitude( GeoDataCoordinates::Degree ), 2.0 );
+    QCOMPARE( lineString->at( 0 ).latitude( GeoDataCoordinates::Degree ), 1.0 );
+    QCOMPARE( lineString->at( 2 ).longitude( GeoDataCoordinates::Degree ), 242.0 / 120 );
+    QCOMPARE( lineString->at( 2 ).latitude( GeoDataCoordinates::Degree ), 119.0 / 120 );
+    QCOMPARE( lineString->at( 3 ).longitude( GeoDataCoordinates::Degree ), -2.0 );
+
+    const GeoDataPolygon *polygon = dynamic_cast<const GeoDataPolygon *>( document->placemarkList().at( 1 )->geometry() );
+    QVERIFY( polygon );
+    QCOMPARE( polygon->outerBoundary().size(), 4 );
+    QCOMPARE( polygon->innerBoundaries().size(), 1 );
+    QCOMPARE( polygon->innerBoundaries().first().size(), 3 );
+
+    const GeoDataLinearRing *ring = dynamic_cast<const GeoDataLinearRing *>( document->placemarkList().at( 2 )->geometry() );
+    QVERIFY( ring );
+    QCOMPARE( ring->size(), 3 );
+    QCOMPARE( ring->at( 0 ).latitude( GeoDataCoordinates::Degree ), -5.0 );
+
+    delete document;
+}
+
+void Pn2RunnerTest::rejectInvalidCoordinates()
+{
+    const QString fileName = pn2FileName( "invalid" );
+    QFile file( fileName );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    QDataStream out( &file );
+    out << quint8( 1 ) << quint32( 2 );
+    writePolygon( out, 1, 0, 0, 0, 2 );
+    writePolygon( out, 2, 0, 10900, 0, 2 );
+    file.close();
+
+    ParsingRunnerManager manager( &m_pluginManager );
+    GeoDataDocument *document = manager.openFile( fileName );
+    QFile::remove( fileName );
+    QVERIFY( !document );
+}
+
+void Pn2RunnerTest::benchmarkParse()
+{
+    ParsingRunnerManager manager( &m_pluginManager );
+
+    QBENCHMARK {
+        GeoDataDocument *document = manager.openFile( m_largeFile );
+        QVERIFY( document );
+        QCOMPARE( document->placemarkList().size(), 2000 );
+        delete document;
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::Pn2RunnerTest )
+
+#include "Pn2RunnerTest.moc"
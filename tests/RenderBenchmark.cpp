@@ -0,0 +1,518 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+// Measures how long MarbleMap takes to paint a frame into an offscreen
+// image in scripted scenarios. Only installed map data is used, the
+// model works offline.
+//
+// The usual QtTest options give stable and machine readable numbers for
+// comparing builds, e.g.
+//
+//   RenderBenchmark -median 5 -xml > before.xml
+//
+// If MARBLE_BENCHMARK_PROFILE is set to a directory, the time spent in each
+// layer is written there as a Chrome trace for every scenario.
+
+#include "GeoDataDocument.h"
+#include "GeoDataLatLonAltBox.h"
+#include "GeoDataTreeModel.h"
+#include "GeoPainter.h"
+#include "GeoSceneVectorTile.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+#include "RenderProfiler.h"
+#include "TestUtils.h"
+#include "TileLoader.h"
+#include "VectorTileModel.h"
+#include "ViewportParams.h"
+
+#include <QDir>
+#include <QImage>
+#include <QThreadPool>
+#include <qmath.h>
+#include <QtTest>
+
+namespace Marble
+{
+
+class RenderBenchmark : public QObject
+{
+    Q_OBJECT
+
+ public:
+    RenderBenchmark();
+
+ private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void benchmarkPan_data();
+    void benchmarkPan();
+
+    void benchmarkZoom_data();
+    void benchmarkZoom();
+
+    void benchmarkRotate_data();
+    void benchmarkRotate();
+
+    void benchmarkQuality_data();
+    void benchmarkQuality();
+
+    void benchmarkKmlOverlay_data();
+    void benchmarkKmlOverlay();
+
+    void benchmarkPlacemarks_data();
+    void benchmarkPlacemarks();
+
+    void benchmarkGraticule_data();
+    void benchmarkGraticule();
+
+    void benchmarkVectorTileZoom_data();
+    void benchmarkVectorTileZoom();
+
+ private:
+    static void addScenarioColumns();
+    static void addScenarioRows();
+
+    /** Paints frames until the tiles of the view are loaded */
+    static void warmUp( MarbleMap *map, QImage *image );
+
+    static void paintFrame( MarbleMap *map, QImage *image );
+
+    static QString kmlOverlay();
+    static QString kmlPlacemarks();
+
+    MarbleModel m_model;
+    QString m_profileDirectory;
+};
+
+RenderBenchmark::RenderBenchmark()
+    : m_model(),
+      m_profileDirectory( qgetenv( "MARBLE_BENCHMARK_PROFILE" ) )
+{
+}
+
+void RenderBenchmark::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    m_model.setWorkOffline( true );
+}
+
+void RenderBenchmark::init()
+{
+    RenderProfiler::setEnabled( !m_profileDirectory.isEmpty() );
+}
+
+void RenderBenchmark::cleanup()
+{
+    QThreadPool::globalInstance()->waitForDone();  // wait for all runners to terminate
+
+    if ( !RenderProfiler::isEnabled() ) {
+        return;
+    }
+
+    QString name = QString( "%1-%2.json" ).arg( QTest::currentTestFunction() ).arg( QTest::currentDataTag() );
+    name.replace( QRegExp( "[^A-Za-z0-9.-]" ), "_" );
+    RenderProfiler::exportChromeTrace( QDir( m_profileDirectory ).filePath( name ) );
+    RenderProfiler::setEnabled( false );
+}
+
+void RenderBenchmark::addScenarioColumns()
+{
+    QTest::addColumn<QString>( "mapThemeId" );
+    QTest::addColumn<int>( "projection" );
+}
+
+void RenderBenchmark::addScenarioRows()
+{
+    QStringList const mapThemeIds = QStringList() << "earth/plain/plain.dgml" << "earth/srtm/srtm.dgml";
+    foreach ( const QString &mapThemeId, mapThemeIds ) {
+        QString const theme = mapThemeId.section( '/', 1, 1 );
+        QTest::newRow( qPrintable( theme + " spherical" ) ) << mapThemeId << (int)Spherical;
+        QTest::newRow( qPrintable( theme + " equirectangular" ) ) << mapThemeId << (int)Equirectangular;
+        QTest::newRow( qPrintable( theme + " mercator" ) ) << mapThemeId << (int)Mercator;
+    }
+}
+
+void RenderBenchmark::warmUp( MarbleMap *map, QImage *image )
+{
+    for ( int i = 0; i < 3; ++i ) {
+        paintFrame( map, image );
+        QThreadPool::globalInstance()->waitForDone();
+        QCoreApplication::processEvents();
+    }
+}
+
+void RenderBenchmark::paintFrame( MarbleMap *map, QImage *image )
+{
+    GeoPainter painter( image, map->viewport(), map->mapQuality() );
+    map->paint( painter, QRect() );
+}
+
+void RenderBenchmark::benchmarkPan_data()
+{
+    addScenarioColumns();
+    addScenarioRows();
+}
+
+void RenderBenchmark::benchmarkPan()
+{
+    QFETCH( QString, mapThemeId );
+    QFETCH( int, projection );
+
+    MarbleMap map( &m_model );
+    map.setMapThemeId( mapThemeId );
+    map.setSize( 1280, 720 );
+    map.setProjection( (Projection)projection );
+    map.setRadius( 1000 );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    warmUp( &map, &image );
+
+    qreal lon = 0.0;
+    QBENCHMARK {
+        lon += 1.0;
+        map.centerOn( lon, 20.0 );
+        paintFrame( &map, &image );
+    }
+}
+
+void RenderBenchmark::benchmarkZoom_data()
+{
+    addScenarioColumns();
+    addScenarioRows();
+}
+
+void RenderBenchmark::benchmarkZoom()
+{
+    QFETCH( QString, mapThemeId );
+    QFETCH( int, projection );
+
+    MarbleMap map( &m_model );
+    map.setMapThemeId( mapThemeId );
+    map.setSize( 1280, 720 );
+    map.setProjection( (Projection)projection );
+    map.centerOn( 10.0, 50.0 );
+
+    // zoom in and out again
+    QVector<int> radii;
+    for ( qreal radius = 250; radius < 4000; radius *= 1.25 ) {
+        radii << qRound( radius );
+    }
+    for ( int i = radii.size() - 2; i > 0; --i ) {
+        radii << radii[i];
+    }
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    foreach ( int radius, radii ) {
+        map.setRadius( radius );
+        warmUp( &map, &image );
+    }
+
+    int step = 0;
+    QBENCHMARK {
+        map.setRadius( radii[step] );
+        step = ( step + 1 ) % radii.size();
+        paintFrame( &map, &image );
+    }
+}
+
+void RenderBenchmark::benchmarkRotate_data()
+{
+    addScenarioColumns();
+    addScenarioRows();
+}
+
+void RenderBenchmark::benchmarkRotate()
+{
+    QFETCH( QString, mapThemeId );
+    QFETCH( int, projection );
+
+    MarbleMap map( &m_model );
+    map.setMapThemeId( mapThemeId );
+    map.setSize( 1280, 720 );
+    map.setProjection( (Projection)projection );
+    map.setRadius( 400 );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    warmUp( &map, &image );
+
+    QBENCHMARK {
+        map.rotateBy( 3.0, 1.0 );
+        paintFrame( &map, &image );
+    }
+}
+
+void RenderBenchmark::benchmarkQuality_data()
+{
+    QTest::addColumn<int>( "quality" );
+
+    QTest::newRow( "outline" ) << (int)OutlineQuality;
+    QTest::newRow( "low" ) << (int)LowQuality;
+    QTest::newRow( "normal" ) << (int)NormalQuality;
+    QTest::newRow( "high" ) << (int)HighQuality;
+    QTest::newRow( "print" ) << (int)PrintQuality;
+}
+
+void RenderBenchmark::benchmarkQuality()
+{
+    QFETCH( int, quality );
+
+    MarbleMap map( &m_model );
+    map.setMapThemeId( "earth/srtm/srtm.dgml" );
+    map.setSize( 1280, 720 );
+    map.setMapQualityForViewContext( (MapQuality)quality, Still );
+    map.setRadius( 1000 );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    warmUp( &map, &image );
+
+    qreal lon = 0.0;
+    QBENCHMARK {
+        lon += 1.0;
+        map.centerOn( lon, 20.0 );
+        paintFrame( &map, &image );
+    }
+}
+
+QString RenderBenchmark::kmlOverlay()
+{
+    // 500 polygons with 200 points each and 500 long line strings
+    QString kml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>"
+                  "<Style id=\"area\"><LineStyle><color>ff0000ff</color><width>2</width></LineStyle>"
+                  "<PolyStyle><color>7f00ff00</color></PolyStyle></Style>"
+                  "<Style id=\"line\"><LineStyle><color>ffff0000</color><width>3</width></LineStyle></Style>";
+
+    for ( int i = 0; i < 500; ++i ) {
+        qreal const centerLon = -180.0 + ( i % 25 ) * 14.4 + 7.2;
+        qreal const centerLat = -70.0 + ( i / 25 ) * 7.0 + 3.5;
+
+        QStringList coordinates;
+        for ( int j = 0; j <= 200; ++j ) {
+            qreal const angle = 2 * M_PI * j / 200;
+            qreal const radius = ( j % 2 ) ? 2.5 : 3.0;
+            coordinates << QString( "%1,%2" ).arg( centerLon + radius * cos( angle ) ).arg( centerLat + radius * sin( angle ) );
+        }
+        kml += QString( "<Placemark><styleUrl>#area</styleUrl><Polygon><outerBoundaryIs><LinearRing>"
+                        "<coordinates>%1</coordinates></LinearRing></outerBoundaryIs></Polygon></Placemark>" )
+               .arg( coordinates.join( " " ) );
+
+        coordinates.clear();
+        for ( int j = 0; j < 200; ++j ) {
+            coordinates << QString( "%1,%2" ).arg( -180.0 + j * 1.8 ).arg( centerLat + 2.0 * sin( j * 0.3 + i ) );
+        }
+        kml += QString( "<Placemark><styleUrl>#line</styleUrl><LineString>"
+                        "<coordinates>%1</coordinates></LineString></Placemark>" )
+               .arg( coordinates.join( " " ) );
+    }
+
+    kml += "</Document></kml>";
+    return kml;
+}
+
+void RenderBenchmark::benchmarkKmlOverlay_data()
+{
+    QTest::addColumn<int>( "projection" );
+
+    QTest::newRow( "spherical" ) << (int)Spherical;
+    QTest::newRow( "equirectangular" ) << (int)Equirectangular;
+    QTest::newRow( "mercator" ) << (int)Mercator;
+}
+
+void RenderBenchmark::benchmarkKmlOverlay()
+{
+    QFETCH( int, projection );
+
+    GeoDataDocument *const document = parseKml( kmlOverlay() );
+    m_model.treeModel()->addDocument( document );
+
+    MarbleMap map( &m_model );
+    map.setMapThemeId( "earth/plain/plain.dgml" );
+    map.setSize( 1280, 720 );
+    map.setProjection( (Projection)projection );
+    map.setRadius( 600 );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    warmUp( &map, &image );
+
+    qreal lon = 0.0;
+    QBENCHMARK {
+        lon += 1.0;
+        map.centerOn( lon, 20.0 );
+        paintFrame( &map, &image );
+    }
+
+    m_model.treeModel()->removeDocument( document );
+    delete document;
+}
+
+QString RenderBenchmark::kmlPlacemarks()
+{
+    // evenly spread, so that the result does not depend on random numbers
+    QString kml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>";
+
+    for ( int i = 0; i < 20000; ++i ) {
+        qreal const lon = -180.0 + ( i % 200 ) * 1.8 + ( i / 200 ) * 0.01;
+        qreal const lat = -80.0 + ( i / 200 ) * 1.6;
+        kml += QString( "<Placemark><name>Place %1</name><Point><coordinates>%2,%3</coordinates></Point></Placemark>" )
+               .arg( i ).arg( lon ).arg( lat );
+    }
+
+    kml += "</Document></kml>";
+    return kml;
+}
+
+void RenderBenchmark::benchmarkPlacemarks_data()
+{
+    QTest::addColumn<int>( "radius" );
+
+    QTest::newRow( "globe" ) << 300;
+    QTest::newRow( "continent" ) << 1500;
+    QTest::newRow( "country" ) << 6000;
+}
+
+void RenderBenchmark::benchmarkPlacemarks()
+{
+    QFETCH( int, radius );
+
+    GeoDataDocument *const document = parseKml( kmlPlacemarks() );
+    m_model.treeModel()->addDocument( document );
+
+    MarbleMap map( &m_model );
+    map.setMapThemeId( "earth/plain/plain.dgml" );
+    map.setSize( 1280, 720 );
+    map.setRadius( radius );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    warmUp( &map, &image );
+
+    qreal lon = 0.0;
+    QBENCHMARK {
+        lon += 0.5;
+        map.centerOn( lon, 20.0 );
+        paintFrame( &map, &image );
+    }
+
+    m_model.treeModel()->removeDocument( document );
+    delete document;
+}
+
+void RenderBenchmark::benchmarkGraticule_data()
+{
+    QTest::addColumn<int>( "projection" );
+    QTest::addColumn<bool>( "showGrid" );
+    QTest::addColumn<bool>( "pan" );
+
+    // the difference to the rows without grid is the cost of the graticule
+    QTest::newRow( "spherical" ) << (int)Spherical << true << true;
+    QTest::newRow( "spherical without grid" ) << (int)Spherical << false << true;
+    QTest::newRow( "spherical unchanged" ) << (int)Spherical << true << false;
+    QTest::newRow( "equirectangular" ) << (int)Equirectangular << true << true;
+    QTest::newRow( "equirectangular without grid" ) << (int)Equirectangular << false << true;
+    QTest::newRow( "equirectangular unchanged" ) << (int)Equirectangular << true << false;
+    QTest::newRow( "mercator" ) << (int)Mercator << true << true;
+    QTest::newRow( "mercator without grid" ) << (int)Mercator << false << true;
+    QTest::newRow( "mercator unchanged" ) << (int)Mercator << true << false;
+}
+
+void RenderBenchmark::benchmarkGraticule()
+{
+    QFETCH( int, projection );
+    QFETCH( bool, showGrid );
+    QFETCH( bool, pan );
+
+    MarbleMap map( &m_model );
+    map.setMapThemeId( "earth/plain/plain.dgml" );
+    map.setSize( 1280, 720 );
+    map.setProjection( (Projection)projection );
+    map.setShowGrid( showGrid );
+    map.setRadius( 20000 );  // one degree between grid lines
+    map.centerOn( 0.0, 20.0 );
+
+    QImage image( map.size(), QImage::Format_ARGB32_Premultiplied );
+    warmUp( &map, &image );
+
+    qreal lon = 0.0;
+    QBENCHMARK {
+        if ( pan ) {
+            lon += 0.05;
+            map.centerOn( lon, 20.0 );
+        }
+        paintFrame( &map, &image );
+    }
+}
+
+void RenderBenchmark::benchmarkVectorTileZoom_data()
+{
+    QTest::addColumn<int>( "minimumRadius" );
+    QTest::addColumn<int>( "maximumRadius" );
+
+    QTest::newRow( "country" ) << 1000 << 16000;
+    QTest::newRow( "city" ) << 16000 << 256000;
+}
+
+void RenderBenchmark::benchmarkVectorTileZoom()
+{
+    QFETCH( int, minimumRadius );
+    QFETCH( int, maximumRadius );
+
+    // no tiles are installed for this layer, so every tile is an empty document and
+    // the numbers show the cost of switching zoom levels in the model and the tree
+    GeoSceneVectorTile layer( "vectortile" );
+    layer.setSourceDir( "earth/vectortilebenchmark" );
+    layer.setTileSize( QSize( 256, 256 ) );
+    layer.setLevelZeroColumns( 1 );
+    layer.setLevelZeroRows( 1 );
+    layer.setMaximumTileLevel( 17 );
+    layer.setStorageLayout( GeoSceneTiled::OpenStreetMap );
+    layer.setProjection( GeoSceneTiled::Mercator );
+
+    TileLoader loader( m_model.downloadManager(), m_model.pluginManager() );
+    GeoDataTreeModel treeModel;
+    QThreadPool threadPool;
+    VectorTileModel model( &loader, &layer, &treeModel, &threadPool );
+
+    // zoom in and out again
+    QVector<int> radii;
+    for ( qreal radius = minimumRadius; radius < maximumRadius; radius *= 1.25 ) {
+        radii << qRound( radius );
+    }
+    for ( int i = radii.size() - 2; i > 0; --i ) {
+        radii << radii[i];
+    }
+
+    ViewportParams viewport( Mercator, 10.0 * DEG2RAD, 50.0 * DEG2RAD, minimumRadius, QSize( 1280, 720 ) );
+    foreach ( int radius, radii ) {
+        viewport.setRadius( radius );
+        model.setViewport( viewport.viewLatLonAltBox(), radius );
+        threadPool.waitForDone();
+        QTest::qWait( 200 );  // let the parsed tiles get into the tree model
+    }
+
+    // the tree model is updated whenever the timer of the model fires in between
+    int step = 0;
+    QBENCHMARK {
+        viewport.setRadius( radii[step] );
+        step = ( step + 1 ) % radii.size();
+        model.setViewport( viewport.viewLatLonAltBox(), viewport.radius() );
+        threadPool.waitForDone();
+        QCoreApplication::processEvents();
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::RenderBenchmark )
+
+#include "RenderBenchmark.moc"
@@ -0,0 +1,146 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "RenderProfiler.h"
+
+#include <QDir>
+#include <QFile>
+#include <QtTest>
+
+namespace Marble
+{
+
+class RenderProfilerTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void cleanup();
+
+    void disabled();
+    void scopes();
+    void histogram();
+    void exportChromeTrace();
+
+    void benchmarkScopeDisabled();
+    void benchmarkScopeEnabled();
+};
+
+void RenderProfilerTest::cleanup()
+{
+    RenderProfiler::setEnabled( false );
+    RenderProfiler::clear();
+}
+
+void RenderProfilerTest::disabled()
+{
+    {
+        RenderProfiler::Scope scope( "disabled" );
+    }
+
+    QVERIFY( RenderProfiler::names().isEmpty() );
+    QCOMPARE( RenderProfiler::count( "disabled" ), 0 );
+}
+
+void RenderProfilerTest::scopes()
+{
+    RenderProfiler::setEnabled( true );
+
+    for ( int i = 0; i < 3; ++i ) {
+        RenderProfiler::Scope frame( "frame" );
+        RenderProfiler::Scope layer( QString( "layer" ) );
+    }
+
+    QCOMPARE( RenderProfiler::names(), QStringList() << "frame" << "layer" );
+    QCOMPARE( RenderProfiler::count( "frame" ), 3 );
+    QCOMPARE( RenderProfiler::count( "layer" ), 3 );
+    QCOMPARE( RenderProfiler::count( "other" ), 0 );
+
+    // enabling again starts a new profile
+    RenderProfiler::setEnabled( false );
+    RenderProfiler::setEnabled( true );
+    QVERIFY( RenderProfiler::names().isEmpty() );
+}
+
+void RenderProfilerTest::histogram()
+{
+    RenderProfiler::setEnabled( true );
+
+    for ( int i = 0; i < 10; ++i ) {
+        RenderProfiler::Scope scope( "sleep" );
+        QTest::qSleep( 2 );
+    }
+
+    QVector<int> const buckets = RenderProfiler::histogram( "sleep" );
+    QCOMPARE( buckets.size(), int( RenderProfiler::BucketCount ) );
+
+    int total = 0;
+    foreach ( int count, buckets ) {
+        total += count;
+    }
+    QCOMPARE( total, 10 );
+
+    // nothing below 1 ms = 2^10 microseconds
+    for ( int i = 0; i < 10; ++i ) {
+        QCOMPARE( buckets[i], 0 );
+    }
+
+    QVERIFY( RenderProfiler::percentile( "sleep", 0.5 ) >= 2000 );
+    QVERIFY( RenderProfiler::percentile( "sleep", 0.0 ) <= RenderProfiler::percentile( "sleep", 1.0 ) );
+    QCOMPARE( RenderProfiler::percentile( "other", 0.5 ), qint64( 0 ) );
+}
+
+void RenderProfilerTest::exportChromeTrace()
+{
+    RenderProfiler::setEnabled( true );
+
+    {
+        RenderProfiler::Scope frame( "frame" );
+        RenderProfiler::Scope layer( QString( "\"quoted\" layer" ) );
+    }
+
+    QString const fileName = QDir::tempPath() + QString( "/marble-renderprofile-%1.json" )
+            .arg( QCoreApplication::applicationPid() );
+    QVERIFY( RenderProfiler::exportChromeTrace( fileName ) );
+
+    QFile file( fileName );
+    QVERIFY( file.open( QIODevice::ReadOnly ) );
+    QString const trace = QString::fromUtf8( file.readAll() );
+    file.close();
+    QFile::remove( fileName );
+
+    QVERIFY( trace.startsWith( "{\"traceEvents\":[" ) );
+    QVERIFY( trace.trimmed().endsWith( '}' ) );
+    QCOMPARE( trace.count( "\"ph\":\"X\"" ), 2 );
+
+    // the inner scope ends first
+    QVERIFY( trace.indexOf( "\"name\":\"\\\"quoted\\\" layer\"" ) > 0 );
+    QVERIFY( trace.indexOf( "\"name\":\"\\\"quoted\\\" layer\"" ) < trace.indexOf( "\"name\":\"frame\"" ) );
+}
+
+void RenderProfilerTest::benchmarkScopeDisabled()
+{
+    QBENCHMARK {
+        RenderProfiler::Scope scope( "benchmark" );
+    }
+}
+
+void RenderProfilerTest::benchmarkScopeEnabled()
+{
+    RenderProfiler::setEnabled( true );
+
+    QBENCHMARK {
+        RenderProfiler::Scope scope( "benchmark" );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::RenderProfilerTest )
+
+#include "RenderProfilerTest.moc"
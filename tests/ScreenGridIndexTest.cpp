@@ -0,0 +1,160 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ScreenGridIndex.h"
+
+#include <QtTest>
+
+namespace Marble
+{
+
+class ScreenGridIndexTest : public QObject
+{
+    Q_OBJECT
+
+ private Q_SLOTS:
+    void itemsAt_data();
+    void itemsAt();
+    void insertionOrder();
+    void intersects();
+    void reset();
+
+    void benchmarkItemsAt();
+    void benchmarkLinearScan();
+
+ private:
+    /// 20000 labels of 60x14 pixels spread over a 1920x1080 screen
+    static QVector<QRectF> labels();
+};
+
+QVector<QRectF> ScreenGridIndexTest::labels()
+{
+    QVector<QRectF> rects;
+    for ( int i = 0; i < 20000; ++i ) {
+        rects << QRectF( ( i * 97 ) % 1920, ( i * 53 ) % 1080, 60, 14 );
+    }
+
+    return rects;
+}
+
+void ScreenGridIndexTest::itemsAt_data()
+{
+    QTest::addColumn<QPointF>( "point" );
+    QTest::addColumn<int>( "count" );
+
+    QTest::newRow( "inside" ) << QPointF( 110, 110 ) << 1;
+    QTest::newRow( "overlap" ) << QPointF( 140, 140 ) << 2;
+    QTest::newRow( "cell border" ) << QPointF( 128, 150 ) << 2;
+    QTest::newRow( "nothing" ) << QPointF( 300, 300 ) << 0;
+    QTest::newRow( "left of screen" ) << QPointF( -20, 20 ) << 1;
+    QTest::newRow( "right of screen" ) << QPointF( 700, 420 ) << 1;
+}
+
+void ScreenGridIndexTest::itemsAt()
+{
+    QFETCH( QPointF, point );
+    QFETCH( int, count );
+
+    ScreenGridIndex<int> index;
+    index.reset( QSize( 640, 480 ) );
+    index.insert( QRectF( 100, 100, 50, 50 ), 1 );
+    index.insert( QRectF( 120, 130, 50, 50 ), 2 );
+    index.insert( QRectF( -50, 0, 60, 40 ), 3 );
+    index.insert( QRectF( 600, 400, 200, 50 ), 4 );
+
+    QCOMPARE( index.itemsAt( point ).size(), count );
+}
+
+void ScreenGridIndexTest::insertionOrder()
+{
+    ScreenGridIndex<int> index;
+    index.reset( QSize( 640, 480 ) );
+    index.insert( QRectF( 10, 10, 100, 100 ), 3 );
+    index.insert( QRectF( 20, 20, 100, 100 ), 1 );
+    index.insert( QRectF( 30, 30, 10, 10 ), 3 );
+    index.insert( QRectF( 30, 30, 100, 100 ), 2 );
+
+    QVector<int> expected;
+    expected << 3 << 1 << 2;
+    QCOMPARE( index.itemsAt( QPointF( 35, 35 ) ), expected );
+}
+
+void ScreenGridIndexTest::intersects()
+{
+    ScreenGridIndex<int> index;
+    index.reset( QSize( 640, 480 ) );
+    index.insert( QRectF( 100, 100, 50, 50 ), 1 );
+
+    QVERIFY( index.intersects( QRectF( 140, 140, 200, 10 ) ) );
+    QVERIFY( index.intersects( QRectF( 0, 0, 640, 480 ) ) );
+    QVERIFY( !index.intersects( QRectF( 151, 100, 50, 50 ) ) );
+    QVERIFY( !index.intersects( QRectF( 0, 0, 99, 99 ) ) );
+}
+
+void ScreenGridIndexTest::reset()
+{
+    ScreenGridIndex<int> index;
+    QVERIFY( index.itemsAt( QPointF( 0, 0 ) ).isEmpty() );
+
+    index.reset( QSize( 640, 480 ) );
+    index.insert( QRectF( 100, 100, 50, 50 ), 1 );
+    QCOMPARE( index.size(), 1 );
+
+    index.clear();
+    QVERIFY( index.isEmpty() );
+    QVERIFY( index.itemsAt( QPointF( 120, 120 ) ).isEmpty() );
+
+    // a larger screen
+    index.reset( QSize( 1280, 1024 ) );
+    index.insert( QRectF( 1000, 900, 50, 50 ), 2 );
+    QCOMPARE( index.itemsAt( QPointF( 1020, 920 ) ), QVector<int>() << 2 );
+}
+
+void ScreenGridIndexTest::benchmarkItemsAt()
+{
+    const QVector<QRectF> rects = labels();
+
+    ScreenGridIndex<int> index;
+    index.reset( QSize( 1920, 1080 ) );
+    for ( int i = 0; i < rects.size(); ++i ) {
+        index.insert( rects[i], i );
+    }
+
+    int found = 0;
+    QBENCHMARK {
+        for ( int x = 0; x < 1920; x += 40 ) {
+            found += index.itemsAt( QPointF( x, 540 ) ).size();
+        }
+    }
+    QVERIFY( found > 0 );
+}
+
+void ScreenGridIndexTest::benchmarkLinearScan()
+{
+    const QVector<QRectF> rects = labels();
+
+    int found = 0;
+    QBENCHMARK {
+        for ( int x = 0; x < 1920; x += 40 ) {
+            QVector<int> result;
+            for ( int i = 0; i < rects.size(); ++i ) {
+                if ( rects[i].contains( QPointF( x, 540 ) ) ) {
+                    result.append( i );
+                }
+            }
+            found += result.size();
+        }
+    }
+    QVERIFY( found > 0 );
+}
+
+}
+
+QTEST_MAIN( Marble::ScreenGridIndexTest )
+
+#include "ScreenGridIndexTest.moc"
@@ -20,6 +20,7 @@
 #include <GeoDataFolder.h>
 #include <GeoDataTrack.h>
 #include <GeoDataExtendedData.h>
+#include <GeoDataLineString.h>
 #include <GeoDataSimpleArrayData.h>
 #include "TestUtils.h"
 
@@ -36,6 +37,11 @@ private slots:
     void removeAfterTest();
     void extendedDataParseTest();
     void withoutTimeTest();
+    void addPointTest();
+    void interpolateTest();
+    void lineStringTest();
+    void unsortedTest();
+    void benchmarkAddPoint();
 };
 
 void TestGeoDataTrack::initTestCase()
@@ -319,6 +325,171 @@ void TestGeoDataTrack::withoutTimeTest()
     delete dataDocument;
 }
 
+void TestGeoDataTrack::addPointTest()
+{
+    const QDateTime start( QDate( 2010, 5, 28 ), QTime( 2, 2, 0 ), Qt::UTC );
+
+    GeoDataTrack track;
+    track.addPoint( start.addSecs( 20 ), GeoDataCoordinates( 20, 0, 0, GeoDataCoordinates::Degree ) );
+    track.addPoint( start, GeoDataCoordinates( 0, 0, 0, GeoDataCoordinates::Degree ) );
+    track.addPoint( start.addSecs( 30 ), GeoDataCoordinates( 30, 0, 0, GeoDataCoordinates::Degree ) );
+    track.addPoint( start.addSecs( 10 ), GeoDataCoordinates( 10, 0, 0, GeoDataCoordinates::Degree ) );
+    QCOMPARE( track.size(), 4 );
+
+    for ( int i = 0; i < track.size(); ++i ) {
+        QCOMPARE( track.whenList().at( i ), start.addSecs( 10 * i ) );
+        QCOMPARE( track.coordinatesAt( i ).longitude( GeoDataCoordinates::Degree ), 10.0 * i );
+        QCOMPARE( track.coordinatesAt( start.addSecs( 10 * i ) ).longitude( GeoDataCoordinates::Degree ), 10.0 * i );
+    }
+
+    QCOMPARE( track.firstWhen(), start );
+    QCOMPARE( track.lastWhen(), start.addSecs( 30 ) );
+}
+
+void TestGeoDataTrack::interpolateTest()
+{
+    const QDateTime start( QDate( 2010, 5, 28 ), QTime( 2, 2, 0 ), Qt::UTC );
+
+    GeoDataTrack track;
+    track.addPoint( start, GeoDataCoordinates( 0, 0, 100, GeoDataCoordinates::Degree ) );
+    track.addPoint( start.addSecs( 10 ), GeoDataCoordinates( 10, 0, 200, GeoDataCoordinates::Degree ) );
+
+    QVERIFY( !track.coordinatesAt( start.addSecs( 5 ) ).isValid() );
+
+    track.setInterpolate( true );
+    GeoDataCoordinates coord = track.coordinatesAt( start.addSecs( 5 ) );
+    QVERIFY( coord.isValid() );
+    QFUZZYCOMPARE( coord.longitude( GeoDataCoordinates::Degree ), 5.0, 0.0001 );
+    QFUZZYCOMPARE( coord.altitude(), 150.0, 0.0001 );
+
+    QVERIFY( !track.coordinatesAt( start.addSecs( -5 ) ).isValid() );
+    QVERIFY( !track.coordinatesAt( start.addSecs( 15 ) ).isValid() );
+}
+
+void TestGeoDataTrack::lineStringTest()
+{
+    const QDateTime start( QDate( 2010, 5, 28 ), QTime( 2, 2, 0 ), Qt::UTC );
+
+    GeoDataTrack track;
+    for ( int i = 0; i < 10; ++i ) {
+        track.addPoint( start.addSecs( i ), GeoDataCoordinates( i, 0, 0, GeoDataCoordinates::Degree ) );
+    }
+    QCOMPARE( track.lineString()->size(), 10 );
+
+    // appended points extend the existing line string
+    const GeoDataLineString *lineString = track.lineString();
+    track.addPoint( start.addSecs( 10 ), GeoDataCoordinates( 10, 0, 0, GeoDataCoordinates::Degree ) );
+    QCOMPARE( track.lineString(), lineString );
+    QCOMPARE( track.lineString()->size(), 11 );
+    QCOMPARE( track.lineString()->last().longitude( GeoDataCoordinates::Degree ), 10.0 );
+
+    // points inserted in between are picked up as well
+    track.addPoint( start.addMSecs( 500 ), GeoDataCoordinates( 0.5, 0, 0, GeoDataCoordinates::Degree ) );
+    QCOMPARE( track.lineString()->size(), 12 );
+    QCOMPARE( track.lineString()->at( 1 ).longitude( GeoDataCoordinates::Degree ), 0.5 );
+
+    track.removeBefore( start.addSecs( 5 ) );
+    QCOMPARE( track.size(), 6 );
+    QCOMPARE( track.lineString()->size(), 6 );
+    QCOMPARE( track.lineString()->first().longitude( GeoDataCoordinates::Degree ), 5.0 );
+
+    track.removeAfter( start.addSecs( 7 ) );
+    QCOMPARE( track.size(), 3 );
+    QCOMPARE( track.lineString()->size(), 3 );
+    QCOMPARE( track.lineString()->last().longitude( GeoDataCoordinates::Degree ), 7.0 );
+
+    track.appendAltitude( 42.0 );
+    QCOMPARE( track.lineString()->last().altitude(), 42.0 );
+}
+
+void TestGeoDataTrack::unsortedTest()
+{
+    // times in document order are not sorted and one of them is missing
+    QString content(
+"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<kml xmlns=\"http://www.opengis.net/kml/2.2\""
+" xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+"<Folder>"
+"  <Placemark>"
+"    <gx:Track>"
+"      <when>2010-05-28T02:02:35Z</when>"
+"      <when>2010-05-28T02:02:09Z</when>"
+"      <when></when>"
+"      <when>2010-05-28T02:02:53Z</when>"
+"      <when>2010-05-28T02:02:44Z</when>"
+"      <gx:coord>1 0 0</gx:coord>"
+"      <gx:coord>2 0 0</gx:coord>"
+"      <gx:coord>3 0 0</gx:coord>"
+"      <gx:coord>4 0 0</gx:coord>"
+"      <gx:coord>5 0 0</gx:coord>"
+"    </gx:Track>"
+"  </Placemark>"
+"</Folder>"
+"</kml>" );
+
+    GeoDataDocument* dataDocument = parseKml( content );
+    GeoDataFolder *folder = dataDocument->folderList().at( 0 );
+    GeoDataPlacemark* placemark = folder->placemarkList().at( 0 );
+    QCOMPARE( placemark->geometry()->geometryId(), GeoDataTrackId );
+    GeoDataTrack* track = static_cast<GeoDataTrack*>( placemark->geometry() );
+    QCOMPARE( track->size(), 5 );
+
+    const QDateTime start( QDate( 2010, 5, 28 ), QTime( 2, 2, 0 ), Qt::UTC );
+    QCOMPARE( track->coordinatesAt( start.addSecs( 9 ) ).longitude( GeoDataCoordinates::Degree ), 2.0 );
+    QCOMPARE( track->coordinatesAt( start.addSecs( 35 ) ).longitude( GeoDataCoordinates::Degree ), 1.0 );
+    QCOMPARE( track->coordinatesAt( start.addSecs( 44 ) ).longitude( GeoDataCoordinates::Degree ), 5.0 );
+    QVERIFY( !track->coordinatesAt( start.addSecs( 48 ) ).isValid() );
+
+    // the point without a time is never interpolated from
+    track->setInterpolate( true );
+    QFUZZYCOMPARE( track->coordinatesAt( start.addSecs( 22 ) ).longitude( GeoDataCoordinates::Degree ), 1.5, 0.0001 );
+    QFUZZYCOMPARE( track->coordinatesAt( start.addMSecs( 48500 ) ).longitude( GeoDataCoordinates::Degree ), 4.5, 0.0001 );
+    QVERIFY( !track->coordinatesAt( start.addSecs( 5 ) ).isValid() );
+    QVERIFY( !track->coordinatesAt( start.addSecs( 60 ) ).isValid() );
+
+    // points are removed from the ends up to the first one in the range
+    track->removeBefore( start.addSecs( 30 ) );
+    QCOMPARE( track->size(), 5 );
+    track->removeAfter( start.addSecs( 40 ) );
+    QCOMPARE( track->size(), 3 );
+    QCOMPARE( track->lineString()->size(), 3 );
+    QCOMPARE( track->lineString()->last().longitude( GeoDataCoordinates::Degree ), 3.0 );
+
+    // points added later go before the first later point
+    track->addPoint( start.addSecs( 20 ), GeoDataCoordinates( 6, 0, 0, GeoDataCoordinates::Degree ) );
+    QCOMPARE( track->size(), 4 );
+    QCOMPARE( track->whenList().at( 0 ), start.addSecs( 20 ) );
+
+    delete dataDocument;
+}
+
+void TestGeoDataTrack::benchmarkAddPoint()
+{
+    const QDateTime start( QDate( 2010, 5, 28 ), QTime( 2, 2, 0 ), Qt::UTC );
+    const int points = 1000000;
+    const int lookups = 100000;
+
+    QBENCHMARK {
+        GeoDataTrack track;
+        track.setInterpolate( true );
+        for ( int i = 0; i < points; ++i ) {
+            const qreal lon = -180.0 + 360.0 * i / points;
+            track.addPoint( start.addSecs( i ), GeoDataCoordinates( lon, 0, 0, GeoDataCoordinates::Degree ) );
+            if ( i % ( points / 100 ) == 0 ) {
+                // a recorded track is drawn while it grows
+                track.lineString();
+            }
+        }
+        QCOMPARE( track.size(), points );
+        QCOMPARE( track.lineString()->size(), points );
+
+        for ( int i = 0; i < lookups; ++i ) {
+            const int second = ( i * 7919 ) % ( points - 1 );
+            QVERIFY( track.coordinatesAt( start.addSecs( second ).addMSecs( 500 ) ).isValid() );
+        }
+    }
+}
+
 QTEST_MAIN( TestGeoDataTrack )
 
 #include "TestGeoDataTrack.moc"
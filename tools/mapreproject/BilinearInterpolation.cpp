@@ -4,23 +4,13 @@
 
 #include <cmath>
 
-BilinearInterpolation::BilinearInterpolation( ReadOnlyMapImage * const mapImage )
-    : InterpolationMethod( mapImage )
+namespace
 {
-}
 
-QRgb BilinearInterpolation::interpolate( double const x, double const y )
+inline QRgb blend( QRgb const lowerLeftPixel, QRgb const lowerRightPixel,
+                   QRgb const upperLeftPixel, QRgb const upperRightPixel,
+                   double const fractionX, double const fractionY )
 {
-    int const x1 = x;
-    int const x2 = x1 + 1;
-    int const y1 = y;
-    int const y2 = y1 + 1;
-
-    QRgb const lowerLeftPixel = m_mapImage->pixel( x1, y1 );
-    QRgb const lowerRightPixel = m_mapImage->pixel( x2, y1 );
-    QRgb const upperLeftPixel = m_mapImage->pixel( x1, y2 );
-    QRgb const upperRightPixel = m_mapImage->pixel( x2, y2 );
-
     // interpolate horizontically
     //
     // x2 - x    x2 - x
@@ -31,7 +21,6 @@ QRgb BilinearInterpolation::interpolate( double const x, double const y )
     // ------- = ------ = fractionX
     // x2 - x1     1
 
-    double const fractionX = x - x1;
     double const lowerMidRed   = ( 1.0 - fractionX ) * qRed( lowerLeftPixel )   + fractionX * qRed( lowerRightPixel );
     double const lowerMidGreen = ( 1.0 - fractionX ) * qGreen( lowerLeftPixel ) + fractionX * qGreen( lowerRightPixel );
     double const lowerMidBlue  = ( 1.0 - fractionX ) * qBlue( lowerLeftPixel )  + fractionX * qBlue( lowerRightPixel );
@@ -52,7 +41,6 @@ QRgb BilinearInterpolation::interpolate( double const x, double const y )
     // ------- = ------ = fractionY
     // y2 - y1     1
 
-    double const fractionY = y - y1;
     double const red   = ( 1.0 - fractionY ) * lowerMidRed   + fractionY * upperMidRed;
     double const green = ( 1.0 - fractionY ) * lowerMidGreen + fractionY * upperMidGreen;
     double const blue  = ( 1.0 - fractionY ) * lowerMidBlue  + fractionY * upperMidBlue;
@@ -60,3 +48,42 @@ QRgb BilinearInterpolation::interpolate( double const x, double const y )
 
     return qRgba( round( red ), round( green ), round( blue ), round( alpha ));
 }
+
+}
+
+BilinearInterpolation::BilinearInterpolation( ReadOnlyMapImage * const mapImage )
+    : InterpolationMethod( mapImage )
+{
+}
+
+QRgb BilinearInterpolation::interpolate( double const x, double const y )
+{
+    int const x1 = x;
+    int const x2 = x1 + 1;
+    int const y1 = y;
+    int const y2 = y1 + 1;
+
+    QRgb const lowerLeftPixel = m_mapImage->pixel( x1, y1 );
+    QRgb const lowerRightPixel = m_mapImage->pixel( x2, y1 );
+    QRgb const upperLeftPixel = m_mapImage->pixel( x1, y2 );
+    QRgb const upperRightPixel = m_mapImage->pixel( x2, y2 );
+
+    return blend( lowerLeftPixel, lowerRightPixel, upperLeftPixel, upperRightPixel, x - x1, y - y1 );
+}
+
+void BilinearInterpolation::interpolateRow( double const * const x, double const y, int const count, QRgb * const row )
+{
+    int const y1 = y;
+    int const y2 = y1 + 1;
+    double const fractionY = y - y1;
+
+    ScanLineSegment lowerSegment;
+    ScanLineSegment upperSegment;
+    for ( int i = 0; i < count; ++i ) {
+        int const x1 = x[ i ];
+        int const x2 = x1 + 1;
+        row[ i ] = blend( pixel( x1, y1, lowerSegment ), pixel( x2, y1, lowerSegment ),
+                          pixel( x1, y2, upperSegment ), pixel( x2, y2, upperSegment ),
+                          x[ i ] - x1, fractionY );
+    }
+}
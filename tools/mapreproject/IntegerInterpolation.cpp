@@ -11,3 +11,11 @@ QRgb IntegerInterpolation::interpolate( double const x, double const y )
 {
     return m_mapImage->pixel( static_cast<int>( x ), static_cast<int>( y ));
 }
+
+void IntegerInterpolation::interpolateRow( double const * const x, double const y, int const count, QRgb * const row )
+{
+    int const yi = static_cast<int>( y );
+    ScanLineSegment segment;
+    for ( int i = 0; i < count; ++i )
+        row[ i ] = pixel( static_cast<int>( x[ i ] ), yi, segment );
+}
@@ -11,6 +11,7 @@ public:
     explicit IntegerInterpolation( ReadOnlyMapImage * const mapImage = NULL );
 
     virtual QRgb interpolate( double const x, double const y );
+    virtual void interpolateRow( double const * const x, double const y, int const count, QRgb * const row );
 };
 
 #endif
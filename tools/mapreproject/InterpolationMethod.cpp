@@ -8,3 +8,9 @@ InterpolationMethod::InterpolationMethod( ReadOnlyMapImage * const mapImage )
 InterpolationMethod::~InterpolationMethod()
 {
 }
+
+void InterpolationMethod::interpolateRow( double const * const x, double const y, int const count, QRgb * const row )
+{
+    for ( int i = 0; i < count; ++i )
+        row[ i ] = interpolate( x[ i ], y );
+}
@@ -1,9 +1,9 @@
 #ifndef INTERPOLATIONMETHOD_H
 #define INTERPOLATIONMETHOD_H
 
-#include <QColor>
+#include "ReadOnlyMapImage.h"
 
-class ReadOnlyMapImage;
+#include <QColor>
 
 class InterpolationMethod
 {
@@ -12,9 +12,17 @@ public:
     virtual ~InterpolationMethod();
 
     virtual QRgb interpolate( double const x, double const y ) = 0;
+
+    // Interpolates the pixels at x[0]..x[count-1] and y into row. The default
+    // implementation calls interpolate() for each of them, subclasses read
+    // the source rows directly instead.
+    virtual void interpolateRow( double const * const x, double const y, int const count, QRgb * const row );
+
     void setMapImage( ReadOnlyMapImage * const mapImage );
 
 protected:
+    QRgb pixel( int const x, int const y, ScanLineSegment & segment );
+
     ReadOnlyMapImage * m_mapImage;
 };
 
@@ -24,4 +32,16 @@ inline void InterpolationMethod::setMapImage( ReadOnlyMapImage * const mapImage
     m_mapImage = mapImage;
 }
 
+// Returns the pixel at x in row y, moving segment along the row as needed
+inline QRgb InterpolationMethod::pixel( int const x, int const y, ScanLineSegment & segment )
+{
+    if ( !segment.contains( x ))
+        m_mapImage->scanLine( x, y, segment );
+
+    if ( segment.pixels && segment.contains( x ))
+        return segment.pixels[ x - segment.begin ];
+    else
+        return m_mapImage->pixel( x, y );
+}
+
 #endif
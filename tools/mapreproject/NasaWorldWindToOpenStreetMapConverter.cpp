@@ -1,6 +1,7 @@
 #include "NasaWorldWindToOpenStreetMapConverter.h"
 
 #include "OsmTileClusterRenderer.h"
+#include "SharedTileCache.h"
 #include "Thread.h"
 
 #include <QDebug>
@@ -21,6 +22,11 @@ NasaWorldWindToOpenStreetMapConverter::NasaWorldWindToOpenStreetMapConverter( QO
 {
 }
 
+NasaWorldWindToOpenStreetMapConverter::~NasaWorldWindToOpenStreetMapConverter()
+{
+    qDeleteAll( m_tileCaches );
+}
+
 void NasaWorldWindToOpenStreetMapConverter::setMapSources( QVector<ReadOnlyMapDefinition> const & mapSources )
 {
     m_mapSources = mapSources;
@@ -61,6 +67,19 @@ QVector<QPair<Thread*, OsmTileClusterRenderer*> > NasaWorldWindToOpenStreetMapCo
     if ( osmMapEdgeLengthTiles % m_osmTileClusterEdgeLengthTiles != 0 )
         qFatal("Bad tile cluster size");
 
+    // all threads read the tiles of a map through the same cache, so that
+    // neighboring clusters rendered at the same time share their tiles
+    QVector<ReadOnlyMapDefinition>::iterator pos = m_mapSources.begin();
+    QVector<ReadOnlyMapDefinition>::iterator const end = m_mapSources.end();
+    for (; pos != end; ++pos ) {
+        if ( (*pos).mapType() != NasaWorldWindMap )
+            continue;
+        SharedTileCache * const tileCache = new SharedTileCache( QDir( (*pos).baseDirectory() ),
+                                                                 (*pos).cacheSizeBytes() );
+        (*pos).setTileCache( tileCache );
+        m_tileCaches.push_back( tileCache );
+    }
+
     QVector<QPair<Thread*, OsmTileClusterRenderer*> > renderThreads;
 
     for ( int i = 0; i < m_threadCount; ++i ) {
@@ -10,6 +10,7 @@
 #include <QVector>
 
 class OsmTileClusterRenderer;
+class SharedTileCache;
 class Thread;
 
 // Abbreviations used:
@@ -25,6 +26,7 @@ class NasaWorldWindToOpenStreetMapConverter: public QObject
 
 public:
     explicit NasaWorldWindToOpenStreetMapConverter( QObject * const parent = NULL );
+    ~NasaWorldWindToOpenStreetMapConverter();
 
     void setMapSources( QVector<ReadOnlyMapDefinition> const & mapSources );
     void setOsmBaseDirectory( QDir const & nwwBaseDirectory );
@@ -48,6 +50,7 @@ private:
 
     int m_threadCount;
     QVector<ReadOnlyMapDefinition> m_mapSources;
+    QVector<SharedTileCache*> m_tileCaches;
     QDir m_osmBaseDirectory;
     int m_osmTileLevel;
 
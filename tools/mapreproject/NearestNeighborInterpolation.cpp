@@ -15,3 +15,14 @@ QRgb NearestNeighborInterpolation::interpolate( double const x, double const y )
     int const yr = round( y );
     return m_mapImage->pixel( xr, yr );
 }
+
+void NearestNeighborInterpolation::interpolateRow( double const * const x, double const y, int const count,
+                                                   QRgb * const row )
+{
+    int const yr = round( y );
+    ScanLineSegment segment;
+    for ( int i = 0; i < count; ++i ) {
+        int const xr = round( x[ i ] );
+        row[ i ] = pixel( xr, yr, segment );
+    }
+}
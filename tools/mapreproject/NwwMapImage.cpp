@@ -1,25 +1,25 @@
 #include "NwwMapImage.h"
 
 #include "InterpolationMethod.h"
+#include "SharedTileCache.h"
 
 #include <QDebug>
 #include <cmath>
 
-NwwMapImage::NwwMapImage( QDir const & baseDirectory, int const tileLevel )
+NwwMapImage::NwwMapImage( SharedTileCache * const tileCache, int const tileLevel )
     : m_tileEdgeLengthPixel( 512 ),
       m_emptyPixel( qRgba( 0, 0, 0, 255 )),
-      m_baseDirectory( baseDirectory ),
+      m_tileCache( tileCache ),
       m_tileLevel( tileLevel ),
       m_mapWidthTiles( 10 * pow( 2, m_tileLevel )),
       m_mapHeightTiles( 5 * pow( 2, m_tileLevel )),
       m_mapWidthPixel( m_mapWidthTiles * m_tileEdgeLengthPixel ),
       m_mapHeightPixel( m_mapHeightTiles * m_tileEdgeLengthPixel ),
       m_interpolationMethod(),
-      m_tileCache( DefaultCacheSizeBytes )
+      m_lastTileKey( -1 ),
+      m_lastTile(),
+      m_rowPixelX()
 {
-    if ( !m_baseDirectory.exists() )
-        qFatal( "Base directory '%s' does not exist.", m_baseDirectory.path().toStdString().c_str() );
-
     qDebug() << "tileLevel:" << m_tileLevel
              << "\nmapWidthTiles:" << m_mapWidthTiles
              << "\nmapHeightTiles:" << m_mapHeightTiles
@@ -39,27 +39,44 @@ QRgb NwwMapImage::pixel( int const x, int const y )
     int const tileX = x / m_tileEdgeLengthPixel;
     int const tileY = y / m_tileEdgeLengthPixel;
 
-    // fast check if tile is missing
-    int const tileKey = tileId( tileX, tileY );
-    if ( m_tileMissing.contains( tileKey ))
-        return m_emptyPixel;
-
-    QPair<QImage, bool> potentialTile = tile( tileX, tileY );
-    if ( !potentialTile.second )
+    QImage const potentialTile = tile( tileX, tileY );
+    if ( potentialTile.isNull() )
         return m_emptyPixel;
     else
-        return potentialTile.first.pixel( x % m_tileEdgeLengthPixel,
-                                          m_tileEdgeLengthPixel - y % m_tileEdgeLengthPixel - 1 );
+        return potentialTile.pixel( x % m_tileEdgeLengthPixel,
+                                    m_tileEdgeLengthPixel - y % m_tileEdgeLengthPixel - 1 );
 }
 
-void NwwMapImage::setBaseDirectory( QDir const & baseDirectory )
+void NwwMapImage::pixelRow( double const * const lonRad, double const latRad, int const count, QRgb * const row )
 {
-    m_baseDirectory = baseDirectory;
+    if ( m_rowPixelX.size() < count )
+        m_rowPixelX.resize( count );
+    for ( int i = 0; i < count; ++i )
+        m_rowPixelX[ i ] = lonRadToPixelX( lonRad[ i ] );
+    m_interpolationMethod->interpolateRow( m_rowPixelX.constData(), latRadToPixelY( latRad ), count, row );
 }
 
-void NwwMapImage::setCacheSizeBytes(const int cacheSizeBytes)
+void NwwMapImage::scanLine( int const x, int const y, ScanLineSegment & segment )
 {
-    m_tileCache.setMaxCost( cacheSizeBytes );
+    if ( x < 0 || y < 0 ) {
+        segment = ScanLineSegment();
+        return;
+    }
+
+    int const tileX = x / m_tileEdgeLengthPixel;
+    int const tileY = y / m_tileEdgeLengthPixel;
+    segment.image = tile( tileX, tileY );
+    segment.begin = tileX * m_tileEdgeLengthPixel;
+    segment.end = segment.begin + m_tileEdgeLengthPixel;
+    if ( segment.image.isNull() ) {
+        segment.pixels = NULL;
+        return;
+    }
+
+    // const access does not detach the image from the cache
+    QImage const & image = segment.image;
+    segment.pixels = reinterpret_cast<QRgb const *>(
+                image.scanLine( m_tileEdgeLengthPixel - y % m_tileEdgeLengthPixel - 1 ));
 }
 
 void NwwMapImage::setInterpolationMethod( InterpolationMethod * const method )
@@ -82,29 +99,14 @@ inline int NwwMapImage::tileId( int const tileX, int const tileY )
     return (tileX << 16) + tileY;
 }
 
-QPair<QImage, bool> NwwMapImage::tile( int const tileX, int const tileY )
+QImage NwwMapImage::tile( int const tileX, int const tileY )
 {
     int const tileKey = tileId( tileX, tileY );
-
-    // first check cache
-    QImage * const cachedTile = m_tileCache.object( tileKey );
-    if ( cachedTile )
-        return QPair<QImage, bool>( *cachedTile, true );
-
-    QString const filename = QString("%1/%2/%2_%3.jpg")
-            .arg( m_baseDirectory.path() )
-            .arg( tileY, 4, 10, QLatin1Char('0'))
-            .arg( tileX, 4, 10, QLatin1Char('0'));
-    QImage tile;
-    bool const loaded = tile.load( filename );
-    if ( !loaded ) {
-        m_tileMissing.insert( tileKey );
-        //qDebug() << "Tile" << filename << "not found";
-    } else {
-        m_tileCache.insert( tileKey, new QImage( tile ), tile.byteCount() );
-        //qDebug() << "Tile" << filename << "loaded and inserted in cache";
+    if ( tileKey != m_lastTileKey ) {
+        m_lastTile = m_tileCache->tile( tileX, tileY );
+        m_lastTileKey = tileKey;
     }
-    return QPair<QImage, bool>( tile, loaded );
+    return m_lastTile;
 }
 
 inline double NwwMapImage::lonRadToPixelX( double const lonRad ) const
@@ -4,33 +4,29 @@
 #include "mapreproject.h"
 #include "ReadOnlyMapImage.h"
 
-#include <QCache>
-#include <QDir>
-#include <QPair>
-#include <QSet>
 #include <QColor>
 #include <QImage>
+#include <QVector>
 
 class InterpolationMethod;
+class SharedTileCache;
 
 class NwwMapImage: public ReadOnlyMapImage
 {
 public:
-    NwwMapImage( QDir const & baseDirectory, int const tileLevel );
+    NwwMapImage( SharedTileCache * const tileCache, int const tileLevel );
 
     virtual QRgb pixel( double const lonRad, double const latRad );
     virtual QRgb pixel( int const x, int const y );
+    virtual void pixelRow( double const * const lonRad, double const latRad, int const count, QRgb * const row );
+    virtual void scanLine( int const x, int const y, ScanLineSegment & segment );
 
-    void setBaseDirectory( QDir const & baseDirectory );
-    void setCacheSizeBytes( int const cacheSizeBytes );
     void setInterpolationMethod( InterpolationMethod * const method );
     void setTileLevel( int const level );
 
 private:
-    enum { DefaultCacheSizeBytes = 32 * 1024 * 1024 };
-
     static int tileId( int const tileX, int const tileY );
-    QPair<QImage, bool> tile( int const tileX, int const tileY );
+    QImage tile( int const tileX, int const tileY );
     double lonRadToPixelX( double const lonRad ) const;
     double latRadToPixelY( double const latRad ) const;
 
@@ -41,7 +37,7 @@ private:
     int const m_tileEdgeLengthPixel;
     QRgb const m_emptyPixel;
 
-    QDir m_baseDirectory;
+    SharedTileCache * const m_tileCache;
     int m_tileLevel;
     int m_mapWidthTiles;
     int m_mapHeightTiles;
@@ -51,8 +47,11 @@ private:
 
     InterpolationMethod * m_interpolationMethod;
 
-    QSet<int> m_tileMissing;
-    QCache<int, QImage> m_tileCache;
+    // the last tile used, to avoid locking the shared cache for each pixel
+    int m_lastTileKey;
+    QImage m_lastTile;
+
+    QVector<double> m_rowPixelX;
 };
 
 #endif
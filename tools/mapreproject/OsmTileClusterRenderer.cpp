@@ -5,6 +5,7 @@
 #include <QDebug>
 #include <QTime>
 
+#include <algorithm>
 #include <cmath>
 
 OsmTileClusterRenderer::OsmTileClusterRenderer( QObject * const parent )
@@ -17,7 +18,10 @@ OsmTileClusterRenderer::OsmTileClusterRenderer( QObject * const parent )
       m_clusterEdgeLengthTiles(),
       m_mapSourceDefinitions(),
       m_mapSources(),
-      m_mapSourceCount()
+      m_mapSourceCount(),
+      m_tile( m_osmTileEdgeLengthPixel, m_osmTileEdgeLengthPixel, QImage::Format_ARGB32 ),
+      m_tileLonRad( m_osmTileEdgeLengthPixel ),
+      m_sourceRow( m_osmTileEdgeLengthPixel )
 {
 }
 
@@ -88,14 +92,14 @@ void OsmTileClusterRenderer::renderOsmTileCluster( int const clusterX, int const
     for ( int tileX = tileX1; tileX < tileX2; ++tileX ) {
         QDir const tileDirectory = checkAndCreateDirectory( tileX );
         for ( int tileY = tileY1; tileY < tileY2; ++tileY ) {
-            QImage const osmTile = renderOsmTile( tileX, tileY );
+            bool const tileEmpty = !renderOsmTile( tileX, tileY );
 
             // hack
-            if ( osmTile.isNull() )
+            if ( tileEmpty )
                 continue;
 
             QString const filename = tileDirectory.path() + QString( "/%1.png" ).arg( tileY );
-            bool const saved = osmTile.save( filename );
+            bool const saved = m_tile.save( filename );
             if ( saved )
                 ++tilesRenderedCount;
             else
@@ -109,38 +113,48 @@ void OsmTileClusterRenderer::renderOsmTileCluster( int const clusterX, int const
     emit clusterRendered( this );
 }
 
-QImage OsmTileClusterRenderer::renderOsmTile( int const tileX, int const tileY )
+bool OsmTileClusterRenderer::renderOsmTile( int const tileX, int const tileY )
 {
     //qDebug() << objectName() << "renderOsmTile tileX:" << tileX << ", tileY:" << tileY;
     int const basePixelX = tileX * m_osmTileEdgeLengthPixel;
     int const basePixelY = tileY * m_osmTileEdgeLengthPixel;
 
-    QSize const tileSize( m_osmTileEdgeLengthPixel, m_osmTileEdgeLengthPixel );
-    QImage tile( tileSize, QImage::Format_ARGB32 );
+    // the longitudes are the same for all rows
+    for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x )
+        m_tileLonRad[ x ] = osmPixelXtoLonRad( basePixelX + x );
+
     bool tileEmpty = true;
 
     for ( int y = 0; y < m_osmTileEdgeLengthPixel; ++y ) {
         int const pixelY = basePixelY + y;
         double const latRad = osmPixelYtoLatRad( pixelY );
+        QRgb * const row = reinterpret_cast<QRgb *>( m_tile.scanLine( y ));
+
+        if ( m_mapSourceCount == 0 ) {
+            for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x )
+                row[ x ] = m_emptyPixel;
+            continue;
+        }
 
-        for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x ) {
-            int const pixelX = basePixelX + x;
-            double const lonRad = osmPixelXtoLonRad( pixelX );
-
-            QRgb color = m_emptyPixel;
-            for (int i = 0; i < m_mapSourceCount; ++i)
-            {
-               color = m_mapSources[i]->pixel( lonRad, latRad );
-               if ( color != m_emptyPixel ) {
-                   tileEmpty = false;
-                   break;
-               }
+        // use the first source that has a pixel
+        m_mapSources[0]->pixelRow( m_tileLonRad.constData(), latRad, m_osmTileEdgeLengthPixel, row );
+        for ( int i = 1; i < m_mapSourceCount; ++i ) {
+            if ( std::find( row, row + m_osmTileEdgeLengthPixel, m_emptyPixel ) == row + m_osmTileEdgeLengthPixel )
+                break;
+            m_mapSources[i]->pixelRow( m_tileLonRad.constData(), latRad, m_osmTileEdgeLengthPixel,
+                                       m_sourceRow.data() );
+            for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x ) {
+                if ( row[ x ] == m_emptyPixel )
+                    row[ x ] = m_sourceRow[ x ];
             }
+        }
 
-            tile.setPixel( x, y, color );
+        for ( int x = 0; tileEmpty && x < m_osmTileEdgeLengthPixel; ++x ) {
+            if ( row[ x ] != m_emptyPixel )
+                tileEmpty = false;
         }
     }
-    return tileEmpty ? QImage() : tile;
+    return !tileEmpty;
 }
 
 inline double OsmTileClusterRenderer::osmPixelXtoLonRad( int const pixelX ) const
@@ -32,7 +32,7 @@ public slots:
 
 private:
     QDir checkAndCreateDirectory( int const tileX ) const;
-    QImage renderOsmTile( int const tileX, int const tileY );
+    bool renderOsmTile( int const tileX, int const tileY );
     double osmPixelXtoLonRad( int const pixelX ) const;
     double osmPixelYtoLatRad( int const pixelY ) const;
 
@@ -47,6 +47,11 @@ private:
     QVector<ReadOnlyMapDefinition> m_mapSourceDefinitions;
     QVector<ReadOnlyMapImage*> m_mapSources;
     int m_mapSourceCount;
+
+    // reused for all tiles, which are written to disk one by one
+    QImage m_tile;
+    QVector<double> m_tileLonRad;
+    QVector<QRgb> m_sourceRow;
 };
 
 #endif
@@ -12,6 +12,7 @@ ReadOnlyMapDefinition::ReadOnlyMapDefinition()
       m_baseDirectory(),
       m_tileLevel( -1 ),
       m_cacheSizeBytes(),
+      m_tileCache(),
       m_filename()
 {
 }
@@ -39,10 +40,11 @@ ReadOnlyMapImage * ReadOnlyMapDefinition::createReadOnlyMap() const
         qFatal( "Unsupported interpolation method: '%i'", m_interpolationMethod );
 
     if ( m_mapType == NasaWorldWindMap ) {
-        NwwMapImage * const mapImage = new NwwMapImage( m_baseDirectory, m_tileLevel );
+        if ( !m_tileCache )
+            qFatal( "No tile cache for '%s'", m_baseDirectory.toStdString().c_str() );
+        NwwMapImage * const mapImage = new NwwMapImage( m_tileCache, m_tileLevel );
         interpolationMethod->setMapImage( mapImage );
         mapImage->setInterpolationMethod( interpolationMethod );
-        mapImage->setCacheSizeBytes( m_cacheSizeBytes );
         return mapImage;
     }
     else if ( m_mapType == BathymetryMap ) {
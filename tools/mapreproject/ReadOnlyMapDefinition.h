@@ -8,6 +8,7 @@
 
 class InterpolationMethod;
 class ReadOnlyMapImage;
+class SharedTileCache;
 
 class ReadOnlyMapDefinition
 {
@@ -18,12 +19,17 @@ public:
 
     ReadOnlyMapImage * createReadOnlyMap() const;
 
+    QString baseDirectory() const;
+    int cacheSizeBytes() const;
+    MapSourceType mapType() const;
+
     void setBaseDirectory( QString const & baseDirectory );
     void setCacheSizeBytes( int const cacheSizeBytes );
     void setInterpolationMethod( EInterpolationMethod const interpolationMethod );
     void setFileName( QString const & fileName );
     void setMapType( MapSourceType const mapType );
     void setTileLevel( int const tileLevel );
+    void setTileCache( SharedTileCache * const tileCache );
 
 private:
     InterpolationMethod * createInterpolationMethod() const;
@@ -35,6 +41,7 @@ private:
     QString m_baseDirectory;
     int m_tileLevel;
     int m_cacheSizeBytes;
+    SharedTileCache * m_tileCache;
 
     // relevant for non-tiled maps (only one image)
     QString m_filename;
@@ -45,6 +52,21 @@ QDebug operator<<( QDebug dbg, ReadOnlyMapDefinition const & r);
 
 // inline definitions
 
+inline QString ReadOnlyMapDefinition::baseDirectory() const
+{
+    return m_baseDirectory;
+}
+
+inline int ReadOnlyMapDefinition::cacheSizeBytes() const
+{
+    return m_cacheSizeBytes;
+}
+
+inline MapSourceType ReadOnlyMapDefinition::mapType() const
+{
+    return m_mapType;
+}
+
 inline void ReadOnlyMapDefinition::setBaseDirectory( QString const & baseDirectory )
 {
     m_baseDirectory = baseDirectory;
@@ -75,6 +97,11 @@ inline void ReadOnlyMapDefinition::setTileLevel( int const tileLevel )
     m_tileLevel = tileLevel;
 }
 
+inline void ReadOnlyMapDefinition::setTileCache( SharedTileCache * const tileCache )
+{
+    m_tileCache = tileCache;
+}
+
 
 inline QDebug operator<<( QDebug dbg, ReadOnlyMapDefinition const & r)
 {
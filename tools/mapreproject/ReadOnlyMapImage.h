@@ -2,9 +2,23 @@
 #define READONLYMAPIMAGE_H
 
 #include <QColor>
+#include <QImage>
 
 class InterpolationMethod;
 
+// A run of consecutive pixels of one row of a map image
+struct ScanLineSegment
+{
+    ScanLineSegment();
+
+    bool contains( int const x ) const;
+
+    QImage image;          // keeps the pixels alive
+    QRgb const * pixels;   // pixel x is at pixels[ x - begin ], NULL if there is no image data
+    int begin;
+    int end;
+};
+
 class ReadOnlyMapImage
 {
 public:
@@ -12,7 +26,30 @@ public:
 
     virtual QRgb pixel( double const lonRad, double const latRad ) = 0;
     virtual QRgb pixel( int const x, int const y ) = 0;
+
+    // Fills row with the pixels at lonRad[0]..lonRad[count-1] and latRad
+    virtual void pixelRow( double const * const lonRad, double const latRad, int const count, QRgb * const row ) = 0;
+
+    // Sets segment to the pixels of row y around x, e.g. the part of the row
+    // in the tile containing x. For pixels outside the segment or without
+    // image data pixel( int, int ) has to be used instead.
+    virtual void scanLine( int const x, int const y, ScanLineSegment & segment ) = 0;
+
     virtual void setInterpolationMethod( InterpolationMethod * const interpolationMethod ) = 0;
 };
 
+
+inline ScanLineSegment::ScanLineSegment()
+    : image(),
+      pixels( NULL ),
+      begin( 0 ),
+      end( 0 )
+{
+}
+
+inline bool ScanLineSegment::contains( int const x ) const
+{
+    return x >= begin && x < end;
+}
+
 #endif
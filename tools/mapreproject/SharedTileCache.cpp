@@ -0,0 +1,59 @@
+#include "SharedTileCache.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+SharedTileCache::SharedTileCache( QDir const & baseDirectory, int const cacheSizeBytes )
+    : m_baseDirectory( baseDirectory.path() )
+{
+    if ( !baseDirectory.exists() )
+        qFatal( "Base directory '%s' does not exist.", baseDirectory.path().toStdString().c_str() );
+
+    // each stripe has to hold some tiles, otherwise the cache would reject them all
+    int const stripeSizeBytes = qMax<int>( cacheSizeBytes / StripeCount, MinimumStripeSizeBytes );
+    for ( int i = 0; i < StripeCount; ++i )
+        m_stripes[ i ].tiles.setMaxCost( stripeSizeBytes );
+
+    qDebug() << "tile cache:" << m_baseDirectory
+             << "\nstripes:" << StripeCount
+             << "\nstripeSizeBytes:" << stripeSizeBytes;
+}
+
+QImage SharedTileCache::tile( int const tileX, int const tileY )
+{
+    int const tileKey = ( tileX << 16 ) + tileY;
+
+    // neighboring tiles are in different stripes
+    Stripe & stripe = m_stripes[ static_cast<unsigned int>( tileX ^ tileY ) % StripeCount ];
+
+    // The lock is kept while loading, so that a tile needed by several
+    // threads at once is only loaded once
+    QMutexLocker locker( &stripe.mutex );
+
+    if ( stripe.missingTiles.contains( tileKey ))
+        return QImage();
+
+    QImage * const cachedTile = stripe.tiles.object( tileKey );
+    if ( cachedTile )
+        return *cachedTile;
+
+    QString const filename = QString("%1/%2/%2_%3.jpg")
+            .arg( m_baseDirectory )
+            .arg( tileY, 4, 10, QLatin1Char('0'))
+            .arg( tileX, 4, 10, QLatin1Char('0'));
+    QImage tile;
+    bool const loaded = tile.load( filename );
+    if ( !loaded ) {
+        stripe.missingTiles.insert( tileKey );
+        //qDebug() << "Tile" << filename << "not found";
+        return QImage();
+    }
+
+    // the interpolation methods read the pixels directly
+    if ( tile.format() != QImage::Format_ARGB32 && tile.format() != QImage::Format_RGB32 )
+        tile = tile.convertToFormat( QImage::Format_ARGB32 );
+
+    stripe.tiles.insert( tileKey, new QImage( tile ), tile.byteCount() );
+    //qDebug() << "Tile" << filename << "loaded and inserted in cache";
+    return tile;
+}
@@ -0,0 +1,39 @@
+#ifndef SHAREDTILECACHE_H
+#define SHAREDTILECACHE_H
+
+#include <QCache>
+#include <QDir>
+#include <QImage>
+#include <QMutex>
+#include <QSet>
+
+// Cache for the tiles of a NASA WorldWind map, shared by all render threads.
+// The tiles are spread over stripes with a lock each, so threads only wait
+// for each other if they need tiles of the same stripe at the same time.
+class SharedTileCache
+{
+public:
+    SharedTileCache( QDir const & baseDirectory, int const cacheSizeBytes );
+
+    // Returns the tile, or a null image if it does not exist.
+    // The pixels are in QImage::Format_ARGB32 or QImage::Format_RGB32.
+    QImage tile( int const tileX, int const tileY );
+
+private:
+    enum { StripeCount = 16,
+           MinimumStripeSizeBytes = 4 * 512 * 512 * 4 };
+
+    struct Stripe
+    {
+        QMutex mutex;
+        QCache<int, QImage> tiles;
+        QSet<int> missingTiles;
+    };
+
+    Q_DISABLE_COPY( SharedTileCache )
+
+    QString const m_baseDirectory;
+    Stripe m_stripes[ StripeCount ];
+};
+
+#endif
@@ -11,6 +11,10 @@ SimpleMapImage::SimpleMapImage( QString const & fileName )
 {
     if ( m_image.isNull() )
         qFatal( "Invalid image '%s'", fileName.toStdString().c_str() );
+
+    // the interpolation methods read the pixels directly
+    if ( m_image.format() != QImage::Format_ARGB32 && m_image.format() != QImage::Format_RGB32 )
+        m_image = m_image.convertToFormat( QImage::Format_ARGB32 );
 }
 
 QRgb SimpleMapImage::pixel( double const lonRad,  double const latRad )
@@ -25,6 +29,27 @@ QRgb SimpleMapImage::pixel( int const x, int const y )
     return m_image.pixel( x, m_mapHeightPixel - y - 1 );
 }
 
+void SimpleMapImage::pixelRow( double const * const lonRad, double const latRad, int const count, QRgb * const row )
+{
+    if ( m_rowPixelX.size() < count )
+        m_rowPixelX.resize( count );
+    for ( int i = 0; i < count; ++i )
+        m_rowPixelX[ i ] = lonRadToPixelX( lonRad[ i ] );
+    m_interpolationMethod->interpolateRow( m_rowPixelX.constData(), latRadToPixelY( latRad ), count, row );
+}
+
+void SimpleMapImage::scanLine( int const x, int const y, ScanLineSegment & segment )
+{
+    segment = ScanLineSegment();
+    if ( x < 0 || x >= m_mapWidthPixel || y < 0 || y >= m_mapHeightPixel )
+        return;
+
+    // const access does not detach the image
+    QImage const & image = m_image;
+    segment.pixels = reinterpret_cast<QRgb const *>( image.scanLine( m_mapHeightPixel - y - 1 ));
+    segment.end = m_mapWidthPixel;
+}
+
 void SimpleMapImage::setInterpolationMethod( InterpolationMethod * const interpolationMethod )
 {
     m_interpolationMethod = interpolationMethod;
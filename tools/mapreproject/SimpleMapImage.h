@@ -6,6 +6,7 @@
 #include <QString>
 #include <QColor>
 #include <QImage>
+#include <QVector>
 
 class InterpolationMethod;
 
@@ -16,6 +17,8 @@ public:
 
     virtual QRgb pixel( double const lonRad, double const latRad );
     virtual QRgb pixel( int const x, int const y );
+    virtual void pixelRow( double const * const lonRad, double const latRad, int const count, QRgb * const row );
+    virtual void scanLine( int const x, int const y, ScanLineSegment & segment );
     virtual void setInterpolationMethod( InterpolationMethod * const interpolationMethod );
 
 private:
@@ -26,6 +29,7 @@ private:
     int m_mapWidthPixel;
     int m_mapHeightPixel;
     InterpolationMethod * m_interpolationMethod;
+    QVector<double> m_rowPixelX;
 };
 
 #endif
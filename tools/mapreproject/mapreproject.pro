@@ -22,6 +22,7 @@ SOURCES += main.cpp \
     Thread.cpp \
     ReadOnlyMapImage.cpp \
     ReadOnlyMapDefinition.cpp \
+    SharedTileCache.cpp \
     SimpleMapImage.cpp \
     InterpolationMethod.cpp \
     BilinearInterpolation.cpp \
@@ -36,6 +37,7 @@ HEADERS += \
     mapreproject.h \
     ReadOnlyMapImage.h \
     ReadOnlyMapDefinition.h \
+    SharedTileCache.h \
     SimpleMapImage.h \
     InterpolationMethod.h \
     BilinearInterpolation.h \
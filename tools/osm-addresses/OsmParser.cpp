@@ -10,6 +10,7 @@
 
 #include "OsmParser.h"
 #include "OsmRegionTree.h"
+#include "ContractionHierarchyBuilder.h"
 
 #include "marble/GeoDataLinearRing.h"
 #include "marble/GeoDataLineString.h"
@@ -224,6 +225,7 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
 
     m_placemarks.clear();
     m_osmOsmRegions.clear();
+    m_roads.clear();
 
     int pass = 0;
     bool needAnotherPass = false;
@@ -383,6 +385,12 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
         }
     }
 
+    if ( hasRoutingGraph() ) {
+        qWarning() << "Step 5a: Creating the routing graph from" << m_roads.size() << "roads";
+        writeRoutingGraph();
+        m_roads.clear();
+    }
+
     m_convexHull = convexHull();
     m_coordinates.clear();
     m_nodes.clear();
@@ -627,6 +635,129 @@ void OsmParser::setCategory( Element &element, const QString &key, const QString
     }
 }
 
+void OsmParser::setRoutingGraph( const QString &fileName )
+{
+    m_routingGraph = fileName;
+}
+
+bool OsmParser::hasRoutingGraph() const
+{
+    return !m_routingGraph.isEmpty();
+}
+
+void OsmParser::setRoad( Way &way, const QString &key, const QString &value ) const
+{
+    static QHash<QString, float> speeds;
+    if ( speeds.isEmpty() ) {
+        speeds["motorway"] = 120.0;
+        speeds["motorway_link"] = 60.0;
+        speeds["trunk"] = 100.0;
+        speeds["trunk_link"] = 50.0;
+        speeds["primary"] = 80.0;
+        speeds["primary_link"] = 40.0;
+        speeds["secondary"] = 70.0;
+        speeds["secondary_link"] = 35.0;
+        speeds["tertiary"] = 60.0;
+        speeds["tertiary_link"] = 30.0;
+        speeds["unclassified"] = 50.0;
+        speeds["road"] = 40.0;
+        speeds["residential"] = 30.0;
+        speeds["living_street"] = 10.0;
+        speeds["service"] = 20.0;
+    }
+
+    if ( key == "highway" ) {
+        way.speed = speeds.value( value, 0.0 );
+        if ( value == "motorway" || value == "motorway_link" ) {
+            way.impliedOneway = true;
+        }
+    } else if ( key == "junction" && value == "roundabout" ) {
+        way.impliedOneway = true;
+    } else if ( key == "oneway" ) {
+        if ( value == "yes" || value == "true" || value == "1" ) {
+            way.oneway = 1;
+        } else if ( value == "-1" ) {
+            way.oneway = -1;
+        } else if ( value == "no" || value == "false" || value == "0" ) {
+            way.oneway = 2;
+        }
+    } else if ( key == "maxspeed" ) {
+        bool ok = false;
+        float const speed = value.section( ' ', 0, 0 ).toFloat( &ok );
+        if ( ok && speed > 0.0 ) {
+            way.maxSpeed = value.endsWith( QLatin1String( "mph" ) ) ? speed * 1.609 : speed;
+        }
+    }
+}
+
+bool OsmParser::addRoad( const Way &way )
+{
+    if ( !hasRoutingGraph() || way.speed <= 0.0 || way.nodes.size() < 2 ) {
+        return false;
+    }
+
+    m_roads << way;
+    return true;
+}
+
+void OsmParser::writeRoutingGraph() const
+{
+    ContractionHierarchyBuilder builder;
+    QHash<int, int> graphNodes;
+    int skipped = 0;
+
+    foreach( const Way &road, m_roads ) {
+        bool forward = true;
+        bool backward = true;
+        if ( road.oneway == 1 || ( road.oneway == 0 && road.impliedOneway ) ) {
+            backward = false;
+        } else if ( road.oneway == -1 ) {
+            forward = false;
+        }
+
+        // drive a bit slower than allowed on average
+        float const speed = road.maxSpeed > 0.0 ? qMin( road.speed, road.maxSpeed * 0.9f ) : road.speed;
+
+        int previous = -1;
+        foreach( int node, road.nodes ) {
+            if ( !m_coordinates.contains( node ) ) {
+                ++skipped;
+                previous = -1;
+                continue;
+            }
+
+            QHash<int, int>::const_iterator iter = graphNodes.constFind( node );
+            int current;
+            if ( iter == graphNodes.constEnd() ) {
+                const Coordinate &coordinate = m_coordinates[node];
+                current = builder.addNode( coordinate.lon, coordinate.lat );
+                graphNodes[node] = current;
+            } else {
+                current = iter.value();
+            }
+
+            if ( previous >= 0 ) {
+                builder.addEdge( previous, current, speed, forward, backward );
+            }
+            previous = current;
+        }
+    }
+
+    if ( skipped > 0 ) {
+        qDebug() << "Skipped" << skipped << "unknown road nodes. Check data.";
+    }
+
+    QTime timer;
+    timer.start();
+    builder.contract();
+    qWarning() << "Contracted" << builder.nodeCount() << "nodes with" << builder.shortcutCount()
+               << "shortcuts in" << timer.elapsed() / 1000 << "s";
+
+    if ( !builder.save( m_routingGraph ) ) {
+        qCritical() << "Unable to write the routing graph to" << m_routingGraph;
+    }
+}
+
 // From http://en.wikipedia.org/wiki/Graham_scan#Pseudocode
 GeoDataLinearRing* OsmParser::convexHull() const
 {
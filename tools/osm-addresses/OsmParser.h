@@ -80,6 +80,19 @@ struct Way : public Element {
     QList<int> nodes;
     bool isBuilding;
 
+    // routing attributes of roads: the speed of their highway type in km/h,
+    // the maxspeed tag, and 1 for oneway=yes, -1 for oneway=-1, 2 for oneway=no
+    float speed;
+    float maxSpeed;
+    int oneway;
+    bool impliedOneway;
+
+    Way() : isBuilding( false ),
+        speed( 0.0 ),
+        maxSpeed( 0.0 ),
+        oneway( 0 ),
+        impliedOneway( false ) {}
+
     operator OsmPlacemark() const;
     void setPosition( const QHash<int, Coordinate> &database, OsmPlacemark &placemark ) const;
     void setRegion( const QHash<int, Node> &database, const OsmRegionTree & tree, QList<OsmOsmRegion> & osmOsmRegions, OsmPlacemark &placemark ) const;
@@ -157,6 +170,9 @@ public:
 
     void writeKml( const QString &area, const QString &version, const QString &date, const QString &transport, const QString &payload, const QString &outputKml ) const;
 
+    /** Also write the road network as a routing graph for the local-osm-routing plugin */
+    void setRoutingGraph( const QString &fileName );
+
 protected:
     virtual bool parse( const QFileInfo &file, int pass, bool &needAnotherPass ) = 0;
 
@@ -164,6 +180,14 @@ protected:
 
     void setCategory( Element &element, const QString &key, const QString &value );
 
+    /** Sets the routing attributes of @p way for the tag @p key=@p value */
+    void setRoad( Way &way, const QString &key, const QString &value ) const;
+
+    /** Keeps @p way with all its nodes for the routing graph if it is a road */
+    bool addRoad( const Way &way );
+
+    bool hasRoutingGraph() const;
+
     QHash<int, Coordinate> m_coordinates;
 
     QHash<int, Node> m_nodes;
@@ -209,8 +233,14 @@ private:
 
     QList<OsmOsmRegion> m_osmOsmRegions;
 
+    void writeRoutingGraph() const;
+
     QList<OsmPlacemark> m_placemarks;
 
+    QString m_routingGraph;
+
+    QList<Way> m_roads;
+
     QHash<QString, OsmPlacemark::OsmCategory> m_categoryMap;
 
     mutable Statistic m_statistic;
@@ -31,6 +31,7 @@ SqlWriter::SqlWriter( const QString &filename, QObject* parent ) :
 
     execQuery( "DROP TABLE IF EXISTS placemarks;" );
     execQuery( "CREATE TABLE placemarks ("
+               " id INTEGER PRIMARY KEY,"
                " regionId INTEGER,"
                " nameId INTEGER,"
                " number VARCHAR(8),"
@@ -53,7 +54,9 @@ SqlWriter::SqlWriter( const QString &filename, QObject* parent ) :
     execQuery( "DROP VIEW IF EXISTS places" );
     execQuery( "CREATE VIEW places AS "
                " SELECT"
+               "  placemarks.id AS id,"
                "  placemarks.regionId AS region,"
+               "  placemarks.nameId AS nameId,"
                "  names.name AS name,"
                "  placemarks.number AS number,"
                "  placemarks.category AS category,"
@@ -62,6 +65,16 @@ SqlWriter::SqlWriter( const QString &filename, QObject* parent ) :
                " FROM names"
                " INNER JOIN placemarks"
                " ON names.id=placemarks.nameId" );
+
+    // Search indexes used by the local-osm-search runner: full text indexes
+    // for prefix searches of names and regions, and an R-tree over the
+    // placemark coordinates for searches around a position
+    execQuery( "DROP TABLE IF EXISTS namesFts" );
+    execQuery( "CREATE VIRTUAL TABLE namesFts USING fts3(name)" );
+    execQuery( "DROP TABLE IF EXISTS regionsFts" );
+    execQuery( "CREATE VIRTUAL TABLE regionsFts USING fts3(name)" );
+    execQuery( "DROP TABLE IF EXISTS placemarksRtree" );
+    execQuery( "CREATE VIRTUAL TABLE placemarksRtree USING rtree(id, minLon, maxLon, minLat, maxLat)" );
     execQuery( "BEGIN TRANSACTION" );
 }
 
@@ -71,6 +84,12 @@ SqlWriter::~SqlWriter()
     execQuery( "CREATE INDEX namesIndex ON names(name)" );
     execQuery( "CREATE INDEX placemarksIndex ON placemarks(regionId,nameId,category)" );
     execQuery( "CREATE INDEX regionsIndex ON regions(name,parent,lft,rgt)" );
+
+    execQuery( "BEGIN TRANSACTION" );
+    execQuery( "INSERT INTO namesFts (docid, name) SELECT id, name FROM names" );
+    execQuery( "INSERT INTO regionsFts (docid, name) SELECT id, name FROM regions" );
+    execQuery( "INSERT INTO placemarksRtree SELECT id, lon, lon, lat, lat FROM placemarks" );
+    execQuery( "END TRANSACTION" );
 }
 
 void SqlWriter::addOsmRegion( const OsmRegion &region )
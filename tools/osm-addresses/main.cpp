@@ -63,6 +63,7 @@ void usage()
     qDebug() << "\t--name aName";
     qDebug() << "\t--date aDate";
     qDebug() << "\t--payload aFilename";
+    qDebug() << "\t--routing aFilename (also write a routing graph for offline routing)";
 }
 
 int main( int argc, char *argv[] )
@@ -82,6 +83,7 @@ int main( int argc, char *argv[] )
     QString date;
     QString transport;
     QString payload;
+    QString routingGraph;
     for ( int i=1; i<argc-3; ++i ) {
         QString arg( argv[i] );
         if ( arg == "-v" ) {
@@ -98,6 +100,8 @@ int main( int argc, char *argv[] )
             transport = argv[++i];
         } else if ( arg == "--payload" ) {
             payload = argv[++i];
+        } else if ( arg == "--routing" ) {
+            routingGraph = argv[++i];
         } else {
             usage();
             return 1;
@@ -124,6 +128,9 @@ int main( int argc, char *argv[] )
     Q_ASSERT( parser );
     SqlWriter sql( outputSqlite );
     parser->addWriter( &sql );
+    if ( !routingGraph.isEmpty() ) {
+        parser->setRoutingGraph( routingGraph );
+    }
     parser->read( file, name );
     parser->writeKml( name, version, date, transport, payload, outputKml );
 }
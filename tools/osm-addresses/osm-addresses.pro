@@ -14,6 +14,9 @@ INCLUDEPATH += /home/dennis/marble/export-git/include
 # Marble include dir of the local osm search plugin
 INCLUDEPATH += /home/dennis/marble/src-git/src/plugins/runner/local-osm-search
 
+# Marble include dir of the local osm routing plugin
+INCLUDEPATH += /home/dennis/marble/src-git/src/plugins/runner/local-osm-routing
+
 # Additional marble includes (not exported)
 INCLUDEPATH += /home/dennis/marble/src-git/src/lib
 INCLUDEPATH += /home/dennis/marble/src-git/src/lib/geodata
@@ -38,7 +41,9 @@ SOURCES += main.cpp \
     pbf/fileformat.pb.cc \
     pbf/osmformat.pb.cc \
     pbf/PbfParser.cpp \
-    xml/XmlParser.cpp
+    xml/XmlParser.cpp \
+    /home/dennis/marble/src-git/src/plugins/runner/local-osm-routing/ContractionHierarchy.cpp \
+    /home/dennis/marble/src-git/src/plugins/runner/local-osm-routing/ContractionHierarchyBuilder.cpp
 
 HEADERS += \
     OsmParser.h \
@@ -340,6 +340,7 @@ void PbfParser::parseWay()
                     way.save = true;
                 }
                 setCategory( way, key, value );
+                setRoad( way, key, value );
             }
         }
 
@@ -349,6 +350,13 @@ void PbfParser::parseWay()
             way.nodes.push_back( lastRef );
         }
 
+        // the routing graph needs all nodes of roads, not just the ones kept below
+        if ( addRoad( way ) ) {
+            foreach( int node, way.nodes ) {
+                m_referencedNodes << node;
+            }
+        }
+
         if ( relation.isAdministrativeBoundary && !way.name.isEmpty() ) {
             relation.name = way.name;
             relation.ways << QPair<int, Marble::RelationRole>( inputWay.id(), Marble::Outer );
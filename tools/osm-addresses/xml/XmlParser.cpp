@@ -103,6 +103,7 @@ bool XmlParser::startElement ( const QString & /*namespaceURI*/, const QString &
                 m_way.save = true;
             }
             setCategory( m_way, key, value );
+            setRoad( m_way, key, value );
         }
     } else if ( qName == "tag" && m_element == NodeType ) {
         QString const key = atts.value( "k" );
@@ -133,8 +134,12 @@ bool XmlParser::endElement ( const QString & /*namespaceURI*/, const QString & /
 {
     if ( qName == "node" ) {
         m_nodes[m_id] = m_node;
+        if ( hasRoutingGraph() ) {
+            m_coordinates[m_id] = m_node;
+        }
     } else if ( qName == "way" ) {
         m_ways[m_id] = m_way;
+        addRoad( m_way );
     } else if ( qName == "relation" ) {
         m_relations[m_id] = m_relation;
     }
@@ -18,6 +18,13 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QCache>
+#include <QFuture>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrentRun>
 
 using namespace Marble;
 
@@ -25,8 +32,35 @@ class TileCreatorSourceSrtm : public TileCreatorSource
 {
 public:
     TileCreatorSourceSrtm( const QString &sourceDir )
-        : m_sourceDir( sourceDir )
+        : m_sourceDir( sourceDir ),
+          m_cache( 32 ),
+          m_prefetchCount( 2 * QThread::idealThreadCount() )
     {
+        // Look up which cells exist once instead of probing six directories per tile
+        QStringList dirs;
+        dirs << "Africa" << "Australia" << "Eurasia" << "Silands" << "North_America" << "South_America";
+        foreach( const QString &dir, dirs) {
+            QDir directory( m_sourceDir + '/' + dir );
+            QStringList const nameFilters = QStringList() << "*.hgt" << "*.hgt.zip";
+            foreach( const QString &file, directory.entryList( nameFilters, QDir::Files ) ) {
+                int lng, lat;
+                if ( parseHgtFileName( file, lng, lat ) ) {
+                    QString const fileName = directory.filePath( file.endsWith( ".zip" ) ? file.left( file.size() - 4 ) : file );
+                    // the first directory wins, like before
+                    if ( !m_hgtFiles.contains( qMakePair( lng, lat ) ) ) {
+                        m_hgtFiles.insert( qMakePair( lng, lat ), fileName );
+                    }
+                }
+            }
+        }
+        qDebug() << m_hgtFiles.size() << "hgt files found," << m_prefetchCount << "tiles are created in parallel";
+    }
+
+    ~TileCreatorSourceSrtm()
+    {
+        foreach( QFuture<QImage> future, m_tiles ) {
+            future.waitForFinished();
+        }
     }
 
     virtual QSize fullImageSize() const
@@ -42,6 +76,34 @@ public:
         Q_ASSERT( nmax == 512 );
         int  mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, maxTileLevel );
 
+        // Tiles are requested in order, so the next ones are created in the
+        // thread pool meanwhile. Tiles that got skipped (e.g. existing tiles
+        // when resuming) are simply dropped.
+        qint64 const index = qint64( n ) * mmax + m;
+        QMap<qint64, QFuture<QImage> >::iterator it = m_tiles.begin();
+        while ( it != m_tiles.end() && it.key() < index ) {
+            it = m_tiles.erase( it );
+        }
+
+        qint64 const last = qMin( index + m_prefetchCount, qint64( nmax ) * mmax );
+        for ( qint64 i = index; i < last; ++i ) {
+            if ( !m_tiles.contains( i ) ) {
+                m_tiles.insert( i, QtConcurrent::run( this, &TileCreatorSourceSrtm::createTile,
+                                                      int( i / mmax ), int( i % mmax ), maxTileLevel ) );
+            }
+        }
+
+        QImage const result = m_tiles.value( index ).result();
+        m_tiles.remove( index );
+        return result;
+    }
+
+private:
+    QImage createTile( int n, int m, int maxTileLevel )
+    {
+        int  nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, maxTileLevel );
+        int  mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, maxTileLevel );
+
         qreal startLat = ( ( ( (qreal)n * 180 ) / nmax ) - 90 ) * -1;
         qreal startLng = ( ( (qreal)m * 360 ) / mmax ) - 180;
 
@@ -49,10 +111,10 @@ public:
         int startLatPxResized = c_defaultTileSize * n;
 
 
-        if (hgtFileName(std::floor(startLng), std::floor(startLat)).isNull()
-            && hgtFileName(std::floor(startLng)+1, std::floor(startLat)).isNull()
-            && hgtFileName(std::floor(startLng), std::floor(startLat)-1).isNull()
-            && hgtFileName(std::floor(startLng)+1, std::floor(startLat)-1).isNull()
+        if (!m_hgtFiles.contains(qMakePair<int, int>(std::floor(startLng), std::floor(startLat)))
+            && !m_hgtFiles.contains(qMakePair<int, int>(std::floor(startLng)+1, std::floor(startLat)))
+            && !m_hgtFiles.contains(qMakePair<int, int>(std::floor(startLng), std::floor(startLat)-1))
+            && !m_hgtFiles.contains(qMakePair<int, int>(std::floor(startLng)+1, std::floor(startLat)-1))
         ) {
             QImage ret( c_defaultTileSize, c_defaultTileSize, QImage::Format_ARGB32  );
             QPainter painter( &ret );
@@ -115,37 +177,53 @@ public:
         Q_ASSERT(startLngPxResized - imageLngPxResized >= 0);
         Q_ASSERT(startLatPxResized - imageLatPxResized >= 0);
 
-        QImage croppedImage = image.copy(startLngPx - imageLngPx, startLatPx - imageLatPx, 675, 675);
         QImage ret = image.copy(startLngPxResized - imageLngPxResized, startLatPxResized - imageLatPxResized, c_defaultTileSize, c_defaultTileSize);
         //qDebug() << image.size() << ret.size();
         return ret;
     }
 
-private:
+    static bool parseHgtFileName( const QString &file, int &lng, int &lat )
+    {
+        // e.g. N45E006.hgt
+        if ( file.size() < 11 ) {
+            return false;
+        }
+
+        bool latOk, lngOk;
+        lat = file.mid( 1, 2 ).toInt( &latOk );
+        lng = file.mid( 4, 3 ).toInt( &lngOk );
+        if ( !latOk || !lngOk ) {
+            return false;
+        }
+
+        QChar const NS = file.at( 0 ).toUpper();
+        QChar const EW = file.at( 3 ).toUpper();
+        if ( ( NS != 'N' && NS != 'S' ) || ( EW != 'E' && EW != 'W' ) ) {
+            return false;
+        }
+        if ( NS == 'S' ) lat *= -1;
+        if ( EW == 'W' ) lng *= -1;
+
+        return true;
+    }
+
     QString hgtFileName( int lng, int lat )
     {
-        QChar EW( lng >= 0 ? 'E' : 'W' );
-        QChar NS( lat >= 0 ? 'N' : 'S' );
+        QString const fileName = m_hgtFiles.value( qMakePair( lng, lat ) );
+        if ( fileName.isNull() ) {
+            return fileName;
+        }
 
-        QStringList dirs;
-        dirs << "Africa" << "Australia" << "Eurasia" << "Silands" << "North_America" << "South_America";
-        foreach( const QString &dir, dirs) {
-            QString fileName = m_sourceDir + '/' + dir + '/';
-            if ( lat < 0 ) lat *= -1;
-            fileName += QString( "%1%2%3%4.hgt" ).arg( NS ).arg( lat<0 ? lat*-1 : lat, 2, 10, QLatin1Char('0') )
-                                        .arg( EW ).arg( lng<0 ? lng*-1 : lng, 3, 10, QLatin1Char('0' ) );
-            //qDebug() << fileName;
-
-            if ( !QFile::exists( fileName ) && QFile::exists( fileName + ".zip" ) ) {
-                qDebug() << "zip found, unzipping";
-                QProcess p;
-                p.execute("unzip", QStringList() << fileName + ".zip" );
-                p.waitForFinished();
-                QFile( QDir::currentPath() + '/' + QFileInfo( fileName ).fileName()).rename(fileName);
-            }
-            if ( QFile::exists( fileName ) ) {
-                return fileName;
-            }
+        QMutexLocker locker( &m_unzipMutex );
+        if ( !QFile::exists( fileName ) && QFile::exists( fileName + ".zip" ) ) {
+            qDebug() << "zip found, unzipping";
+            QProcess p;
+            p.execute("unzip", QStringList() << fileName + ".zip" );
+            p.waitForFinished();
+            QFile( QDir::currentPath() + '/' + QFileInfo( fileName ).fileName()).rename(fileName);
+        }
+        if ( QFile::exists( fileName ) ) {
+            return fileName;
         }
 
         return QString();
@@ -153,10 +231,14 @@ private:
 
     QImage readHgt( int lng, int lat )
     {
-        static QCache<QPair<int, int>, QImage > cache( 10 );
-        if ( cache.contains( qMakePair( lng, lat ) ) ) {
-            return *cache[ qMakePair( lng, lat ) ];
+        QPair<int, int> const cell = qMakePair( lng, lat );
+        {
+            QMutexLocker locker( &m_cacheMutex );
+            if ( QImage *cached = m_cache.object( cell ) ) {
+                return *cached;
+            }
         }
+
         QString fileName = hgtFileName( lng, lat );
         if ( fileName.isNull() ) {
             //qDebug() << lng << lat << "hgt file does not exist, returing null image";
@@ -168,39 +250,42 @@ private:
         QFile file( fileName );
 
         file.open( QIODevice::ReadOnly );
-        int iLat = 0;
-        int iLng = 0;
+        QByteArray const data = file.readAll();
+        file.close();
 
         //hgt file is 1201px large, but the last px is overlapping
         QImage image( 1200, 1200, QImage::Format_ARGB32 );
-        while(true) {
-            QByteArray data = file.read( 2 );
-
-            if ( iLng < 1200 ) {
-                unsigned short height =  *(unsigned short*)data.data();
-                height = ( height << 8 | height >> 8 );
-                unsigned int pixel;
-                pixel = height;
-                pixel += 0xFF000000; //fully opaque
-                image.setPixel( iLng, iLat, pixel );
-            }
-
-            if ( iLat >= 1199 && iLng >= 1199 ) break;
-
-            iLng++;
-            if ( iLng > 1200 ) { //here not 1199 but one more, because of overlapping px at the end of the line
-                iLng = 0;
-                iLat++;
+        image.fill( 0xFF000000 );
+        const uchar *source = reinterpret_cast<const uchar *>( data.constData() );
+        int const rows = qMin<int>( 1200, data.size() / ( 2 * 1201 ) );
+        for ( int iLat = 0; iLat < rows; ++iLat ) {
+            QRgb *line = reinterpret_cast<QRgb *>( image.scanLine( iLat ) );
+            const uchar *row = source + iLat * 2 * 1201;
+            for ( int iLng = 0; iLng < 1200; ++iLng ) {
+                // big endian heights
+                unsigned short const height = row[2*iLng] << 8 | row[2*iLng+1];
+                line[iLng] = 0xFF000000 + height; //fully opaque
             }
         }
-        file.close();
 
-        cache.insert( qMakePair( lng, lat ), new QImage( image ) );
+        QMutexLocker locker( &m_cacheMutex );
+        m_cache.insert( cell, new QImage( image ) );
 
         return image;
     }
 
     QString m_sourceDir;
+
+    /** The files of all cells, by the longitude and latitude of their south west corner */
+    QHash<QPair<int, int>, QString> m_hgtFiles;
+    QMutex m_unzipMutex;
+
+    /** Decoded cells, shared by all threads. A tile needs up to four of them. */
+    QCache<QPair<int, int>, QImage> m_cache;
+    QMutex m_cacheMutex;
+
+    int const m_prefetchCount;
+    QMap<qint64, QFuture<QImage> > m_tiles;
 };
 
 TCCoreApplication::TCCoreApplication( int argc, char ** argv ) : QCoreApplication( argc, argv )